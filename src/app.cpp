@@ -1,21 +1,36 @@
 #include "app.h"
 
 #include "board.h"
+#include "bridge.h"
 #include "config.h"
+#include "congestion.h"
 #include "dedup.h"
 #include "frame.h"
+#include "led.h"
 #include "log.h"
+#include "mesh_params.h"
+#include "neighbours.h"
+#include "netcode.h"
+#include "phy.h"
 #include "radio.h"
+#include "relay_ack.h"
+#include "report_ack.h"
+#include "report_rate.h"
+#include "report_store.h"
+#include "role.h"
+#include "tdma.h"
 #include "uart.h"
 
 namespace {
 
 AppState gState;
+AppStats gStats = {};
 bool gTimebaseReady = false;
 
 uint32_t gLastHeartbeatMs = 0;
 uint32_t gLastBattLogMs = 0;
-uint32_t gLastBeaconSlotMs = 0;
+uint32_t gLastBeaconMs = 0;
+uint8_t gBeaconCount = 0;
 uint32_t gLastWindowTickMs = 0;
 uint32_t gLastPingEnqueueMs = 0;
 uint16_t gTxSeq = 0;
@@ -23,20 +38,17 @@ uint16_t gReportSeq = 0;
 uint32_t gLastParsedUartMs = 0;
 uint32_t gNextTxAtMs = 0;
 uint32_t gNextFwdTxAtMs = 0;
-uint32_t gLastStatusReportMs = 0;
-uint8_t gLastReportedFlags = 0xFFU;
+uint32_t gNextDrainAtMs = 0;
 uint32_t gFwdWindowStartMs = 0;
 uint8_t gFwdCountInWindow = 0;
 bool gFwdLmLoggedInWindow = false;
 
-uint16_t gParsedFreqMHz[MAX_FREQS] = {0};
-uint8_t gParsedFreqCount = 0;
+FreqSet gFreqs = {};
 uint8_t SDR_OK = 0;
 
-constexpr uint32_t BEACON_SLOT_PERIOD_MS = 1000UL;
 constexpr uint32_t WINDOW_TICK_PERIOD_MS = 1000UL;
-constexpr uint8_t TX_QUEUE_CAPACITY = 4U;
-constexpr uint8_t FWD_QUEUE_CAPACITY = 6U;
+constexpr uint8_t TX_QUEUE_CAPACITY = Role::TX_QUEUE_CAPACITY;
+constexpr uint8_t FWD_QUEUE_CAPACITY = Role::FWD_QUEUE_CAPACITY;
 constexpr uint8_t TX_FRAME_MAX = 64U;
 constexpr uint32_t RPI_UART_FRESH_MS = 15000UL;
 constexpr uint16_t LOW_BATT_THRESHOLD_MV = 3300U;
@@ -45,11 +57,34 @@ constexpr uint8_t STATUS_SDR_OK_BIT = 1;
 constexpr uint8_t STATUS_UART_VALID_BIT = 2;
 constexpr uint8_t STATUS_LOW_BATT_BIT = 3;
 constexpr uint8_t SCANNER_DST_ID = 0xFFU;
+// Own frames up to this length are queued as FRAG pieces.
+constexpr uint8_t MSG_FRAME_MAX = codec::HEADER_LEN + FRAG_PAYLOAD_MAX + codec::CRC_LEN;
+static_assert((codec::reportBandMaxLen(FREQ_EXTRA_MAX, FREQ_BAND_BYTES) + FRAME_NEIGHBOURS_LEN + FRAME_TRACE_LEN +
+               FRAME_AUTH_LEN) <= MSG_FRAME_MAX,
+              "FREQ_BAND_CHANNELS / FREQ_EXTRA_MAX too large for one fragmented REPORT");
+constexpr uint8_t FRAG_CHUNK_MIN = codec::fragmentChunk(TX_FRAME_MAX - FRAME_AUTH_LEN);
+static_assert((codec::fragmentCount(MSG_FRAME_MAX, FRAG_CHUNK_MIN) > 0U) &&
+                  (codec::fragmentCount(MSG_FRAME_MAX, FRAG_CHUNK_MIN) <= TX_QUEUE_CAPACITY),
+              "a full fragmented message must fit the TX queue");
+static_assert(TX_FRAME_MAX <= RELAY_ACK_FRAME_MAX, "relay ACK entries must hold any sent frame");
+static_assert(TX_FRAME_MAX <= NETCODE_FRAME_MAX, "the recent-frame store must hold any sent frame");
+static_assert(TX_FRAME_MAX <= REPORT_RETX_FRAME_MAX, "REPORT re-send entries must hold any single-frame REPORT");
+static_assert((codec::beaconLen(codec::HEADER_LEN, codec::REPORT_ACK_MAX) + FRAME_AUTH_LEN) <= TX_FRAME_MAX,
+              "a beacon with a full REPORT_ACK list must fit one frame");
+static_assert((MSG_FRAME_MAX + 9U) <= STORE_PAGE_SIZE, "a store page must hold the largest REPORT");
 constexpr bool RADIO_TEST_TX_ACTIVE = RADIO_TEST_TX || RADIO_TEST_BIDIR;
 constexpr bool RADIO_TEST_RX_ACTIVE = RADIO_TEST_RX || RADIO_TEST_BIDIR;
+// Gateways always listen: the export bridge needs every accepted frame.
+constexpr bool RADIO_RX_ACTIVE = RADIO_TEST_RX_ACTIVE || MESH_ENABLED || RX_CAPTURE_ENABLED || Role::EXPORTS;
+constexpr bool BRIDGE_ACTIVE = Role::EXPORTS || RX_CAPTURE_ENABLED;
+constexpr bool RADIO_ACTIVE = RADIO_TEST_TX_ACTIVE || RADIO_RX_ACTIVE;
+constexpr uint8_t PROFILE_CURRENT = 0xFFU;
 
 struct TxItem {
   uint8_t len;
+  uint8_t profileId;  // PROFILE_CURRENT, or a PHY profile to send this frame on.
+  bool resend;        // Copy of an already sent REPORT; never superseded in place.
+  uint32_t queuedAtMs;
   uint8_t data[TX_FRAME_MAX];
 };
 
@@ -58,6 +93,9 @@ struct FwdItem {
   uint8_t data[TX_FRAME_MAX];
   uint8_t src;
   uint16_t msgId;
+  bool traced;  // FLAG_TRACE: stamp this hop's delay at TX.
+  bool asHeard;  // Not yet stamped for TX; only such frames may be coded.
+  uint32_t rxAtMs;
 };
 
 TxItem gTxQueue[TX_QUEUE_CAPACITY] = {};
@@ -70,74 +108,130 @@ uint8_t gFwdHead = 0;
 uint8_t gFwdTail = 0;
 uint8_t gFwdCount = 0;
 
-bool isSep(char ch) {
-  return (ch == ',') || (ch == ' ') || (ch == '\t');
-}
+using Reassembler = codec::Reassembler<FRAG_REASM_SLOTS, FRAG_PAYLOAD_MAX>;
+Reassembler gReasm;  // Role::EXPORTS only; scanner images drop it.
 
 bool timeReached(uint32_t nowMs, uint32_t deadlineMs) {
   return static_cast<int32_t>(nowMs - deadlineMs) >= 0;
 }
 
 uint32_t randomBackoffMs() {
-  if (BACKOFF_MAX_MS <= BACKOFF_MIN_MS) {
-    return BACKOFF_MIN_MS;
+  const codec::MeshParams& params = meshParams();
+  if (params.backoffMaxMs <= params.backoffMinMs) {
+    return params.backoffMinMs;
+  }
+  return static_cast<uint32_t>(random(static_cast<long>(params.backoffMinMs),
+                                      static_cast<long>(params.backoffMaxMs + 1UL)));
+}
+
+// A congested neighbour widens the forward backoff window by its level.
+uint32_t forwardBackoffMs(uint32_t nowMs) {
+  const uint32_t widenMs = static_cast<uint32_t>(meshParams().backoffMaxMs) * congestionHeardLevel(nowMs);
+  if (widenMs == 0UL) {
+    return randomBackoffMs();
   }
-  return static_cast<uint32_t>(random(static_cast<long>(BACKOFF_MIN_MS),
-                                      static_cast<long>(BACKOFF_MAX_MS + 1UL)));
+  return randomBackoffMs() + static_cast<uint32_t>(random(static_cast<long>(widenMs + 1UL)));
 }
 
-bool txQueuePush(const uint8_t* data, uint8_t len) {
+bool txQueuePush(const uint8_t* data,
+                 uint8_t len,
+                 uint32_t nowMs,
+                 uint8_t profileId = PROFILE_CURRENT,
+                 bool resend = false) {
   if ((data == nullptr) || (len == 0U) || (len > TX_FRAME_MAX)) {
     return false;
   }
   if (gTxCount >= TX_QUEUE_CAPACITY) {
     // Full queue policy: drop newest frame.
     logEvent("QSAT");
+    ++gStats.txDropQueue;
     return false;
   }
 
   gTxQueue[gTxTail].len = len;
+  gTxQueue[gTxTail].profileId = profileId;
+  gTxQueue[gTxTail].resend = resend;
+  gTxQueue[gTxTail].queuedAtMs = nowMs;
   for (uint8_t i = 0; i < len; ++i) {
     gTxQueue[gTxTail].data[i] = data[i];
   }
 
   gTxTail = static_cast<uint8_t>((gTxTail + 1U) % TX_QUEUE_CAPACITY);
   ++gTxCount;
-  logEvent2("QADD", gTxCount);
+  ++gStats.txQueued;
+  if (gTxCount > gStats.txQueueHighWater) {
+    gStats.txQueueHighWater = gTxCount;
+  }
+  logFrameEvent2("QADD", gTxCount);
+  return true;
+}
+
+// Queues an own frame, split into FRAG pieces when longer than one radio
+// frame. All pieces or none: a partial message only costs airtime.
+bool txQueuePushFrame(const uint8_t* frame, uint8_t len, uint32_t nowMs, bool resend = false) {
+  if (len <= TX_FRAME_MAX) {
+    return txQueuePush(frame, len, nowMs, PROFILE_CURRENT, resend);
+  }
+  const uint8_t count = fragmentCountFor(frame, len, TX_FRAME_MAX);
+  if (count == 0U) {
+    return false;
+  }
+  if (static_cast<uint8_t>(TX_QUEUE_CAPACITY - gTxCount) < count) {
+    logEvent("QSAT");
+    ++gStats.txDropQueue;
+    return false;
+  }
+  uint8_t piece[TX_FRAME_MAX];
+  for (uint8_t i = 0U; i < count; ++i) {
+    const uint8_t pieceLen = buildFragmentFrame(frame, len, i, piece, sizeof(piece));
+    if ((pieceLen == 0U) || !txQueuePush(piece, pieceLen, nowMs, PROFILE_CURRENT, resend)) {
+      return false;
+    }
+    ++gStats.txFragments;
+  }
   return true;
 }
 
-bool fwdQueuePush(const uint8_t* data, uint8_t len, uint8_t src, uint16_t msgId) {
+bool fwdQueuePush(const uint8_t* data, uint8_t len, const codec::FrameView& view, uint32_t nowMs) {
   if ((data == nullptr) || (len == 0U) || (len > TX_FRAME_MAX)) {
     return false;
   }
   if (gFwdCount >= FWD_QUEUE_CAPACITY) {
     // Forward queue policy: drop newest frame.
     logEvent("FQSAT");
+    ++gStats.fwdDropQueue;
     return false;
   }
 
   gFwdQueue[gFwdTail].len = len;
-  gFwdQueue[gFwdTail].src = src;
-  gFwdQueue[gFwdTail].msgId = msgId;
+  gFwdQueue[gFwdTail].src = view.src();
+  gFwdQueue[gFwdTail].msgId = view.seq();
+  gFwdQueue[gFwdTail].traced = (view.flags() & FRAME_FLAG_TRACE) != 0U;
+  gFwdQueue[gFwdTail].asHeard = true;
+  gFwdQueue[gFwdTail].rxAtMs = nowMs;
   for (uint8_t i = 0; i < len; ++i) {
     gFwdQueue[gFwdTail].data[i] = data[i];
   }
 
   gFwdTail = static_cast<uint8_t>((gFwdTail + 1U) % FWD_QUEUE_CAPACITY);
   ++gFwdCount;
+  ++gStats.fwdQueued;
+  if (gFwdCount > gStats.fwdQueueHighWater) {
+    gStats.fwdQueueHighWater = gFwdCount;
+  }
   return true;
 }
 
 bool forwardRateAllow(uint32_t nowMs) {
-  if ((nowMs - gFwdWindowStartMs) >= WINDOW_MS) {
+  if ((nowMs - gFwdWindowStartMs) >= meshParams().windowMs) {
     gFwdWindowStartMs = nowMs;
     gFwdCountInWindow = 0U;
     gFwdLmLoggedInWindow = false;
   }
-  if (gFwdCountInWindow < MAX_FORWARDS_PER_WINDOW) {
+  if (gFwdCountInWindow < meshParams().maxForwardsPerWindow) {
     return true;
   }
+  ++gStats.fwdDropRate;
   if (!gFwdLmLoggedInWindow) {
     logEvent("FWDLM");
     gFwdLmLoggedInWindow = true;
@@ -151,7 +245,35 @@ void forwardRateConsume() {
   }
 }
 
-const TxItem* txQueueFront() {
+// What neighbours are told: the worse of forward queue fill and forward
+// budget spent in this window. Own traffic is left out; the report rate
+// already paces it.
+uint8_t localCongestionLevel() {
+  const uint8_t queue = congestionLevelFor(gFwdCount, FWD_QUEUE_CAPACITY);
+  const uint8_t budget = congestionLevelFor(gFwdCountInWindow, meshParams().maxForwardsPerWindow);
+  return (queue > budget) ? queue : budget;
+}
+
+// Own REPORT still waiting in the TX queue, whole or as fragments; at most
+// one exists (see enqueueReport). Re-sends do not count.
+TxItem* txQueuePendingReport(bool& fragmented) {
+  for (uint8_t i = 0U; i < gTxCount; ++i) {
+    TxItem& item = gTxQueue[(gTxHead + i) % TX_QUEUE_CAPACITY];
+    codec::FrameView view;
+    if (item.resend || !view.init(item.data, item.len)) {
+      continue;
+    }
+    codec::Fragment frag{};
+    fragmented = codec::parseFragmentView(view, frag) && (frag.innerType == REPORT_TYPE);
+    if (fragmented || (view.type() == REPORT_TYPE)) {
+      return &item;
+    }
+  }
+  fragmented = false;
+  return nullptr;
+}
+
+TxItem* txQueueFront() {
   if (gTxCount == 0U) {
     return nullptr;
   }
@@ -166,7 +288,7 @@ void txQueuePop() {
   --gTxCount;
 }
 
-const FwdItem* fwdQueueFront() {
+FwdItem* fwdQueueFront() {
   if (gFwdCount == 0U) {
     return nullptr;
   }
@@ -181,23 +303,53 @@ void fwdQueuePop() {
   --gFwdCount;
 }
 
+// Removes the item `pos` places behind the front; later ones move up.
+void fwdQueueRemove(uint8_t pos) {
+  if (pos >= gFwdCount) {
+    return;
+  }
+  for (uint8_t k = pos; (k + 1U) < gFwdCount; ++k) {
+    gFwdQueue[(gFwdHead + k) % FWD_QUEUE_CAPACITY] = gFwdQueue[(gFwdHead + k + 1U) % FWD_QUEUE_CAPACITY];
+  }
+  gFwdTail = static_cast<uint8_t>((gFwdTail + FWD_QUEUE_CAPACITY - 1U) % FWD_QUEUE_CAPACITY);
+  --gFwdCount;
+}
+
 uint16_t frameSeq(const uint8_t* frame, uint8_t len) {
-  if ((frame == nullptr) || (len < 7U)) {
-    return 0U;
+  codec::FrameView view;
+  return view.init(frame, len) ? view.seq() : 0U;
+}
+
+// Beacons carry the sender's network time and the time left until an
+// announced PHY switch, both as of TX start.
+void stampBeacon(uint8_t* frame, uint8_t len, uint32_t nowMs) {
+  codec::FrameView view;
+  codec::Beacon beacon{};
+  if (!view.init(frame, len) || !codec::parseBeaconView(view, beacon)) {
+    return;
+  }
+  bool stamped = tdmaSynced(nowMs) && codec::stampBeaconTime(frame, len, tdmaNetTimeMs(nowMs));
+  if (beacon.hasPhy) {
+    stamped = codec::stampBeaconSwitch(frame, len, phySwitchInMs(beacon.phy.target, nowMs)) || stamped;
+  }
+  if (stamped) {
+    // Every node holds the network key, so relays re-sign the new values.
+    frameAuthReseal(frame, len);
   }
-  return static_cast<uint16_t>(frame[5]) |
-         static_cast<uint16_t>(static_cast<uint16_t>(frame[6]) << 8);
 }
 
 void runTxScheduler(uint32_t nowMs) {
-  const TxItem* item = txQueueFront();
+  TxItem* item = txQueueFront();
   if (item == nullptr) {
     gNextTxAtMs = 0U;
     return;
   }
 
+  // Synced: own frames go out in this node's slot, no backoff needed.
+  // Frames for another PHY profile (rescue beacons) do not fit the slot.
+  const bool slotted = tdmaSynced(nowMs) && (item->profileId == PROFILE_CURRENT);
   if (gNextTxAtMs == 0U) {
-    gNextTxAtMs = nowMs + randomBackoffMs();
+    gNextTxAtMs = slotted ? tdmaNextOwnTxMs(nowMs, item->len) : (nowMs + randomBackoffMs());
     return;
   }
 
@@ -209,10 +361,43 @@ void runTxScheduler(uint32_t nowMs) {
     return;
   }
 
+  if (slotted) {
+    const uint32_t slotAtMs = tdmaNextOwnTxMs(nowMs, item->len);
+    if (slotAtMs != nowMs) {
+      gNextTxAtMs = slotAtMs;
+      return;
+    }
+  }
+  stampBeacon(item->data, item->len, nowMs);
+  frameTraceStamp(item->data, item->len, TRACE_ORIGIN, nowMs - item->queuedAtMs);
+  const uint8_t congestion = CONGESTION_ENABLED ? localCongestionLevel() : 0U;
+  if constexpr (CONGESTION_ENABLED) {
+    item->len = frameCongestionStamp(item->data, item->len, TX_FRAME_MAX, congestion);
+  }
+
   const uint16_t seq = frameSeq(item->data, item->len);
-  if (radioSend(item->data, item->len)) {
-    logEvent2("TXOK", seq);
+  const uint8_t activeProfile = radioProfileId();
+  const bool otherProfile = (item->profileId != PROFILE_CURRENT) && (item->profileId != activeProfile);
+  if (otherProfile) {
+    (void)radioApplyProfile(item->profileId);
+  }
+  const bool sent = radioSend(item->data, item->len);
+  if (otherProfile) {
+    (void)radioApplyProfile(activeProfile);
+  }
+  if (sent) {
+    logFrameEvent2("TXOK", seq);
+    if constexpr (Role::FOLLOWS_GATEWAY) {
+      relayAckOnSent(item->data, item->len, nowMs);
+      reportAckOnSent(item->data, item->len);
+    }
+    netcodeRemember(item->data, item->len);
     txQueuePop();
+    ++gStats.txSent;
+    ledShow(LedPattern::Tx);
+    if (congestion > 0U) {
+      congestionOnSignalled();
+    }
   } else {
     logEvent2("TXFAIL", radioLastCode());
   }
@@ -221,15 +406,153 @@ void runTxScheduler(uint32_t nowMs) {
   gNextTxAtMs = nowMs + randomBackoffMs();
 }
 
+// Re-queues a sent REPORT no neighbour was heard relaying. Own ones go back
+// to the TX queue unless a newer REPORT already supersedes them; relayed ones
+// spend forward budget like a first forward. A refused re-send is tried
+// again after another ACK timeout.
+void runRelayAckResend(uint32_t nowMs) {
+  uint8_t frame[TX_FRAME_MAX];
+  const uint8_t len = relayAckPeekDue(nowMs, frame, sizeof(frame));
+  if (len == 0U) {
+    return;
+  }
+  codec::FrameView view;
+  if (!view.init(frame, len)) {
+    relayAckResendResult(RelayAckResend::Dropped, nowMs);
+    return;
+  }
+  RelayAckResend result = RelayAckResend::NoRoom;
+  if (view.src() == NODE_ID) {
+    bool fragmented = false;
+    if (txQueuePendingReport(fragmented) != nullptr) {
+      result = RelayAckResend::Dropped;
+    } else if ((gTxCount < TX_QUEUE_CAPACITY) && txQueuePush(frame, len, nowMs, PROFILE_CURRENT, true)) {
+      result = RelayAckResend::Queued;
+    }
+  } else if (forwardRateAllow(nowMs) && fwdQueuePush(frame, len, view, nowMs)) {
+    forwardRateConsume();
+    result = RelayAckResend::Queued;
+  }
+  if (result == RelayAckResend::Queued) {
+    logEvent3("RACKTO", view.src(), view.seq());
+  }
+  relayAckResendResult(result, nowMs);
+}
+
+// Own REPORTs a gateway beacon listed as missing go out again, behind
+// whatever is already queued. A full queue leaves them missing for a later
+// pass instead of spending a retry.
+void runReportResend(uint32_t nowMs) {
+  if (gTxCount >= TX_QUEUE_CAPACITY) {
+    return;
+  }
+  uint8_t frame[TX_FRAME_MAX];
+  const uint8_t len = reportAckPeekMissing(frame, sizeof(frame));
+  if ((len > 0U) && txQueuePush(frame, len, nowMs, PROFILE_CURRENT, true)) {
+    reportAckResendQueued();
+    logEvent2("RPTRE", frameSeq(frame, len));
+  }
+}
+
+// Once a gateway is back, stored REPORTs go out oldest first, one per
+// STORE_DRAIN_INTERVAL_MS and only into idle queues so live traffic keeps
+// priority. Own ones are re-sends (never superseded); relayed ones take the
+// forward queue without spending forward budget.
+void runStoreDrain(uint32_t nowMs) {
+  if (reportStoreHolding(nowMs) || (reportStorePending() == 0U) || !timeReached(nowMs, gNextDrainAtMs)) {
+    return;
+  }
+  gNextDrainAtMs = nowMs + STORE_DRAIN_INTERVAL_MS;
+  if ((gTxCount > 0U) || (gFwdCount > 0U)) {
+    return;
+  }
+  uint8_t frame[MSG_FRAME_MAX];
+  const uint8_t len = reportStorePeek(frame, sizeof(frame));
+  codec::FrameView view;
+  if ((len == 0U) || !view.init(frame, len)) {
+    return;
+  }
+  const bool queued = (view.src() == NODE_ID) ? txQueuePushFrame(frame, len, nowMs, true)
+                                              : fwdQueuePush(frame, len, view, nowMs);
+  if (queued) {
+    reportStorePop();
+    logEvent3("STOUT", view.src(), view.seq());
+  }
+}
+
+// A queued forward to send XORed with the front one: returns the CODED
+// frame and the partner's queue position, or 0 when none pairs or fits.
+uint8_t buildCodedForward(uint8_t* out, uint8_t& partner) {
+  const FwdItem& front = gFwdQueue[gFwdHead];
+  codec::FrameView a;
+  if (!front.asHeard || !a.init(front.data, front.len)) {
+    return 0U;
+  }
+  for (uint8_t k = 1U; k < gFwdCount; ++k) {
+    const FwdItem& other = gFwdQueue[(gFwdHead + k) % FWD_QUEUE_CAPACITY];
+    codec::FrameView b;
+    if (!other.asHeard || !b.init(other.data, other.len) || !netcodePairable(a, b)) {
+      continue;
+    }
+    const uint8_t len = buildCodedFrame(gReportSeq, front.data, front.len, other.data, other.len, out, TX_FRAME_MAX);
+    if (len > 0U) {
+      partner = k;
+      return len;
+    }
+  }
+  return 0U;
+}
+
+// One send for the front forward and its partner. Both natives count as
+// forwarded and are tracked for relay ACK as if sent on their own.
+void sendCodedForward(uint8_t* frame, uint8_t len, uint8_t partner, uint32_t nowMs) {
+  const uint8_t congestion = CONGESTION_ENABLED ? localCongestionLevel() : 0U;
+  if constexpr (CONGESTION_ENABLED) {
+    len = frameCongestionStamp(frame, len, TX_FRAME_MAX, congestion);
+  }
+  if (radioSend(frame, len)) {
+    const FwdItem& front = gFwdQueue[gFwdHead];
+    const FwdItem& other = gFwdQueue[(gFwdHead + partner) % FWD_QUEUE_CAPACITY];
+    logFrameEvent3("FWDNC", front.src, other.src);
+    ++gReportSeq;
+    if constexpr (Role::FOLLOWS_GATEWAY) {
+      relayAckOnSent(front.data, front.len, nowMs);
+      relayAckOnSent(other.data, other.len, nowMs);
+    }
+    netcodeRemember(front.data, front.len);
+    netcodeRemember(other.data, other.len);
+    netcodeOnSent();
+    fwdQueueRemove(partner);
+    fwdQueuePop();
+    gStats.fwdSent += 2U;
+    ledShow(LedPattern::Tx);
+    if (congestion > 0U) {
+      congestionOnSignalled();
+    }
+  } else {
+    logEvent2("FWDF", radioLastCode());
+  }
+
+  (void)radioStartRx();
+  gNextFwdTxAtMs = nowMs + forwardBackoffMs(nowMs);
+}
+
 void runForwardScheduler(uint32_t nowMs) {
-  const FwdItem* item = fwdQueueFront();
+  FwdItem* item = fwdQueueFront();
   if (item == nullptr) {
     gNextFwdTxAtMs = 0U;
     return;
   }
+  // A re-send whose ACK arrived while it was queued.
+  if constexpr (RELAY_ACK_ENABLED && Role::FOLLOWS_GATEWAY) {
+    if (relayAckDone(item->src, item->msgId)) {
+      fwdQueuePop();
+      return;
+    }
+  }
 
   if (gNextFwdTxAtMs == 0U) {
-    gNextFwdTxAtMs = nowMs + randomBackoffMs();
+    gNextFwdTxAtMs = nowMs + forwardBackoffMs(nowMs);
     return;
   }
 
@@ -241,35 +564,143 @@ void runForwardScheduler(uint32_t nowMs) {
     return;
   }
 
-  if (radioSend(item->data, item->len)) {
-    logEvent3("FWDOK", item->src, item->msgId);
+  uint8_t coded[TX_FRAME_MAX];
+  uint8_t codedLen = 0U;
+  uint8_t partner = 0U;
+  if constexpr (NETCODE_ENABLED) {
+    codedLen = buildCodedForward(coded, partner);
+  }
+
+  // Synced: relayed traffic contends only in the period after the slots.
+  if (tdmaSynced(nowMs)) {
+    const uint32_t windowAtMs = tdmaNextContentionTxMs(nowMs, (codedLen > 0U) ? codedLen : item->len);
+    if (windowAtMs != nowMs) {
+      gNextFwdTxAtMs = windowAtMs + forwardBackoffMs(nowMs);
+      return;
+    }
+  }
+  if (codedLen > 0U) {
+    sendCodedForward(coded, codedLen, partner, nowMs);
+    return;
+  }
+  item->asHeard = false;
+  stampBeacon(item->data, item->len, nowMs);
+  const uint8_t congestion = CONGESTION_ENABLED ? localCongestionLevel() : 0U;
+  if constexpr (CONGESTION_ENABLED) {
+    item->len = frameCongestionStamp(item->data, item->len, TX_FRAME_MAX, congestion);
+  }
+  // Stamped on a copy so a failed send does not count this hop twice.
+  uint8_t tracedBuf[TX_FRAME_MAX];
+  const uint8_t* txData = item->data;
+  if (item->traced) {
+    for (uint8_t i = 0U; i < item->len; ++i) {
+      tracedBuf[i] = item->data[i];
+    }
+    frameTraceStamp(tracedBuf, item->len, NODE_ID, nowMs - item->rxAtMs);
+    txData = tracedBuf;
+  }
+
+  if (radioSend(txData, item->len)) {
+    logFrameEvent3("FWDOK", item->src, item->msgId);
+    if constexpr (Role::FOLLOWS_GATEWAY) {
+      relayAckOnSent(item->data, item->len, nowMs);
+    }
+    netcodeRemember(txData, item->len);
     fwdQueuePop();
+    ++gStats.fwdSent;
+    ledShow(LedPattern::Tx);
+    if (congestion > 0U) {
+      congestionOnSignalled();
+    }
   } else {
     logEvent2("FWDF", radioLastCode());
   }
 
   (void)radioStartRx();
-  gNextFwdTxAtMs = nowMs + randomBackoffMs();
+  gNextFwdTxAtMs = nowMs + forwardBackoffMs(nowMs);
 }
 
-bool meshShouldForward(const uint8_t* frame, uint8_t len, uint32_t nowMs, uint8_t& srcOut, uint16_t& msgIdOut) {
-  if (!frameCrcOk(frame, len)) {
-    return false;
+// Fragments of one message share src and seq; dedup tells them apart by index.
+uint8_t dedupPart(const codec::FrameView& view) {
+  codec::Fragment frag{};
+  return codec::parseFragmentView(view, frag) ? frag.idx : DEDUP_PART_WHOLE;
+}
+
+bool rxDrop(RxDrop reason) {
+  ++gStats.rxDrop[static_cast<uint8_t>(reason)];
+  return false;
+}
+
+// Only a non-zero level costs a CRC (and tag) check here, ahead of the
+// classifier's own.
+void noteNeighbourCongestion(const codec::FrameView& view, uint32_t nowMs) {
+  const uint8_t level = codec::congestionLevel(view.flags());
+  if ((level > 0U) && view.crcOk() && (!AUTH_ENABLED || frameAuthOk(view))) {
+    congestionOnHeard(level, nowMs);
   }
-  if (!frameGetSrcMsgId(frame, len, srcOut, msgIdOut)) {
-    return false;
+}
+
+bool rxTypeKnown(uint8_t type) {
+  return (type == PING_TYPE) || (type == REPORT_TYPE) || (type == BEACON_TYPE) || (type == FRAG_TYPE) ||
+         (type == CONFIG_TYPE) || (NETCODE_ENABLED && (type == CODED_TYPE));
+}
+
+// Gateways consume every frame and nodes consume beacons, CONFIGs and CODED
+// frames even when the frame may not travel further; anything else is only
+// worth forwarding.
+bool meshConsumesLocally(const codec::FrameView& view) {
+  return Role::EXPORTS || (view.type() == BEACON_TYPE) || (view.type() == CONFIG_TYPE) || (view.type() == CODED_TYPE);
+}
+
+// Staged classifier, cheapest rejection first: header fields, then the dedup
+// scan, then CRC and auth over the whole frame. Foreign-network traffic and
+// our own echoes never cost a CRC. Dedup only reads the table, so a corrupt
+// frame that slips past it cannot evict real entries.
+bool meshAccept(codec::FrameView& view, const uint8_t* frame, uint8_t len, uint32_t nowMs) {
+  // Structure is checked once here; every later read is a plain field load.
+  if (!view.init(frame, len) || (len > TX_FRAME_MAX)) {
+    return rxDrop(RxDrop::Length);
   }
-  if (dedupSeen(srcOut, msgIdOut, nowMs)) {
-    return false;
+  if (!frameNetOk(view)) {
+    return rxDrop(RxDrop::Net);
   }
-  uint8_t ttl = 0U;
-  if (!frameGetTTL(frame, len, ttl)) {
-    return false;
+  if (!rxTypeKnown(view.type())) {
+    return rxDrop(RxDrop::Type);
+  }
+  // A neighbour relaying what we sent is usually a duplicate (or our own
+  // frame) by now, so it is checked before those stages drop it. The same
+  // goes for the congestion level the relay stamped on it.
+  if constexpr (Role::FOLLOWS_GATEWAY) {
+    relayAckOnHeard(view);
   }
-  if (ttl == 0U) {
+  if constexpr (CONGESTION_ENABLED) {
+    noteNeighbourCongestion(view, nowMs);
+  }
+  if (view.src() == NODE_ID) {
+    return rxDrop(RxDrop::Self);
+  }
+  if (!meshConsumesLocally(view) && ((view.ttl() == 0U) || view.noRelay())) {
+    return rxDrop(RxDrop::NoRelay);
+  }
+  if (dedupSeen(view.src(), view.seq(), dedupPart(view), nowMs)) {
+    return rxDrop(RxDrop::Dedup);
+  }
+  if (!view.crcOk()) {
+    return rxDrop(RxDrop::Crc);
+  }
+  if (AUTH_ENABLED && !frameAuthOk(view)) {
+    return rxDrop(RxDrop::Auth);
+  }
+  return true;
+}
+
+// Frames kept for local use may still be unforwardable. A rate-limited frame
+// was accepted, so it counts as fwdDropRate rather than as an RX drop.
+bool meshShouldForward(const codec::FrameView& view, uint32_t nowMs) {
+  if (view.ttl() == 0U) {
     return false;
   }
-  if (frameIsNoRelay(frame, len)) {
+  if (view.noRelay()) {
     return false;
   }
   if (!forwardRateAllow(nowMs)) {
@@ -278,85 +709,116 @@ bool meshShouldForward(const uint8_t* frame, uint8_t len, uint32_t nowMs, uint8_
   return true;
 }
 
-void meshOnRx(const uint8_t* frame, uint8_t len, uint32_t nowMs) {
-  uint8_t srcForDedup = 0U;
-  uint16_t msgIdForDedup = 0U;
-  if (!meshShouldForward(frame, len, nowMs, srcForDedup, msgIdForDedup)) {
-    return;
-  }
-
-  uint8_t fwdBuf[TX_FRAME_MAX] = {0};
-  for (uint8_t i = 0U; i < len; ++i) {
-    fwdBuf[i] = frame[i];
-  }
-
-  if (!frameDecTTLIncHopsAndRecrc(fwdBuf, len)) {
-    return;
+// Gateway handling of a complete frame, received whole or reassembled.
+void gatewayOnFrame(const codec::FrameView& view, uint32_t nowMs) {
+  if (view.type() == REPORT_TYPE) {
+    phyObserveReportSnr(radioLastSnr());
+    reportRateObserveReport();
+    if constexpr (REPORT_ACK_ENABLED) {
+      reportAckObserve(view.src(), view.seq(), view.seqBits());
+    }
   }
-
-  dedupRemember(srcForDedup, msgIdForDedup, nowMs);
-  if (fwdQueuePush(fwdBuf, len, srcForDedup, msgIdForDedup)) {
-    forwardRateConsume();
-    // Sparse RX log: only when packet passes mesh decision and is queued.
-    logEvent3("RXOK", frame[4], len);
+  // Export every accepted frame once; relayed copies then hit dedup.
+  if constexpr (!RX_CAPTURE_ENABLED) {
+    (void)bridgePushRx(view.data(), view.len(), nowMs, radioLastRssi(), radioLastSnr());
   }
 }
 
-void pushFreqIfValid(uint32_t value, uint16_t outMHz[MAX_FREQS], uint8_t& outCount) {
-  if ((value == 0UL) || (value > 65535UL)) {
-    return;
-  }
-  if (outCount >= MAX_FREQS) {
+// `decoded`: recovered from a CODED frame, so a beacon's time is as old as
+// the relay's queueing delay.
+void meshOnRx(const uint8_t* frame, uint8_t len, uint32_t nowMs, bool decoded = false) {
+  codec::FrameView view;
+  if (!meshAccept(view, frame, len, nowMs)) {
     return;
   }
-  outMHz[outCount] = static_cast<uint16_t>(value);
-  ++outCount;
-}
-
-uint8_t parseFreqLineMHz(const char* line, uint16_t outMHz[MAX_FREQS]) {
-  uint8_t outCount = 0;
-  uint32_t value = 0;
-  bool hasDigits = false;
-  bool tokenOverflow = false;
-
-  for (uint16_t i = 0; ; ++i) {
-    const char ch = line[i];
-    const bool isEnd = (ch == '\0');
-
-    if (!isEnd && (ch >= '0') && (ch <= '9')) {
-      hasDigits = true;
-      if (!tokenOverflow) {
-        value = (value * 10UL) + static_cast<uint32_t>(ch - '0');
-        if (value > 65535UL) {
-          tokenOverflow = true;
+  ++gStats.rxAccepted;
+  ledShow(LedPattern::Rx);
+  neighboursOnHeard(view, radioLastRssi(), radioLastSnr(), nowMs);
+
+  if constexpr (NETCODE_ENABLED) {
+    if (view.type() == CODED_TYPE) {
+      uint8_t native[TX_FRAME_MAX];
+      codec::FrameView known;
+      const uint8_t nativeLen = netcodeDecode(view, native, sizeof(native), known);
+      if (nativeLen > 0U) {
+        // The sender relayed the native we hold as surely as if sent alone.
+        if constexpr (Role::FOLLOWS_GATEWAY) {
+          relayAckOnHeard(known);
         }
+        meshOnRx(native, nativeLen, nowMs, true);
       }
-      continue;
+      return;
     }
+    netcodeRemember(frame, len);
+  }
+
+  codec::ConfigMsg config{};
+  if (codec::parseConfigView(view, config)) {
+    meshParamsOnConfig(config, nowMs);
+  }
 
-    if (isEnd || isSep(ch)) {
-      if (hasDigits && !tokenOverflow) {
-        pushFreqIfValid(value, outMHz, outCount);
+  if constexpr (Role::FOLLOWS_GATEWAY) {
+    codec::Beacon beacon{};
+    if (codec::parseBeaconView(view, beacon)) {
+      if (beacon.hasPhy) {
+        phyOnBeacon(beacon.phy, nowMs);
       }
-      value = 0;
-      hasDigits = false;
-      tokenOverflow = false;
-      if (isEnd) {
-        break;
+      if (beacon.hasReportRate) {
+        reportRateSetSlowdown(beacon.reportSlowdown);
       }
-      continue;
+      if (beacon.hasTime && !decoded) {
+        tdmaOnBeaconTime(beacon.netTimeMs, len, nowMs);
+      }
+      reportAckOnBeacon(beacon);
+      reportStoreOnBeacon(nowMs);
     }
+  }
 
-    // Any non-digit/non-separator character ends current token safely.
-    if (hasDigits && !tokenOverflow) {
-      pushFreqIfValid(value, outMHz, outCount);
+  if constexpr (Role::EXPORTS) {
+    if (view.type() == FRAG_TYPE) {
+      uint8_t whole[Reassembler::FRAME_MAX];
+      const uint8_t wholeLen = gReasm.accept(view, nowMs, whole, sizeof(whole));
+      codec::FrameView wholeView;
+      if ((wholeLen > 0U) && wholeView.init(whole, wholeLen)) {
+        logFrameEvent3("FRAGOK", view.src(), view.seq());
+        gatewayOnFrame(wholeView, nowMs);
+      }
+    } else {
+      gatewayOnFrame(view, nowMs);
     }
-    value = 0;
-    hasDigits = false;
-    tokenOverflow = false;
+    dedupRemember(view.src(), view.seq(), dedupPart(view), nowMs);
+  }
+
+  if (!meshShouldForward(view, nowMs)) {
+    return;
+  }
+
+  uint8_t fwdBuf[TX_FRAME_MAX] = {0};
+  for (uint8_t i = 0U; i < len; ++i) {
+    fwdBuf[i] = frame[i];
   }
 
-  return outCount;
+  if (!frameRelayRewrite(fwdBuf, len)) {
+    return;
+  }
+
+  if constexpr (!Role::EXPORTS) {
+    dedupRemember(view.src(), view.seq(), dedupPart(view), nowMs);
+  }
+  if constexpr (Role::FOLLOWS_GATEWAY) {
+    // No gateway to reach: keep the REPORT rather than flood it.
+    if ((view.type() == REPORT_TYPE) && reportStoreHolding(nowMs)) {
+      if (reportStorePut(fwdBuf, len)) {
+        logFrameEvent3("FWDST", view.src(), view.seq());
+      }
+      return;
+    }
+  }
+  if (fwdQueuePush(fwdBuf, len, view, nowMs)) {
+    forwardRateConsume();
+    // Sparse RX log: only when packet passes mesh decision and is queued.
+    logFrameEvent3("RXOK", view.type(), len);
+  }
 }
 
 uint16_t calcLastUartAgeS(uint32_t nowMs, bool hasUart, uint32_t uartTsMs) {
@@ -389,39 +851,107 @@ uint8_t buildStatusFlags(bool hasUart, uint16_t lastUartAgeS, uint16_t battMv) {
   return flags;
 }
 
-void enqueueReport(uint32_t nowMs, bool forceReport) {
+void enqueueReport(uint32_t nowMs) {
   const bool hasUart = uartHasValidLine();
   const uint16_t lastUartAgeS = calcLastUartAgeS(nowMs, hasUart, uartLastTimestampMs());
   const uint16_t battMv = battReadMv();
   const uint8_t statusFlags = buildStatusFlags(hasUart, lastUartAgeS, battMv);
 
-  const bool flagsChanged = (statusFlags != gLastReportedFlags);
-  const bool periodicDue =
-      ((nowMs - gLastStatusReportMs) >= REPORT_STATUS_PERIOD_MS);
+  reportRateNoteFlags(statusFlags);
+  if (!reportRateDue(nowMs)) {
+    return;
+  }
 
-  if (!forceReport && !flagsChanged && !periodicDue) {
+  // Coalesce: a newer state replaces the unsent REPORT in place, keeping its
+  // queue position and seq, so the queue never holds stale own reports.
+  // Fragments cannot be rewritten in place: report again once they are sent.
+  bool fragmented = false;
+  TxItem* pending = txQueuePendingReport(fragmented);
+  if (fragmented) {
+    return;
+  }
+  const uint16_t seq = (pending != nullptr) ? frameSeq(pending->data, pending->len) : gReportSeq;
+
+  // Small sets keep the plain FREQ_LIST; larger ones go out as a band bitmap.
+  uint8_t reportBuf[MSG_FRAME_MAX] = {0};
+  uint16_t list[MAX_FREQS] = {0};
+  uint8_t reportLen = 0U;
+  if (gFreqs.count <= MAX_FREQS) {
+    const uint8_t listCount = freqSetToList(gFreqs, list, MAX_FREQS);
+    reportLen = buildReportFrame(
+        seq, SCANNER_DST_ID, list, listCount, statusFlags, lastUartAgeS, reportBuf, sizeof(reportBuf));
+  } else {
+    reportLen = buildReportBandFrame(
+        seq, SCANNER_DST_ID, gFreqs, statusFlags, lastUartAgeS, reportBuf, sizeof(reportBuf));
+  }
+  if ((reportLen == 0U) || ((pending != nullptr) && (reportLen > TX_FRAME_MAX))) {
+    return;
+  }
+  if (pending != nullptr) {
+    pending->len = reportLen;
+    for (uint8_t i = 0U; i < reportLen; ++i) {
+      pending->data[i] = reportBuf[i];
+    }
+    ++gStats.txSuperseded;
+    logEvent2("RPTSUP", seq);
+  } else if (!reportStoreHolding(nowMs) && txQueuePushFrame(reportBuf, reportLen, nowMs)) {
+    logEvent2("RPT", reportLen);
+    ++gReportSeq;
+  } else if (reportStorePut(reportBuf, reportLen)) {
+    // No fresh gateway, or no room in the TX queue: send it later.
+    logEvent2("RPTST", seq);
+    ++gReportSeq;
+  } else {
     return;
   }
+  reportRateOnReported(gFreqs, statusFlags, nowMs);
+}
 
-  uint8_t reportBuf[64] = {0};
-  const uint8_t reportLen = buildReportFrame(gReportSeq,
-                                             SCANNER_DST_ID,
-                                             gParsedFreqMHz,
-                                             gParsedFreqCount,
-                                             statusFlags,
-                                             lastUartAgeS,
-                                             reportBuf,
-                                             sizeof(reportBuf));
-  if (reportLen > 0U) {
-    if (txQueuePush(reportBuf, reportLen)) {
-      logEvent2("RPT", reportLen);
+void enqueueBeacon(uint32_t nowMs) {
+  codec::Beacon beacon{};
+  beacon.phy = phyBeaconState(nowMs);
+  beacon.reportSlowdown = reportRateEvaluate(nowMs);
+  beacon.netTimeMs = tdmaNetTimeMs(nowMs);  // Restamped at TX.
+  if constexpr (REPORT_ACK_ENABLED) {
+    reportAckFill(beacon);
+  }
+  const codec::PhySwitch& phy = beacon.phy;
+  uint8_t beaconBuf[TX_FRAME_MAX] = {0};
+  // Beacons share the report sequence space: dedup keys on (src, seq).
+  const uint8_t beaconLen = buildBeaconFrame(gReportSeq, beacon, beaconBuf, sizeof(beaconBuf));
+  if ((beaconLen == 0U) || !txQueuePush(beaconBuf, beaconLen, nowMs)) {
+    return;
+  }
+  ++gReportSeq;
+  ++gBeaconCount;
+  logEvent3("BCN", phy.active, phy.target);
+
+  // Nodes that lost the network fell back to the default profile; an
+  // occasional copy there tells them where everyone went.
+  if ((phy.active != PHY_PROFILE_DEFAULT) && ((gBeaconCount % PHY_RESCUE_BEACON_EVERY) == 0U)) {
+    const uint8_t rescueLen = buildBeaconFrame(gReportSeq, beacon, beaconBuf, sizeof(beaconBuf));
+    if ((rescueLen > 0U) && txQueuePush(beaconBuf, rescueLen, nowMs, PHY_PROFILE_DEFAULT)) {
       ++gReportSeq;
-      gLastStatusReportMs = nowMs;
-      gLastReportedFlags = statusFlags;
     }
   }
 }
 
+// Trickle says this node's CONFIG is worth a send now. Shares the report
+// sequence space like beacons.
+void runConfigSync(uint32_t nowMs) {
+  if (!meshParamsDue(nowMs)) {
+    return;
+  }
+  codec::ConfigMsg config{};
+  meshParamsFill(config);
+  uint8_t frame[TX_FRAME_MAX];
+  const uint8_t len = buildConfigFrame(gReportSeq, config, frame, sizeof(frame));
+  if ((len > 0U) && txQueuePush(frame, len, nowMs)) {
+    ++gReportSeq;
+    logEvent2("CFGTX", config.version);
+  }
+}
+
 void processLatestUartLine(uint32_t nowMs) {
   if (!uartHasValidLine()) {
     return;
@@ -433,38 +963,94 @@ void processLatestUartLine(uint32_t nowMs) {
   }
   gLastParsedUartMs = tsMs;
 
-  uint16_t parsedMHz[MAX_FREQS] = {0};
-  const uint8_t count = parseFreqLineMHz(uartLastValidLine(), parsedMHz);
-
-  gParsedFreqCount = count;
-  for (uint8_t i = 0; i < MAX_FREQS; ++i) {
-    gParsedFreqMHz[i] = parsedMHz[i];
-  }
-
-  if (count > 0U) {
+  gFreqs = uartLastFreqs();
+  if (gFreqs.count > 0U) {
     SDR_OK = 1U;
-    logEvent2("PFREQ", count);
+    logEvent2("PFREQ", gFreqs.count);
   } else {
     SDR_OK = 0U;
     logEvent("PBAD");
   }
-  enqueueReport(nowMs, true);
+  reportRateNoteFreqSet(gFreqs);
+  enqueueReport(nowMs);
 }
 
 }  // namespace
 
+const char* rxDropName(RxDrop reason) {
+  static const char* const NAMES[] = {"length", "net", "type", "self", "no_relay", "dedup", "crc", "auth"};
+  static_assert(sizeof(NAMES) / sizeof(NAMES[0]) == static_cast<uint8_t>(RxDrop::Count), "one name per RxDrop");
+  const uint8_t idx = static_cast<uint8_t>(reason);
+  return (idx < static_cast<uint8_t>(RxDrop::Count)) ? NAMES[idx] : "?";
+}
+
+const AppStats& appStats() {
+  gStats.txQueueDepth = gTxCount;
+  gStats.fwdQueueDepth = gFwdCount;
+  if constexpr (Role::EXPORTS) {
+    gStats.fragReassembled = gReasm.completed();
+    gStats.fragDropped = gReasm.timedOut() + gReasm.evicted();
+  }
+  gStats.relayAckHeard = relayAckHeard();
+  gStats.relayAckRetries = relayAckRetries();
+  gStats.relayAckGaveUp = relayAckGaveUp();
+  gStats.reportAckConfirmed = reportAckConfirmed();
+  gStats.reportResent = reportAckResent();
+  gStats.storeWritten = reportStoreWritten();
+  gStats.storeDrained = reportStoreDrained();
+  gStats.storeDropped = reportStoreDropped();
+  gStats.storeSuperseded = reportStoreSuperseded();
+  gStats.storePending = reportStorePending();
+  gStats.configVersion = meshParamsVersion();
+  gStats.configAdopted = meshParamsAdopted();
+  gStats.configSuppressed = meshParamsSuppressed();
+  gStats.congestionSignalled = congestionSignalled();
+  gStats.congestionHeard = congestionHeard();
+  gStats.neighbours = neighbourCount();
+  gStats.neighboursEvicted = neighboursEvicted();
+  gStats.netcodeSent = netcodeSent();
+  gStats.netcodeDecoded = netcodeDecoded();
+  gStats.netcodeUndecodable = netcodeUndecodable();
+  return gStats;
+}
+
 void appInit() {
   gState.mode = NodeMode::Idle;
   gTimebaseReady = false;
-  uartInit();
-  const uint32_t seed = static_cast<uint32_t>(boardBootId()) ^
-                        (static_cast<uint32_t>(battReadMv()) << 8) ^
-                        micros();
+  ledInit();
+  if constexpr (Role::SCANS) {
+    uartInit();
+  }
+  // Radio first: after a reset the node is listening within a few ms.
+  if constexpr (RADIO_ACTIVE) {
+    if (!radioInit()) {
+      ledShow(LedPattern::Fault);
+    }
+  }
+  if constexpr (BRIDGE_ACTIVE) {
+    bridgeInit();
+  }
+  meshParamsInit();
+  phyInit();
+  tdmaInit();
+  if constexpr (Role::FOLLOWS_GATEWAY) {
+    relayAckInit();
+    reportStoreInit();
+  }
+  reportAckInit();
+  congestionInit();
+  neighboursInit();
+  netcodeInit();
+  reportRateInit(NODE_ID);
+  uint32_t seed = static_cast<uint32_t>(boardBootId()) ^ micros();
+  if constexpr (Role::SCANS) {
+    seed ^= static_cast<uint32_t>(battReadMv()) << 8;
+  }
   randomSeed(seed);
 
   if constexpr (RADIO_FRAME_SELFTEST) {
     uint8_t frame[PING_FRAME_LEN];
-    buildPingFrame(1U, frame);
+    const uint8_t frameLen = buildPingFrame(1U, frame);
 
     uint16_t seqOut = 0U;
     uint8_t srcOut = 0U;
@@ -476,46 +1062,69 @@ void appInit() {
       frameHead8[i] = frame[i];
     }
     logHex8("FHEX", frameHead8);
-    const uint16_t frameCrc = static_cast<uint16_t>(frame[PING_FRAME_LEN - 2U]) |
-                              static_cast<uint16_t>(static_cast<uint16_t>(frame[PING_FRAME_LEN - 1U]) << 8);
+    const uint16_t frameCrc = static_cast<uint16_t>(frame[frameLen - 2U]) |
+                              static_cast<uint16_t>(static_cast<uint16_t>(frame[frameLen - 1U]) << 8);
     logEvent2("FCRC", frameCrc);
 
-    if (parsePingFrame(frame, PING_FRAME_LEN, seqOut, srcOut, bootOut, errCode)) {
+    if (parsePingFrame(frame, frameLen, seqOut, srcOut, bootOut, errCode)) {
       logEvent("FSELF OK");
     } else {
       logEvent2("FSELF FAIL", errCode);
     }
-  }
 
-  if constexpr (RADIO_TEST_TX_ACTIVE || RADIO_TEST_RX_ACTIVE) {
-    (void)radioInit();
+    if constexpr (AUTH_ENABLED) {
+      // On-target MAC cost: microseconds for 16 checks of a full REPORT.
+      uint16_t freqs[MAX_FREQS] = {0};
+      for (uint8_t i = 0U; i < MAX_FREQS; ++i) {
+        freqs[i] = static_cast<uint16_t>(433U + i);
+      }
+      uint8_t report[TX_FRAME_MAX];
+      const uint8_t reportLen =
+          buildReportFrame(1U, SCANNER_DST_ID, freqs, MAX_FREQS, 0U, 0U, report, sizeof(report));
+      codec::FrameView view;
+      bool ok = view.init(report, reportLen);
+      const uint32_t t0 = micros();
+      for (uint8_t i = 0U; i < 16U; ++i) {
+        ok = frameAuthOk(view) && ok;
+      }
+      logEvent2(ok ? "AUTHUS16" : "AUTH FAIL", static_cast<int32_t>(micros() - t0));
+    }
   }
 }
 
 void appTick(uint32_t nowMs) {
-  uartPoll(nowMs);
-  processLatestUartLine(nowMs);
-  enqueueReport(nowMs, false);
+  if constexpr (Role::SCANS) {
+    uartPoll(nowMs);
+    processLatestUartLine(nowMs);
+    enqueueReport(nowMs);
+  }
 
   if (!gTimebaseReady) {
     gLastHeartbeatMs = nowMs;
     gLastBattLogMs = nowMs;
-    gLastBeaconSlotMs = nowMs;
+    gLastBeaconMs = nowMs;
     gLastWindowTickMs = nowMs;
     gLastPingEnqueueMs = nowMs;
-    gLastStatusReportMs = nowMs;
     gFwdWindowStartMs = nowMs;
     gTimebaseReady = true;
   }
 
-  if ((nowMs - gLastBeaconSlotMs) >= BEACON_SLOT_PERIOD_MS) {
-    gLastBeaconSlotMs = nowMs;
-    // Placeholder for beacon scheduling/jitter logic.
+  if constexpr (Role::BEACONS && RADIO_ACTIVE) {
+    if ((nowMs - gLastBeaconMs) >= BEACON_PERIOD_MS) {
+      gLastBeaconMs = nowMs;
+      phyEvaluate(nowMs);
+      enqueueBeacon(nowMs);
+    }
   }
 
   if ((nowMs - gLastWindowTickMs) >= WINDOW_TICK_PERIOD_MS) {
     gLastWindowTickMs = nowMs;
-    // Placeholder for future rate-limit window maintenance.
+    neighboursExpire(nowMs);
+    if constexpr (Role::EXPORTS) {
+      if (gReasm.expire(nowMs, FRAG_REASM_TIMEOUT_MS) > 0U) {
+        logEvent2("FRAGTO", gReasm.inFlight());
+      }
+    }
   }
 
   if constexpr (RADIO_TEST_TX_ACTIVE) {
@@ -523,28 +1132,55 @@ void appTick(uint32_t nowMs) {
       gLastPingEnqueueMs = nowMs;
 
       uint8_t frame[PING_FRAME_LEN];
-      buildPingFrame(gTxSeq, frame);
-      if (txQueuePush(frame, PING_FRAME_LEN)) {
+      const uint8_t frameLen = buildPingFrame(gTxSeq, frame);
+      if (txQueuePush(frame, frameLen, nowMs)) {
         ++gTxSeq;
       }
     }
   }
 
-  if constexpr (RADIO_TEST_TX_ACTIVE || RADIO_TEST_RX_ACTIVE) {
+  if constexpr (RADIO_ACTIVE) {
+    phyTick(nowMs);
+    if constexpr (RELAY_ACK_ENABLED && Role::FOLLOWS_GATEWAY) {
+      runRelayAckResend(nowMs);
+    }
+    if constexpr (REPORT_ACK_ENABLED && Role::FOLLOWS_GATEWAY) {
+      runReportResend(nowMs);
+    }
+    if constexpr (STORE_FORWARD_ENABLED && Role::FOLLOWS_GATEWAY) {
+      runStoreDrain(nowMs);
+    }
+    if constexpr (CONFIG_SYNC_ENABLED) {
+      runConfigSync(nowMs);
+    }
+    if constexpr (CONGESTION_ENABLED && Role::SCANS) {
+      reportRateSetCongestion(congestionHeardLevel(nowMs));
+    }
     runForwardScheduler(nowMs);
     runTxScheduler(nowMs);
   }
 
-  if constexpr (RADIO_TEST_RX_ACTIVE) {
-    uint8_t rxBuf[32];
+  if constexpr (RADIO_RX_ACTIVE) {
+    uint8_t rxBuf[TX_FRAME_MAX];
     const uint8_t rxLen = radioRead(rxBuf, sizeof(rxBuf));
     if (rxLen > 0U) {
+      ++gStats.rxFrames;
+      if constexpr (RX_CAPTURE_ENABLED) {
+        // Raw capture for offline replay: every frame, before any filtering.
+        (void)bridgePushRx(rxBuf, rxLen, nowMs, radioLastRssi(), radioLastSnr());
+      }
       meshOnRx(rxBuf, rxLen, nowMs);
     }
   }
 
+  if constexpr (BRIDGE_ACTIVE) {
+    bridgePoll(nowMs);
+  }
+
+  ledTick(nowMs);
+
 #if LOG_ENABLED
-  if ((nowMs - gLastBattLogMs) >= BATT_LOG_PERIOD_MS) {
+  if (Role::SCANS && ((nowMs - gLastBattLogMs) >= BATT_LOG_PERIOD_MS)) {
     gLastBattLogMs = nowMs;
     logEvent2("BATT", battReadMv());
   }
@@ -11,7 +11,67 @@ struct AppState {
   NodeMode mode;
 };
 
+// RX classifier stages, cheapest first; a frame is counted at the first
+// stage that rejects it.
+enum class RxDrop : uint8_t {
+  Length,   // Truncated, malformed or longer than TX_FRAME_MAX.
+  Net,      // Foreign NET_ID.
+  Type,     // Not PING, REPORT, BEACON or FRAG.
+  Self,     // Our own frame relayed back.
+  NoRelay,  // TTL 0 or NO_RELAY on a node with no local use for it.
+  Dedup,    // Already consumed or forwarded.
+  Crc,
+  Auth,
+  Count,
+};
+
+// Metric name of a drop stage, e.g. "net".
+const char* rxDropName(RxDrop reason);
+
+// Runtime counters since boot (saturating is not needed at these rates).
+struct AppStats {
+  uint32_t rxFrames;
+  uint32_t rxAccepted;
+  uint32_t rxDrop[static_cast<uint8_t>(RxDrop::Count)];
+  uint32_t fwdQueued;
+  uint32_t fwdSent;
+  uint32_t fwdDropQueue;
+  uint32_t fwdDropRate;
+  uint32_t txQueued;
+  uint32_t txSent;
+  uint32_t txDropQueue;
+  uint32_t txSuperseded;
+  uint32_t txFragments;
+  uint32_t fragReassembled;
+  uint32_t fragDropped;
+  uint32_t relayAckHeard;
+  uint32_t relayAckRetries;
+  uint32_t relayAckGaveUp;
+  uint32_t reportAckConfirmed;
+  uint32_t reportResent;
+  uint32_t storeWritten;
+  uint32_t storeDrained;
+  uint32_t storeDropped;
+  uint32_t storeSuperseded;
+  uint16_t storePending;
+  uint16_t configVersion;
+  uint32_t configAdopted;
+  uint32_t configSuppressed;
+  uint32_t congestionSignalled;  // Frames sent with a non-zero level.
+  uint32_t congestionHeard;
+  uint8_t neighbours;
+  uint32_t neighboursEvicted;
+  uint32_t netcodeSent;  // CODED frames, each standing in for two forwards.
+  uint32_t netcodeDecoded;
+  uint32_t netcodeUndecodable;  // Heard CODED frames holding neither native.
+  uint8_t txQueueDepth;
+  uint8_t fwdQueueDepth;
+  uint8_t txQueueHighWater;
+  uint8_t fwdQueueHighWater;
+};
+
 void appInit();
 void appTick(uint32_t nowMs);
+const AppStats& appStats();
 
 #endif  // APP_H
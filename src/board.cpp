@@ -7,6 +7,12 @@
 #include "log.h"
 #endif
 
+// Linker script symbols: the .data initialisers are the last thing the image
+// puts in flash, at _sidata.
+extern "C" uint32_t _sidata;
+extern "C" uint32_t _sdata;
+extern "C" uint32_t _edata;
+
 namespace {
 
 uint8_t gBootId = 0;
@@ -15,16 +21,40 @@ constexpr uint8_t BATT_SAMPLES = 8;
 constexpr uint16_t ADC_MAX_12BIT = 4095U;
 constexpr uint16_t ADC_REF_MV = 3300U;
 
-uint8_t generateBootId() {
-  uint32_t mix = micros();
-  for (uint8_t i = 0; i < 8; ++i) {
-    mix ^= (micros() << (i & 7));
-    mix ^= (static_cast<uint32_t>(analogRead(PIN_BATT_ADC)) << ((i * 3) & 15));
-    delayMicroseconds(60 + (mix & 0x1F));
+// Backup registers survive resets that keep VDD or VBAT up (watchdog,
+// brownout, NRST). DR1 counts boots; DR2 marks DR1 as valid, so a cold
+// backup domain is seeded from ADC noise instead of restarting at zero.
+constexpr uint16_t BKP_MAGIC = 0xB007U;
+
+uint16_t bootCounterNext() {
+  __HAL_RCC_PWR_CLK_ENABLE();
+  __HAL_RCC_BKP_CLK_ENABLE();
+  HAL_PWR_EnableBkUpAccess();
+  uint16_t count = static_cast<uint16_t>(BKP->DR1);
+  if (static_cast<uint16_t>(BKP->DR2) != BKP_MAGIC) {
+    count = 0U;
+    for (uint8_t i = 0; i < 4U; ++i) {
+      count = static_cast<uint16_t>((count << 4) ^ analogRead(PIN_BATT_ADC));
+    }
+    BKP->DR2 = BKP_MAGIC;
   }
+  ++count;
+  BKP->DR1 = count;
+  HAL_PWR_DisableBkUpAccess();
+  return count;
+}
+
+// Chip UID folded to a byte, plus the boot counter: consecutive boots of a
+// node get distinct ids and nodes booting together start apart.
+uint8_t generateBootId() {
+  uint32_t mix = HAL_GetUIDw0() ^ HAL_GetUIDw1() ^ HAL_GetUIDw2();
   mix ^= (mix >> 16);
   mix ^= (mix >> 8);
-  return static_cast<uint8_t>(mix & 0xFF);
+  return static_cast<uint8_t>((mix + bootCounterNext()) & 0xFFU);
+}
+
+uint32_t flashPageAddr(uint8_t page) {
+  return STORE_FLASH_END - (static_cast<uint32_t>(STORE_PAGES - page) * STORE_PAGE_SIZE);
 }
 
 }  // namespace
@@ -33,12 +63,6 @@ void boardLedSet(bool on) {
   digitalWrite(CFG_PIN_LED, on ? LOW : HIGH);
 }
 
-void boardLedPulse(uint16_t ms) {
-  boardLedSet(true);
-  delay(ms);
-  boardLedSet(false);
-}
-
 uint8_t boardBootId() {
   return gBootId;
 }
@@ -54,6 +78,50 @@ uint16_t battReadMv() {
   return static_cast<uint16_t>(mv);
 }
 
+bool boardFlashStoreFree() {
+  const uintptr_t dataLen = reinterpret_cast<uintptr_t>(&_edata) - reinterpret_cast<uintptr_t>(&_sdata);
+  return (reinterpret_cast<uintptr_t>(&_sidata) + dataLen) <= STORE_FLASH_BASE;
+}
+
+bool boardFlashErase(uint8_t page) {
+  if ((page >= STORE_PAGES) || !boardFlashStoreFree()) {
+    return false;
+  }
+  FLASH_EraseInitTypeDef erase = {};
+  erase.TypeErase = FLASH_TYPEERASE_PAGES;
+  erase.PageAddress = flashPageAddr(page);
+  erase.NbPages = 1U;
+  uint32_t badPage = 0U;
+  HAL_FLASH_Unlock();
+  const bool ok = (HAL_FLASHEx_Erase(&erase, &badPage) == HAL_OK);
+  HAL_FLASH_Lock();
+  return ok;
+}
+
+bool boardFlashWrite(uint8_t page, uint16_t offset, const uint8_t* data, uint16_t len) {
+  if ((page >= STORE_PAGES) || ((offset & 1U) != 0U) ||
+      ((static_cast<uint32_t>(offset) + len) > STORE_PAGE_SIZE) || !boardFlashStoreFree()) {
+    return false;
+  }
+  const uint32_t addr = flashPageAddr(page) + offset;
+  bool ok = true;
+  HAL_FLASH_Unlock();
+  for (uint16_t i = 0U; ok && (i < len); i = static_cast<uint16_t>(i + 2U)) {
+    const uint16_t hi = ((i + 1U) < len) ? data[i + 1U] : 0xFFU;
+    const uint16_t half = static_cast<uint16_t>(data[i] | (hi << 8));
+    ok = (HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, addr + i, half) == HAL_OK);
+  }
+  HAL_FLASH_Lock();
+  return ok;
+}
+
+void boardFlashRead(uint8_t page, uint16_t offset, uint8_t* out, uint16_t len) {
+  const uint8_t* src = reinterpret_cast<const uint8_t*>(flashPageAddr(page) + offset);
+  for (uint16_t i = 0U; i < len; ++i) {
+    out[i] = src[i];
+  }
+}
+
 void boardInit() {
   pinMode(CFG_PIN_LED, OUTPUT);
   boardLedSet(false);
@@ -70,12 +138,4 @@ void boardInit() {
   logEvent3("BOOT", NODE_ID, boardBootId());
   logEvent2("ROLE", IS_GATEWAY ? 1 : 0);
 #endif
-
-  for (uint8_t i = 0; i < 3; ++i) {
-    boardLedPulse(90);
-    if (i < 2) {
-      delay(110);
-    }
-  }
-  boardLedSet(false);
 }
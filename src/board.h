@@ -3,10 +3,21 @@
 
 #include <stdint.h>
 
+// Returns without waiting; the boot blinks are played by the LED engine.
 void boardInit();
 void boardLedSet(bool on);
-void boardLedPulse(uint16_t ms);
 uint8_t boardBootId();
 uint16_t battReadMv();
 
+// Spare flash for the report store: STORE_PAGES pages of STORE_PAGE_SIZE
+// below STORE_FLASH_END. Erased bytes read 0xFF; writes are half-word
+// granular (even `offset`, an odd tail is padded with 0xFF) and may only
+// clear bits. Erasing stalls the CPU for about 20 ms.
+// False when the firmware image reaches STORE_FLASH_BASE; erase and write
+// then refuse, and the store stays off.
+bool boardFlashStoreFree();
+bool boardFlashErase(uint8_t page);
+bool boardFlashWrite(uint8_t page, uint16_t offset, const uint8_t* data, uint16_t len);
+void boardFlashRead(uint8_t page, uint16_t offset, uint8_t* out, uint16_t len);
+
 #endif  // BOARD_H
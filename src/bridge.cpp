@@ -0,0 +1,220 @@
+#include "bridge.h"
+
+#include <Arduino.h>
+
+#include "config.h"
+#include "crc16.h"
+#include "log.h"
+
+namespace {
+
+static_assert((BRIDGE_RING_BYTES & (BRIDGE_RING_BYTES - 1U)) == 0U,
+              "BRIDGE_RING_BYTES must be a power of two");
+
+constexpr uint16_t RING_MASK = static_cast<uint16_t>(BRIDGE_RING_BYTES - 1U);
+constexpr uint8_t RECORD_MAX = 255U;
+constexpr uint8_t LOG_META_LEN = 4U;  // ts_ms
+
+static_assert(BRIDGE_FLUSH_MAX_BYTES_PER_TICK >= RECORD_MAX, "one tick must be able to flush the largest record");
+#ifdef SERIAL_TX_BUFFER_SIZE
+// availableForWrite() never exceeds the core's TX buffer (64 bytes by
+// default), and records only go out whole: export images need a larger one.
+static_assert(!(IS_GATEWAY || RX_CAPTURE_ENABLED) || (SERIAL_TX_BUFFER_SIZE > RECORD_MAX),
+              "build export images with -DSERIAL_TX_BUFFER_SIZE=256");
+#endif
+
+uint8_t gRing[BRIDGE_RING_BYTES] = {0};
+uint16_t gHead = 0U;  // Next byte to flush.
+uint16_t gUsed = 0U;
+uint16_t gHighWater = 0U;
+uint32_t gOldestPendingMs = 0UL;
+uint32_t gLastStatsMs = 0UL;
+uint32_t gExported = 0UL;
+uint32_t gDropped = 0UL;
+uint32_t gDroppedLogged = 0UL;
+bool gStatsReady = false;
+
+uint16_t ringFree() {
+  return static_cast<uint16_t>(BRIDGE_RING_BYTES - gUsed);
+}
+
+void ringPut(const uint8_t* data, uint8_t len) {
+  uint16_t tail = static_cast<uint16_t>((gHead + gUsed) & RING_MASK);
+  for (uint8_t i = 0U; i < len; ++i) {
+    gRing[tail] = data[i];
+    tail = static_cast<uint16_t>((tail + 1U) & RING_MASK);
+  }
+  gUsed = static_cast<uint16_t>(gUsed + len);
+  if (gUsed > gHighWater) {
+    gHighWater = gUsed;
+  }
+}
+
+void putU16(uint8_t* out, uint8_t& idx, uint16_t v) {
+  out[idx++] = static_cast<uint8_t>(v & 0xFFU);
+  out[idx++] = static_cast<uint8_t>((v >> 8) & 0xFFU);
+}
+
+void putU32(uint8_t* out, uint8_t& idx, uint32_t v) {
+  putU16(out, idx, static_cast<uint16_t>(v & 0xFFFFU));
+  putU16(out, idx, static_cast<uint16_t>((v >> 16) & 0xFFFFU));
+}
+
+// Whole records only: a record that does not fit is dropped, never split.
+bool pushRecord(uint8_t kind,
+                const uint8_t* meta,
+                uint8_t metaLen,
+                const uint8_t* payload,
+                uint8_t payloadLen,
+                uint32_t nowMs) {
+  const uint16_t bodyLen = static_cast<uint16_t>(metaLen + payloadLen);
+  const uint16_t recordLen = static_cast<uint16_t>(bodyLen + BRIDGE_RECORD_OVERHEAD);
+  if ((recordLen > RECORD_MAX) || (recordLen > ringFree())) {
+    ++gDropped;
+    return false;
+  }
+
+  const uint8_t head[4] = {BRIDGE_SYNC0, BRIDGE_SYNC1, kind, static_cast<uint8_t>(bodyLen)};
+  uint16_t crc = crc16_ccitt_false_update(0xFFFFU, &head[2], 2U);
+  crc = crc16_ccitt_false_update(crc, meta, metaLen);
+  crc = crc16_ccitt_false_update(crc, payload, payloadLen);
+  const uint8_t tail[2] = {static_cast<uint8_t>(crc & 0xFFU), static_cast<uint8_t>((crc >> 8) & 0xFFU)};
+
+  if (gUsed == 0U) {
+    gOldestPendingMs = nowMs;
+  }
+  ringPut(head, sizeof(head));
+  ringPut(meta, metaLen);
+  ringPut(payload, payloadLen);
+  ringPut(tail, sizeof(tail));
+  return true;
+}
+
+void pushStats(uint32_t nowMs) {
+  uint8_t body[BRIDGE_STATS_LEN] = {0};
+  uint8_t idx = 0U;
+  putU32(body, idx, nowMs);
+  putU32(body, idx, gExported);
+  putU32(body, idx, gDropped);
+  putU16(body, idx, gHighWater);
+  (void)pushRecord(BRIDGE_KIND_STATS, body, idx, nullptr, 0U, nowMs);
+}
+
+bool flushDue(uint32_t nowMs) {
+  if (gUsed == 0U) {
+    return false;
+  }
+  if (gUsed >= BRIDGE_FLUSH_MIN_BYTES) {
+    return true;
+  }
+  return (nowMs - gOldestPendingMs) >= BRIDGE_FLUSH_MAX_DELAY_MS;
+}
+
+// Never blocks and never splits a record: writes the queued records that
+// the serial TX buffer can take whole right now, and nothing past the first
+// one that does not fit.
+void flush() {
+  const int room = Serial.availableForWrite();
+  if (room <= 0) {
+    return;
+  }
+  uint16_t budget = static_cast<uint16_t>(room);
+  if (budget > BRIDGE_FLUSH_MAX_BYTES_PER_TICK) {
+    budget = BRIDGE_FLUSH_MAX_BYTES_PER_TICK;
+  }
+
+  while (gUsed > 0U) {
+    const uint16_t recordLen =
+        static_cast<uint16_t>(gRing[(gHead + 3U) & RING_MASK] + BRIDGE_RECORD_OVERHEAD);  // LEN byte
+    if (recordLen > budget) {
+      return;
+    }
+    // Up to two writes where the record wraps the ring end.
+    uint16_t left = recordLen;
+    while (left > 0U) {
+      uint16_t chunk = static_cast<uint16_t>(BRIDGE_RING_BYTES - gHead);
+      if (chunk > left) {
+        chunk = left;
+      }
+      (void)Serial.write(&gRing[gHead], chunk);
+      gHead = static_cast<uint16_t>((gHead + chunk) & RING_MASK);
+      left = static_cast<uint16_t>(left - chunk);
+    }
+    gUsed = static_cast<uint16_t>(gUsed - recordLen);
+    budget = static_cast<uint16_t>(budget - recordLen);
+  }
+}
+
+}  // namespace
+
+void bridgeInit() {
+  // Gateways have no UART ingest to open the port for them. Records queued
+  // before this (boot log lines) stay queued.
+  Serial.begin(UART_BAUD);
+  gHighWater = 0U;
+  gExported = 0UL;
+  gDropped = 0UL;
+  gDroppedLogged = 0UL;
+  gStatsReady = false;
+}
+
+bool bridgePushRx(const uint8_t* frame, uint8_t len, uint32_t nowMs, int16_t rssi, int8_t snr) {
+  if ((frame == nullptr) || (len == 0U) || (len > (RECORD_MAX - BRIDGE_RECORD_OVERHEAD - BRIDGE_RX_META_LEN))) {
+    return false;
+  }
+
+  uint8_t meta[BRIDGE_RX_META_LEN] = {0};
+  uint8_t idx = 0U;
+  putU32(meta, idx, nowMs);
+  putU16(meta, idx, static_cast<uint16_t>(rssi));
+  meta[idx++] = static_cast<uint8_t>(snr);
+
+  if (!pushRecord(BRIDGE_KIND_RX, meta, idx, frame, len, nowMs)) {
+    return false;
+  }
+  ++gExported;
+  return true;
+}
+
+bool bridgePushLog(const char* text, uint8_t len, uint32_t nowMs) {
+  if ((text == nullptr) || (len > (RECORD_MAX - BRIDGE_RECORD_OVERHEAD - LOG_META_LEN))) {
+    return false;
+  }
+  const uint16_t recordLen = static_cast<uint16_t>(BRIDGE_RECORD_OVERHEAD + LOG_META_LEN + len);
+  if ((gUsed + recordLen) > BRIDGE_LOG_FILL_MAX) {
+    return false;  // RX records first; STATS and BXDROP count only those.
+  }
+  uint8_t meta[LOG_META_LEN] = {0};
+  uint8_t idx = 0U;
+  putU32(meta, idx, nowMs);
+  return pushRecord(BRIDGE_KIND_LOG, meta, idx, reinterpret_cast<const uint8_t*>(text), len, nowMs);
+}
+
+void bridgePoll(uint32_t nowMs) {
+  if (!gStatsReady) {
+    gLastStatsMs = nowMs;
+    gStatsReady = true;
+  }
+
+  if ((nowMs - gLastStatsMs) >= BRIDGE_STATS_PERIOD_MS) {
+    gLastStatsMs = nowMs;
+    pushStats(nowMs);
+    if (gDropped != gDroppedLogged) {
+      // Sparse drop log: once per stats period, only when drops grew.
+      logEvent2("BXDROP", static_cast<int32_t>(gDropped - gDroppedLogged));
+      gDroppedLogged = gDropped;
+    }
+  }
+
+  if (flushDue(nowMs)) {
+    flush();
+  }
+}
+
+uint32_t bridgeExportedCount() {
+  return gExported;
+}
+
+uint32_t bridgeDroppedCount() {
+  return gDropped;
+}
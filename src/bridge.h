@@ -0,0 +1,34 @@
+#ifndef BRIDGE_H
+#define BRIDGE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Gateway RX -> host export bridge.
+// Record layout (little-endian):
+//   [0xA5][0x5A][KIND][LEN][BODY...LEN bytes][CRC16 LE over KIND..BODY]
+// RX body:    ts_ms u32, rssi i16, snr i8, raw frame bytes.
+// STATS body: ts_ms u32, exported u32, dropped u32, ring_high_water u16.
+// LOG body:   ts_ms u32, one log line as ASCII (no line ending).
+// The bridge is the only writer to Serial in export builds: log lines go
+// out as LOG records, and a record is written whole or not at all. LOG
+// records yield to RX records (BRIDGE_LOG_FILL_MAX) and never count as
+// dropped.
+constexpr uint8_t BRIDGE_SYNC0 = 0xA5U;
+constexpr uint8_t BRIDGE_SYNC1 = 0x5AU;
+constexpr uint8_t BRIDGE_KIND_RX = 0x01U;
+constexpr uint8_t BRIDGE_KIND_STATS = 0x02U;
+constexpr uint8_t BRIDGE_KIND_LOG = 0x03U;
+constexpr uint8_t BRIDGE_RX_META_LEN = 7U;
+constexpr uint8_t BRIDGE_STATS_LEN = 14U;
+constexpr uint8_t BRIDGE_RECORD_OVERHEAD = 6U;  // sync x2, kind, len, crc x2
+
+void bridgeInit();
+bool bridgePushRx(const uint8_t* frame, uint8_t len, uint32_t nowMs, int16_t rssi, int8_t snr);
+bool bridgePushLog(const char* text, uint8_t len, uint32_t nowMs);
+void bridgePoll(uint32_t nowMs);
+
+uint32_t bridgeExportedCount();
+uint32_t bridgeDroppedCount();
+
+#endif  // BRIDGE_H
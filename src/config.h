@@ -7,6 +7,75 @@
 #ifndef LOG_ENABLED
 #define LOG_ENABLED 1
 #endif
+// Mesh runtime outside bench modes: radio RX -> mesh handler + TX/forward schedulers.
+#ifndef MESH_ENABLED
+#define MESH_ENABLED 0
+#endif
+// Raw RX capture: stream every received frame through the export bridge
+// (any role) for offline replay with tools/sim/replay.
+#ifndef RX_CAPTURE_ENABLED
+#define RX_CAPTURE_ENABLED 0
+#endif
+// Own frames use the compact header (5-8 bytes instead of 10). Receivers
+// always accept both formats; needs NET_ID <= 15 and TTLs <= 15.
+#ifndef COMPACT_HEADER_TX
+#define COMPACT_HEADER_TX 0
+#endif
+// Frame authentication: own frames carry a truncated SipHash-2-4 tag under
+// AUTH_KEY; received frames without a valid one are dropped before dedup and
+// forwarding. All nodes of a network need the same setting and key.
+#ifndef AUTH_ENABLED
+#define AUTH_ENABLED 0
+#endif
+// Passive hop-by-hop ACK: sent REPORTs are re-sent when no neighbour is
+// overheard relaying them (see "Relay ACK" below). Nodes only.
+#ifndef RELAY_ACK_ENABLED
+#define RELAY_ACK_ENABLED 0
+#endif
+// End-to-end REPORT ACK: gateway beacons list which REPORTs arrived and
+// nodes re-send the missing ones (see "Report ACK" below).
+#ifndef REPORT_ACK_ENABLED
+#define REPORT_ACK_ENABLED 0
+#endif
+// In-band latency trace: every Nth own REPORT (by seq) sets FLAGS bit 2 and
+// carries a TLV that the origin and each relay update at TX time. 0 = off.
+#ifndef TRACE_REPORT_EVERY
+#define TRACE_REPORT_EVERY 0
+#endif
+// Store-and-forward: while no gateway beacon is fresh, REPORTs go to a log in
+// spare flash instead of the air and drain once one is heard again (see
+// "Report store" below). Nodes only.
+#ifndef STORE_FORWARD_ENABLED
+#define STORE_FORWARD_ENABLED 0
+#endif
+// What survives in the store: every REPORT in arrival order (0), or only the
+// newest one per source (1). Both drain oldest first.
+#define STORE_POLICY_OLDEST_FIRST 0
+#define STORE_POLICY_LATEST_PER_SOURCE 1
+#ifndef STORE_POLICY
+#define STORE_POLICY STORE_POLICY_OLDEST_FIRST
+#endif
+// Runtime mesh tuning: CONFIG frames spread versioned parameters by Trickle
+// and every node applies them without a reflash (see "Mesh parameters").
+#ifndef CONFIG_SYNC_ENABLED
+#define CONFIG_SYNC_ENABLED 0
+#endif
+// Congestion signalling: sent frames carry this node's forward congestion in
+// FLAGS bits 3-4 and neighbours that hear it slow down (see "Congestion").
+#ifndef CONGESTION_ENABLED
+#define CONGESTION_ENABLED 0
+#endif
+// Link telemetry: every Nth own REPORT (by seq) carries the freshest links of
+// the neighbour table (see "Neighbours" below). 0 = off; the table is always kept.
+#ifndef NEIGHBOUR_REPORT_EVERY
+#define NEIGHBOUR_REPORT_EVERY 0
+#endif
+// Network coding: a relay holding an upward and a downward forward sends
+// them XORed in one CODED frame; neighbours that hold either one recover
+// the other (see "Network coding" below). Every device needs it to decode.
+#ifndef NETCODE_ENABLED
+#define NETCODE_ENABLED 0
+#endif
 constexpr bool RADIO_FRAME_SELFTEST = false;
 constexpr bool RADIO_TEST_TX = false;
 constexpr bool RADIO_TEST_RX = false;
@@ -18,7 +87,11 @@ constexpr uint32_t HEARTBEAT_PERIOD_MS = 5000UL;
 // Change NODE_ID per physical node before flashing (e.g. 1, 2, 3...).
 // Do not clone firmware to multiple nodes with the same NODE_ID.
 constexpr uint8_t NODE_ID = 1;
-constexpr bool IS_GATEWAY = false;
+// Role: 1 builds the gateway image, 0 a scanner node (see "Roles" below).
+#ifndef ROLE_GATEWAY
+#define ROLE_GATEWAY 0
+#endif
+constexpr bool IS_GATEWAY = (ROLE_GATEWAY != 0);
 constexpr uint8_t NET_ID = 1;
 
 // ===== Pins =====
@@ -50,28 +123,209 @@ constexpr uint8_t LORA_CR = 6;           // 4/6
 constexpr uint8_t LORA_CR_FALLBACK = 5;  // 4/5
 constexpr int8_t LORA_TX_POWER_DBM = 2;
 constexpr bool RADIO_RX_CONTINUOUS = true;
+constexpr uint16_t LORA_SYNC_WORD = 0x1424U;  // Private network.
+// E22-400M modules run their crystal off a TCXO powered from DIO3.
+constexpr bool RADIO_TCXO = true;
+constexpr uint32_t RADIO_SPI_HZ = 8000000UL;  // SX126x allows up to 16 MHz.
+
+// Runtime PHY profiles, fastest first. The gateway picks one from observed
+// REPORT SNR and announces the switch in its beacons; every node boots on
+// (and falls back to) PHY_PROFILE_DEFAULT, the compile-time profile above.
+struct PhyProfile {
+  uint8_t sf;
+  uint32_t bwHz;
+  uint8_t cr;
+  int8_t txPowerDbm;
+};
+constexpr PhyProfile PHY_PROFILES[] = {
+    {7, 125000UL, 5, 2},
+    {8, 125000UL, 5, 2},
+    {LORA_SF, LORA_BW_HZ, LORA_CR, LORA_TX_POWER_DBM},
+    {10, 125000UL, 6, 10},
+    {11, 125000UL, 6, 17},
+    {12, 125000UL, 8, 22},
+};
+constexpr uint8_t PHY_PROFILE_COUNT = sizeof(PHY_PROFILES) / sizeof(PHY_PROFILES[0]);
+constexpr uint8_t PHY_PROFILE_DEFAULT = 2;
+constexpr int8_t PHY_SNR_MARGIN_DB = 5;      // Worst link must clear the SF demod floor by this.
+constexpr int8_t PHY_UPGRADE_HYST_DB = 3;    // Extra margin before moving to a faster profile.
+constexpr uint8_t PHY_EVAL_MIN_REPORTS = 8;
+constexpr uint32_t PHY_EVAL_PERIOD_MS = 60000UL;
+constexpr uint32_t PHY_SWITCH_LEAD_MS = 30000UL;  // Announced this far ahead; fits the u16 TLV field.
+constexpr uint8_t PHY_RESCUE_BEACON_EVERY = 3;   // Every Nth beacon also goes out on the default profile.
 
 // ===== Mesh =====
 // Mesh constants v1.5
 constexpr uint8_t BEACON_TTL_HOPS = 3;
+constexpr uint32_t BEACON_PERIOD_MS = 10000UL;  // Gateway only.
 constexpr uint32_t GW_TIMEOUT_MS = 120000UL;
 constexpr uint8_t DATA_TTL = 8;
 constexpr uint8_t DATA_TTL_EMERG = 12;
-constexpr uint16_t DEDUP_N = 128;
 constexpr uint32_t BACKOFF_MIN_MS = 50UL;
 constexpr uint32_t BACKOFF_MAX_MS = 300UL;
 constexpr uint8_t MAX_FORWARDS_PER_WINDOW = 10;
 constexpr uint32_t WINDOW_MS = 10000UL;
+// Frames longer than one radio frame go out as FRAG pieces; the gateway
+// rebuilds them in a static table (FRAG_REASM_SLOTS x FRAG_PAYLOAD_MAX).
+constexpr uint8_t FRAG_PAYLOAD_MAX = 192U;  // Largest fragmented payload; export records take up to 230.
+constexpr uint8_t FRAG_REASM_SLOTS = 2U;
+constexpr uint32_t FRAG_REASM_TIMEOUT_MS = 20000UL;
+// Per-network SipHash key (AUTH_ENABLED). Replace before deployment.
+constexpr uint8_t AUTH_KEY[16] = {0x70, 0x61, 0x70, 0x75, 0x67, 0x61, 0x2D, 0x6E,
+                                  0x65, 0x74, 0x2D, 0x6B, 0x65, 0x79, 0x2D, 0x31};
+
+// ===== Mesh parameters =====
+// CONFIG_SYNC_ENABLED: BACKOFF_MIN_MS, BACKOFF_MAX_MS, WINDOW_MS,
+// MAX_FORWARDS_PER_WINDOW, DATA_TTL and REPORT_STATUS_PERIOD_MS are only the
+// boot values, known as version MESH_PARAMS_VERSION; the highest version
+// heard replaces them. To retune, change them here, bump the version and
+// flash one node. CONFIG frames are never relayed: each node announces its
+// version once at a random point in the second half of a Trickle interval,
+// unless TRICKLE_K matching ones were heard first. The interval starts at
+// TRICKLE_IMIN_MS, doubles up to TRICKLE_IMAX_DOUBLINGS times while
+// neighbours agree, and drops back to the minimum when one does not.
+constexpr uint16_t MESH_PARAMS_VERSION = 0U;
+constexpr uint32_t TRICKLE_IMIN_MS = 4000UL;
+constexpr uint8_t TRICKLE_IMAX_DOUBLINGS = 8U;  // About 17 min.
+constexpr uint8_t TRICKLE_K = 1U;
+
+// ===== Time sync / TDMA =====
+// Beacons carry the gateway clock; synced nodes send their own frames in
+// slot NODE_ID % TDMA_SLOTS of a repeating superframe, and relay traffic
+// contends in the TDMA_CONTENTION_SLOTS that follow. A slot fits one
+// TDMA_SLOT_BYTES frame on the active PHY profile plus TDMA_GUARD_MS.
+constexpr uint8_t TDMA_SLOTS = 8U;
+constexpr uint8_t TDMA_CONTENTION_SLOTS = 4U;
+constexpr uint8_t TDMA_SLOT_BYTES = 64U;
+constexpr uint32_t TDMA_GUARD_MS = 20UL;
+constexpr uint32_t TIME_SYNC_STEP_MS = 200UL;  // Larger errors step the clock instead of slewing it.
+
+// ===== Relay ACK =====
+// RELAY_ACK_ENABLED: a sent REPORT waits for a neighbour's relay of it for
+// BACKOFF_MAX_MS + airtime + RELAY_ACK_MARGIN_MS (plus one superframe while
+// TDMA-synced), then goes out again, at most RELAY_ACK_RETRIES times.
+constexpr uint8_t RELAY_ACK_SLOTS = 4U;
+constexpr uint8_t RELAY_ACK_RETRIES = 2U;
+constexpr uint32_t RELAY_ACK_MARGIN_MS = 200UL;
+
+// ===== Report ACK =====
+// REPORT_ACK_ENABLED: the gateway keeps, for up to GW_ACK_SOURCES sources,
+// the highest REPORT seq plus a bitmap of the 8 below it, and puts every
+// changed source in its next REPORT_ACK_REPEAT beacons. Nodes keep their last
+// REPORT_RETX_SLOTS single-frame REPORTs and re-send each one the gateway
+// misses at most REPORT_RETX_MAX times.
+constexpr uint8_t GW_ACK_SOURCES = 16U;
+constexpr uint8_t REPORT_ACK_REPEAT = 2U;
+constexpr uint8_t REPORT_RETX_SLOTS = 4U;
+constexpr uint8_t REPORT_RETX_MAX = 2U;
+
+// ===== Report store =====
+// STORE_FORWARD_ENABLED: a log of whole REPORT frames in the top STORE_PAGES
+// flash pages (STM32F103C8: 64 KB, 1 KB pages), written round-robin so every
+// page wears alike. Full: the oldest page is erased and its REPORTs dropped.
+// Holding starts STORE_GW_STALE_MS after the last beacon (and at boot); once
+// a beacon is back, one REPORT drains every STORE_DRAIN_INTERVAL_MS while the
+// queues are idle.
+// The linker script still gives the sketch all 64 KB, so nothing reserves
+// these pages: the image (code, rodata and the .data initialisers, which end
+// at _sidata + .data size) must stay below STORE_FLASH_BASE, i.e. 60 KB with
+// 4 pages. boardFlashStoreFree() checks that at boot and the store stays off
+// when it fails. Lower STORE_PAGES or build without the store before a larger
+// image would overwrite itself.
+constexpr uint32_t STORE_FLASH_END = 0x08010000UL;
+constexpr uint16_t STORE_PAGE_SIZE = 1024U;
+constexpr uint8_t STORE_PAGES = 4U;
+constexpr uint32_t STORE_FLASH_BASE = STORE_FLASH_END - (static_cast<uint32_t>(STORE_PAGES) * STORE_PAGE_SIZE);
+constexpr uint32_t STORE_GW_STALE_MS = 35000UL;  // Three beacons missed.
+constexpr uint32_t STORE_DRAIN_INTERVAL_MS = 1000UL;
+
+// ===== Neighbours =====
+// Frames heard with HOPS 0 come straight from their origin and update its
+// entry: RSSI/SNR averages (EWMA, weight 2^-NEIGHBOUR_EWMA_SHIFT), frames
+// heard, and a reception ratio from its sequence numbers. A jump above
+// NEIGHBOUR_SEQ_GAP_MAX (or a new boot id) restarts the count instead of
+// counting as loss. Entries unheard for NEIGHBOUR_STALE_MS are dropped; a
+// full table evicts the least recently heard. A quiet node under the largest
+// gateway slowdown only sends a heartbeat every 80 s << 4 = 1280 s, so the
+// stale time covers two of those plus margin.
+constexpr uint8_t NEIGHBOUR_SLOTS = 16U;
+constexpr uint8_t NEIGHBOUR_EWMA_SHIFT = 3U;
+constexpr uint8_t NEIGHBOUR_SEQ_GAP_MAX = 16U;
+constexpr uint32_t NEIGHBOUR_STALE_MS = 2700000UL;
+
+// ===== Congestion =====
+// CONGESTION_ENABLED: the level sent is the worse of forward queue fill and
+// forward budget spent in the current window: 0 below CONGESTION_ONSET_PCT,
+// 3 when full. The highest level heard holds until CONGESTION_DECAY_MS pass
+// without one; meanwhile own REPORTs slow down by 2^level (or the gateway's
+// slowdown, whichever is larger) and the forward backoff window grows by
+// BACKOFF_MAX_MS per level.
+constexpr uint8_t CONGESTION_ONSET_PCT = 50U;
+constexpr uint32_t CONGESTION_DECAY_MS = 30000UL;
+
+// ===== Network coding =====
+// NETCODE_ENABLED: the last NETCODE_RECENT_SLOTS frames sent or accepted are
+// kept, as a relay would queue them, to decode CODED frames with.
+constexpr uint8_t NETCODE_RECENT_SLOTS = 8U;
+
+// ===== Roles =====
+// Each image carries only its role's tasks and buffers (src/role.h). Scanners
+// have no reassembly table, export ring or beacon origin and spend that RAM
+// on deeper queues and a larger dedup cache; gateways have no UART ingest,
+// own REPORTs or loss recovery. `tools/sim/budget.py` reports both images.
+// Replay tests shrink the scanner TX queue with -DSCANNER_TX_QUEUE_DEPTH to
+// reach a full queue with few frames.
+#ifndef SCANNER_TX_QUEUE_DEPTH
+#define SCANNER_TX_QUEUE_DEPTH 8
+#endif
+constexpr uint8_t SCANNER_TX_QUEUE = SCANNER_TX_QUEUE_DEPTH;
+constexpr uint8_t SCANNER_FWD_QUEUE = 8U;
+constexpr uint16_t SCANNER_DEDUP_N = 192U;
+constexpr uint8_t GATEWAY_TX_QUEUE = 6U;
+constexpr uint8_t GATEWAY_FWD_QUEUE = 6U;
+constexpr uint16_t GATEWAY_DEDUP_N = 128U;
 
 // ===== UART =====
 constexpr uint32_t UART_BAUD = 115200UL;
-constexpr uint8_t UART_LINE_MAX = 64;
+// Lines are tokenized as they stream in, so this only bounds a line that
+// never ends; it costs no RAM.
+constexpr uint16_t UART_LINE_MAX = 4096U;
 constexpr uint8_t UART_MAX_BYTES_PER_TICK = 64;
-constexpr uint8_t MAX_FREQS = 5;
+constexpr uint8_t MAX_FREQS = 5;  // Sets up to this size are reported as a plain FREQ_LIST.
+constexpr uint8_t FREQ_EXTRA_MAX = 24;  // Out-of-band values kept per line; may need fragmentation.
 // UART format: ASCII list of frequencies in MHz, terminated by '\n'.
+// Detections inside the band below are kept as a bitmap, any number per line.
+constexpr uint16_t FREQ_BAND_START_MHZ = 400U;
+constexpr uint8_t FREQ_BAND_STEP_MHZ = 1U;
+constexpr uint16_t FREQ_BAND_CHANNELS = 240U;  // Multiple of 8; worst-case REPORT must fit one frame.
+constexpr uint8_t FREQ_BAND_BYTES = FREQ_BAND_CHANNELS / 8U;
+
+// ===== Report rate =====
+// Own REPORTs go out on a frequency-set or status change (no closer than
+// REPORT_MIN_GAP_MS) and as a heartbeat whose period doubles from
+// REPORT_STATUS_PERIOD_MS up to REPORT_STATUS_PERIOD_MAX_MS while nothing
+// changes. Gateway beacons may stretch both by 2^slowdown.
+constexpr uint32_t REPORT_STATUS_PERIOD_MS = 5000UL;
+constexpr uint32_t REPORT_STATUS_PERIOD_MAX_MS = 80000UL;
+constexpr uint32_t REPORT_MIN_GAP_MS = 2000UL;
+constexpr uint32_t REPORT_JITTER_MS = 500UL;
+constexpr uint8_t REPORT_SLOWDOWN_MAX = 4;
+static_assert(NEIGHBOUR_STALE_MS > 2UL * (REPORT_STATUS_PERIOD_MAX_MS << REPORT_SLOWDOWN_MAX),
+              "a neighbour must survive a lost heartbeat at the slowest report rate");
+constexpr uint16_t GW_REPORT_BUDGET_PER_MIN = 60U;  // Above this the gateway asks for a slowdown.
+
+// ===== Gateway export bridge =====
+// Active only on IS_GATEWAY nodes: accepted RX frames are streamed to the host.
+constexpr uint16_t BRIDGE_RING_BYTES = 2048U;  // Power of two.
+// LOG records only go into the ring below this fill, so RX records keep the
+// rest; a refused log line is not counted as a dropped export.
+constexpr uint16_t BRIDGE_LOG_FILL_MAX = BRIDGE_RING_BYTES / 4U;
+constexpr uint16_t BRIDGE_FLUSH_MIN_BYTES = 64U;
+constexpr uint32_t BRIDGE_FLUSH_MAX_DELAY_MS = 20UL;
+constexpr uint16_t BRIDGE_FLUSH_MAX_BYTES_PER_TICK = 256U;
+constexpr uint32_t BRIDGE_STATS_PERIOD_MS = 10000UL;
 
 // ===== Battery ADC =====
 constexpr uint32_t BATT_LOG_PERIOD_MS = 10000UL;
-constexpr uint32_t REPORT_STATUS_PERIOD_MS = 5000UL;
 
 #endif  // CONFIG_H
@@ -0,0 +1,70 @@
+#include "congestion.h"
+
+#include "config.h"
+#include "frame_codec.h"
+
+namespace {
+
+uint8_t gHeardLevel = 0U;
+uint32_t gHeardUntilMs = 0UL;
+uint32_t gSignalled = 0UL;
+uint32_t gHeard = 0UL;
+
+bool timeReached(uint32_t nowMs, uint32_t deadlineMs) {
+  return static_cast<int32_t>(nowMs - deadlineMs) >= 0;
+}
+
+}  // namespace
+
+void congestionInit() {
+  gHeardLevel = 0U;
+  gSignalled = 0UL;
+  gHeard = 0UL;
+}
+
+uint8_t congestionLevelFor(uint8_t used, uint8_t capacity) {
+  if (capacity == 0U) {
+    return 0U;
+  }
+  const uint32_t pct = (used >= capacity) ? 100UL : ((static_cast<uint32_t>(used) * 100UL) / capacity);
+  if (pct < CONGESTION_ONSET_PCT) {
+    return 0U;
+  }
+  // Levels 1-2 split the range above the onset; only a full resource is 3.
+  if (pct >= 100UL) {
+    return codec::CONGESTION_LEVEL_MAX;
+  }
+  return static_cast<uint8_t>(1UL + (((pct - CONGESTION_ONSET_PCT) * 2UL) / (100UL - CONGESTION_ONSET_PCT)));
+}
+
+void congestionOnHeard(uint8_t level, uint32_t nowMs) {
+  if (!CONGESTION_ENABLED || (level == 0U)) {
+    return;
+  }
+  ++gHeard;
+  // A lower level keeps a stronger one in force: the level only drops once
+  // the neighbourhood has been quiet for the whole decay period.
+  if (level >= congestionHeardLevel(nowMs)) {
+    gHeardLevel = level;
+  }
+  gHeardUntilMs = nowMs + CONGESTION_DECAY_MS;
+}
+
+uint8_t congestionHeardLevel(uint32_t nowMs) {
+  if ((gHeardLevel > 0U) && timeReached(nowMs, gHeardUntilMs)) {
+    gHeardLevel = 0U;
+  }
+  return gHeardLevel;
+}
+
+void congestionOnSignalled() {
+  ++gSignalled;
+}
+
+uint32_t congestionSignalled() {
+  return gSignalled;
+}
+
+uint32_t congestionHeard() {
+  return gHeard;
+}
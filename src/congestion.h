@@ -0,0 +1,29 @@
+#ifndef CONGESTION_H
+#define CONGESTION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Neighbour congestion signalling (CONGESTION_ENABLED, tuning: "Congestion"
+// in config.h). Every frame this node sends carries its level in FLAGS bits
+// 3-4; a level heard from a neighbour holds for CONGESTION_DECAY_MS and
+// throttles own REPORTs and forwards meanwhile.
+
+void congestionInit();
+
+// Level for a resource `used` out of `capacity`: 0 below
+// CONGESTION_ONSET_PCT, then rising to 3 when exhausted.
+uint8_t congestionLevelFor(uint8_t used, uint8_t capacity);
+
+// A valid frame from a neighbour carried `level`.
+void congestionOnHeard(uint8_t level, uint32_t nowMs);
+// Highest level heard within CONGESTION_DECAY_MS; 0 with the feature off.
+uint8_t congestionHeardLevel(uint32_t nowMs);
+
+// A frame went out with a non-zero level.
+void congestionOnSignalled();
+
+uint32_t congestionSignalled();
+uint32_t congestionHeard();
+
+#endif  // CONGESTION_H
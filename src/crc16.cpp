@@ -1,18 +1,11 @@
 #include "crc16.h"
 
-uint16_t crc16_ccitt_false(const uint8_t* data, uint8_t len) {
-  uint16_t crc = 0xFFFFU;
+#include "frame_codec.h"
 
-  for (uint8_t i = 0; i < len; ++i) {
-    crc ^= static_cast<uint16_t>(data[i]) << 8;
-    for (uint8_t bit = 0; bit < 8; ++bit) {
-      if ((crc & 0x8000U) != 0U) {
-        crc = static_cast<uint16_t>((crc << 1) ^ 0x1021U);
-      } else {
-        crc = static_cast<uint16_t>(crc << 1);
-      }
-    }
-  }
+uint16_t crc16_ccitt_false_update(uint16_t crc, const uint8_t* data, uint8_t len) {
+  return codec::crc16Update(crc, data, len);
+}
 
-  return crc;
+uint16_t crc16_ccitt_false(const uint8_t* data, uint8_t len) {
+  return codec::crc16(data, len);
 }
@@ -4,5 +4,7 @@
 #include <stdint.h>
 
 uint16_t crc16_ccitt_false(const uint8_t* data, uint8_t len);
+// Continues a CRC over another chunk; start with 0xFFFF.
+uint16_t crc16_ccitt_false_update(uint16_t crc, const uint8_t* data, uint8_t len);
 
 #endif  // CRC16_H
@@ -1,43 +1,48 @@
 #include "dedup.h"
 
 #include "config.h"
+#include "role.h"
 
 namespace {
 
+// No initialisers: a zeroed table lives in .bss instead of costing its size
+// again in flash. Entries mean nothing until `used` is set.
 struct DedupEntry {
-  uint8_t src = 0U;
-  uint16_t msgId = 0U;
-  uint32_t timestampMs = 0UL;
-  bool used = false;
+  uint8_t src;
+  uint16_t msgId;
+  uint8_t part;
+  uint32_t timestampMs;
+  bool used;
 };
 
-DedupEntry gDedup[DEDUP_N];
+DedupEntry gDedup[Role::DEDUP_N];
 uint16_t gDedupNext = 0U;
 
 }  // namespace
 
-bool dedupSeen(uint8_t src, uint16_t msgId, uint32_t nowMs) {
+bool dedupSeen(uint8_t src, uint16_t msgId, uint8_t part, uint32_t nowMs) {
   (void)nowMs;  // Reserved for future aging policy.
 
-  for (uint16_t i = 0U; i < DEDUP_N; ++i) {
+  for (uint16_t i = 0U; i < Role::DEDUP_N; ++i) {
     if (!gDedup[i].used) {
       continue;
     }
-    if ((gDedup[i].src == src) && (gDedup[i].msgId == msgId)) {
+    if ((gDedup[i].src == src) && (gDedup[i].msgId == msgId) && (gDedup[i].part == part)) {
       return true;
     }
   }
   return false;
 }
 
-void dedupRemember(uint8_t src, uint16_t msgId, uint32_t nowMs) {
+void dedupRemember(uint8_t src, uint16_t msgId, uint8_t part, uint32_t nowMs) {
   gDedup[gDedupNext].src = src;
   gDedup[gDedupNext].msgId = msgId;
+  gDedup[gDedupNext].part = part;
   gDedup[gDedupNext].timestampMs = nowMs;
   gDedup[gDedupNext].used = true;
 
   ++gDedupNext;
-  if (gDedupNext >= DEDUP_N) {
+  if (gDedupNext >= Role::DEDUP_N) {
     gDedupNext = 0U;
   }
 }
@@ -4,7 +4,11 @@
 #include <stdbool.h>
 #include <stdint.h>
 
-bool dedupSeen(uint8_t src, uint16_t msgId, uint32_t nowMs);
-void dedupRemember(uint8_t src, uint16_t msgId, uint32_t nowMs);
+// `part` tells fragments of one message apart: the fragment index for FRAG
+// frames, DEDUP_PART_WHOLE for everything else.
+constexpr uint8_t DEDUP_PART_WHOLE = 0xFFU;
+
+bool dedupSeen(uint8_t src, uint16_t msgId, uint8_t part, uint32_t nowMs);
+void dedupRemember(uint8_t src, uint16_t msgId, uint8_t part, uint32_t nowMs);
 
 #endif  // DEDUP_H
@@ -2,109 +2,125 @@
 
 #include "board.h"
 #include "config.h"
-#include "crc16.h"
+#include "mesh_params.h"
+#include "neighbours.h"
 
 namespace {
 
-constexpr uint8_t PING_TYPE = 0x01U;
 constexpr uint8_t SCANNER_DST_ID = 0xFFU;
-constexpr uint8_t PING_LEN = PING_FRAME_LEN;
-constexpr uint8_t HEADER_LEN = 10U;
-constexpr uint8_t CRC_LEN = 2U;
-constexpr uint8_t NODE_STATUS_LEN = 3U;
-constexpr uint8_t IDX_NET = 0U;
-constexpr uint8_t IDX_SRC = 1U;
-constexpr uint8_t IDX_DST = 2U;
-constexpr uint8_t IDX_BOOT = 3U;
-constexpr uint8_t IDX_TYPE = 4U;
-constexpr uint8_t IDX_SEQ_L = 5U;
-constexpr uint8_t IDX_SEQ_H = 6U;
-constexpr uint8_t IDX_TTL = 7U;
-constexpr uint8_t IDX_HOPS = 8U;
-constexpr uint8_t IDX_FLAGS = 9U;
 
-}  // namespace
+static_assert(NET_ID < codec::compact::VERSION_BIT, "legacy NET_ID must leave the compact-header bit clear");
+static_assert(!COMPACT_HEADER_TX || ((NET_ID <= codec::compact::NET_MASK) && (DATA_TTL_EMERG <= codec::compact::NIBBLE_MAX) &&
+                                     (BEACON_TTL_HOPS <= codec::compact::NIBBLE_MAX)),
+              "compact headers carry a 4-bit NET_ID and TTL");
+
+codec::Header localHeader(uint8_t type, uint8_t dstId, uint16_t seq) {
+  codec::Header h{};
+  h.netId = NET_ID;
+  h.src = NODE_ID;
+  h.dst = dstId;
+  h.bootId = boardBootId();
+  h.type = type;
+  h.seq = seq;
+  h.ttl = meshParams().dataTtl;
+  h.hops = 0U;
+  h.flags = AUTH_ENABLED ? codec::FLAG_AUTH : 0U;
+  h.compact = (COMPACT_HEADER_TX != 0);
+  return h;
+}
 
-void buildPingFrame(uint16_t seq, uint8_t out[PING_FRAME_LEN]) {
-  out[IDX_NET] = NET_ID;
-  out[IDX_SRC] = NODE_ID;
-  out[IDX_DST] = SCANNER_DST_ID;
-  out[IDX_BOOT] = boardBootId();
-  out[IDX_TYPE] = PING_TYPE;
-  out[IDX_SEQ_L] = static_cast<uint8_t>(seq & 0xFFU);
-  out[IDX_SEQ_H] = static_cast<uint8_t>((seq >> 8) & 0xFFU);
-  out[IDX_TTL] = DATA_TTL;
-  out[IDX_HOPS] = 0U;
-  out[IDX_FLAGS] = 0U;
-
-  const uint16_t crc = crc16_ccitt_false(out, HEADER_LEN);
-  out[HEADER_LEN] = static_cast<uint8_t>(crc & 0xFFU);
-  out[HEADER_LEN + 1U] = static_cast<uint8_t>((crc >> 8) & 0xFFU);
-}
-
-bool frameCrcOk(const uint8_t* buf, uint8_t len) {
-  if ((buf == nullptr) || (len < (HEADER_LEN + CRC_LEN))) {
-    return false;
+// Builders get `outMax - FRAME_AUTH_LEN`; the tag goes in the room left.
+uint8_t finishOwn(uint8_t* out, uint8_t len, uint8_t outMax) {
+  if constexpr (AUTH_ENABLED) {
+    return (len == 0U) ? 0U : codec::authAppend(AUTH_KEY, out, len, outMax);
   }
-  const uint8_t crcIdx = static_cast<uint8_t>(len - CRC_LEN);
-  const uint16_t crcCalc = crc16_ccitt_false(buf, crcIdx);
-  const uint16_t crcIn = static_cast<uint16_t>(buf[crcIdx]) |
-                         static_cast<uint16_t>(static_cast<uint16_t>(buf[crcIdx + 1U]) << 8);
-  return crcCalc == crcIn;
+  return len;
 }
 
-bool frameGetSrcMsgId(const uint8_t* buf, uint8_t len, uint8_t& srcOut, uint16_t& msgIdOut) {
-  if ((buf == nullptr) || (len < (HEADER_LEN + CRC_LEN))) {
-    return false;
-  }
-  srcOut = buf[IDX_SRC];
-  msgIdOut = static_cast<uint16_t>(buf[IDX_SEQ_L]) |
-             static_cast<uint16_t>(static_cast<uint16_t>(buf[IDX_SEQ_H]) << 8);
-  return true;
+// Every TRACE_REPORT_EVERY-th own REPORT (by seq) is traced.
+bool reportTraced(uint16_t seq) {
+  return (TRACE_REPORT_EVERY > 0U) && ((seq % TRACE_REPORT_EVERY) == 0U);
 }
 
-bool frameGetTTL(const uint8_t* buf, uint8_t len, uint8_t& ttlOut) {
-  if ((buf == nullptr) || (len < (HEADER_LEN + CRC_LEN))) {
-    return false;
+codec::Header reportHeader(uint8_t dstId, uint16_t seq) {
+  codec::Header h = localHeader(codec::REPORT_TYPE, dstId, seq);
+  if (reportTraced(seq)) {
+    h.flags = static_cast<uint8_t>(h.flags | codec::FLAG_TRACE);
   }
-  ttlOut = buf[IDX_TTL];
-  return true;
+  return h;
 }
 
-bool frameGetHops(const uint8_t* buf, uint8_t len, uint8_t& hopsOut) {
-  if ((buf == nullptr) || (len < (HEADER_LEN + CRC_LEN))) {
-    return false;
+// Every NEIGHBOUR_REPORT_EVERY-th own REPORT (by seq) lists neighbour links.
+bool reportLinks(uint16_t seq) {
+  return (NEIGHBOUR_REPORT_EVERY > 0U) && ((seq % NEIGHBOUR_REPORT_EVERY) == 0U);
+}
+
+// REPORT builders also leave FRAME_NEIGHBOURS_LEN and FRAME_TRACE_LEN for
+// those TLVs, which go in that order before the tag.
+uint8_t finishReport(uint16_t seq, uint8_t* out, uint8_t len, uint8_t outMax) {
+  if (reportLinks(seq) && (len > 0U)) {
+    codec::Link links[codec::NEIGHBOURS_MAX];
+    const uint8_t count = neighboursFillLinks(links, codec::NEIGHBOURS_MAX);
+    len = codec::neighboursAppend(out, len, outMax - FRAME_AUTH_LEN - FRAME_TRACE_LEN, links, count);
   }
-  hopsOut = buf[IDX_HOPS];
-  return true;
+  if (reportTraced(seq) && (len > 0U)) {
+    len = codec::traceAppend(out, len, outMax - FRAME_AUTH_LEN);
+  }
+  return finishOwn(out, len, outMax);
+}
+
+}  // namespace
+
+uint8_t buildPingFrame(uint16_t seq, uint8_t out[PING_FRAME_LEN]) {
+  return finishOwn(out, codec::buildPing(localHeader(codec::PING_TYPE, SCANNER_DST_ID, seq), out), PING_FRAME_LEN);
+}
+
+// Pieces carry their own tag so relays can check each one.
+uint8_t fragmentCountFor(const uint8_t* frame, uint8_t frameLen, uint8_t outMax) {
+  return codec::fragmentsFor(frame, frameLen, outMax - FRAME_AUTH_LEN);
+}
+
+uint8_t buildFragmentFrame(const uint8_t* frame, uint8_t frameLen, uint8_t idx, uint8_t* out, uint8_t outMax) {
+  const uint8_t len = codec::buildFragment(frame, frameLen, outMax - FRAME_AUTH_LEN, idx, out, outMax);
+  return finishOwn(out, len, outMax);
 }
 
-bool frameIsNoRelay(const uint8_t* buf, uint8_t len) {
-  if ((buf == nullptr) || (len < (HEADER_LEN + CRC_LEN))) {
-    return true;
+bool frameNetOk(const codec::FrameView& view) {
+  const uint8_t want = view.compact() ? static_cast<uint8_t>(NET_ID & codec::compact::NET_MASK) : NET_ID;
+  return view.netId() == want;
+}
+
+bool frameRelayRewrite(uint8_t* buf, uint8_t len) {
+  return codec::relayRewrite(buf, len);
+}
+
+bool frameAuthOk(const codec::FrameView& view) {
+  return codec::authOk(AUTH_KEY, view);
+}
+
+void frameAuthReseal(uint8_t* buf, uint8_t len) {
+  (void)codec::authReseal(AUTH_KEY, buf, len);
+}
+
+void frameTraceStamp(uint8_t* buf, uint8_t len, uint8_t relayId, uint32_t delayMs) {
+  if (codec::traceStamp(buf, len, relayId, delayMs) && AUTH_ENABLED) {
+    frameAuthReseal(buf, len);
   }
-  return (buf[IDX_FLAGS] & FRAME_FLAG_NO_RELAY) != 0U;
 }
 
-bool frameDecTTLIncHopsAndRecrc(uint8_t* buf, uint8_t len) {
-  if ((buf == nullptr) || (len < (HEADER_LEN + CRC_LEN))) {
-    return false;
+uint8_t frameCongestionStamp(uint8_t* buf, uint8_t len, uint8_t outMax, uint8_t level) {
+  codec::FrameView view;
+  if (!view.init(buf, len) || (codec::congestionLevel(view.flags()) == level)) {
+    return len;
   }
-  if (!frameCrcOk(buf, len)) {
-    return false;
+  const uint8_t stamped = static_cast<uint8_t>(codec::congestionStamp(buf, len, outMax, level));
+  if (stamped == 0U) {
+    return len;
   }
-  if (buf[IDX_TTL] == 0U) {
-    return false;
+  if (AUTH_ENABLED) {
+    frameAuthReseal(buf, stamped);
   }
-
-  buf[IDX_TTL] = static_cast<uint8_t>(buf[IDX_TTL] - 1U);
-  buf[IDX_HOPS] = static_cast<uint8_t>(buf[IDX_HOPS] + 1U);
-
-  const uint8_t crcIdx = static_cast<uint8_t>(len - CRC_LEN);
-  const uint16_t crc = crc16_ccitt_false(buf, crcIdx);
-  buf[crcIdx] = static_cast<uint8_t>(crc & 0xFFU);
-  buf[crcIdx + 1U] = static_cast<uint8_t>((crc >> 8) & 0xFFU);
-  return true;
+  return stamped;
 }
 
 bool parsePingFrame(const uint8_t* buf,
@@ -113,31 +129,13 @@ bool parsePingFrame(const uint8_t* buf,
                     uint8_t& srcOut,
                     uint8_t& bootOut,
                     uint8_t& errCode) {
-  if (len != PING_LEN) {
-    errCode = 1U;
+  codec::Header h{};
+  if (!codec::parsePing(buf, len, NET_ID, h, errCode)) {
     return false;
   }
-
-  if (buf[0] != NET_ID) {
-    errCode = 2U;
-    return false;
-  }
-
-  if (buf[4] != PING_TYPE) {
-    errCode = 4U;
-    return false;
-  }
-
-  if (!frameCrcOk(buf, len)) {
-    errCode = 3U;
-    return false;
-  }
-
-  seqOut = static_cast<uint16_t>(buf[IDX_SEQ_L]) |
-           static_cast<uint16_t>(static_cast<uint16_t>(buf[IDX_SEQ_H]) << 8);
-  srcOut = buf[IDX_SRC];
-  bootOut = buf[IDX_BOOT];
-  errCode = 0U;
+  seqOut = h.seq;
+  srcOut = h.src;
+  bootOut = h.bootId;
   return true;
 }
 
@@ -149,54 +147,61 @@ uint8_t buildReportFrame(uint16_t seq,
                          uint16_t lastUartAgeS,
                          uint8_t* out,
                          uint8_t outMax) {
-  if ((out == nullptr) || (outMax < (HEADER_LEN + CRC_LEN))) {
-    return 0U;
-  }
-
   uint8_t safeFreqCount = freqCount;
   if (safeFreqCount > MAX_FREQS) {
     safeFreqCount = MAX_FREQS;
   }
+  const uint8_t len = codec::buildReport(reportHeader(dstId, seq),
+                                         freqMHz,
+                                         safeFreqCount,
+                                         statusFlags,
+                                         lastUartAgeS,
+                                         out,
+                                         outMax - FRAME_AUTH_LEN - FRAME_TRACE_LEN - FRAME_NEIGHBOURS_LEN);
+  return finishReport(seq, out, len, outMax);
+}
 
-  const uint8_t freqBytes = static_cast<uint8_t>(safeFreqCount * 2U);
-  const uint8_t payloadLen =
-      static_cast<uint8_t>(2U + freqBytes + 2U + NODE_STATUS_LEN);  // two TLV headers + payloads
-  const uint8_t fullLen = static_cast<uint8_t>(HEADER_LEN + payloadLen + CRC_LEN);
-
-  if (fullLen > outMax) {
-    return 0U;
-  }
-
-  out[IDX_NET] = NET_ID;
-  out[IDX_SRC] = NODE_ID;
-  out[IDX_DST] = dstId;
-  out[IDX_BOOT] = boardBootId();
-  out[IDX_TYPE] = REPORT_TYPE;
-  out[IDX_SEQ_L] = static_cast<uint8_t>(seq & 0xFFU);
-  out[IDX_SEQ_H] = static_cast<uint8_t>((seq >> 8) & 0xFFU);
-  out[IDX_TTL] = DATA_TTL;
-  out[IDX_HOPS] = 0U;
-  out[IDX_FLAGS] = 0U;
-
-  uint8_t idx = HEADER_LEN;
-
-  out[idx++] = TLV_FREQ_LIST;
-  out[idx++] = freqBytes;
-  for (uint8_t i = 0; i < safeFreqCount; ++i) {
-    const uint16_t f = freqMHz[i];
-    out[idx++] = static_cast<uint8_t>(f & 0xFFU);
-    out[idx++] = static_cast<uint8_t>((f >> 8) & 0xFFU);
-  }
+uint8_t buildReportBandFrame(uint16_t seq,
+                             uint8_t dstId,
+                             const FreqSet& freqs,
+                             uint8_t statusFlags,
+                             uint16_t lastUartAgeS,
+                             uint8_t* out,
+                             uint8_t outMax) {
+  const uint8_t len = codec::buildReportBand(reportHeader(dstId, seq),
+                                             freqs.extra,
+                                             freqs.extraCount,
+                                             FREQ_BAND_START_MHZ,
+                                             FREQ_BAND_STEP_MHZ,
+                                             freqs.band,
+                                             FREQ_BAND_BYTES,
+                                             statusFlags,
+                                             lastUartAgeS,
+                                             out,
+                                             outMax - FRAME_AUTH_LEN - FRAME_TRACE_LEN - FRAME_NEIGHBOURS_LEN);
+  return finishReport(seq, out, len, outMax);
+}
 
-  out[idx++] = TLV_NODE_STATUS;
-  out[idx++] = NODE_STATUS_LEN;
-  out[idx++] = statusFlags;
-  out[idx++] = static_cast<uint8_t>(lastUartAgeS & 0xFFU);
-  out[idx++] = static_cast<uint8_t>((lastUartAgeS >> 8) & 0xFFU);
+uint8_t buildBeaconFrame(uint16_t seq, const codec::Beacon& beacon, uint8_t* out, uint8_t outMax) {
+  codec::Header h = localHeader(codec::BEACON_TYPE, SCANNER_DST_ID, seq);
+  h.ttl = BEACON_TTL_HOPS;
+  return finishOwn(out, codec::buildBeacon(h, beacon, out, outMax - FRAME_AUTH_LEN), outMax);
+}
 
-  const uint16_t crc = crc16_ccitt_false(out, idx);
-  out[idx++] = static_cast<uint8_t>(crc & 0xFFU);
-  out[idx++] = static_cast<uint8_t>((crc >> 8) & 0xFFU);
+uint8_t buildConfigFrame(uint16_t seq, const codec::ConfigMsg& config, uint8_t* out, uint8_t outMax) {
+  codec::Header h = localHeader(codec::CONFIG_TYPE, SCANNER_DST_ID, seq);
+  h.ttl = 0U;
+  return finishOwn(out, codec::buildConfig(h, config, out, outMax - FRAME_AUTH_LEN), outMax);
+}
 
-  return idx;
+uint8_t buildCodedFrame(uint16_t seq,
+                        const uint8_t* a,
+                        uint8_t lenA,
+                        const uint8_t* b,
+                        uint8_t lenB,
+                        uint8_t* out,
+                        uint8_t outMax) {
+  codec::Header h = localHeader(codec::CODED_TYPE, SCANNER_DST_ID, seq);
+  h.ttl = 0U;
+  return finishOwn(out, codec::buildCoded(h, a, lenA, b, lenB, out, outMax - FRAME_AUTH_LEN), outMax);
 }
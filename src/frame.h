@@ -4,13 +4,36 @@
 #include <stdbool.h>
 #include <stdint.h>
 
-constexpr uint8_t PING_FRAME_LEN = 12U;
-constexpr uint8_t REPORT_TYPE = 0x10U;
-constexpr uint8_t TLV_FREQ_LIST = 0x01U;
-constexpr uint8_t TLV_NODE_STATUS = 0x02U;
-constexpr uint8_t FRAME_FLAG_NO_RELAY = 0x01U;
+#include "config.h"
+#include "frame_codec.h"
+#include "freq_set.h"
 
-void buildPingFrame(uint16_t seq, uint8_t out[PING_FRAME_LEN]);
+// Firmware-side wrappers: bind the shared codec to this node's identity.
+// Bytes the auth TLV adds to every own frame.
+constexpr uint8_t FRAME_AUTH_LEN = AUTH_ENABLED ? codec::AUTH_TLV_LEN : 0U;
+// Bytes the trace TLV adds to traced own REPORTs.
+constexpr uint8_t FRAME_TRACE_LEN = (TRACE_REPORT_EVERY > 0U) ? codec::TRACE_TLV_LEN : 0U;
+// Bytes the neighbour links TLV adds, at most, to own REPORTs.
+constexpr uint8_t FRAME_NEIGHBOURS_LEN = (NEIGHBOUR_REPORT_EVERY > 0U) ? codec::NEIGHBOURS_TLV_MAX_LEN : 0U;
+constexpr uint8_t PING_FRAME_LEN = codec::PING_FRAME_LEN + FRAME_AUTH_LEN;  // Buffer size; compact PINGs are shorter.
+constexpr uint8_t PING_TYPE = codec::PING_TYPE;
+constexpr uint8_t CONFIG_TYPE = codec::CONFIG_TYPE;
+constexpr uint8_t REPORT_TYPE = codec::REPORT_TYPE;
+constexpr uint8_t BEACON_TYPE = codec::BEACON_TYPE;
+constexpr uint8_t FRAG_TYPE = codec::FRAG_TYPE;
+constexpr uint8_t CODED_TYPE = codec::CODED_TYPE;
+constexpr uint8_t TLV_FREQ_LIST = codec::TLV_FREQ_LIST;
+constexpr uint8_t TLV_NODE_STATUS = codec::TLV_NODE_STATUS;
+constexpr uint8_t FRAME_FLAG_NO_RELAY = codec::FLAG_NO_RELAY;
+constexpr uint8_t FRAME_FLAG_AUTH = codec::FLAG_AUTH;
+constexpr uint8_t FRAME_FLAG_TRACE = codec::FLAG_TRACE;
+constexpr uint8_t TRACE_ORIGIN = 0xFFU;  // frameTraceStamp() relay id of the origin.
+
+// Own frames use the compact header when COMPACT_HEADER_TX is set and end
+// with an auth tag when AUTH_ENABLED is set. Every TRACE_REPORT_EVERY-th
+// REPORT carries a trace TLV, every NEIGHBOUR_REPORT_EVERY-th one the
+// freshest neighbour links.
+uint8_t buildPingFrame(uint16_t seq, uint8_t out[PING_FRAME_LEN]);
 bool parsePingFrame(const uint8_t* buf,
                     uint8_t len,
                     uint16_t& seqOut,
@@ -27,11 +50,51 @@ uint8_t buildReportFrame(uint16_t seq,
                          uint8_t* out,
                          uint8_t outMax);
 
-bool frameCrcOk(const uint8_t* buf, uint8_t len);
-bool frameGetSrcMsgId(const uint8_t* buf, uint8_t len, uint8_t& srcOut, uint16_t& msgIdOut);
-bool frameGetTTL(const uint8_t* buf, uint8_t len, uint8_t& ttlOut);
-bool frameGetHops(const uint8_t* buf, uint8_t len, uint8_t& hopsOut);
-bool frameIsNoRelay(const uint8_t* buf, uint8_t len);
-bool frameDecTTLIncHopsAndRecrc(uint8_t* buf, uint8_t len);
+// REPORT for sets larger than MAX_FREQS: band bitmap/RLE plus out-of-band list.
+// May exceed one radio frame when many out-of-band values are present.
+uint8_t buildReportBandFrame(uint16_t seq,
+                             uint8_t dstId,
+                             const FreqSet& freqs,
+                             uint8_t statusFlags,
+                             uint16_t lastUartAgeS,
+                             uint8_t* out,
+                             uint8_t outMax);
+
+// Gateway beacon: flooded with BEACON_TTL_HOPS.
+uint8_t buildBeaconFrame(uint16_t seq, const codec::Beacon& beacon, uint8_t* out, uint8_t outMax);
+// TTL 0: CONFIGs travel by Trickle re-announcement, never by relaying.
+uint8_t buildConfigFrame(uint16_t seq, const codec::ConfigMsg& config, uint8_t* out, uint8_t outMax);
+// TTL 0: two queued forwards XORed for the neighbours on either side; see
+// codec::buildCoded().
+uint8_t buildCodedFrame(uint16_t seq,
+                        const uint8_t* a,
+                        uint8_t lenA,
+                        const uint8_t* b,
+                        uint8_t lenB,
+                        uint8_t* out,
+                        uint8_t outMax);
+
+// Fragment `idx` of an own frame too long for `outMax`; see codec::buildFragment().
+uint8_t fragmentCountFor(const uint8_t* frame, uint8_t frameLen, uint8_t outMax);
+uint8_t buildFragmentFrame(const uint8_t* frame, uint8_t frameLen, uint8_t idx, uint8_t* out, uint8_t outMax);
+
+// Header fields of received frames are read through codec::FrameView.
+// NET_ID match; compact headers carry only its low nibble.
+bool frameNetOk(const codec::FrameView& view);
+// Relay rewrite of an already-validated copy (either header format):
+// TTL-1, HOPS+1, new CRC.
+bool frameRelayRewrite(uint8_t* buf, uint8_t len);
+
+// Tag check of a structurally valid frame against AUTH_KEY.
+bool frameAuthOk(const codec::FrameView& view);
+// Recomputes the tag after an in-place payload rewrite; no-op without one.
+void frameAuthReseal(uint8_t* buf, uint8_t len);
+// Adds one send to a traced frame right before TX (see codec::traceStamp());
+// no-op on untraced frames.
+void frameTraceStamp(uint8_t* buf, uint8_t len, uint8_t relayId, uint32_t delayMs);
+// Puts this node's congestion level in FLAGS right before TX (see
+// codec::congestionStamp()) and re-signs; returns the new length, or `len`
+// when the frame has no room for it.
+uint8_t frameCongestionStamp(uint8_t* buf, uint8_t len, uint8_t outMax, uint8_t level);
 
 #endif  // FRAME_H
@@ -0,0 +1,1684 @@
+#ifndef FRAME_CODEC_H
+#define FRAME_CODEC_H
+
+// Header-only frame codec shared by the firmware and host tools.
+// No Arduino or config.h dependencies: node identity is passed in by the caller.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "siphash.h"
+
+namespace codec {
+
+// ===== Header layout =====
+// Single source of truth for field offsets; everything else derives from it.
+
+struct HeaderField {
+  uint8_t offset;
+  uint8_t size;
+};
+
+namespace layout {
+constexpr HeaderField NET{0U, 1U};
+constexpr HeaderField SRC{1U, 1U};
+constexpr HeaderField DST{2U, 1U};
+constexpr HeaderField BOOT{3U, 1U};
+constexpr HeaderField TYPE{4U, 1U};
+constexpr HeaderField SEQ{5U, 2U};  // Little-endian.
+constexpr HeaderField TTL{7U, 1U};
+constexpr HeaderField HOPS{8U, 1U};
+constexpr HeaderField FLAGS{9U, 1U};
+}  // namespace layout
+
+// Compact variant, selected by bit 7 of the first byte (legacy NET ids stay
+// below 0x80 so both formats coexist on one channel):
+//   [0] 1 | HAS_DST | HAS_BOOT | HAS_FLAGS | NET (4 bits)
+//   [1] SRC  [2] TYPE  [3] SEQ (low 8 bits)  [4] TTL << 4 | HOPS
+//   then DST when not broadcast, BOOT when SEQ is 0 (first frame after boot
+//   and every wrap: the receiver's epoch marker), FLAGS when nonzero.
+namespace compact {
+constexpr uint8_t VERSION_BIT = 0x80U;
+constexpr uint8_t HAS_DST = 0x40U;
+constexpr uint8_t HAS_BOOT = 0x20U;
+constexpr uint8_t HAS_FLAGS = 0x10U;
+constexpr uint8_t NET_MASK = 0x0FU;
+constexpr uint8_t NIBBLE_MAX = 0x0FU;
+constexpr uint8_t DST_BROADCAST = 0xFFU;
+constexpr uint8_t IDX_SRC = 1U;
+constexpr uint8_t IDX_TYPE = 2U;
+constexpr uint8_t IDX_SEQ = 3U;
+constexpr uint8_t IDX_TTL_HOPS = 4U;
+constexpr uint8_t BASE_LEN = 5U;
+}  // namespace compact
+
+constexpr uint8_t HEADER_LEN = layout::FLAGS.offset + layout::FLAGS.size;  // Legacy, and the longest.
+constexpr uint8_t CRC_LEN = 2U;
+constexpr uint8_t TLV_HEADER_LEN = 2U;
+constexpr uint8_t PING_FRAME_LEN = HEADER_LEN + CRC_LEN;  // Longest PING.
+constexpr uint8_t MIN_FRAME_LEN = compact::BASE_LEN + CRC_LEN;
+constexpr uint8_t NODE_STATUS_LEN = 3U;
+
+static_assert(HEADER_LEN == 10U, "on-air header is 10 bytes");
+static_assert(layout::SEQ.offset + layout::SEQ.size == layout::TTL.offset, "header fields must be contiguous");
+static_assert(compact::BASE_LEN + 3U <= HEADER_LEN, "a compact header is never longer than a legacy one");
+
+constexpr uint8_t PING_TYPE = 0x01U;
+constexpr uint8_t REPORT_TYPE = 0x10U;
+constexpr uint8_t BEACON_TYPE = 0x20U;
+constexpr uint8_t FRAG_TYPE = 0x30U;
+constexpr uint8_t CONFIG_TYPE = 0x40U;
+constexpr uint8_t CODED_TYPE = 0x50U;
+constexpr uint8_t TLV_FREQ_LIST = 0x01U;
+constexpr uint8_t TLV_NODE_STATUS = 0x02U;
+constexpr uint8_t TLV_FREQ_BITMAP = 0x03U;
+constexpr uint8_t TLV_FREQ_RLE = 0x04U;
+constexpr uint8_t BAND_HEADER_LEN = 3U;  // startMHz(LE16), stepMHz
+constexpr uint8_t TLV_PHY_SWITCH = 0x10U;
+constexpr uint8_t TLV_REPORT_RATE = 0x11U;
+constexpr uint8_t TLV_TIME_SYNC = 0x12U;
+constexpr uint8_t PHY_SWITCH_LEN = 4U;   // active, target, switchInMs(LE16)
+constexpr uint8_t REPORT_RATE_LEN = 1U;  // slowdown shift
+constexpr uint8_t TIME_SYNC_LEN = 4U;    // network time in ms (LE32) at TX start
+constexpr uint8_t TLV_REPORT_ACK = 0x13U;
+constexpr uint8_t REPORT_ACK_ENTRY_LEN = 4U;  // src, highest seq(LE16), bitmap of the 8 seqs below it
+constexpr uint8_t REPORT_ACK_MAX = 6U;        // Entries per beacon.
+constexpr uint8_t TLV_CONFIG_VERSION = 0x14U;
+constexpr uint8_t TLV_MESH_PARAMS = 0x15U;
+constexpr uint8_t CONFIG_VERSION_LEN = 2U;  // LE16, newer wins (serial order)
+constexpr uint8_t MESH_PARAMS_LEN = 10U;    // see MeshParams
+constexpr uint8_t TLV_CODED = 0x16U;
+constexpr uint8_t CODED_ENTRY_LEN = 3U;  // src, seq low byte, frame length; one per native
+constexpr uint8_t TLV_AUTH = 0x05U;
+constexpr uint8_t AUTH_TAG_LEN = 4U;  // Truncated SipHash-2-4.
+constexpr uint8_t AUTH_TLV_LEN = TLV_HEADER_LEN + AUTH_TAG_LEN;
+constexpr uint8_t AUTH_KEY_LEN = 16U;
+constexpr uint8_t TLV_TRACE = 0x06U;
+constexpr uint8_t TRACE_LEN = 10U;  // see Trace
+constexpr uint8_t TRACE_TLV_LEN = TLV_HEADER_LEN + TRACE_LEN;
+constexpr uint8_t TLV_NEIGHBOURS = 0x07U;
+constexpr uint8_t NEIGHBOUR_ENTRY_LEN = 4U;  // id, RSSI dBm (i8), SNR dB (i8), PRR %
+constexpr uint8_t NEIGHBOURS_MAX = 4U;       // Entries per REPORT.
+constexpr uint8_t NEIGHBOURS_TLV_MAX_LEN = TLV_HEADER_LEN + (NEIGHBOURS_MAX * NEIGHBOUR_ENTRY_LEN);
+constexpr uint8_t FLAG_NO_RELAY = 0x01U;
+constexpr uint8_t FLAG_AUTH = 0x02U;  // Frame ends with a TLV_AUTH tag.
+constexpr uint8_t FLAG_TRACE = 0x04U;  // Payload carries a TLV_TRACE relays update.
+constexpr uint8_t FLAG_CONGESTION_MASK = 0x18U;  // Sender's congestion level, 0-3.
+constexpr uint8_t FLAG_CONGESTION_SHIFT = 3U;
+constexpr uint8_t CONGESTION_LEVEL_MAX = 3U;
+constexpr uint8_t FRAG_HEADER_LEN = 3U;  // inner type, index<<4 | (count-1), offset
+constexpr uint8_t FRAG_MAX_COUNT = 16U;
+
+constexpr uint8_t IDX_NET = layout::NET.offset;
+constexpr uint8_t IDX_SRC = layout::SRC.offset;
+constexpr uint8_t IDX_DST = layout::DST.offset;
+constexpr uint8_t IDX_BOOT = layout::BOOT.offset;
+constexpr uint8_t IDX_TYPE = layout::TYPE.offset;
+constexpr uint8_t IDX_SEQ_L = layout::SEQ.offset;
+constexpr uint8_t IDX_SEQ_H = layout::SEQ.offset + 1U;
+constexpr uint8_t IDX_TTL = layout::TTL.offset;
+constexpr uint8_t IDX_HOPS = layout::HOPS.offset;
+constexpr uint8_t IDX_FLAGS = layout::FLAGS.offset;
+
+// Error codes match the historical parsePingFrame() values.
+enum ParseError : uint8_t {
+  PARSE_OK = 0U,
+  PARSE_ERR_LEN = 1U,
+  PARSE_ERR_NET = 2U,
+  PARSE_ERR_CRC = 3U,
+  PARSE_ERR_TYPE = 4U,
+  PARSE_ERR_TLV = 5U,
+};
+
+struct Header {
+  uint8_t netId;
+  uint8_t src;
+  uint8_t dst;
+  uint8_t bootId;
+  uint8_t type;
+  uint16_t seq;
+  uint8_t ttl;
+  uint8_t hops;
+  uint8_t flags;
+  bool compact;  // Compact wire format; SEQ keeps 8 bits, TTL/HOPS 4 bits each.
+};
+
+// ===== CRC16 (CCITT-FALSE), byte-table driven =====
+
+struct Crc16Table {
+  uint16_t v[256];
+};
+
+constexpr Crc16Table makeCrc16Table() {
+  Crc16Table t{};
+  for (uint16_t i = 0U; i < 256U; ++i) {
+    uint16_t crc = static_cast<uint16_t>(i << 8);
+    for (uint8_t bit = 0U; bit < 8U; ++bit) {
+      crc = ((crc & 0x8000U) != 0U) ? static_cast<uint16_t>((crc << 1) ^ 0x1021U)
+                                     : static_cast<uint16_t>(crc << 1);
+    }
+    t.v[i] = crc;
+  }
+  return t;
+}
+
+inline constexpr Crc16Table CRC16_TABLE = makeCrc16Table();
+
+inline uint16_t crc16Update(uint16_t crc, const uint8_t* data, size_t len) {
+  for (size_t i = 0U; i < len; ++i) {
+    crc = static_cast<uint16_t>((crc << 8) ^ CRC16_TABLE.v[((crc >> 8) ^ data[i]) & 0xFFU]);
+  }
+  return crc;
+}
+
+inline uint16_t crc16(const uint8_t* data, size_t len) {
+  return crc16Update(0xFFFFU, data, len);
+}
+
+// ===== Little-endian helpers =====
+
+inline uint16_t readU16(const uint8_t* p) {
+  return static_cast<uint16_t>(p[0]) | static_cast<uint16_t>(static_cast<uint16_t>(p[1]) << 8);
+}
+
+inline void writeU16(uint8_t* p, uint16_t v) {
+  p[0] = static_cast<uint8_t>(v & 0xFFU);
+  p[1] = static_cast<uint8_t>((v >> 8) & 0xFFU);
+}
+
+inline uint32_t readU32(const uint8_t* p) {
+  return static_cast<uint32_t>(readU16(p)) | (static_cast<uint32_t>(readU16(&p[2])) << 16);
+}
+
+inline void writeU32(uint8_t* p, uint32_t v) {
+  writeU16(p, static_cast<uint16_t>(v & 0xFFFFU));
+  writeU16(&p[2], static_cast<uint16_t>(v >> 16));
+}
+
+// ===== Header / CRC =====
+
+inline bool isCompact(const uint8_t* buf) {
+  return (buf[0] & compact::VERSION_BIT) != 0U;
+}
+
+// Header length announced by the first byte.
+inline uint8_t headerLenOf(uint8_t first) {
+  if ((first & compact::VERSION_BIT) == 0U) {
+    return HEADER_LEN;
+  }
+  return static_cast<uint8_t>(compact::BASE_LEN + (((first & compact::HAS_DST) != 0U) ? 1U : 0U) +
+                              (((first & compact::HAS_BOOT) != 0U) ? 1U : 0U) +
+                              (((first & compact::HAS_FLAGS) != 0U) ? 1U : 0U));
+}
+
+// Header length of the frame in `buf`; 0 when `len` cannot hold it plus the CRC.
+inline uint8_t headerLen(const uint8_t* buf, size_t len) {
+  if ((buf == nullptr) || (len < MIN_FRAME_LEN)) {
+    return 0U;
+  }
+  const uint8_t n = headerLenOf(buf[0]);
+  return (len >= (static_cast<size_t>(n) + CRC_LEN)) ? n : 0U;
+}
+
+inline bool hasMinLen(const uint8_t* buf, size_t len) {
+  return headerLen(buf, len) > 0U;
+}
+
+// Bytes writeHeader() emits for `h`.
+inline uint8_t encodedHeaderLen(const Header& h) {
+  if (!h.compact) {
+    return HEADER_LEN;
+  }
+  return static_cast<uint8_t>(compact::BASE_LEN + ((h.dst != compact::DST_BROADCAST) ? 1U : 0U) +
+                              (((h.seq & 0xFFU) == 0U) ? 1U : 0U) + ((h.flags != 0U) ? 1U : 0U));
+}
+
+// Returns the header length; `out` needs room for encodedHeaderLen(h).
+// Compact TTL/HOPS saturate at 15.
+inline uint8_t writeHeader(const Header& h, uint8_t* out) {
+  if (!h.compact) {
+    out[IDX_NET] = h.netId;
+    out[IDX_SRC] = h.src;
+    out[IDX_DST] = h.dst;
+    out[IDX_BOOT] = h.bootId;
+    out[IDX_TYPE] = h.type;
+    writeU16(&out[IDX_SEQ_L], h.seq);
+    out[IDX_TTL] = h.ttl;
+    out[IDX_HOPS] = h.hops;
+    out[IDX_FLAGS] = h.flags;
+    return HEADER_LEN;
+  }
+  const bool hasDst = (h.dst != compact::DST_BROADCAST);
+  const bool hasBoot = ((h.seq & 0xFFU) == 0U);
+  const bool hasFlags = (h.flags != 0U);
+  const uint8_t ttl = (h.ttl < compact::NIBBLE_MAX) ? h.ttl : compact::NIBBLE_MAX;
+  const uint8_t hops = (h.hops < compact::NIBBLE_MAX) ? h.hops : compact::NIBBLE_MAX;
+  out[0] = static_cast<uint8_t>(compact::VERSION_BIT | (hasDst ? compact::HAS_DST : 0U) |
+                                (hasBoot ? compact::HAS_BOOT : 0U) | (hasFlags ? compact::HAS_FLAGS : 0U) |
+                                (h.netId & compact::NET_MASK));
+  out[compact::IDX_SRC] = h.src;
+  out[compact::IDX_TYPE] = h.type;
+  out[compact::IDX_SEQ] = static_cast<uint8_t>(h.seq & 0xFFU);
+  out[compact::IDX_TTL_HOPS] = static_cast<uint8_t>((ttl << 4) | hops);
+  uint8_t idx = compact::BASE_LEN;
+  if (hasDst) {
+    out[idx++] = h.dst;
+  }
+  if (hasBoot) {
+    out[idx++] = h.bootId;
+  }
+  if (hasFlags) {
+    out[idx++] = h.flags;
+  }
+  return idx;
+}
+
+// Decodes either format. Elided compact fields read as broadcast DST, BOOT 0
+// and FLAGS 0.
+inline bool readHeader(const uint8_t* buf, size_t len, Header& out) {
+  if (!hasMinLen(buf, len)) {
+    return false;
+  }
+  if (!isCompact(buf)) {
+    out.netId = buf[IDX_NET];
+    out.src = buf[IDX_SRC];
+    out.dst = buf[IDX_DST];
+    out.bootId = buf[IDX_BOOT];
+    out.type = buf[IDX_TYPE];
+    out.seq = readU16(&buf[IDX_SEQ_L]);
+    out.ttl = buf[IDX_TTL];
+    out.hops = buf[IDX_HOPS];
+    out.flags = buf[IDX_FLAGS];
+    out.compact = false;
+    return true;
+  }
+  const uint8_t first = buf[0];
+  out.netId = static_cast<uint8_t>(first & compact::NET_MASK);
+  out.src = buf[compact::IDX_SRC];
+  out.type = buf[compact::IDX_TYPE];
+  out.seq = buf[compact::IDX_SEQ];
+  out.ttl = static_cast<uint8_t>(buf[compact::IDX_TTL_HOPS] >> 4);
+  out.hops = static_cast<uint8_t>(buf[compact::IDX_TTL_HOPS] & compact::NIBBLE_MAX);
+  out.compact = true;
+  uint8_t idx = compact::BASE_LEN;
+  out.dst = ((first & compact::HAS_DST) != 0U) ? buf[idx++] : compact::DST_BROADCAST;
+  out.bootId = ((first & compact::HAS_BOOT) != 0U) ? buf[idx++] : 0U;
+  out.flags = ((first & compact::HAS_FLAGS) != 0U) ? buf[idx++] : 0U;
+  return true;
+}
+
+// Offset of the TYPE byte in a header of either format.
+inline uint8_t typeIndex(const uint8_t* buf) {
+  return isCompact(buf) ? compact::IDX_TYPE : IDX_TYPE;
+}
+
+// Stores TTL/HOPS into a header of either format.
+inline void writeTtlHops(uint8_t* buf, uint8_t ttl, uint8_t hops) {
+  if (!isCompact(buf)) {
+    buf[IDX_TTL] = ttl;
+    buf[IDX_HOPS] = hops;
+    return;
+  }
+  const uint8_t t = (ttl < compact::NIBBLE_MAX) ? ttl : compact::NIBBLE_MAX;
+  const uint8_t n = (hops < compact::NIBBLE_MAX) ? hops : compact::NIBBLE_MAX;
+  buf[compact::IDX_TTL_HOPS] = static_cast<uint8_t>((t << 4) | n);
+}
+
+inline bool crcOk(const uint8_t* buf, size_t len) {
+  if (!hasMinLen(buf, len)) {
+    return false;
+  }
+  const size_t crcIdx = len - CRC_LEN;
+  return crc16(buf, crcIdx) == readU16(&buf[crcIdx]);
+}
+
+// Appends the CRC after `bodyLen` bytes; returns the full frame length.
+inline size_t sealCrc(uint8_t* buf, size_t bodyLen) {
+  writeU16(&buf[bodyLen], crc16(buf, bodyLen));
+  return bodyLen + CRC_LEN;
+}
+
+// ===== Builders =====
+
+inline uint8_t buildPing(const Header& h, uint8_t out[PING_FRAME_LEN]) {
+  Header ping = h;
+  ping.type = PING_TYPE;
+  return static_cast<uint8_t>(sealCrc(out, writeHeader(ping, out)));
+}
+
+inline uint8_t reportLen(uint8_t freqCount, uint8_t hdrLen = HEADER_LEN) {
+  return static_cast<uint8_t>(hdrLen + TLV_HEADER_LEN + (freqCount * 2U) + TLV_HEADER_LEN +
+                              NODE_STATUS_LEN + CRC_LEN);
+}
+
+// Returns frame length, or 0 when `out` is too small.
+inline uint8_t buildReport(const Header& h,
+                           const uint16_t* freqMHz,
+                           uint8_t freqCount,
+                           uint8_t statusFlags,
+                           uint16_t lastUartAgeS,
+                           uint8_t* out,
+                           size_t outMax) {
+  if ((out == nullptr) || (freqCount > 127U) || (reportLen(freqCount, encodedHeaderLen(h)) > outMax)) {
+    return 0U;
+  }
+
+  Header report = h;
+  report.type = REPORT_TYPE;
+  uint8_t idx = writeHeader(report, out);
+  out[idx++] = TLV_FREQ_LIST;
+  out[idx++] = static_cast<uint8_t>(freqCount * 2U);
+  for (uint8_t i = 0U; i < freqCount; ++i) {
+    writeU16(&out[idx], freqMHz[i]);
+    idx = static_cast<uint8_t>(idx + 2U);
+  }
+
+  out[idx++] = TLV_NODE_STATUS;
+  out[idx++] = NODE_STATUS_LEN;
+  out[idx++] = statusFlags;
+  writeU16(&out[idx], lastUartAgeS);
+  idx = static_cast<uint8_t>(idx + 2U);
+
+  return static_cast<uint8_t>(sealCrc(out, idx));
+}
+
+// ===== Band TLVs =====
+// Value: startMHz(LE16), stepMHz, then
+//   FREQ_BITMAP: bit i (LSB first) set <=> start + i * step detected;
+//   FREQ_RLE:    run lengths alternating absent/present, starting absent.
+//                A run over 255 continues after a 0-length opposite run.
+// Encoders drop leading/trailing empty bytes (moving start) and keep
+// whichever form is shorter.
+
+inline bool bandBit(const uint8_t* bits, uint16_t i) {
+  return (bits[i >> 3] & (1U << (i & 7U))) != 0U;
+}
+
+inline constexpr uint8_t reportBandMaxLen(uint8_t extraCount, uint8_t bandBytes) {
+  return static_cast<uint8_t>(HEADER_LEN + ((extraCount > 0U) ? (TLV_HEADER_LEN + (extraCount * 2U)) : 0U) +
+                              TLV_HEADER_LEN + BAND_HEADER_LEN + bandBytes + TLV_HEADER_LEN + NODE_STATUS_LEN +
+                              CRC_LEN);
+}
+
+// Writes run lengths for bits [first, last]; 0 when more than `outMax` bytes.
+inline size_t writeBandRuns(const uint8_t* bits, uint16_t first, uint16_t last, uint8_t* out, size_t outMax) {
+  size_t n = 0U;
+  bool present = false;
+  uint16_t i = first;
+  while (i <= last) {
+    uint8_t run = 0U;
+    while ((i <= last) && (bandBit(bits, i) == present) && (run < 255U)) {
+      ++run;
+      ++i;
+    }
+    if (n >= outMax) {
+      return 0U;
+    }
+    out[n++] = run;
+    present = !present;
+  }
+  return n;
+}
+
+// Writes a complete band TLV; returns its length, 0 when it does not fit.
+inline size_t writeBandTlv(uint16_t startMHz,
+                           uint8_t stepMHz,
+                           const uint8_t* bits,
+                           uint8_t nbytes,
+                           uint8_t* out,
+                           size_t outMax) {
+  uint8_t firstByte = 0U;
+  while ((firstByte < nbytes) && (bits[firstByte] == 0U)) {
+    ++firstByte;
+  }
+  uint8_t endByte = nbytes;
+  while ((endByte > firstByte) && (bits[endByte - 1U] == 0U)) {
+    --endByte;
+  }
+  const uint8_t mapLen = static_cast<uint8_t>(endByte - firstByte);
+  if (outMax < (TLV_HEADER_LEN + BAND_HEADER_LEN)) {
+    return 0U;
+  }
+  const size_t bodyMax = outMax - TLV_HEADER_LEN - BAND_HEADER_LEN;
+
+  uint8_t* body = &out[TLV_HEADER_LEN + BAND_HEADER_LEN];
+  size_t bodyLen = 0U;
+  uint8_t type = TLV_FREQ_BITMAP;
+  if (mapLen > 0U) {
+    uint16_t lastBit = static_cast<uint16_t>((endByte * 8U) - 1U);
+    while (!bandBit(bits, lastBit)) {
+      --lastBit;
+    }
+    // RLE only has to beat the bitmap, so its budget is one byte less.
+    const size_t rleMax = ((mapLen - 1U) < bodyMax) ? (mapLen - 1U) : bodyMax;
+    bodyLen = writeBandRuns(bits, static_cast<uint16_t>(firstByte * 8U), lastBit, body, rleMax);
+    if (bodyLen > 0U) {
+      type = TLV_FREQ_RLE;
+    } else if (mapLen <= bodyMax) {
+      for (uint8_t i = 0U; i < mapLen; ++i) {
+        body[i] = bits[firstByte + i];
+      }
+      bodyLen = mapLen;
+    } else {
+      return 0U;
+    }
+  }
+
+  out[0] = type;
+  out[1] = static_cast<uint8_t>(BAND_HEADER_LEN + bodyLen);
+  writeU16(&out[TLV_HEADER_LEN], static_cast<uint16_t>(startMHz + (firstByte * 8U * stepMHz)));
+  out[TLV_HEADER_LEN + 2U] = stepMHz;
+  return TLV_HEADER_LEN + BAND_HEADER_LEN + bodyLen;
+}
+
+// REPORT for large sets: out-of-band `extra` values as FREQ_LIST (omitted
+// when empty), the band as FREQ_BITMAP or FREQ_RLE, then NODE_STATUS.
+// Returns frame length, or 0 when `out` is too small.
+inline uint8_t buildReportBand(const Header& h,
+                               const uint16_t* extraMHz,
+                               uint8_t extraCount,
+                               uint16_t bandStartMHz,
+                               uint8_t bandStepMHz,
+                               const uint8_t* bandBits,
+                               uint8_t bandBytes,
+                               uint8_t statusFlags,
+                               uint16_t lastUartAgeS,
+                               uint8_t* out,
+                               size_t outMax) {
+  const size_t fixedLen = encodedHeaderLen(h) + ((extraCount > 0U) ? (TLV_HEADER_LEN + (extraCount * 2U)) : 0U) +
+                          TLV_HEADER_LEN + NODE_STATUS_LEN + CRC_LEN;
+  if ((out == nullptr) || (extraCount > 127U) || (fixedLen > outMax)) {
+    return 0U;
+  }
+
+  Header report = h;
+  report.type = REPORT_TYPE;
+  size_t idx = writeHeader(report, out);
+  if (extraCount > 0U) {
+    out[idx++] = TLV_FREQ_LIST;
+    out[idx++] = static_cast<uint8_t>(extraCount * 2U);
+    for (uint8_t i = 0U; i < extraCount; ++i) {
+      writeU16(&out[idx], extraMHz[i]);
+      idx += 2U;
+    }
+  }
+
+  const size_t bandLen = writeBandTlv(bandStartMHz, bandStepMHz, bandBits, bandBytes, &out[idx], outMax - fixedLen);
+  if (bandLen == 0U) {
+    return 0U;
+  }
+  idx += bandLen;
+
+  out[idx++] = TLV_NODE_STATUS;
+  out[idx++] = NODE_STATUS_LEN;
+  out[idx++] = statusFlags;
+  writeU16(&out[idx], lastUartAgeS);
+  idx += 2U;
+
+  return static_cast<uint8_t>(sealCrc(out, idx));
+}
+
+// Yields the frequencies of a FREQ_BITMAP / FREQ_RLE value in ascending order.
+class BandIter {
+ public:
+  BandIter() = default;
+  BandIter(uint8_t tlvType, const uint8_t* value, uint8_t len) {
+    if ((value == nullptr) || (len < BAND_HEADER_LEN)) {
+      return;
+    }
+    mRle = (tlvType == TLV_FREQ_RLE);
+    mStart = readU16(value);
+    mStep = value[2];
+    mData = value + BAND_HEADER_LEN;
+    mLen = static_cast<uint8_t>(len - BAND_HEADER_LEN);
+  }
+
+  bool next(uint16_t& mhz) {
+    uint32_t idx = 0UL;
+    if (!nextIndex(idx)) {
+      return false;
+    }
+    const uint32_t value = mStart + (idx * mStep);
+    if (value > 0xFFFFUL) {
+      mPos = mLen;
+      mLeft = 0U;
+      return false;
+    }
+    mhz = static_cast<uint16_t>(value);
+    return true;
+  }
+
+ private:
+  bool nextIndex(uint32_t& idx) {
+    if (!mRle) {
+      while (mBit < (static_cast<uint32_t>(mLen) * 8UL)) {
+        const uint32_t i = mBit++;
+        if ((mData[i >> 3] & (1U << (i & 7U))) != 0U) {
+          idx = i;
+          return true;
+        }
+      }
+      return false;
+    }
+    while (mLeft == 0U) {
+      if (mPos >= mLen) {
+        return false;
+      }
+      const uint8_t run = mData[mPos];
+      const bool present = (mPos & 1U) != 0U;
+      ++mPos;
+      if (present) {
+        mLeft = run;
+      } else {
+        mBit += run;
+      }
+    }
+    --mLeft;
+    idx = mBit++;
+    return true;
+  }
+
+  const uint8_t* mData = nullptr;
+  uint8_t mLen = 0U;
+  bool mRle = false;
+  uint16_t mStart = 0U;
+  uint8_t mStep = 0U;
+  uint8_t mPos = 0U;
+  uint8_t mLeft = 0U;
+  uint32_t mBit = 0UL;
+};
+
+// Network PHY state carried by gateway beacons: the profile in use and the
+// one every node moves to `switchInMs` after hearing the beacon.
+struct PhySwitch {
+  uint8_t active;
+  uint8_t target;
+  uint16_t switchInMs;
+};
+
+// Cumulative REPORT acknowledgement for one source: `highestSeq` arrived,
+// and bit i of `bitmap` says whether highestSeq - 1 - i did.
+struct ReportAck {
+  uint8_t src;
+  uint16_t highestSeq;
+  uint8_t bitmap;
+};
+
+// Gateway beacon content. Receivers skip TLVs they do not know.
+struct Beacon {
+  PhySwitch phy;
+  uint8_t reportSlowdown;  // Nodes stretch report periods by 2^reportSlowdown.
+  uint32_t netTimeMs;      // Restamped by every sender right before TX.
+  bool hasPhy;
+  bool hasReportRate;
+  bool hasTime;
+  uint8_t ackCount;  // REPORT_ACK TLV only when nonzero.
+  ReportAck acks[REPORT_ACK_MAX];
+};
+
+inline constexpr uint8_t beaconLen(uint8_t hdrLen = HEADER_LEN, uint8_t ackCount = 0U) {
+  const uint8_t ackLen = (ackCount > 0U) ? static_cast<uint8_t>(TLV_HEADER_LEN + ackCount * REPORT_ACK_ENTRY_LEN) : 0U;
+  return static_cast<uint8_t>(hdrLen + TLV_HEADER_LEN + PHY_SWITCH_LEN + TLV_HEADER_LEN + REPORT_RATE_LEN +
+                              TLV_HEADER_LEN + TIME_SYNC_LEN + ackLen + CRC_LEN);
+}
+
+// Returns frame length, or 0 when `out` is too small.
+inline uint8_t buildBeacon(const Header& h, const Beacon& b, uint8_t* out, size_t outMax) {
+  if ((out == nullptr) || (b.ackCount > REPORT_ACK_MAX) || (beaconLen(encodedHeaderLen(h), b.ackCount) > outMax)) {
+    return 0U;
+  }
+  Header beacon = h;
+  beacon.type = BEACON_TYPE;
+  uint8_t idx = writeHeader(beacon, out);
+  out[idx++] = TLV_PHY_SWITCH;
+  out[idx++] = PHY_SWITCH_LEN;
+  out[idx++] = b.phy.active;
+  out[idx++] = b.phy.target;
+  writeU16(&out[idx], b.phy.switchInMs);
+  idx = static_cast<uint8_t>(idx + 2U);
+
+  out[idx++] = TLV_REPORT_RATE;
+  out[idx++] = REPORT_RATE_LEN;
+  out[idx++] = b.reportSlowdown;
+
+  out[idx++] = TLV_TIME_SYNC;
+  out[idx++] = TIME_SYNC_LEN;
+  writeU32(&out[idx], b.netTimeMs);
+  idx = static_cast<uint8_t>(idx + TIME_SYNC_LEN);
+
+  if (b.ackCount > 0U) {
+    out[idx++] = TLV_REPORT_ACK;
+    out[idx++] = static_cast<uint8_t>(b.ackCount * REPORT_ACK_ENTRY_LEN);
+    for (uint8_t i = 0U; i < b.ackCount; ++i) {
+      out[idx++] = b.acks[i].src;
+      writeU16(&out[idx], b.acks[i].highestSeq);
+      idx = static_cast<uint8_t>(idx + 2U);
+      out[idx++] = b.acks[i].bitmap;
+    }
+  }
+
+  return static_cast<uint8_t>(sealCrc(out, idx));
+}
+
+// Runtime mesh tuning carried by CONFIG frames.
+struct MeshParams {
+  uint16_t backoffMinMs;
+  uint16_t backoffMaxMs;
+  uint16_t windowMs;  // Forward rate window.
+  uint8_t maxForwardsPerWindow;
+  uint8_t dataTtl;
+  uint16_t reportStatusPeriodS;
+};
+
+// CONFIG content: a version, plus the parameters of that version unless the
+// sender has none (version 0, boot defaults).
+struct ConfigMsg {
+  uint16_t version;
+  bool hasParams;
+  MeshParams params;
+};
+
+inline constexpr uint8_t configLen(uint8_t hdrLen = HEADER_LEN, bool hasParams = true) {
+  return static_cast<uint8_t>(hdrLen + TLV_HEADER_LEN + CONFIG_VERSION_LEN +
+                              (hasParams ? (TLV_HEADER_LEN + MESH_PARAMS_LEN) : 0U) + CRC_LEN);
+}
+
+// Returns frame length, or 0 when `out` is too small.
+inline uint8_t buildConfig(const Header& h, const ConfigMsg& c, uint8_t* out, size_t outMax) {
+  if ((out == nullptr) || (configLen(encodedHeaderLen(h), c.hasParams) > outMax)) {
+    return 0U;
+  }
+  Header config = h;
+  config.type = CONFIG_TYPE;
+  uint8_t idx = writeHeader(config, out);
+  out[idx++] = TLV_CONFIG_VERSION;
+  out[idx++] = CONFIG_VERSION_LEN;
+  writeU16(&out[idx], c.version);
+  idx = static_cast<uint8_t>(idx + CONFIG_VERSION_LEN);
+  if (c.hasParams) {
+    out[idx++] = TLV_MESH_PARAMS;
+    out[idx++] = MESH_PARAMS_LEN;
+    writeU16(&out[idx], c.params.backoffMinMs);
+    writeU16(&out[idx + 2U], c.params.backoffMaxMs);
+    writeU16(&out[idx + 4U], c.params.windowMs);
+    out[idx + 6U] = c.params.maxForwardsPerWindow;
+    out[idx + 7U] = c.params.dataTtl;
+    writeU16(&out[idx + 8U], c.params.reportStatusPeriodS);
+    idx = static_cast<uint8_t>(idx + MESH_PARAMS_LEN);
+  }
+  return static_cast<uint8_t>(sealCrc(out, idx));
+}
+
+// ===== Coded frames =====
+// A CODED frame carries two relayed frames ("natives") as one: TLV_CODED
+// holds an entry per native, then both XORed, the shorter one zero-padded.
+// A neighbour that holds either native byte for byte recovers the other.
+
+inline constexpr uint8_t codedLen(uint8_t hdrLen, uint8_t lenA, uint8_t lenB) {
+  return static_cast<uint8_t>(hdrLen + TLV_HEADER_LEN + (2U * CODED_ENTRY_LEN) + ((lenA > lenB) ? lenA : lenB) +
+                              CRC_LEN);
+}
+
+// Returns frame length, or 0 when a native has no header or `out` is too
+// small.
+inline uint8_t buildCoded(const Header& h,
+                          const uint8_t* a,
+                          uint8_t lenA,
+                          const uint8_t* b,
+                          uint8_t lenB,
+                          uint8_t* out,
+                          size_t outMax) {
+  Header ha{};
+  Header hb{};
+  const uint8_t xorLen = (lenA > lenB) ? lenA : lenB;
+  if ((out == nullptr) || !readHeader(a, lenA, ha) || !readHeader(b, lenB, hb) ||
+      (codedLen(encodedHeaderLen(h), lenA, lenB) > outMax) ||
+      ((static_cast<size_t>(2U * CODED_ENTRY_LEN) + xorLen) > 0xFFU)) {
+    return 0U;
+  }
+  Header coded = h;
+  coded.type = CODED_TYPE;
+  uint8_t idx = writeHeader(coded, out);
+  out[idx++] = TLV_CODED;
+  out[idx++] = static_cast<uint8_t>((2U * CODED_ENTRY_LEN) + xorLen);
+  out[idx++] = ha.src;
+  out[idx++] = static_cast<uint8_t>(ha.seq & 0xFFU);
+  out[idx++] = lenA;
+  out[idx++] = hb.src;
+  out[idx++] = static_cast<uint8_t>(hb.seq & 0xFFU);
+  out[idx++] = lenB;
+  for (uint8_t i = 0U; i < xorLen; ++i) {
+    out[idx++] = static_cast<uint8_t>(((i < lenA) ? a[i] : 0U) ^ ((i < lenB) ? b[i] : 0U));
+  }
+  return static_cast<uint8_t>(sealCrc(out, idx));
+}
+
+// ===== TLV iteration =====
+
+struct Tlv {
+  uint8_t type;
+  uint8_t len;
+  const uint8_t* value;
+};
+
+// Walks the TLV area between header and CRC; never reads past `len`.
+class TlvReader {
+ public:
+  TlvReader(const uint8_t* payload, size_t len) : mPos(payload), mEnd(payload + len) {}
+
+  bool next(Tlv& out) {
+    if (mPos == mEnd) {
+      return false;
+    }
+    if ((mEnd - mPos) < static_cast<ptrdiff_t>(TLV_HEADER_LEN)) {
+      mMalformed = true;
+      mPos = mEnd;
+      return false;
+    }
+    const uint8_t valueLen = mPos[1];
+    if ((mEnd - mPos - TLV_HEADER_LEN) < static_cast<ptrdiff_t>(valueLen)) {
+      mMalformed = true;
+      mPos = mEnd;
+      return false;
+    }
+    out.type = mPos[0];
+    out.len = valueLen;
+    out.value = mPos + TLV_HEADER_LEN;
+    mPos += TLV_HEADER_LEN + valueLen;
+    return true;
+  }
+
+  bool malformed() const {
+    return mMalformed;
+  }
+
+ private:
+  const uint8_t* mPos;
+  const uint8_t* mEnd;
+  bool mMalformed = false;
+};
+
+// ===== FrameView =====
+
+// Validated-once view over a frame buffer (no copy).
+// init() checks the structure and decodes the header (either format) a
+// single time; all accessors afterwards are plain inlined loads. CRC is
+// verified separately so callers can reject on cheap header fields before
+// paying for it.
+class FrameView {
+ public:
+  FrameView() = default;
+
+  bool init(const uint8_t* buf, size_t len) {
+    if ((len > 255U) || !readHeader(buf, len, mHdr)) {
+      mBuf = nullptr;
+      mLen = 0U;
+      mHdrLen = 0U;
+      mAuthLen = 0U;
+      return false;
+    }
+    mBuf = buf;
+    mLen = static_cast<uint8_t>(len);
+    mHdrLen = headerLenOf(buf[0]);
+    // The auth TLV sits right before the CRC; the payload stops short of it.
+    const uint8_t bodyEnd = static_cast<uint8_t>(mLen - CRC_LEN);
+    mAuthLen = (((mHdr.flags & FLAG_AUTH) != 0U) && ((bodyEnd - mHdrLen) >= AUTH_TLV_LEN) &&
+                (buf[bodyEnd - AUTH_TLV_LEN] == TLV_AUTH) && (buf[bodyEnd - AUTH_TAG_LEN - 1U] == AUTH_TAG_LEN))
+                   ? AUTH_TLV_LEN
+                   : 0U;
+    return true;
+  }
+
+  // init() + CRC; the common path for code that does not stage its checks.
+  bool parse(const uint8_t* buf, size_t len) {
+    return init(buf, len) && crcOk();
+  }
+
+  bool valid() const {
+    return mBuf != nullptr;
+  }
+
+  bool crcOk() const {
+    return codec::crcOk(mBuf, mLen);
+  }
+
+  const uint8_t* data() const {
+    return mBuf;
+  }
+  uint8_t len() const {
+    return mLen;
+  }
+
+  const Header& header() const {
+    return mHdr;
+  }
+  uint8_t headerLen() const {
+    return mHdrLen;
+  }
+  bool compact() const {
+    return mHdr.compact;
+  }
+  uint8_t netId() const {
+    return mHdr.netId;
+  }
+  uint8_t src() const {
+    return mHdr.src;
+  }
+  uint8_t dst() const {
+    return mHdr.dst;
+  }
+  uint8_t bootId() const {
+    return mHdr.bootId;
+  }
+  uint8_t type() const {
+    return mHdr.type;
+  }
+  uint16_t seq() const {
+    return mHdr.seq;
+  }
+  // Bits of SEQ on air; serial comparisons of seqs must wrap at this width.
+  uint8_t seqBits() const {
+    return mHdr.compact ? 8U : 16U;
+  }
+  uint8_t ttl() const {
+    return mHdr.ttl;
+  }
+  uint8_t hops() const {
+    return mHdr.hops;
+  }
+  uint8_t flags() const {
+    return mHdr.flags;
+  }
+  bool noRelay() const {
+    return (flags() & FLAG_NO_RELAY) != 0U;
+  }
+  // Auth tag bytes, or nullptr when the frame carries none.
+  const uint8_t* authTag() const {
+    return (mAuthLen != 0U) ? &mBuf[mLen - CRC_LEN - AUTH_TAG_LEN] : nullptr;
+  }
+
+  // TLV area between header and auth tag (or CRC).
+  const uint8_t* payload() const {
+    return &mBuf[mHdrLen];
+  }
+  uint8_t payloadLen() const {
+    return static_cast<uint8_t>(mLen - mHdrLen - mAuthLen - CRC_LEN);
+  }
+  TlvReader tlvs() const {
+    return TlvReader(payload(), payloadLen());
+  }
+
+  // First TLV of `type`; false when absent or the TLV area is malformed.
+  bool findTlv(uint8_t tlvType, Tlv& out) const {
+    TlvReader reader = tlvs();
+    while (reader.next(out)) {
+      if (out.type == tlvType) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  const uint8_t* mBuf = nullptr;
+  uint8_t mLen = 0U;
+  uint8_t mHdrLen = 0U;
+  uint8_t mAuthLen = 0U;
+  Header mHdr{};
+};
+
+// Relay rewrite on an already-validated copy: TTL-1, HOPS+1, reseal CRC.
+// Either header format; compact HOPS saturates at 15.
+inline bool relayRewrite(uint8_t* buf, size_t len) {
+  Header h{};
+  if (!readHeader(buf, len, h) || (h.ttl == 0U)) {
+    return false;
+  }
+  writeTtlHops(buf, static_cast<uint8_t>(h.ttl - 1U), static_cast<uint8_t>(h.hops + 1U));
+  (void)sealCrc(buf, len - CRC_LEN);
+  return true;
+}
+
+// ===== Congestion =====
+// FLAGS bits 3-4 carry the congestion level of whoever sent the frame last;
+// each relay overwrites them with its own at TX time.
+
+inline uint8_t congestionLevel(uint8_t flags) {
+  return static_cast<uint8_t>((flags & FLAG_CONGESTION_MASK) >> FLAG_CONGESTION_SHIFT);
+}
+
+// Sets the congestion level of a sealed frame and reseals the CRC (not the
+// auth tag). A compact header without a FLAGS byte gains one for a non-zero
+// level when `outMax` leaves room. Returns the new length; 0 when the frame
+// is invalid or has no room.
+inline size_t congestionStamp(uint8_t* buf, size_t len, size_t outMax, uint8_t level) {
+  Header h{};
+  if (!readHeader(buf, len, h)) {
+    return 0U;
+  }
+  level = (level < CONGESTION_LEVEL_MAX) ? level : CONGESTION_LEVEL_MAX;
+  const uint8_t flags =
+      static_cast<uint8_t>((h.flags & ~FLAG_CONGESTION_MASK) | (level << FLAG_CONGESTION_SHIFT));
+  if (flags == h.flags) {
+    return len;
+  }
+  const uint8_t hdrLen = headerLenOf(buf[0]);
+  if (!isCompact(buf)) {
+    buf[IDX_FLAGS] = flags;
+  } else if ((buf[0] & compact::HAS_FLAGS) != 0U) {
+    buf[hdrLen - 1U] = flags;  // FLAGS is the last compact header byte.
+  } else {
+    if ((len + 1U) > outMax) {
+      return 0U;
+    }
+    for (size_t i = len; i > hdrLen; --i) {
+      buf[i] = buf[i - 1U];
+    }
+    buf[0] = static_cast<uint8_t>(buf[0] | compact::HAS_FLAGS);
+    buf[hdrLen] = flags;
+    ++len;
+  }
+  return sealCrc(buf, len - CRC_LEN);
+}
+
+// ===== Authentication =====
+// Frames with FLAG_AUTH end with a TLV_AUTH carrying the low AUTH_TAG_LEN
+// bytes (LE) of SipHash-2-4 under the network key over the immutable header
+// fields (NET, SRC, DST, BOOT, TYPE, SEQ LE16, FLAGS, as decoded, so both
+// header formats sign alike) and the payload before the tag. TTL and HOPS
+// are left out: relays forward tagged frames without the key.
+
+inline uint32_t authTagOf(const uint8_t key[AUTH_KEY_LEN], const Header& h, const uint8_t* payload, size_t len) {
+  const uint8_t fields[8] = {h.netId,
+                             h.src,
+                             h.dst,
+                             h.bootId,
+                             h.type,
+                             static_cast<uint8_t>(h.seq & 0xFFU),
+                             static_cast<uint8_t>(h.seq >> 8),
+                             h.flags};
+  SipHash24 mac(key);
+  mac.update(fields, sizeof(fields));
+  mac.update(payload, len);
+  return static_cast<uint32_t>(mac.final());
+}
+
+// Checks the tag of a frame whose structure was validated by init(); false
+// when FLAG_AUTH or the tag is missing. Compare cost is constant.
+inline bool authOk(const uint8_t key[AUTH_KEY_LEN], const FrameView& view) {
+  const uint8_t* tag = view.authTag();
+  if (tag == nullptr) {
+    return false;
+  }
+  uint8_t expect[4];
+  writeU32(expect, authTagOf(key, view.header(), view.payload(), view.payloadLen()));
+  uint8_t diff = 0U;
+  for (uint8_t i = 0U; i < AUTH_TAG_LEN; ++i) {
+    diff = static_cast<uint8_t>(diff | (expect[i] ^ tag[i]));
+  }
+  return diff == 0U;
+}
+
+// Appends the auth TLV to a sealed frame whose header has FLAG_AUTH and
+// reseals; returns the new length, 0 when it does not fit `outMax`.
+inline uint8_t authAppend(const uint8_t key[AUTH_KEY_LEN], uint8_t* buf, size_t len, size_t outMax) {
+  Header h{};
+  if (!readHeader(buf, len, h) || ((h.flags & FLAG_AUTH) == 0U) || ((len + AUTH_TLV_LEN) > outMax) ||
+      ((len + AUTH_TLV_LEN) > 255U)) {
+    return 0U;
+  }
+  const uint8_t hdrLen = headerLenOf(buf[0]);
+  const size_t bodyLen = len - CRC_LEN;
+  buf[bodyLen] = TLV_AUTH;
+  buf[bodyLen + 1U] = AUTH_TAG_LEN;
+  writeU32(&buf[bodyLen + TLV_HEADER_LEN], authTagOf(key, h, &buf[hdrLen], bodyLen - hdrLen));
+  return static_cast<uint8_t>(sealCrc(buf, bodyLen + AUTH_TLV_LEN));
+}
+
+// Recomputes the tag in place after a payload rewrite (beacon restamp).
+inline bool authReseal(const uint8_t key[AUTH_KEY_LEN], uint8_t* buf, size_t len) {
+  FrameView view;
+  if (!view.init(buf, len) || (view.authTag() == nullptr)) {
+    return false;
+  }
+  const size_t tagIdx = len - CRC_LEN - AUTH_TAG_LEN;
+  writeU32(&buf[tagIdx], authTagOf(key, view.header(), view.payload(), view.payloadLen()));
+  (void)sealCrc(buf, len - CRC_LEN);
+  return true;
+}
+
+// ===== Trace =====
+// Frames with FLAG_TRACE carry one fixed-size TLV_TRACE (before any auth
+// tag) that the origin and every relay update in place at TX time, so the
+// frame never grows in flight. Untraced frames cost relays one flag test.
+// FRAG pieces are not updated.
+
+struct Trace {
+  uint16_t originQueueMs;  // Origin: queued until on air.
+  uint16_t relayQueueMs;   // Sum over relays: received until forwarded.
+  uint16_t maxHopMs;       // Longest single relay delay...
+  uint8_t maxHopRelay;     // ...and the relay it happened at.
+  uint8_t lastRelay;       // 0xFF until relayed.
+  uint16_t relayBits;      // Bit (id % 16) for every relay passed.
+};
+
+inline uint16_t traceSat16(uint32_t v) {
+  return (v > 0xFFFFUL) ? 0xFFFFU : static_cast<uint16_t>(v);
+}
+
+inline void writeTrace(uint8_t* p, const Trace& t) {
+  writeU16(&p[0], t.originQueueMs);
+  writeU16(&p[2], t.relayQueueMs);
+  writeU16(&p[4], t.maxHopMs);
+  p[6] = t.maxHopRelay;
+  p[7] = t.lastRelay;
+  writeU16(&p[8], t.relayBits);
+}
+
+inline bool readTrace(const FrameView& view, Trace& out) {
+  Tlv tlv{};
+  if (((view.flags() & FLAG_TRACE) == 0U) || !view.findTlv(TLV_TRACE, tlv) || (tlv.len < TRACE_LEN)) {
+    return false;
+  }
+  out.originQueueMs = readU16(&tlv.value[0]);
+  out.relayQueueMs = readU16(&tlv.value[2]);
+  out.maxHopMs = readU16(&tlv.value[4]);
+  out.maxHopRelay = tlv.value[6];
+  out.lastRelay = tlv.value[7];
+  out.relayBits = readU16(&tlv.value[8]);
+  return true;
+}
+
+// Appends an empty trace TLV to a sealed frame whose header has FLAG_TRACE
+// and reseals; call before authAppend(). Returns the new length, 0 when it
+// does not fit `outMax`.
+inline uint8_t traceAppend(uint8_t* buf, size_t len, size_t outMax) {
+  Header h{};
+  if (!readHeader(buf, len, h) || ((h.flags & FLAG_TRACE) == 0U) || ((len + TRACE_TLV_LEN) > outMax) ||
+      ((len + TRACE_TLV_LEN) > 255U)) {
+    return 0U;
+  }
+  const size_t bodyLen = len - CRC_LEN;
+  buf[bodyLen] = TLV_TRACE;
+  buf[bodyLen + 1U] = TRACE_LEN;
+  Trace empty{};
+  empty.lastRelay = 0xFFU;
+  empty.maxHopRelay = 0xFFU;
+  writeTrace(&buf[bodyLen + TLV_HEADER_LEN], empty);
+  return static_cast<uint8_t>(sealCrc(buf, bodyLen + TRACE_TLV_LEN));
+}
+
+// Folds one send into the trace of a validated frame and reseals the CRC
+// (the caller re-signs when tagged): the origin's queue time when
+// `relayId` is 0xFF, else one relay's delay. False when there is no trace.
+inline bool traceStamp(uint8_t* buf, size_t len, uint8_t relayId, uint32_t delayMs) {
+  FrameView view;
+  Trace t{};
+  Tlv tlv{};
+  if (!view.init(buf, len) || (view.type() == FRAG_TYPE) || !readTrace(view, t) ||
+      !view.findTlv(TLV_TRACE, tlv)) {
+    return false;
+  }
+  const uint16_t delay = traceSat16(delayMs);
+  if (relayId == 0xFFU) {
+    t.originQueueMs = delay;
+  } else {
+    t.relayQueueMs = traceSat16(static_cast<uint32_t>(t.relayQueueMs) + delay);
+    if ((t.maxHopRelay == 0xFFU) || (delay > t.maxHopMs)) {
+      t.maxHopMs = delay;
+      t.maxHopRelay = relayId;
+    }
+    t.lastRelay = relayId;
+    t.relayBits = static_cast<uint16_t>(t.relayBits | (1U << (relayId % 16U)));
+  }
+  writeTrace(&buf[tlv.value - buf], t);
+  (void)sealCrc(buf, len - CRC_LEN);
+  return true;
+}
+
+// ===== Neighbour links =====
+// REPORTs may carry one TLV_NEIGHBOURS (before any trace or auth TLV) with
+// the links the sender hears directly, freshest first.
+
+struct Link {
+  uint8_t id;
+  int8_t rssiDbm;
+  int8_t snrDb;
+  uint8_t prrPct;
+};
+
+// Appends up to NEIGHBOURS_MAX links to a sealed frame and reseals; call
+// before traceAppend() and authAppend(). Returns the new length, `len` when
+// there are none, 0 when they do not fit `outMax`.
+inline uint8_t neighboursAppend(uint8_t* buf, size_t len, size_t outMax, const Link* links, uint8_t count) {
+  count = (count < NEIGHBOURS_MAX) ? count : NEIGHBOURS_MAX;
+  if (count == 0U) {
+    return static_cast<uint8_t>(len);
+  }
+  const size_t tlvLen = TLV_HEADER_LEN + (static_cast<size_t>(count) * NEIGHBOUR_ENTRY_LEN);
+  if (!hasMinLen(buf, len) || ((len + tlvLen) > outMax) || ((len + tlvLen) > 255U)) {
+    return 0U;
+  }
+  size_t idx = len - CRC_LEN;
+  buf[idx++] = TLV_NEIGHBOURS;
+  buf[idx++] = static_cast<uint8_t>(count * NEIGHBOUR_ENTRY_LEN);
+  for (uint8_t i = 0U; i < count; ++i) {
+    buf[idx++] = links[i].id;
+    buf[idx++] = static_cast<uint8_t>(links[i].rssiDbm);
+    buf[idx++] = static_cast<uint8_t>(links[i].snrDb);
+    buf[idx++] = links[i].prrPct;
+  }
+  return static_cast<uint8_t>(sealCrc(buf, idx));
+}
+
+// Number of links copied to `out` (at most `outMax`); 0 without the TLV.
+inline uint8_t readNeighbours(const FrameView& view, Link* out, uint8_t outMax) {
+  Tlv tlv{};
+  if (!view.findTlv(TLV_NEIGHBOURS, tlv)) {
+    return 0U;
+  }
+  uint8_t n = 0U;
+  for (uint8_t off = 0U; ((off + NEIGHBOUR_ENTRY_LEN) <= tlv.len) && (n < outMax); off += NEIGHBOUR_ENTRY_LEN) {
+    out[n].id = tlv.value[off];
+    out[n].rssiDbm = static_cast<int8_t>(tlv.value[off + 1U]);
+    out[n].snrDb = static_cast<int8_t>(tlv.value[off + 2U]);
+    out[n].prrPct = tlv.value[off + 3U];
+    ++n;
+  }
+  return n;
+}
+
+// ===== Parsers =====
+
+inline bool parsePing(const uint8_t* buf, size_t len, uint8_t expectedNetId, Header& out, uint8_t& errCode) {
+  const uint8_t hdrLen = headerLen(buf, len);
+  if ((hdrLen == 0U) || (len != (static_cast<size_t>(hdrLen) + CRC_LEN))) {
+    errCode = PARSE_ERR_LEN;
+    return false;
+  }
+  (void)readHeader(buf, len, out);
+  if (out.netId != expectedNetId) {
+    errCode = PARSE_ERR_NET;
+    return false;
+  }
+  if (out.type != PING_TYPE) {
+    errCode = PARSE_ERR_TYPE;
+    return false;
+  }
+  if (!crcOk(buf, len)) {
+    errCode = PARSE_ERR_CRC;
+    return false;
+  }
+  errCode = PARSE_OK;
+  return true;
+}
+
+// Zero-copy REPORT view: frequency values are read straight from the frame.
+struct Report {
+  Header header;
+  const uint8_t* freqBytes;
+  uint8_t freqCount;
+  bool hasStatus;
+  uint8_t statusFlags;
+  uint16_t lastUartAgeS;
+  uint8_t bandType;  // TLV_FREQ_BITMAP / TLV_FREQ_RLE, 0 when absent.
+  const uint8_t* band;
+  uint8_t bandLen;
+
+  uint16_t freqAt(uint8_t i) const {
+    return readU16(&freqBytes[i * 2U]);
+  }
+  BandIter bandFreqs() const {
+    return (bandType != 0U) ? BandIter(bandType, band, bandLen) : BandIter();
+  }
+};
+
+// TLV decode of a REPORT whose header and CRC were already validated.
+inline bool parseReportView(const FrameView& view, Report& out, uint8_t& errCode) {
+  out.header = view.header();
+  out.freqBytes = nullptr;
+  out.freqCount = 0U;
+  out.hasStatus = false;
+  out.statusFlags = 0U;
+  out.lastUartAgeS = 0xFFFFU;
+  out.bandType = 0U;
+  out.band = nullptr;
+  out.bandLen = 0U;
+
+  // Unknown TLV types are skipped so newer senders stay decodable.
+  TlvReader tlvs = view.tlvs();
+  Tlv tlv{};
+  while (tlvs.next(tlv)) {
+    if ((tlv.type == TLV_FREQ_LIST) && ((tlv.len & 1U) == 0U)) {
+      out.freqBytes = tlv.value;
+      out.freqCount = static_cast<uint8_t>(tlv.len / 2U);
+    } else if ((tlv.type == TLV_NODE_STATUS) && (tlv.len >= NODE_STATUS_LEN)) {
+      out.hasStatus = true;
+      out.statusFlags = tlv.value[0];
+      out.lastUartAgeS = readU16(&tlv.value[1]);
+    } else if (((tlv.type == TLV_FREQ_BITMAP) || (tlv.type == TLV_FREQ_RLE)) && (tlv.len >= BAND_HEADER_LEN)) {
+      out.bandType = tlv.type;
+      out.band = tlv.value;
+      out.bandLen = tlv.len;
+    }
+  }
+  if (tlvs.malformed()) {
+    errCode = PARSE_ERR_TLV;
+    return false;
+  }
+
+  errCode = PARSE_OK;
+  return true;
+}
+
+// TLV decode of a BEACON whose header and CRC were already validated.
+inline bool parseBeaconView(const FrameView& view, Beacon& out) {
+  out = Beacon{};
+  if (view.type() != BEACON_TYPE) {
+    return false;
+  }
+  TlvReader tlvs = view.tlvs();
+  Tlv tlv{};
+  while (tlvs.next(tlv)) {
+    if ((tlv.type == TLV_PHY_SWITCH) && (tlv.len >= PHY_SWITCH_LEN)) {
+      out.hasPhy = true;
+      out.phy.active = tlv.value[0];
+      out.phy.target = tlv.value[1];
+      out.phy.switchInMs = readU16(&tlv.value[2]);
+    } else if ((tlv.type == TLV_REPORT_RATE) && (tlv.len >= REPORT_RATE_LEN)) {
+      out.hasReportRate = true;
+      out.reportSlowdown = tlv.value[0];
+    } else if ((tlv.type == TLV_TIME_SYNC) && (tlv.len >= TIME_SYNC_LEN)) {
+      out.hasTime = true;
+      out.netTimeMs = readU32(tlv.value);
+    } else if (tlv.type == TLV_REPORT_ACK) {
+      // Entries past REPORT_ACK_MAX are ignored, not an error.
+      const uint8_t* entry = tlv.value;
+      for (uint8_t left = tlv.len; (left >= REPORT_ACK_ENTRY_LEN) && (out.ackCount < REPORT_ACK_MAX);
+           left = static_cast<uint8_t>(left - REPORT_ACK_ENTRY_LEN), entry += REPORT_ACK_ENTRY_LEN) {
+        ReportAck& ack = out.acks[out.ackCount++];
+        ack.src = entry[0];
+        ack.highestSeq = readU16(&entry[1]);
+        ack.bitmap = entry[3];
+      }
+    }
+  }
+  return !tlvs.malformed();
+}
+
+// The beacon's acknowledgement entry for `src`, or nullptr.
+inline const ReportAck* findReportAck(const Beacon& b, uint8_t src) {
+  for (uint8_t i = 0U; i < b.ackCount; ++i) {
+    if (b.acks[i].src == src) {
+      return &b.acks[i];
+    }
+  }
+  return nullptr;
+}
+
+// TLV decode of a CONFIG whose header and CRC were already validated; the
+// version is mandatory.
+inline bool parseConfigView(const FrameView& view, ConfigMsg& out) {
+  out = ConfigMsg{};
+  if (view.type() != CONFIG_TYPE) {
+    return false;
+  }
+  bool hasVersion = false;
+  TlvReader tlvs = view.tlvs();
+  Tlv tlv{};
+  while (tlvs.next(tlv)) {
+    if ((tlv.type == TLV_CONFIG_VERSION) && (tlv.len >= CONFIG_VERSION_LEN)) {
+      hasVersion = true;
+      out.version = readU16(tlv.value);
+    } else if ((tlv.type == TLV_MESH_PARAMS) && (tlv.len >= MESH_PARAMS_LEN)) {
+      out.hasParams = true;
+      out.params.backoffMinMs = readU16(&tlv.value[0]);
+      out.params.backoffMaxMs = readU16(&tlv.value[2]);
+      out.params.windowMs = readU16(&tlv.value[4]);
+      out.params.maxForwardsPerWindow = tlv.value[6];
+      out.params.dataTtl = tlv.value[7];
+      out.params.reportStatusPeriodS = readU16(&tlv.value[8]);
+    }
+  }
+  return hasVersion && !tlvs.malformed();
+}
+
+struct Coded {
+  uint8_t src[2];
+  uint8_t seqLow[2];
+  uint8_t len[2];
+  const uint8_t* xorBytes;  // Points into the frame; max(len) bytes.
+};
+
+// TLV decode of a CODED frame whose header and CRC were already validated.
+inline bool parseCodedView(const FrameView& view, Coded& out) {
+  out = Coded{};
+  Tlv tlv{};
+  if ((view.type() != CODED_TYPE) || !view.findTlv(TLV_CODED, tlv) || (tlv.len < (2U * CODED_ENTRY_LEN))) {
+    return false;
+  }
+  for (uint8_t i = 0U; i < 2U; ++i) {
+    out.src[i] = tlv.value[i * CODED_ENTRY_LEN];
+    out.seqLow[i] = tlv.value[(i * CODED_ENTRY_LEN) + 1U];
+    out.len[i] = tlv.value[(i * CODED_ENTRY_LEN) + 2U];
+  }
+  out.xorBytes = &tlv.value[2U * CODED_ENTRY_LEN];
+  const uint8_t xorLen = (out.len[0] > out.len[1]) ? out.len[0] : out.len[1];
+  return tlv.len == ((2U * CODED_ENTRY_LEN) + xorLen);
+}
+
+// Recovers the native of `c` that is not `known` into `out`. Returns its
+// length; 0 when `known` is not one of the pair (same src, seq low byte and
+// length) or the result fails its CRC.
+inline uint8_t decodeCoded(const Coded& c, const uint8_t* known, uint8_t knownLen, uint8_t* out, size_t outMax) {
+  Header h{};
+  if (!readHeader(known, knownLen, h)) {
+    return 0U;
+  }
+  uint8_t other = 2U;
+  for (uint8_t i = 0U; i < 2U; ++i) {
+    if ((c.src[i] == h.src) && (c.seqLow[i] == static_cast<uint8_t>(h.seq & 0xFFU)) && (c.len[i] == knownLen)) {
+      other = static_cast<uint8_t>(1U - i);
+    }
+  }
+  if ((other > 1U) || (c.len[other] > outMax)) {
+    return 0U;
+  }
+  const uint8_t len = c.len[other];
+  for (uint8_t i = 0U; i < len; ++i) {
+    out[i] = static_cast<uint8_t>(c.xorBytes[i] ^ ((i < knownLen) ? known[i] : 0U));
+  }
+  FrameView view;
+  return (view.init(out, len) && view.crcOk()) ? len : 0U;
+}
+
+// Rewrites the TIME_SYNC value of a validated BEACON in place and reseals
+// the CRC; false when the frame carries no time.
+inline bool stampBeaconTime(uint8_t* buf, size_t len, uint32_t netTimeMs) {
+  FrameView view;
+  Tlv tlv{};
+  if (!view.init(buf, len) || (view.type() != BEACON_TYPE) || !view.findTlv(TLV_TIME_SYNC, tlv) ||
+      (tlv.len < TIME_SYNC_LEN)) {
+    return false;
+  }
+  writeU32(&buf[tlv.value - buf], netTimeMs);
+  (void)sealCrc(buf, len - CRC_LEN);
+  return true;
+}
+
+// Rewrites the switchInMs of a validated BEACON's PHY_SWITCH in place and
+// reseals the CRC; false when the beacon announces no switch.
+inline bool stampBeaconSwitch(uint8_t* buf, size_t len, uint16_t switchInMs) {
+  FrameView view;
+  Tlv tlv{};
+  if (!view.init(buf, len) || (view.type() != BEACON_TYPE) || !view.findTlv(TLV_PHY_SWITCH, tlv) ||
+      (tlv.len < PHY_SWITCH_LEN) || (tlv.value[0] == tlv.value[1])) {
+    return false;
+  }
+  writeU16(&buf[(tlv.value - buf) + 2], switchInMs);
+  (void)sealCrc(buf, len - CRC_LEN);
+  return true;
+}
+
+// ===== Fragmentation =====
+// A frame too long for the radio is sent as FRAG frames. Each carries the
+// original header (either format) with type FRAG_TYPE (SEQ stays the message
+// id), then FRAG_HEADER_LEN bytes and a slice of the original payload
+// (between header and CRC). Receivers key fragments on (src, boot, seq) and
+// rebuild the original frame with a fresh CRC.
+
+// Payload bytes per fragment so every piece fits a `frameMax`-byte frame.
+inline constexpr uint8_t fragmentChunk(size_t frameMax, uint8_t hdrLen = HEADER_LEN) {
+  return (frameMax > (static_cast<size_t>(hdrLen) + FRAG_HEADER_LEN + CRC_LEN))
+             ? static_cast<uint8_t>(frameMax - hdrLen - FRAG_HEADER_LEN - CRC_LEN)
+             : 0U;
+}
+
+// Pieces needed for a `frameLen`-byte frame; 0 when more than FRAG_MAX_COUNT.
+inline constexpr uint8_t fragmentCount(size_t frameLen, uint8_t chunk, uint8_t hdrLen = HEADER_LEN) {
+  if ((frameLen < (static_cast<size_t>(hdrLen) + CRC_LEN)) || (chunk == 0U)) {
+    return 0U;
+  }
+  const size_t payloadLen = frameLen - hdrLen - CRC_LEN;
+  const size_t count = (payloadLen + chunk - 1U) / chunk;
+  return (count == 0U) ? 1U : static_cast<uint8_t>((count > FRAG_MAX_COUNT) ? 0U : count);
+}
+
+// Pieces a complete frame needs when sent as `frameMax`-byte fragments.
+inline uint8_t fragmentsFor(const uint8_t* frame, size_t frameLen, size_t frameMax) {
+  const uint8_t hdrLen = headerLen(frame, frameLen);
+  return (hdrLen == 0U) ? 0U : fragmentCount(frameLen, fragmentChunk(frameMax, hdrLen), hdrLen);
+}
+
+// Writes fragment `idx` of a complete frame split into pieces of at most
+// `frameMax` bytes; returns its length, 0 on a bad index or when `out` is
+// too small.
+inline uint8_t buildFragment(const uint8_t* frame, size_t frameLen, size_t frameMax, uint8_t idx, uint8_t* out,
+                             size_t outMax) {
+  const uint8_t hdrLen = headerLen(frame, frameLen);
+  const uint8_t chunk = fragmentChunk(frameMax, hdrLen);
+  const uint8_t count = fragmentsFor(frame, frameLen, frameMax);
+  if ((out == nullptr) || (idx >= count) || (frameLen > 255U)) {
+    return 0U;
+  }
+  const size_t payloadLen = frameLen - hdrLen - CRC_LEN;
+  const size_t offset = static_cast<size_t>(idx) * chunk;
+  const size_t sliceLen = ((payloadLen - offset) < chunk) ? (payloadLen - offset) : chunk;
+  if ((hdrLen + FRAG_HEADER_LEN + sliceLen + CRC_LEN) > outMax) {
+    return 0U;
+  }
+  for (uint8_t i = 0U; i < hdrLen; ++i) {
+    out[i] = frame[i];
+  }
+  const uint8_t typeIdx = typeIndex(frame);
+  out[typeIdx] = FRAG_TYPE;
+  out[hdrLen] = frame[typeIdx];
+  out[hdrLen + 1U] = static_cast<uint8_t>((idx << 4) | (count - 1U));
+  out[hdrLen + 2U] = static_cast<uint8_t>(offset);
+  for (size_t i = 0U; i < sliceLen; ++i) {
+    out[hdrLen + FRAG_HEADER_LEN + i] = frame[hdrLen + offset + i];
+  }
+  return static_cast<uint8_t>(sealCrc(out, hdrLen + FRAG_HEADER_LEN + sliceLen));
+}
+
+struct Fragment {
+  uint8_t innerType;
+  uint8_t idx;
+  uint8_t count;
+  uint8_t offset;
+  const uint8_t* data;
+  uint8_t len;
+};
+
+// Fragment header of a FRAG frame whose header and CRC were already validated.
+inline bool parseFragmentView(const FrameView& view, Fragment& out) {
+  if ((view.type() != FRAG_TYPE) || (view.payloadLen() < FRAG_HEADER_LEN)) {
+    return false;
+  }
+  const uint8_t* p = view.payload();
+  out.innerType = p[0];
+  out.idx = static_cast<uint8_t>(p[1] >> 4);
+  out.count = static_cast<uint8_t>((p[1] & 0x0FU) + 1U);
+  out.offset = p[2];
+  out.data = &p[FRAG_HEADER_LEN];
+  out.len = static_cast<uint8_t>(view.payloadLen() - FRAG_HEADER_LEN);
+  return (out.idx < out.count) && (out.innerType != FRAG_TYPE);
+}
+
+// Fixed-size reassembly table: SLOTS messages of up to MAX_PAYLOAD bytes in
+// flight. A new message takes a free slot or evicts the oldest, and slots
+// time out, so memory stays bounded whatever is lost.
+template <uint8_t SLOTS, uint8_t MAX_PAYLOAD>
+class Reassembler {
+ public:
+  static constexpr size_t FRAME_MAX = HEADER_LEN + MAX_PAYLOAD + CRC_LEN;
+  static_assert(FRAME_MAX <= 255U, "reassembled frame must fit a u8 length");
+
+  // Feeds one validated FRAG frame. Returns the rebuilt frame length in `out`
+  // once the last missing fragment arrives, 0 otherwise.
+  uint8_t accept(const FrameView& view, uint32_t nowMs, uint8_t* out, size_t outMax) {
+    Fragment f{};
+    if (!parseFragmentView(view, f) || ((static_cast<size_t>(f.offset) + f.len) > MAX_PAYLOAD)) {
+      ++mRejected;
+      return 0U;
+    }
+    Slot* slot = find(view.src(), view.bootId(), view.seq());
+    if (slot == nullptr) {
+      slot = claim(nowMs);
+      slot->used = true;
+      slot->src = view.src();
+      slot->bootId = view.bootId();
+      slot->msgId = view.seq();
+      slot->innerType = f.innerType;
+      slot->count = f.count;
+      slot->have = 0U;
+      slot->payloadLen = 0U;
+      slot->startMs = nowMs;
+      slot->headerLen = view.headerLen();
+      for (uint8_t i = 0U; i < slot->headerLen; ++i) {
+        slot->header[i] = view.data()[i];
+      }
+    } else if ((slot->innerType != f.innerType) || (slot->count != f.count) ||
+               (slot->headerLen != view.headerLen())) {
+      ++mRejected;
+      return 0U;
+    }
+
+    const uint16_t bit = static_cast<uint16_t>(1U << f.idx);
+    if ((slot->have & bit) != 0U) {
+      return 0U;
+    }
+    slot->have = static_cast<uint16_t>(slot->have | bit);
+    for (uint8_t i = 0U; i < f.len; ++i) {
+      slot->payload[f.offset + i] = f.data[i];
+    }
+    if ((f.idx + 1U) == f.count) {
+      slot->payloadLen = static_cast<uint8_t>(f.offset + f.len);
+    }
+    // Relayed copies arrive with lower TTL; keep the freshest hop counters.
+    writeTtlHops(slot->header, view.ttl(), view.hops());
+
+    if (slot->have != static_cast<uint16_t>((1UL << slot->count) - 1UL)) {
+      return 0U;
+    }
+    slot->used = false;
+    const uint8_t hdrLen = slot->headerLen;
+    const size_t frameLen = hdrLen + slot->payloadLen + CRC_LEN;
+    if ((out == nullptr) || (frameLen > outMax)) {
+      ++mRejected;
+      return 0U;
+    }
+    for (uint8_t i = 0U; i < hdrLen; ++i) {
+      out[i] = slot->header[i];
+    }
+    out[typeIndex(out)] = slot->innerType;
+    for (uint8_t i = 0U; i < slot->payloadLen; ++i) {
+      out[hdrLen + i] = slot->payload[i];
+    }
+    ++mCompleted;
+    return static_cast<uint8_t>(sealCrc(out, hdrLen + slot->payloadLen));
+  }
+
+  // Frees slots older than `timeoutMs`; returns how many were dropped.
+  uint8_t expire(uint32_t nowMs, uint32_t timeoutMs) {
+    uint8_t n = 0U;
+    for (Slot& slot : mSlots) {
+      if (slot.used && ((nowMs - slot.startMs) >= timeoutMs)) {
+        slot.used = false;
+        ++n;
+      }
+    }
+    mTimedOut += n;
+    return n;
+  }
+
+  uint8_t inFlight() const {
+    uint8_t n = 0U;
+    for (const Slot& slot : mSlots) {
+      n = static_cast<uint8_t>(n + (slot.used ? 1U : 0U));
+    }
+    return n;
+  }
+  uint32_t completed() const {
+    return mCompleted;
+  }
+  uint32_t timedOut() const {
+    return mTimedOut;
+  }
+  uint32_t evicted() const {
+    return mEvicted;
+  }
+  uint32_t rejected() const {
+    return mRejected;
+  }
+
+ private:
+  struct Slot {
+    bool used;
+    uint8_t src;
+    uint8_t bootId;
+    uint16_t msgId;
+    uint8_t innerType;
+    uint8_t count;
+    uint16_t have;  // Bit per received fragment index.
+    uint8_t payloadLen;
+    uint32_t startMs;
+    uint8_t headerLen;
+    uint8_t header[HEADER_LEN];
+    uint8_t payload[MAX_PAYLOAD];
+  };
+
+  Slot* find(uint8_t src, uint8_t bootId, uint16_t msgId) {
+    for (Slot& slot : mSlots) {
+      if (slot.used && (slot.src == src) && (slot.bootId == bootId) && (slot.msgId == msgId)) {
+        return &slot;
+      }
+    }
+    return nullptr;
+  }
+
+  Slot* claim(uint32_t nowMs) {
+    Slot* oldest = &mSlots[0];
+    for (Slot& slot : mSlots) {
+      if (!slot.used) {
+        return &slot;
+      }
+      if ((nowMs - slot.startMs) > (nowMs - oldest->startMs)) {
+        oldest = &slot;
+      }
+    }
+    ++mEvicted;
+    return oldest;
+  }
+
+  Slot mSlots[SLOTS] = {};
+  uint32_t mCompleted = 0UL;
+  uint32_t mTimedOut = 0UL;
+  uint32_t mEvicted = 0UL;
+  uint32_t mRejected = 0UL;
+};
+
+inline bool parseReport(const uint8_t* buf, size_t len, uint8_t expectedNetId, Report& out, uint8_t& errCode) {
+  FrameView view;
+  if (!view.init(buf, len)) {
+    errCode = PARSE_ERR_LEN;
+    return false;
+  }
+  if (view.netId() != expectedNetId) {
+    errCode = PARSE_ERR_NET;
+    return false;
+  }
+  if (view.type() != REPORT_TYPE) {
+    errCode = PARSE_ERR_TYPE;
+    return false;
+  }
+  if (!view.crcOk()) {
+    errCode = PARSE_ERR_CRC;
+    return false;
+  }
+  return parseReportView(view, out, errCode);
+}
+
+}  // namespace codec
+
+#endif  // FRAME_CODEC_H
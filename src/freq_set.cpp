@@ -0,0 +1,109 @@
+#include "freq_set.h"
+
+namespace {
+
+bool bandIndex(uint16_t mhz, uint16_t& idx) {
+  if (mhz < FREQ_BAND_START_MHZ) {
+    return false;
+  }
+  const uint16_t offset = static_cast<uint16_t>(mhz - FREQ_BAND_START_MHZ);
+  if ((offset % FREQ_BAND_STEP_MHZ) != 0U) {
+    return false;
+  }
+  idx = static_cast<uint16_t>(offset / FREQ_BAND_STEP_MHZ);
+  return idx < FREQ_BAND_CHANNELS;
+}
+
+bool extraContains(const FreqSet& set, uint16_t mhz) {
+  for (uint8_t i = 0U; i < set.extraCount; ++i) {
+    if (set.extra[i] == mhz) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+void freqSetClear(FreqSet& set) {
+  for (uint8_t i = 0U; i < FREQ_BAND_BYTES; ++i) {
+    set.band[i] = 0U;
+  }
+  set.extraCount = 0U;
+  set.count = 0U;
+}
+
+void freqSetAdd(FreqSet& set, uint16_t mhz) {
+  uint16_t idx = 0U;
+  if (bandIndex(mhz, idx)) {
+    const uint8_t mask = static_cast<uint8_t>(1U << (idx & 7U));
+    if ((set.band[idx >> 3] & mask) == 0U) {
+      set.band[idx >> 3] = static_cast<uint8_t>(set.band[idx >> 3] | mask);
+      ++set.count;
+    }
+    return;
+  }
+  if ((set.extraCount < FREQ_EXTRA_MAX) && !extraContains(set, mhz)) {
+    set.extra[set.extraCount++] = mhz;
+    ++set.count;
+  }
+}
+
+bool freqSetEqual(const FreqSet& a, const FreqSet& b) {
+  if ((a.count != b.count) || (a.extraCount != b.extraCount)) {
+    return false;
+  }
+  for (uint8_t i = 0U; i < FREQ_BAND_BYTES; ++i) {
+    if (a.band[i] != b.band[i]) {
+      return false;
+    }
+  }
+  for (uint8_t i = 0U; i < a.extraCount; ++i) {
+    if (!extraContains(b, a.extra[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint8_t freqSetToList(const FreqSet& set, uint16_t* out, uint8_t maxOut) {
+  if (set.count > maxOut) {
+    return 0U;
+  }
+  uint8_t n = 0U;
+  for (uint16_t idx = 0U; idx < FREQ_BAND_CHANNELS; ++idx) {
+    if ((set.band[idx >> 3] & (1U << (idx & 7U))) != 0U) {
+      out[n++] = static_cast<uint16_t>(FREQ_BAND_START_MHZ + (idx * FREQ_BAND_STEP_MHZ));
+    }
+  }
+  for (uint8_t i = 0U; i < set.extraCount; ++i) {
+    out[n++] = set.extra[i];
+  }
+  return n;
+}
+
+void freqTokenizerReset(FreqTokenizer& tok) {
+  tok.value = 0UL;
+  tok.hasDigits = false;
+  tok.overflow = false;
+}
+
+void freqTokenizerFeed(FreqTokenizer& tok, char ch, FreqSet& out) {
+  if ((ch >= '0') && (ch <= '9')) {
+    tok.hasDigits = true;
+    if (!tok.overflow) {
+      tok.value = (tok.value * 10UL) + static_cast<uint32_t>(ch - '0');
+      tok.overflow = (tok.value > 65535UL);
+    }
+    return;
+  }
+  // Separators and any other character end the current token.
+  freqTokenizerFinish(tok, out);
+}
+
+void freqTokenizerFinish(FreqTokenizer& tok, FreqSet& out) {
+  if (tok.hasDigits && !tok.overflow && (tok.value != 0UL)) {
+    freqSetAdd(out, static_cast<uint16_t>(tok.value));
+  }
+  freqTokenizerReset(tok);
+}
@@ -0,0 +1,36 @@
+#ifndef FREQ_SET_H
+#define FREQ_SET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "config.h"
+
+// Set of detected frequencies (MHz) from one UART line. In-band values are
+// one bit each; up to FREQ_EXTRA_MAX out-of-band values are kept as a list.
+struct FreqSet {
+  uint8_t band[FREQ_BAND_BYTES];  // Bit i (LSB first): FREQ_BAND_START_MHZ + i * FREQ_BAND_STEP_MHZ.
+  uint16_t extra[FREQ_EXTRA_MAX];
+  uint8_t extraCount;
+  uint16_t count;  // Distinct values stored.
+};
+
+void freqSetClear(FreqSet& set);
+void freqSetAdd(FreqSet& set, uint16_t mhz);
+bool freqSetEqual(const FreqSet& a, const FreqSet& b);
+// Writes every value (band ascending, then extras) when count <= maxOut.
+uint8_t freqSetToList(const FreqSet& set, uint16_t* out, uint8_t maxOut);
+
+// Streaming tokenizer with the old parseFreqLineMHz() rules: digit runs are
+// values, anything else ends a token, 0 and values above 65535 are dropped.
+struct FreqTokenizer {
+  uint32_t value;
+  bool hasDigits;
+  bool overflow;
+};
+
+void freqTokenizerReset(FreqTokenizer& tok);
+void freqTokenizerFeed(FreqTokenizer& tok, char ch, FreqSet& out);
+void freqTokenizerFinish(FreqTokenizer& tok, FreqSet& out);
+
+#endif  // FREQ_SET_H
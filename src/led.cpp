@@ -0,0 +1,75 @@
+#include "led.h"
+
+#include "board.h"
+
+namespace {
+
+struct Pattern {
+  const uint16_t* stepsMs;  // On, off, on, ... durations.
+  uint8_t steps;
+  bool repeat;
+};
+
+constexpr uint16_t RX_STEPS[] = {15U};
+constexpr uint16_t TX_STEPS[] = {60U};
+constexpr uint16_t BOOT_STEPS[] = {90U, 110U, 90U, 110U, 90U};
+constexpr uint16_t FAULT_STEPS[] = {60U, 140U};
+
+constexpr Pattern PATTERNS[] = {
+    {RX_STEPS, sizeof(RX_STEPS) / sizeof(RX_STEPS[0]), false},
+    {TX_STEPS, sizeof(TX_STEPS) / sizeof(TX_STEPS[0]), false},
+    {BOOT_STEPS, sizeof(BOOT_STEPS) / sizeof(BOOT_STEPS[0]), false},
+    {FAULT_STEPS, sizeof(FAULT_STEPS) / sizeof(FAULT_STEPS[0]), true},
+};
+
+bool gActive = false;
+LedPattern gPattern = LedPattern::Rx;
+uint8_t gStep = 0U;
+bool gStepStarted = false;  // The first step starts on the next tick.
+uint32_t gStepStartMs = 0UL;
+
+void setStep(uint8_t step) {
+  gStep = step;
+  boardLedSet((step & 1U) == 0U);
+}
+
+}  // namespace
+
+void ledInit() {
+  gActive = false;
+  boardLedSet(false);
+  ledShow(LedPattern::Boot);
+}
+
+void ledShow(LedPattern pattern) {
+  if (gActive && (pattern < gPattern)) {
+    return;
+  }
+  gActive = true;
+  gPattern = pattern;
+  gStepStarted = false;
+  setStep(0U);
+}
+
+void ledTick(uint32_t nowMs) {
+  if (!gActive) {
+    return;
+  }
+  if (!gStepStarted) {
+    gStepStarted = true;
+    gStepStartMs = nowMs;
+  }
+  const Pattern& p = PATTERNS[static_cast<uint8_t>(gPattern)];
+  while ((nowMs - gStepStartMs) >= p.stepsMs[gStep]) {
+    gStepStartMs += p.stepsMs[gStep];
+    if ((gStep + 1U) < p.steps) {
+      setStep(static_cast<uint8_t>(gStep + 1U));
+    } else if (p.repeat) {
+      setStep(0U);
+    } else {
+      gActive = false;
+      boardLedSet(false);
+      return;
+    }
+  }
+}
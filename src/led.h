@@ -0,0 +1,20 @@
+#ifndef LED_H
+#define LED_H
+
+#include <stdint.h>
+
+// Status LED patterns, played from appTick() without blocking. A pattern
+// shown while one of higher priority plays is dropped; Fault repeats until
+// the next reset.
+enum class LedPattern : uint8_t {
+  Rx,     // Accepted frame: one short flash.
+  Tx,     // Frame sent: one longer flash.
+  Boot,   // Three blinks after reset.
+  Fault,  // Radio failed to start: steady fast blink.
+};
+
+void ledInit();  // Starts the Boot pattern.
+void ledShow(LedPattern pattern);
+void ledTick(uint32_t nowMs);
+
+#endif  // LED_H
@@ -2,40 +2,105 @@
 
 #include <Arduino.h>
 
+#include "bridge.h"
+
 #if LOG_ENABLED
 
+namespace {
+
+// Export builds share Serial with the bridge (same condition as
+// BRIDGE_ACTIVE in app.cpp): a line goes out as one LOG record instead of
+// text that could land inside an export record, and nothing blocks.
+constexpr bool LOG_TO_BRIDGE = IS_GATEWAY || RX_CAPTURE_ENABLED;
+constexpr uint8_t LINE_MAX = 48U;
+
+class Line {
+ public:
+  explicit Line(const char* tag) {
+    put(tag);
+  }
+
+  void put(char c) {
+    if (mLen < LINE_MAX) {
+      mText[mLen++] = c;
+    }
+  }
+
+  void put(const char* s) {
+    while (*s != '\0') {
+      put(*s++);
+    }
+  }
+
+  void putInt(int32_t v) {
+    put(' ');
+    uint32_t mag = static_cast<uint32_t>(v);
+    if (v < 0) {
+      put('-');
+      mag = 0U - mag;
+    }
+    char digits[10];
+    uint8_t n = 0U;
+    do {
+      digits[n++] = static_cast<char>('0' + (mag % 10U));
+      mag /= 10U;
+    } while (mag > 0U);
+    while (n > 0U) {
+      put(digits[--n]);
+    }
+  }
+
+  void putHex(uint8_t v) {
+    static const char HEX_DIGITS[] = "0123456789ABCDEF";
+    put(' ');
+    put(HEX_DIGITS[v >> 4]);
+    put(HEX_DIGITS[v & 0x0FU]);
+  }
+
+  void emit() const {
+    if constexpr (LOG_TO_BRIDGE) {
+      (void)bridgePushLog(mText, mLen, millis());
+    } else {
+      Serial.write(reinterpret_cast<const uint8_t*>(mText), mLen);
+      Serial.write(static_cast<uint8_t>('\r'));
+      Serial.write(static_cast<uint8_t>('\n'));
+    }
+  }
+
+ private:
+  char mText[LINE_MAX];
+  uint8_t mLen = 0U;
+};
+
+}  // namespace
+
 void logInit() {
   Serial.begin(UART_BAUD);
 }
 
 void logEvent(const char* tag) {
-  Serial.println(tag);
+  Line(tag).emit();
 }
 
 void logEvent2(const char* tag, int32_t v) {
-  Serial.print(tag);
-  Serial.print(' ');
-  Serial.println(v);
+  Line line(tag);
+  line.putInt(v);
+  line.emit();
 }
 
 void logEvent3(const char* tag, int32_t v1, int32_t v2) {
-  Serial.print(tag);
-  Serial.print(' ');
-  Serial.print(v1);
-  Serial.print(' ');
-  Serial.println(v2);
+  Line line(tag);
+  line.putInt(v1);
+  line.putInt(v2);
+  line.emit();
 }
 
 void logHex8(const char* tag, const uint8_t data[8]) {
-  Serial.print(tag);
+  Line line(tag);
   for (uint8_t i = 0; i < 8; ++i) {
-    Serial.print(' ');
-    if (data[i] < 16U) {
-      Serial.print('0');
-    }
-    Serial.print(data[i], HEX);
+    line.putHex(data[i]);
   }
-  Serial.println();
+  line.emit();
 }
 
 #else
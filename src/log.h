@@ -10,4 +10,27 @@ void logEvent2(const char* tag, int32_t v);
 void logEvent3(const char* tag, int32_t v1, int32_t v2);
 void logHex8(const char* tag, const uint8_t data[8]);
 
+// Per-frame progress (received, queued, on air, listening again). Export
+// builds leave it out: their log lines share the bridge ring with the RX
+// records, which carry the same frames anyway.
+constexpr bool LOG_FRAME_EVENTS = !(IS_GATEWAY || RX_CAPTURE_ENABLED);
+
+inline void logFrameEvent(const char* tag) {
+  if constexpr (LOG_FRAME_EVENTS) {
+    logEvent(tag);
+  }
+}
+
+inline void logFrameEvent2(const char* tag, int32_t v) {
+  if constexpr (LOG_FRAME_EVENTS) {
+    logEvent2(tag, v);
+  }
+}
+
+inline void logFrameEvent3(const char* tag, int32_t v1, int32_t v2) {
+  if constexpr (LOG_FRAME_EVENTS) {
+    logEvent3(tag, v1, v2);
+  }
+}
+
 #endif  // LOG_H
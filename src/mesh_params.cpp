@@ -0,0 +1,151 @@
+#include "mesh_params.h"
+
+#include "config.h"
+#include "log.h"
+
+namespace {
+
+static_assert((BACKOFF_MAX_MS <= 0xFFFFUL) && (WINDOW_MS <= 0xFFFFUL) && (MAX_FORWARDS_PER_WINDOW <= 0xFFU) &&
+                  ((REPORT_STATUS_PERIOD_MS % 1000UL) == 0UL),
+              "boot mesh parameters must fit the CONFIG encoding");
+
+constexpr codec::MeshParams BOOT_PARAMS = {
+    static_cast<uint16_t>(BACKOFF_MIN_MS),
+    static_cast<uint16_t>(BACKOFF_MAX_MS),
+    static_cast<uint16_t>(WINDOW_MS),
+    MAX_FORWARDS_PER_WINDOW,
+    DATA_TTL,
+    static_cast<uint16_t>(REPORT_STATUS_PERIOD_MS / 1000UL),
+};
+// Compact headers carry a 4-bit TTL.
+constexpr uint8_t TTL_MAX = COMPACT_HEADER_TX ? codec::compact::NIBBLE_MAX : 0xFFU;
+
+codec::MeshParams gParams = BOOT_PARAMS;
+uint16_t gVersion = MESH_PARAMS_VERSION;
+bool gBootAnnounced = false;
+uint32_t gAdopted = 0UL;
+uint32_t gSuppressed = 0UL;
+
+// Trickle state (RFC 6206): interval length, its start, the send point t in
+// [I/2, I), and consistent CONFIGs heard since the interval began.
+uint32_t gIntervalMs = TRICKLE_IMIN_MS;
+uint32_t gIntervalStartMs = 0UL;
+uint32_t gFireAtMs = 0UL;
+bool gStarted = false;  // The first interval starts on the first tick.
+bool gFired = false;
+uint8_t gHeard = 0U;
+
+bool timeReached(uint32_t nowMs, uint32_t deadlineMs) {
+  return static_cast<int32_t>(nowMs - deadlineMs) >= 0;
+}
+
+void startInterval(uint32_t nowMs) {
+  const uint32_t half = gIntervalMs / 2UL;
+  gIntervalStartMs = nowMs;
+  gFireAtMs = nowMs + half + static_cast<uint32_t>(random(static_cast<long>(half)));
+  gFired = false;
+  gHeard = 0U;
+}
+
+// Something inconsistent was heard: announce soon.
+void resetTrickle(uint32_t nowMs) {
+  if (!gStarted || (gIntervalMs != TRICKLE_IMIN_MS)) {
+    gStarted = true;
+    gIntervalMs = TRICKLE_IMIN_MS;
+    startInterval(nowMs);
+  }
+}
+
+// Out-of-range values are refused rather than clamped: a half-valid
+// version would spread anyway.
+bool paramsValid(const codec::MeshParams& p) {
+  return (p.backoffMinMs <= p.backoffMaxMs) && (p.windowMs >= 1000U) && (p.maxForwardsPerWindow > 0U) &&
+         (p.dataTtl > 0U) && (p.dataTtl <= TTL_MAX) && (p.reportStatusPeriodS > 0U) &&
+         ((static_cast<uint32_t>(p.reportStatusPeriodS) * 1000UL) <= REPORT_STATUS_PERIOD_MAX_MS);
+}
+
+}  // namespace
+
+void meshParamsInit() {
+  gParams = BOOT_PARAMS;
+  gVersion = MESH_PARAMS_VERSION;
+  gBootAnnounced = false;
+  gAdopted = 0UL;
+  gSuppressed = 0UL;
+  gIntervalMs = TRICKLE_IMIN_MS;
+  gStarted = false;
+}
+
+const codec::MeshParams& meshParams() {
+  return gParams;
+}
+
+uint16_t meshParamsVersion() {
+  return gVersion;
+}
+
+void meshParamsOnConfig(const codec::ConfigMsg& msg, uint32_t nowMs) {
+  if (!CONFIG_SYNC_ENABLED) {
+    return;
+  }
+  const int16_t d = static_cast<int16_t>(static_cast<uint16_t>(msg.version - gVersion));
+  if (d == 0) {
+    if (gHeard < 0xFFU) {
+      ++gHeard;
+    }
+    return;
+  }
+  if (d > 0) {
+    // Unusable: ignored, so a bad version cannot keep the timers short.
+    if (!msg.hasParams || !paramsValid(msg.params)) {
+      return;
+    }
+    gParams = msg.params;
+    gVersion = msg.version;
+    ++gAdopted;
+    logEvent2("CFGNEW", gVersion);
+  }
+  // Adopted a newer version, or the sender is behind: announce soon.
+  resetTrickle(nowMs);
+}
+
+bool meshParamsDue(uint32_t nowMs) {
+  if (!CONFIG_SYNC_ENABLED) {
+    return false;
+  }
+  if (!gStarted) {
+    gStarted = true;
+    startInterval(nowMs);
+  }
+  bool due = false;
+  if (!gFired && timeReached(nowMs, gFireAtMs)) {
+    gFired = true;
+    if (gHeard >= TRICKLE_K) {
+      ++gSuppressed;
+    } else if ((gVersion != 0U) || !gBootAnnounced) {
+      gBootAnnounced = true;
+      due = true;
+    }
+  }
+  if (timeReached(nowMs, gIntervalStartMs + gIntervalMs)) {
+    if (gIntervalMs < (TRICKLE_IMIN_MS << TRICKLE_IMAX_DOUBLINGS)) {
+      gIntervalMs *= 2UL;
+    }
+    startInterval(nowMs);
+  }
+  return due;
+}
+
+void meshParamsFill(codec::ConfigMsg& msg) {
+  msg.version = gVersion;
+  msg.hasParams = (gVersion != 0U);
+  msg.params = gParams;
+}
+
+uint32_t meshParamsAdopted() {
+  return gAdopted;
+}
+
+uint32_t meshParamsSuppressed() {
+  return gSuppressed;
+}
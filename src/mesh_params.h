@@ -0,0 +1,31 @@
+#ifndef MESH_PARAMS_H
+#define MESH_PARAMS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "frame_codec.h"
+
+// Runtime mesh tuning (CONFIG_SYNC_ENABLED, tuning: "Mesh parameters" in
+// config.h). Boots with the config.h values as MESH_PARAMS_VERSION, adopts
+// any newer valid version heard, and decides by Trickle when this node
+// announces its own. A node without parameters (version 0) announces once
+// per boot so neighbours that know better answer quickly.
+
+void meshParamsInit();
+
+// Values in force; the config.h ones until a newer version is adopted.
+const codec::MeshParams& meshParams();
+uint16_t meshParamsVersion();
+
+// A CONFIG frame was heard.
+void meshParamsOnConfig(const codec::ConfigMsg& msg, uint32_t nowMs);
+// True once per Trickle interval when this node should announce; the
+// CONFIG to send is meshParamsFill().
+bool meshParamsDue(uint32_t nowMs);
+void meshParamsFill(codec::ConfigMsg& msg);
+
+uint32_t meshParamsAdopted();
+uint32_t meshParamsSuppressed();
+
+#endif  // MESH_PARAMS_H
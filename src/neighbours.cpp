@@ -0,0 +1,231 @@
+#include "neighbours.h"
+
+#include "config.h"
+
+namespace {
+
+constexpr uint8_t NONE = 0xFFU;
+constexpr int32_t PRR_ONE = 0x8000;  // Q15
+
+static_assert(NEIGHBOUR_SLOTS < NONE, "slot indices must leave NONE free");
+
+struct Entry {
+  uint8_t id;
+  uint8_t bootId;
+  uint8_t lastSeq;  // Low byte only: compact headers carry no more.
+  uint8_t prev;     // Towards the most recently heard.
+  uint8_t next;
+  int16_t rssiX16;
+  int16_t snrX16;
+  uint16_t prrQ15;
+  uint16_t heard;
+  uint32_t lastHeardMs;
+};
+
+Entry gSlots[NEIGHBOUR_SLOTS];
+uint8_t gSlotOf[256];  // id -> slot + 1; 0 = not in the table.
+uint8_t gHead = NONE;  // Most recently heard.
+uint8_t gTail = NONE;
+uint8_t gCount = 0U;
+uint32_t gEvicted = 0UL;
+
+void unlink(uint8_t slot) {
+  Entry& e = gSlots[slot];
+  if (e.prev != NONE) {
+    gSlots[e.prev].next = e.next;
+  } else {
+    gHead = e.next;
+  }
+  if (e.next != NONE) {
+    gSlots[e.next].prev = e.prev;
+  } else {
+    gTail = e.prev;
+  }
+}
+
+void pushFront(uint8_t slot) {
+  Entry& e = gSlots[slot];
+  e.prev = NONE;
+  e.next = gHead;
+  if (gHead != NONE) {
+    gSlots[gHead].prev = slot;
+  }
+  gHead = slot;
+  if (gTail == NONE) {
+    gTail = slot;
+  }
+}
+
+void removeSlot(uint8_t slot) {
+  unlink(slot);
+  gSlotOf[gSlots[slot].id] = 0U;
+  --gCount;
+}
+
+int16_t ewma(int16_t avgX16, int16_t sample) {
+  const int32_t avg = avgX16;
+  return static_cast<int16_t>(avg + (((static_cast<int32_t>(sample) * 16) - avg) >> NEIGHBOUR_EWMA_SHIFT));
+}
+
+uint16_t prrStep(uint16_t prr, int32_t sample) {
+  const int32_t p = prr;
+  return static_cast<uint16_t>(p + ((sample - p) >> NEIGHBOUR_EWMA_SHIFT));
+}
+
+// Gaps of 1..NEIGHBOUR_SEQ_GAP_MAX count the frames missed in between;
+// repeats (fragments of one message, re-sends) and older seqs change
+// nothing. A larger jump, or a reboot, restarts from this frame.
+void updatePrr(Entry& e, const codec::FrameView& view, bool hasBoot) {
+  const uint8_t seq = static_cast<uint8_t>(view.seq() & 0xFFU);
+  const uint8_t gap = static_cast<uint8_t>(seq - e.lastSeq);
+  if (hasBoot && (view.bootId() != e.bootId)) {
+    e.bootId = view.bootId();
+    e.lastSeq = seq;
+    return;
+  }
+  if ((gap == 0U) || (gap >= 0x80U)) {
+    return;
+  }
+  e.lastSeq = seq;
+  if (gap > NEIGHBOUR_SEQ_GAP_MAX) {
+    return;
+  }
+  for (uint8_t i = 1U; i < gap; ++i) {
+    e.prrQ15 = prrStep(e.prrQ15, 0);
+  }
+  e.prrQ15 = prrStep(e.prrQ15, PRR_ONE);
+}
+
+void fill(const Entry& e, Neighbour& out) {
+  out.id = e.id;
+  out.rssiDbm = static_cast<int16_t>(e.rssiX16 / 16);
+  out.snrDb = static_cast<int8_t>(e.snrX16 / 16);
+  out.prrPct = static_cast<uint8_t>((static_cast<uint32_t>(e.prrQ15) * 100UL + (PRR_ONE / 2)) / PRR_ONE);
+  out.heard = e.heard;
+  out.lastHeardMs = e.lastHeardMs;
+}
+
+int8_t clampI8(int16_t v) {
+  return static_cast<int8_t>((v < -128) ? -128 : ((v > 127) ? 127 : v));
+}
+
+}  // namespace
+
+void neighboursInit() {
+  for (uint16_t id = 0U; id < 256U; ++id) {
+    gSlotOf[id] = 0U;
+  }
+  gHead = NONE;
+  gTail = NONE;
+  gCount = 0U;
+  gEvicted = 0UL;
+}
+
+void neighboursOnHeard(const codec::FrameView& view, int16_t rssiDbm, int8_t snrDb, uint32_t nowMs) {
+  if (view.hops() != 0U) {
+    return;
+  }
+  // Legacy headers always carry BOOT; compact ones only with SEQ low byte 0.
+  const bool hasBoot = !view.compact() || ((view.seq() & 0xFFU) == 0U);
+  uint8_t slot = gSlotOf[view.src()];
+  if (slot != 0U) {
+    --slot;
+    unlink(slot);
+    Entry& e = gSlots[slot];
+    e.rssiX16 = ewma(e.rssiX16, rssiDbm);
+    e.snrX16 = ewma(e.snrX16, snrDb);
+    updatePrr(e, view, hasBoot);
+  } else {
+    if (gCount < NEIGHBOUR_SLOTS) {
+      slot = gCount++;
+    } else {
+      slot = gTail;
+      removeSlot(slot);
+      ++gCount;
+      ++gEvicted;
+    }
+    Entry& e = gSlots[slot];
+    e.id = view.src();
+    e.bootId = hasBoot ? view.bootId() : 0U;
+    e.lastSeq = static_cast<uint8_t>(view.seq() & 0xFFU);
+    e.rssiX16 = static_cast<int16_t>(rssiDbm * 16);
+    e.snrX16 = static_cast<int16_t>(snrDb * 16);
+    e.prrQ15 = static_cast<uint16_t>(PRR_ONE);
+    e.heard = 0U;
+    gSlotOf[e.id] = static_cast<uint8_t>(slot + 1U);
+  }
+  Entry& e = gSlots[slot];
+  if (e.heard < 0xFFFFU) {
+    ++e.heard;
+  }
+  e.lastHeardMs = nowMs;
+  pushFront(slot);
+}
+
+void neighboursExpire(uint32_t nowMs) {
+  // Oldest first; stops at the first fresh entry.
+  while ((gTail != NONE) && ((nowMs - gSlots[gTail].lastHeardMs) >= NEIGHBOUR_STALE_MS)) {
+    const uint8_t slot = gTail;
+    removeSlot(slot);
+    // Keep slots [0, gCount) in use: the last one moves into the hole.
+    if (slot != gCount) {
+      const uint8_t moved = gCount;
+      gSlots[slot] = gSlots[moved];
+      gSlotOf[gSlots[slot].id] = static_cast<uint8_t>(slot + 1U);
+      if (gSlots[slot].prev != NONE) {
+        gSlots[gSlots[slot].prev].next = slot;
+      } else {
+        gHead = slot;
+      }
+      if (gSlots[slot].next != NONE) {
+        gSlots[gSlots[slot].next].prev = slot;
+      } else {
+        gTail = slot;
+      }
+    }
+  }
+}
+
+bool neighbourGet(uint8_t id, Neighbour& out) {
+  const uint8_t slot = gSlotOf[id];
+  if (slot == 0U) {
+    return false;
+  }
+  fill(gSlots[slot - 1U], out);
+  return true;
+}
+
+uint8_t neighbourCount() {
+  return gCount;
+}
+
+bool neighbourAt(uint8_t rank, Neighbour& out) {
+  uint8_t slot = gHead;
+  while ((slot != NONE) && (rank > 0U)) {
+    slot = gSlots[slot].next;
+    --rank;
+  }
+  if (slot == NONE) {
+    return false;
+  }
+  fill(gSlots[slot], out);
+  return true;
+}
+
+uint8_t neighboursFillLinks(codec::Link* out, uint8_t max) {
+  uint8_t n = 0U;
+  for (uint8_t slot = gHead; (slot != NONE) && (n < max); slot = gSlots[slot].next) {
+    Neighbour nb{};
+    fill(gSlots[slot], nb);
+    out[n].id = nb.id;
+    out[n].rssiDbm = clampI8(nb.rssiDbm);
+    out[n].snrDb = nb.snrDb;
+    out[n].prrPct = nb.prrPct;
+    ++n;
+  }
+  return n;
+}
+
+uint32_t neighboursEvicted() {
+  return gEvicted;
+}
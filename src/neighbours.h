@@ -0,0 +1,40 @@
+#ifndef NEIGHBOURS_H
+#define NEIGHBOURS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "frame_codec.h"
+
+// Link table of the nodes heard directly (tuning: "Neighbours" in
+// config.h). Relayed copies say nothing about the link to their origin, so
+// only HOPS 0 frames count. Lookup by id is a direct index and the entries
+// form a most-recently-heard list, so an update costs the same whatever the
+// table size; the list tail is evicted when a new neighbour needs room.
+
+struct Neighbour {
+  uint8_t id;
+  int16_t rssiDbm;  // EWMA
+  int8_t snrDb;     // EWMA
+  uint8_t prrPct;   // Packet reception ratio, from sequence gaps.
+  uint16_t heard;   // Frames heard, saturating.
+  uint32_t lastHeardMs;
+};
+
+void neighboursInit();
+
+// A validated frame was received with this RSSI/SNR.
+void neighboursOnHeard(const codec::FrameView& view, int16_t rssiDbm, int8_t snrDb, uint32_t nowMs);
+// Drops entries not heard for NEIGHBOUR_STALE_MS.
+void neighboursExpire(uint32_t nowMs);
+
+bool neighbourGet(uint8_t id, Neighbour& out);
+uint8_t neighbourCount();
+// The `rank`-th most recently heard neighbour, 0 = freshest.
+bool neighbourAt(uint8_t rank, Neighbour& out);
+// Freshest links for a REPORT; returns how many were written.
+uint8_t neighboursFillLinks(codec::Link* out, uint8_t max);
+
+uint32_t neighboursEvicted();
+
+#endif  // NEIGHBOURS_H
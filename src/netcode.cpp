@@ -0,0 +1,102 @@
+#include "netcode.h"
+
+#include "config.h"
+
+namespace {
+
+struct Recent {
+  uint8_t len;
+  uint8_t data[NETCODE_FRAME_MAX];
+};
+
+Recent gRecent[NETCODE_ENABLED ? NETCODE_RECENT_SLOTS : 1U] = {};
+uint8_t gNext = 0U;
+uint32_t gSent = 0UL;
+uint32_t gDecoded = 0UL;
+uint32_t gUndecodable = 0UL;
+
+// +1 heads for the gateway, -1 comes from it, 0 either way.
+int8_t direction(const codec::FrameView& view) {
+  if ((view.flags() & codec::FLAG_TRACE) != 0U) {
+    return 0;
+  }
+  switch (view.type()) {
+    case codec::REPORT_TYPE:
+    case codec::FRAG_TYPE:
+      return 1;
+    case codec::BEACON_TYPE: {
+      // A pending PHY switch is restamped at TX, which a coded copy cannot be.
+      codec::Beacon beacon{};
+      const bool switching = codec::parseBeaconView(view, beacon) && beacon.hasPhy &&
+                             (beacon.phy.target != beacon.phy.active);
+      return switching ? 0 : -1;
+    }
+    default:
+      return 0;
+  }
+}
+
+}  // namespace
+
+void netcodeInit() {
+  for (Recent& r : gRecent) {
+    r.len = 0U;
+  }
+  gNext = 0U;
+  gSent = 0UL;
+  gDecoded = 0UL;
+  gUndecodable = 0UL;
+}
+
+bool netcodePairable(const codec::FrameView& a, const codec::FrameView& b) {
+  const int8_t da = direction(a);
+  return (da != 0) && ((da + direction(b)) == 0);
+}
+
+void netcodeRemember(const uint8_t* frame, uint8_t len) {
+  if (!NETCODE_ENABLED || (len > NETCODE_FRAME_MAX)) {
+    return;
+  }
+  Recent& r = gRecent[gNext];
+  for (uint8_t i = 0U; i < len; ++i) {
+    r.data[i] = frame[i];
+  }
+  r.len = codec::relayRewrite(r.data, len) ? len : 0U;
+  if (r.len > 0U) {
+    gNext = static_cast<uint8_t>((gNext + 1U) % NETCODE_RECENT_SLOTS);
+  }
+}
+
+uint8_t netcodeDecode(const codec::FrameView& coded, uint8_t* out, uint8_t outMax, codec::FrameView& known) {
+  codec::Coded c{};
+  if (!NETCODE_ENABLED || !codec::parseCodedView(coded, c)) {
+    return 0U;
+  }
+  for (const Recent& r : gRecent) {
+    const uint8_t len = (r.len > 0U) ? codec::decodeCoded(c, r.data, r.len, out, outMax) : 0U;
+    codec::FrameView native;
+    // A CODED native would only come from a broken or hostile sender.
+    if ((len > 0U) && native.init(out, len) && (native.type() != codec::CODED_TYPE) && known.init(r.data, r.len)) {
+      ++gDecoded;
+      return len;
+    }
+  }
+  ++gUndecodable;
+  return 0U;
+}
+
+void netcodeOnSent() {
+  ++gSent;
+}
+
+uint32_t netcodeSent() {
+  return gSent;
+}
+
+uint32_t netcodeDecoded() {
+  return gDecoded;
+}
+
+uint32_t netcodeUndecodable() {
+  return gUndecodable;
+}
@@ -0,0 +1,36 @@
+#ifndef NETCODE_H
+#define NETCODE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "frame_codec.h"
+
+// Opportunistic XOR network coding (NETCODE_ENABLED, tuning: "Network
+// coding" in config.h). A relay holding a frame on its way to the gateway
+// and one on its way from it sends both as one CODED frame: each was heard
+// from the side that now needs the other, and that side still holds its own
+// in the form the relay queued it. Frames carry no last-hop id, so direction
+// is what tells the two sides apart.
+
+constexpr uint8_t NETCODE_FRAME_MAX = 64U;
+
+void netcodeInit();
+
+// One of `a`, `b` is a REPORT or FRAG and the other a BEACON, neither
+// traced (the trace TLV changes at every hop).
+bool netcodePairable(const codec::FrameView& a, const codec::FrameView& b);
+
+// A frame this node sent or accepted, kept as the next relay queues it
+// (TTL-1, HOPS+1). Frames that cannot be relayed are skipped.
+void netcodeRemember(const uint8_t* frame, uint8_t len);
+// The native of `coded` this node lacks, into `out`; 0 when it holds
+// neither. `known` is then the one it held, as the sender relayed it.
+uint8_t netcodeDecode(const codec::FrameView& coded, uint8_t* out, uint8_t outMax, codec::FrameView& known);
+
+void netcodeOnSent();
+uint32_t netcodeSent();
+uint32_t netcodeDecoded();
+uint32_t netcodeUndecodable();
+
+#endif  // NETCODE_H
@@ -0,0 +1,182 @@
+#include "phy.h"
+
+#include "config.h"
+#include "log.h"
+#include "radio.h"
+
+namespace {
+
+bool gSwitchPending = false;
+uint8_t gSwitchTarget = PHY_PROFILE_DEFAULT;
+uint32_t gSwitchAtMs = 0UL;
+
+bool gBeaconSeen = false;
+uint32_t gLastBeaconMs = 0UL;
+
+constexpr uint32_t PREAMBLE_SYMBOLS = 8UL;
+
+int8_t gWorstSnrDb = 127;
+uint16_t gSnrSamples = 0U;
+uint32_t gLastEvalMs = 0UL;
+
+bool timeReached(uint32_t nowMs, uint32_t deadlineMs) {
+  return static_cast<int32_t>(nowMs - deadlineMs) >= 0;
+}
+
+// SX126x LoRa demodulation floor: -7.5 dB at SF7, 2.5 dB lower per SF step.
+int16_t demodFloorDb10(uint8_t sf) {
+  return static_cast<int16_t>(-25 * (static_cast<int16_t>(sf) - 4));
+}
+
+void resetSnrWindow() {
+  gWorstSnrDb = 127;
+  gSnrSamples = 0U;
+}
+
+void scheduleSwitch(uint8_t target, uint32_t atMs) {
+  gSwitchPending = true;
+  gSwitchTarget = target;
+  gSwitchAtMs = atMs;
+}
+
+}  // namespace
+
+void phyInit() {
+  gSwitchPending = false;
+  gBeaconSeen = false;
+  resetSnrWindow();
+}
+
+uint32_t phyAirtimeMs(const PhyProfile& profile, uint8_t len) {
+  const uint32_t sf = profile.sf;
+  const uint32_t cr = static_cast<uint32_t>(profile.cr - 4U);
+  const bool lowDr = (sf >= 11U) && (profile.bwHz <= 125000UL);
+  const uint32_t tSymUs = (1000000UL << sf) / profile.bwHz;
+  const int32_t num = static_cast<int32_t>(8U * len) - static_cast<int32_t>(4U * sf) + 28 + 16;
+  const int32_t den = static_cast<int32_t>(4U * (sf - (lowDr ? 2U : 0U)));
+  int32_t payloadSym = 8;
+  if (num > 0) {
+    payloadSym += ((num + den - 1) / den) * static_cast<int32_t>(cr + 4U);
+  }
+  const uint32_t preambleUs = (PREAMBLE_SYMBOLS * tSymUs) + ((tSymUs * 17U) / 4U);
+  const uint32_t totalUs = preambleUs + (static_cast<uint32_t>(payloadSym) * tSymUs);
+  return (totalUs + 999U) / 1000U;
+}
+
+uint8_t phySelectProfile(uint8_t current, int8_t worstSnrDb) {
+  if (current >= PHY_PROFILE_COUNT) {
+    return PHY_PROFILE_DEFAULT;
+  }
+  const int8_t currentPower = PHY_PROFILES[current].txPowerDbm;
+  for (uint8_t id = 0U; id < PHY_PROFILE_COUNT; ++id) {
+    // SNR scales with TX power; the noise bandwidth is the same for all profiles.
+    const int16_t predictedDb10 =
+        static_cast<int16_t>((worstSnrDb + PHY_PROFILES[id].txPowerDbm - currentPower) * 10);
+    int16_t neededDb10 = static_cast<int16_t>(demodFloorDb10(PHY_PROFILES[id].sf) + (PHY_SNR_MARGIN_DB * 10));
+    if (id < current) {
+      neededDb10 = static_cast<int16_t>(neededDb10 + (PHY_UPGRADE_HYST_DB * 10));
+    }
+    if (predictedDb10 >= neededDb10) {
+      return id;
+    }
+  }
+  return static_cast<uint8_t>(PHY_PROFILE_COUNT - 1U);
+}
+
+void phyObserveReportSnr(int8_t snrDb) {
+  if (snrDb < gWorstSnrDb) {
+    gWorstSnrDb = snrDb;
+  }
+  if (gSnrSamples < 0xFFFFU) {
+    ++gSnrSamples;
+  }
+}
+
+void phyEvaluate(uint32_t nowMs) {
+  if ((nowMs - gLastEvalMs) < PHY_EVAL_PERIOD_MS) {
+    return;
+  }
+  gLastEvalMs = nowMs;
+  if (gSwitchPending) {
+    return;
+  }
+
+  const uint8_t current = radioProfileId();
+  uint8_t target = current;
+  if (gSnrSamples >= PHY_EVAL_MIN_REPORTS) {
+    target = phySelectProfile(current, gWorstSnrDb);
+  } else if ((gSnrSamples == 0U) && (current != PHY_PROFILE_DEFAULT)) {
+    // Nobody heard on this profile: return to where lost nodes fall back to.
+    target = PHY_PROFILE_DEFAULT;
+  }
+  logEvent3("PHYEV", gWorstSnrDb, gSnrSamples);
+  resetSnrWindow();
+
+  if (target != current) {
+    scheduleSwitch(target, nowMs + PHY_SWITCH_LEAD_MS);
+    logEvent3("PHYPLAN", current, target);
+  }
+}
+
+codec::PhySwitch phyBeaconState(uint32_t nowMs) {
+  codec::PhySwitch phy{};
+  phy.active = radioProfileId();
+  phy.target = phy.active;
+  phy.switchInMs = 0U;
+  if (gSwitchPending) {
+    phy.target = gSwitchTarget;
+    phy.switchInMs = timeReached(nowMs, gSwitchAtMs) ? 0U : static_cast<uint16_t>(gSwitchAtMs - nowMs);
+  }
+  return phy;
+}
+
+uint16_t phySwitchInMs(uint8_t target, uint32_t nowMs) {
+  if (!gSwitchPending || (gSwitchTarget != target) || timeReached(nowMs, gSwitchAtMs)) {
+    return 0U;
+  }
+  return static_cast<uint16_t>(gSwitchAtMs - nowMs);
+}
+
+void phyOnBeacon(const codec::PhySwitch& phy, uint32_t nowMs) {
+  if ((phy.active >= PHY_PROFILE_COUNT) || (phy.target >= PHY_PROFILE_COUNT)) {
+    return;
+  }
+  gBeaconSeen = true;
+  gLastBeaconMs = nowMs;
+
+  // Heard on a profile other than the active one: a rescue beacon sent on
+  // the default profile. Rejoin the network right away.
+  if (phy.active != radioProfileId()) {
+    if (radioApplyProfile(phy.active)) {
+      logEvent2("PHYJOIN", phy.active);
+    }
+  }
+
+  if (phy.target == phy.active) {
+    gSwitchPending = false;
+  } else {
+    scheduleSwitch(phy.target, nowMs + phy.switchInMs);
+  }
+}
+
+void phyTick(uint32_t nowMs) {
+  if (gSwitchPending && timeReached(nowMs, gSwitchAtMs)) {
+    gSwitchPending = false;
+    if (radioApplyProfile(gSwitchTarget)) {
+      logEvent2("PHYSW", gSwitchTarget);
+      // SNR seen on the old profile says little about the new one.
+      resetSnrWindow();
+      gLastEvalMs = nowMs;
+    }
+  }
+
+  if constexpr (!IS_GATEWAY) {
+    if (gBeaconSeen && ((nowMs - gLastBeaconMs) >= GW_TIMEOUT_MS)) {
+      gBeaconSeen = false;
+      gSwitchPending = false;
+      if ((radioProfileId() != PHY_PROFILE_DEFAULT) && radioApplyProfile(PHY_PROFILE_DEFAULT)) {
+        logEvent2("PHYFB", PHY_PROFILE_DEFAULT);
+      }
+    }
+  }
+}
@@ -0,0 +1,37 @@
+#ifndef PHY_H
+#define PHY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "frame_codec.h"
+
+// Network-wide PHY profile coordination (profiles: PHY_PROFILES in config.h).
+// Gateway: tracks the worst REPORT SNR, picks a profile every
+// PHY_EVAL_PERIOD_MS and announces the switch PHY_SWITCH_LEAD_MS ahead.
+// Node: follows beacon announcements and falls back to PHY_PROFILE_DEFAULT
+// after GW_TIMEOUT_MS without a beacon.
+
+void phyInit();
+
+// Semtech LoRa time on air (8-symbol preamble, explicit header, CRC on).
+uint32_t phyAirtimeMs(const PhyProfile& profile, uint8_t len);
+
+// Fastest profile whose predicted worst-link SNR clears its demod floor.
+uint8_t phySelectProfile(uint8_t current, int8_t worstSnrDb);
+
+void phyObserveReportSnr(int8_t snrDb);
+void phyEvaluate(uint32_t nowMs);
+codec::PhySwitch phyBeaconState(uint32_t nowMs);
+// Time left until the pending switch to `target`, for a beacon about to go
+// on air; 0 when none is pending or it is due. Every hop restamps it, so
+// queueing and backoff along the path do not delay the switch downstream.
+uint16_t phySwitchInMs(uint8_t target, uint32_t nowMs);
+
+void phyOnBeacon(const codec::PhySwitch& phy, uint32_t nowMs);
+
+// Applies a due switch and the node-side fallback; call every tick.
+void phyTick(uint32_t nowMs);
+
+#endif  // PHY_H
@@ -2,10 +2,11 @@
 
 #include <Arduino.h>
 #include <SPI.h>
-#include <SX126XLT.h>
+#include <string.h>
 
 #include "config.h"
 #include "log.h"
+#include "sx126x.h"
 
 namespace {
 
@@ -13,96 +14,28 @@ int16_t gLastRssi = 0;
 int8_t gLastSnr = 0;
 bool gRadioReady = false;
 uint8_t gLastCode = 0;
-SX126XLT gLt;
-
-constexpr uint32_t RADIO_BUSY_TIMEOUT_MS = 10UL;
-constexpr uint32_t RADIO_RX_CONT_TIMEOUT = 0x00FFFFFFUL;
-
-uint8_t mapBwHzToLib(uint32_t bwHz) {
-  switch (bwHz) {
-    case 125000UL:
-      return LORA_BW_125;
-    case 250000UL:
-      return LORA_BW_250;
-    case 500000UL:
-      return LORA_BW_500;
-    default:
-      return LORA_BW_125;
-  }
-}
-
-uint8_t mapSfToLib(uint8_t sf) {
-  switch (sf) {
-    case 5:
-      return LORA_SF5;
-    case 6:
-      return LORA_SF6;
-    case 7:
-      return LORA_SF7;
-    case 8:
-      return LORA_SF8;
-    case 9:
-      return LORA_SF9;
-    case 10:
-      return LORA_SF10;
-    case 11:
-      return LORA_SF11;
-    case 12:
-      return LORA_SF12;
-    default:
-      return LORA_SF9;
-  }
-}
+uint8_t gProfileId = PHY_PROFILE_DEFAULT;
+uint8_t gSpiBuf[255];
 
-bool mapCrToLib(uint8_t cr, uint8_t* libCr) {
-  switch (cr) {
-    case 5:
-      *libCr = LORA_CR_4_5;
-      return true;
-    case 6:
-      *libCr = LORA_CR_4_6;
-      return true;
-    case 7:
-      *libCr = LORA_CR_4_7;
-      return true;
-    case 8:
-      *libCr = LORA_CR_4_8;
-      return true;
-    default:
-      return false;
-  }
-}
+const SPISettings RADIO_SPI(RADIO_SPI_HZ, MSBFIRST, SPI_MODE0);
+constexpr uint32_t RADIO_TX_TIMEOUT_MS = 3000UL;
 
-bool waitBusyLow(uint32_t timeoutMs) {
-  const uint32_t t0 = millis();
-  while (digitalRead(CFG_PIN_BUSY) == HIGH) {
-    if ((millis() - t0) >= timeoutMs) {
-      return false;
-    }
-  }
-  return true;
-}
-
-uint8_t readStatusByte() {
-  SPI.beginTransaction(SPISettings(1000000UL, MSBFIRST, SPI_MODE0));
-  digitalWrite(CFG_PIN_NSS, LOW);
-  SPI.transfer(0xC0);  // SX126x GetStatus opcode.
-  const uint8_t status = SPI.transfer(0x00);
-  digitalWrite(CFG_PIN_NSS, HIGH);
-  SPI.endTransaction();
-  return status;
+void rfSwitchTx(bool tx) {
+  digitalWrite(CFG_PIN_TXEN, tx ? HIGH : LOW);
+  digitalWrite(CFG_PIN_RXEN, tx ? LOW : HIGH);
 }
 
 bool radioSelfTest(uint8_t* outVal) {
-  if (!waitBusyLow(RADIO_BUSY_TIMEOUT_MS)) {
+  uint8_t v1 = 0;
+  uint8_t v2 = 0;
+  uint8_t v3 = 0;
+  if (!sx126xGetStatus(v1)) {
     return false;
   }
-
-  const uint8_t v1 = readStatusByte();
   delay(2);
-  const uint8_t v2 = readStatusByte();
+  (void)sx126xGetStatus(v2);
   delay(2);
-  const uint8_t v3 = readStatusByte();
+  (void)sx126xGetStatus(v3);
 
   const bool stable = (v1 == v2) && (v2 == v3);
   const bool valid = (v1 != 0x00) && (v1 != 0xFF);
@@ -114,37 +47,61 @@ bool radioSelfTest(uint8_t* outVal) {
   return false;
 }
 
-bool applyLoRaProfile() {
-  const uint8_t sfLib = mapSfToLib(LORA_SF);
-  const uint8_t bwLib = mapBwHzToLib(LORA_BW_HZ);
-
-  uint8_t crLib = 0;
-  uint8_t crApplied = LORA_CR;
+bool applyLoRaProfile(const PhyProfile& profile) {
+  uint8_t crApplied = profile.cr;
   bool useFallback = false;
-
-  if (!mapCrToLib(LORA_CR, &crLib)) {
-    if (!mapCrToLib(LORA_CR_FALLBACK, &crLib)) {
-      return false;
-    }
+  if ((profile.cr < 5U) || (profile.cr > 8U)) {
     crApplied = LORA_CR_FALLBACK;
     useFallback = true;
   }
 
-  gLt.setupLoRa(LORA_FREQ_HZ, 0, sfLib, bwLib, crLib, LDRO_AUTO);
-  gLt.setTxParams(LORA_TX_POWER_DBM, RADIO_RAMP_40_US);
+  if (!sx126xSetModem(profile.sf, profile.bwHz, crApplied, profile.txPowerDbm)) {
+    return false;
+  }
 
-  logEvent3("RPHY", LORA_SF, static_cast<int32_t>(LORA_BW_HZ));
+  logEvent3("RPHY", profile.sf, static_cast<int32_t>(profile.bwHz));
   logEvent2("RCR", crApplied);
   if (useFallback) {
     logEvent2("RCRF", LORA_CR_FALLBACK);
   }
-  logEvent2("RPWR", LORA_TX_POWER_DBM);
+  logEvent2("RPWR", profile.txPowerDbm);
 
   return true;
 }
 
 }  // namespace
 
+bool sx126xBusWaitReady(uint32_t timeoutMs) {
+  const uint32_t t0 = millis();
+  while (digitalRead(CFG_PIN_BUSY) == HIGH) {
+    if ((millis() - t0) >= timeoutMs) {
+      return false;
+    }
+    yield();
+  }
+  return true;
+}
+
+// Command bytes and payload go out as two block transfers. The STM32 core
+// transfers in place, so both are staged in gSpiBuf.
+void sx126xBusCommand(const uint8_t* cmd, uint8_t cmdLen, const uint8_t* tx, uint8_t* rx, uint8_t len) {
+  SPI.beginTransaction(RADIO_SPI);
+  digitalWrite(CFG_PIN_NSS, LOW);
+  memcpy(gSpiBuf, cmd, cmdLen);
+  SPI.transfer(gSpiBuf, cmdLen);
+  if (len > 0U) {
+    if (tx != nullptr) {
+      memcpy(gSpiBuf, tx, len);
+      SPI.transfer(gSpiBuf, len);
+    } else {
+      memset(rx, 0, len);
+      SPI.transfer(rx, len);
+    }
+  }
+  digitalWrite(CFG_PIN_NSS, HIGH);
+  SPI.endTransaction();
+}
+
 bool radioInit() {
   pinMode(CFG_PIN_NSS, OUTPUT);
   digitalWrite(CFG_PIN_NSS, HIGH);
@@ -178,16 +135,15 @@ bool radioInit() {
     return false;
   }
 
-  const bool beginOk = gLt.begin(
-      CFG_PIN_NSS, CFG_PIN_RESET, CFG_PIN_BUSY, CFG_PIN_DIO1, CFG_PIN_RXEN, CFG_PIN_TXEN, DEVICE_SX1268);
-  if (!beginOk) {
+  if (!sx126xSetup(LORA_FREQ_HZ, RADIO_TCXO, LORA_SYNC_WORD)) {
     gRadioReady = false;
     gLastCode = 2;
     logEvent2("RINIT FAIL", 2);
     return false;
   }
 
-  if (!applyLoRaProfile()) {
+  gProfileId = PHY_PROFILE_DEFAULT;
+  if (!applyLoRaProfile(PHY_PROFILES[gProfileId])) {
     gRadioReady = false;
     gLastCode = 3;
     logEvent2("RINIT FAIL", 3);
@@ -214,18 +170,23 @@ bool radioSend(const uint8_t* data, uint8_t len) {
     return false;
   }
 
-  const uint8_t sent = gLt.transmit(const_cast<uint8_t*>(data), len, 3000UL, LORA_TX_POWER_DBM, WAIT_TX);
-  if (sent == len) {
+  rfSwitchTx(true);
+  if (!sx126xStartTx(data, len, RADIO_TX_TIMEOUT_MS)) {
+    gLastCode = 12;
+    return false;
+  }
+  // DIO1 rises on TX_DONE or the chip's own timeout; the local one only
+  // guards against a dead DIO1 line.
+  const uint32_t t0 = millis();
+  while ((digitalRead(CFG_PIN_DIO1) == LOW) && ((millis() - t0) < (RADIO_TX_TIMEOUT_MS + 100UL))) {
+    yield();
+  }
+  uint16_t irq = 0U;
+  if (sx126xIrqStatus(irq) && ((irq & SX126X_IRQ_TX_DONE) != 0U)) {
     gLastCode = 0;
     return true;
   }
-
-  const uint16_t irq = gLt.readIrqStatus();
-  if ((irq & IRQ_RX_TX_TIMEOUT) != 0U) {
-    gLastCode = 11;
-  } else {
-    gLastCode = 12;
-  }
+  gLastCode = ((irq & SX126X_IRQ_TIMEOUT) != 0U) ? 11 : 12;
   return false;
 }
 
@@ -236,10 +197,14 @@ bool radioStartRx() {
     return false;
   }
 
-  gLt.clearIrqStatus(IRQ_RADIO_ALL);
-  gLt.setRx(RADIO_RX_CONT_TIMEOUT);
+  rfSwitchTx(false);
+  if (!sx126xStartRx()) {
+    gLastCode = 21;
+    logEvent("RRX FAIL");
+    return false;
+  }
   gLastCode = 0;
-  logEvent("RRX ON");
+  logFrameEvent("RRX ON");
   return true;
 }
 
@@ -256,33 +221,60 @@ uint8_t radioRead(uint8_t* out, uint8_t maxLen) {
     return 0;
   }
 
-  const uint16_t irq = gLt.readIrqStatus();
-  const uint16_t rxErrMask = IRQ_HEADER_ERROR | IRQ_CRC_ERROR | IRQ_RX_TX_TIMEOUT;
+  // DIO1 carries every RX outcome, so idle ticks cost no SPI traffic.
+  if (digitalRead(CFG_PIN_DIO1) == LOW) {
+    return 0;
+  }
+  uint16_t irq = 0U;
+  if (!sx126xIrqStatus(irq)) {
+    gLastCode = 32;
+    return 0;
+  }
+  const uint16_t rxErrMask = SX126X_IRQ_HEADER_ERR | SX126X_IRQ_CRC_ERR | SX126X_IRQ_TIMEOUT;
 
+  // Continuous RX stays in RX after RX_DONE and errors; only the IRQs need
+  // clearing.
   if ((irq & rxErrMask) != 0U) {
     gLastCode = 31;
-    gLt.clearIrqStatus(IRQ_RADIO_ALL);
-    if (RADIO_RX_CONTINUOUS) {
-      gLt.setRx(RADIO_RX_CONT_TIMEOUT);
-    }
+    (void)sx126xClearIrq(SX126X_IRQ_ALL);
     return 0;
   }
 
-  if ((irq & IRQ_RX_DONE) == 0U) {
+  if ((irq & SX126X_IRQ_RX_DONE) == 0U) {
     return 0;
   }
 
-  const uint8_t rxLen = gLt.readPacket(out, maxLen);
-  gLastRssi = gLt.readPacketRSSI();
-  gLastSnr = gLt.readPacketSNR();
-  gLt.clearIrqStatus(IRQ_RADIO_ALL);
-  if (RADIO_RX_CONTINUOUS) {
-    gLt.setRx(RADIO_RX_CONT_TIMEOUT);
-  }
+  const uint8_t rxLen = sx126xReadPacket(out, maxLen, gLastRssi, gLastSnr);
+  (void)sx126xClearIrq(SX126X_IRQ_ALL);
   gLastCode = 0;
   return rxLen;
 }
 
+bool radioApplyProfile(uint8_t profileId) {
+  if (!gRadioReady || (profileId >= PHY_PROFILE_COUNT)) {
+    gLastCode = 40;
+    return false;
+  }
+  if (profileId == gProfileId) {
+    return true;
+  }
+  // sx126xSetModem() drops the modem to standby first, so this is safe mid-RX.
+  if (!applyLoRaProfile(PHY_PROFILES[profileId])) {
+    gLastCode = 41;
+    return false;
+  }
+  gProfileId = profileId;
+  gLastCode = 0;
+  if (RADIO_RX_CONTINUOUS) {
+    return radioStartRx();
+  }
+  return true;
+}
+
+uint8_t radioProfileId() {
+  return gProfileId;
+}
+
 uint8_t radioLastCode() {
   return gLastCode;
 }
@@ -12,5 +12,8 @@ uint8_t radioRead(uint8_t* out, uint8_t maxLen);
 int16_t radioLastRssi();
 int8_t radioLastSnr();
 uint8_t radioLastCode();
+// Reconfigures modem and TX power to PHY_PROFILES[profileId]; RX resumes.
+bool radioApplyProfile(uint8_t profileId);
+uint8_t radioProfileId();
 
 #endif  // RADIO_H
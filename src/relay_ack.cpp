@@ -0,0 +1,184 @@
+#include "relay_ack.h"
+
+#include "config.h"
+#include "frame.h"
+#include "mesh_params.h"
+#include "phy.h"
+#include "radio.h"
+#include "tdma.h"
+
+namespace {
+
+struct AckEntry {
+  bool used = false;
+  bool waiting = false;  // False while a re-send sits in a queue.
+  bool acked = false;    // Kept so a re-send still queued is not tracked again.
+  uint8_t src = 0U;
+  uint16_t seq = 0U;
+  uint8_t hops = 0U;
+  uint8_t retries = 0U;
+  uint32_t deadlineMs = 0UL;
+  uint8_t len = 0U;
+  uint8_t data[RELAY_ACK_FRAME_MAX] = {};
+};
+
+AckEntry gAck[RELAY_ACK_SLOTS];
+uint8_t gAckNext = 0U;
+uint32_t gHeard = 0UL;
+uint32_t gRetries = 0UL;
+uint32_t gGaveUp = 0UL;
+bool gPeeked = false;
+uint8_t gPeekSlot = 0U;
+
+// A neighbour hears the frame when our TX ends, backs off and sends its
+// copy; while synced it may also wait for the contention period.
+uint32_t ackTimeoutMs(uint8_t len, uint32_t nowMs) {
+  uint32_t waitMs = meshParams().backoffMaxMs + phyAirtimeMs(PHY_PROFILES[radioProfileId()], len) + RELAY_ACK_MARGIN_MS;
+  if (tdmaSynced(nowMs)) {
+    waitMs += tdmaSlotMs() * (TDMA_SLOTS + TDMA_CONTENTION_SLOTS);
+  }
+  return waitMs;
+}
+
+AckEntry* findEntry(uint8_t src, uint16_t seq) {
+  for (uint8_t i = 0U; i < RELAY_ACK_SLOTS; ++i) {
+    if (gAck[i].used && (gAck[i].src == src) && (gAck[i].seq == seq)) {
+      return &gAck[i];
+    }
+  }
+  return nullptr;
+}
+
+// Free or acknowledged slot first, else round-robin: the oldest entry is
+// closest to giving up.
+AckEntry& allocEntry() {
+  for (uint8_t i = 0U; i < RELAY_ACK_SLOTS; ++i) {
+    if (!gAck[i].used || gAck[i].acked) {
+      return gAck[i];
+    }
+  }
+  AckEntry& e = gAck[gAckNext];
+  gAckNext = static_cast<uint8_t>((gAckNext + 1U) % RELAY_ACK_SLOTS);
+  return e;
+}
+
+}  // namespace
+
+void relayAckInit() {
+  for (uint8_t i = 0U; i < RELAY_ACK_SLOTS; ++i) {
+    gAck[i].used = false;
+  }
+  gAckNext = 0U;
+  gHeard = 0UL;
+  gRetries = 0UL;
+  gGaveUp = 0UL;
+  gPeeked = false;
+}
+
+void relayAckOnSent(const uint8_t* frame, uint8_t len, uint32_t nowMs) {
+  // The gateway is the end of every REPORT's path.
+  if (!RELAY_ACK_ENABLED || IS_GATEWAY || (len > RELAY_ACK_FRAME_MAX)) {
+    return;
+  }
+  codec::FrameView view;
+  if (!view.init(frame, len) || (view.type() != codec::REPORT_TYPE) || view.noRelay() || (view.ttl() == 0U)) {
+    return;
+  }
+  AckEntry* e = findEntry(view.src(), view.seq());
+  if ((e != nullptr) && e->acked) {
+    return;
+  }
+  if (e == nullptr) {
+    e = &allocEntry();
+    e->used = true;
+    e->acked = false;
+    e->src = view.src();
+    e->seq = view.seq();
+    e->hops = view.hops();
+    e->retries = 0U;
+    e->len = len;
+    for (uint8_t i = 0U; i < len; ++i) {
+      e->data[i] = frame[i];
+    }
+  }
+  e->waiting = true;
+  e->deadlineMs = nowMs + ackTimeoutMs(len, nowMs);
+}
+
+void relayAckOnHeard(const codec::FrameView& view) {
+  if (!RELAY_ACK_ENABLED || IS_GATEWAY) {
+    return;
+  }
+  AckEntry* e = findEntry(view.src(), view.seq());
+  // Only a copy from further down the path counts; CRC and tag are checked
+  // last because almost nothing matches. Without the tag a forged copy would
+  // cancel the re-sends of a REPORT nobody relayed.
+  if ((e == nullptr) || e->acked || (view.hops() <= e->hops) || !view.crcOk() ||
+      (AUTH_ENABLED && !frameAuthOk(view))) {
+    return;
+  }
+  e->acked = true;
+  e->waiting = false;
+  ++gHeard;
+}
+
+uint8_t relayAckPeekDue(uint32_t nowMs, uint8_t* out, uint8_t outMax) {
+  gPeeked = false;
+  for (uint8_t i = 0U; i < RELAY_ACK_SLOTS; ++i) {
+    AckEntry& e = gAck[i];
+    if (!e.used || e.acked || !e.waiting || (static_cast<int32_t>(nowMs - e.deadlineMs) < 0)) {
+      continue;
+    }
+    if ((e.retries >= RELAY_ACK_RETRIES) || (e.len > outMax)) {
+      e.used = false;
+      ++gGaveUp;
+      continue;
+    }
+    gPeeked = true;
+    gPeekSlot = i;
+    for (uint8_t j = 0U; j < e.len; ++j) {
+      out[j] = e.data[j];
+    }
+    return e.len;
+  }
+  return 0U;
+}
+
+void relayAckResendResult(RelayAckResend result, uint32_t nowMs) {
+  if (!gPeeked) {
+    return;
+  }
+  gPeeked = false;
+  AckEntry& e = gAck[gPeekSlot];
+  switch (result) {
+    case RelayAckResend::Queued:
+      ++e.retries;
+      ++gRetries;
+      e.waiting = false;
+      break;
+    case RelayAckResend::Dropped:
+      e.used = false;
+      ++gGaveUp;
+      break;
+    case RelayAckResend::NoRoom:
+      e.deadlineMs = nowMs + ackTimeoutMs(e.len, nowMs);
+      break;
+  }
+}
+
+bool relayAckDone(uint8_t src, uint16_t seq) {
+  const AckEntry* e = findEntry(src, seq);
+  return (e != nullptr) && e->acked;
+}
+
+uint32_t relayAckHeard() {
+  return gHeard;
+}
+
+uint32_t relayAckRetries() {
+  return gRetries;
+}
+
+uint32_t relayAckGaveUp() {
+  return gGaveUp;
+}
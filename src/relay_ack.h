@@ -0,0 +1,42 @@
+#ifndef RELAY_ACK_H
+#define RELAY_ACK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "frame_codec.h"
+
+// Passive hop-by-hop ACK (RELAY_ACK_ENABLED, tuning: "Relay ACK" in
+// config.h). Every REPORT this node sends, own or relayed, is kept until a
+// neighbour is overheard relaying the same (src, seq) with more HOPS. Without
+// that it is handed back for another send, at most RELAY_ACK_RETRIES times.
+// Frames that cannot be relayed (NO_RELAY, TTL 0) are never tracked.
+
+constexpr uint8_t RELAY_ACK_FRAME_MAX = 64U;
+
+void relayAckInit();
+
+// `frame` just went on air. A re-send of a tracked frame re-arms its timeout.
+void relayAckOnSent(const uint8_t* frame, uint8_t len, uint32_t nowMs);
+// Any received frame of a known type, before self and dedup filtering.
+void relayAckOnHeard(const codec::FrameView& view);
+// Copies a frame whose timeout expired to `out`; 0 when none is due. Frames
+// out of retries are dropped here. The caller reports what became of the
+// copy through relayAckResendResult().
+uint8_t relayAckPeekDue(uint32_t nowMs, uint8_t* out, uint8_t outMax);
+
+enum class RelayAckResend : uint8_t {
+  Queued,   // Counts a retry; the timeout re-arms once it is on air.
+  Dropped,  // Superseded or unusable: released and counted as given up.
+  NoRoom,   // Queue or forward budget refused it: due again after a timeout.
+};
+void relayAckResendResult(RelayAckResend result, uint32_t nowMs);
+
+// A neighbour already relayed this frame; a queued re-send can be dropped.
+bool relayAckDone(uint8_t src, uint16_t seq);
+
+uint32_t relayAckHeard();
+uint32_t relayAckRetries();
+uint32_t relayAckGaveUp();
+
+#endif  // RELAY_ACK_H
@@ -0,0 +1,223 @@
+#include "report_ack.h"
+
+#include "config.h"
+
+namespace {
+
+constexpr uint8_t ACK_WINDOW = 8U;  // Seqs below the highest covered by the bitmap.
+
+struct SourceEntry {
+  bool used = false;
+  uint8_t src = 0U;
+  uint16_t highestSeq = 0U;
+  uint8_t seqBits = 16U;
+  uint8_t bitmap = 0U;
+  uint8_t announce = 0U;  // Beacons still to carry this entry.
+};
+
+struct RetxEntry {
+  bool used = false;
+  bool missing = false;  // Gateway lacks it; waiting for a queued re-send.
+  bool queued = false;   // Re-send handed out, not on air yet.
+  uint16_t seq = 0U;
+  uint8_t seqBits = 16U;
+  uint8_t retries = 0U;
+  uint8_t len = 0U;
+  uint8_t data[REPORT_RETX_FRAME_MAX] = {};
+};
+
+SourceEntry gSources[GW_ACK_SOURCES];
+uint8_t gSourceNext = 0U;
+uint8_t gFillNext = 0U;
+RetxEntry gRetx[REPORT_RETX_SLOTS];
+uint8_t gRetxNext = 0U;
+bool gPeeked = false;
+uint8_t gPeekSlot = 0U;
+uint32_t gConfirmed = 0UL;
+uint32_t gResent = 0UL;
+
+// Serial distance a - b in a seq space `bits` wide: compact headers carry
+// only the low 8 bits, so their seqs wrap at 256.
+int16_t seqDiff(uint16_t a, uint16_t b, uint8_t bits) {
+  const uint16_t d = static_cast<uint16_t>(a - b);
+  return (bits == 8U) ? static_cast<int16_t>(static_cast<int8_t>(static_cast<uint8_t>(d)))
+                      : static_cast<int16_t>(d);
+}
+
+SourceEntry& sourceEntry(uint8_t src) {
+  for (uint8_t i = 0U; i < GW_ACK_SOURCES; ++i) {
+    if (gSources[i].used && (gSources[i].src == src)) {
+      return gSources[i];
+    }
+  }
+  for (uint8_t i = 0U; i < GW_ACK_SOURCES; ++i) {
+    if (!gSources[i].used) {
+      return gSources[i];
+    }
+  }
+  SourceEntry& e = gSources[gSourceNext];
+  gSourceNext = static_cast<uint8_t>((gSourceNext + 1U) % GW_ACK_SOURCES);
+  e.used = false;
+  return e;
+}
+
+}  // namespace
+
+void reportAckInit() {
+  // Each role touches only its own table, so the other one is left out of
+  // its image.
+  if constexpr (IS_GATEWAY) {
+    for (uint8_t i = 0U; i < GW_ACK_SOURCES; ++i) {
+      gSources[i].used = false;
+    }
+  } else {
+    for (uint8_t i = 0U; i < REPORT_RETX_SLOTS; ++i) {
+      gRetx[i].used = false;
+    }
+  }
+  gSourceNext = 0U;
+  gFillNext = 0U;
+  gRetxNext = 0U;
+  gPeeked = false;
+  gConfirmed = 0UL;
+  gResent = 0UL;
+}
+
+void reportAckObserve(uint8_t src, uint16_t seq, uint8_t seqBits) {
+  SourceEntry& e = sourceEntry(src);
+  const int16_t d = (e.used && (e.seqBits == seqBits)) ? seqDiff(seq, e.highestSeq, seqBits) : 0;
+  if (!e.used || (e.seqBits != seqBits) || (d < -static_cast<int16_t>(ACK_WINDOW))) {
+    // New source, far behind, or a changed header format: the node restarted
+    // its sequence.
+    e.used = true;
+    e.src = src;
+    e.highestSeq = seq;
+    e.seqBits = seqBits;
+    e.bitmap = 0U;
+  } else if (d > 0) {
+    // The old highest becomes bit d-1; anything shifted past bit 7 is dropped.
+    uint16_t bits = 0U;
+    if (d <= static_cast<int16_t>(ACK_WINDOW)) {
+      bits = static_cast<uint16_t>((static_cast<uint16_t>(e.bitmap) << d) | (1U << (d - 1)));
+    }
+    e.bitmap = static_cast<uint8_t>(bits);
+    e.highestSeq = seq;
+  } else if (d < 0) {
+    e.bitmap = static_cast<uint8_t>(e.bitmap | (1U << (-d - 1)));
+  } else {
+    return;
+  }
+  e.announce = REPORT_ACK_REPEAT;
+}
+
+// Rotates the starting point so a busy network still gets every source out.
+void reportAckFill(codec::Beacon& beacon) {
+  beacon.ackCount = 0U;
+  for (uint8_t n = 0U; (n < GW_ACK_SOURCES) && (beacon.ackCount < codec::REPORT_ACK_MAX); ++n) {
+    SourceEntry& e = gSources[(gFillNext + n) % GW_ACK_SOURCES];
+    if (!e.used || (e.announce == 0U)) {
+      continue;
+    }
+    --e.announce;
+    codec::ReportAck& ack = beacon.acks[beacon.ackCount++];
+    ack.src = e.src;
+    ack.highestSeq = e.highestSeq;
+    ack.bitmap = e.bitmap;
+  }
+  gFillNext = static_cast<uint8_t>((gFillNext + 1U) % GW_ACK_SOURCES);
+}
+
+void reportAckOnSent(const uint8_t* frame, uint8_t len) {
+  if (!REPORT_ACK_ENABLED || IS_GATEWAY || (len > REPORT_RETX_FRAME_MAX)) {
+    return;
+  }
+  codec::FrameView view;
+  if (!view.init(frame, len) || (view.type() != codec::REPORT_TYPE) || (view.src() != NODE_ID)) {
+    return;
+  }
+  for (uint8_t i = 0U; i < REPORT_RETX_SLOTS; ++i) {
+    if (gRetx[i].used && (gRetx[i].seq == view.seq())) {
+      gRetx[i].queued = false;
+      return;
+    }
+  }
+  // The oldest entry is the first to leave the gateway's window anyway.
+  RetxEntry& e = gRetx[gRetxNext];
+  gRetxNext = static_cast<uint8_t>((gRetxNext + 1U) % REPORT_RETX_SLOTS);
+  e.used = true;
+  e.missing = false;
+  e.queued = false;
+  e.seq = view.seq();
+  e.seqBits = view.seqBits();
+  e.retries = 0U;
+  e.len = len;
+  for (uint8_t i = 0U; i < len; ++i) {
+    e.data[i] = frame[i];
+  }
+}
+
+void reportAckOnBeacon(const codec::Beacon& beacon) {
+  const codec::ReportAck* ack = codec::findReportAck(beacon, NODE_ID);
+  if (!REPORT_ACK_ENABLED || (ack == nullptr)) {
+    return;
+  }
+  for (uint8_t i = 0U; i < REPORT_RETX_SLOTS; ++i) {
+    RetxEntry& e = gRetx[i];
+    if (!e.used) {
+      continue;
+    }
+    const int16_t d = seqDiff(ack->highestSeq, e.seq, e.seqBits);
+    if (d < 0) {
+      continue;  // Sent after everything the gateway has heard of.
+    }
+    if ((d == 0) || ((d <= static_cast<int16_t>(ACK_WINDOW)) && ((ack->bitmap & (1U << (d - 1))) != 0U))) {
+      e.used = false;
+      ++gConfirmed;
+    } else if (d > static_cast<int16_t>(ACK_WINDOW)) {
+      e.used = false;
+    } else if (!e.queued) {
+      e.missing = true;
+    }
+  }
+}
+
+uint8_t reportAckPeekMissing(uint8_t* out, uint8_t outMax) {
+  gPeeked = false;
+  for (uint8_t i = 0U; i < REPORT_RETX_SLOTS; ++i) {
+    RetxEntry& e = gRetx[i];
+    if (!e.used || !e.missing) {
+      continue;
+    }
+    if ((e.retries >= REPORT_RETX_MAX) || (e.len > outMax)) {
+      e.used = false;
+      continue;
+    }
+    gPeeked = true;
+    gPeekSlot = i;
+    for (uint8_t j = 0U; j < e.len; ++j) {
+      out[j] = e.data[j];
+    }
+    return e.len;
+  }
+  return 0U;
+}
+
+void reportAckResendQueued() {
+  if (!gPeeked) {
+    return;
+  }
+  gPeeked = false;
+  RetxEntry& e = gRetx[gPeekSlot];
+  ++e.retries;
+  ++gResent;
+  e.missing = false;
+  e.queued = true;
+}
+
+uint32_t reportAckConfirmed() {
+  return gConfirmed;
+}
+
+uint32_t reportAckResent() {
+  return gResent;
+}
@@ -0,0 +1,39 @@
+#ifndef REPORT_ACK_H
+#define REPORT_ACK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "frame_codec.h"
+
+// End-to-end REPORT acknowledgement through beacons (REPORT_ACK_ENABLED,
+// tuning: "Report ACK" in config.h).
+// Gateway: keeps the highest REPORT seq and the 8 below it per source and
+// lists recently changed sources in its next beacons.
+// Node: keeps its last few single-frame REPORTs and re-sends the ones a
+// beacon shows the gateway missed.
+
+constexpr uint8_t REPORT_RETX_FRAME_MAX = 64U;
+
+void reportAckInit();
+
+// Gateway side.
+// `seqBits` is the SEQ width of the frame it came in (FrameView::seqBits()).
+void reportAckObserve(uint8_t src, uint16_t seq, uint8_t seqBits);
+void reportAckFill(codec::Beacon& beacon);
+
+// Node side. `frame` just went on air; own REPORTs are kept.
+void reportAckOnSent(const uint8_t* frame, uint8_t len);
+void reportAckOnBeacon(const codec::Beacon& beacon);
+// Copies one REPORT the gateway is missing to `out`; 0 when none. It stays
+// missing until reportAckResendQueued(), so a re-send that finds no room is
+// tried again. REPORTs out of retries are dropped here.
+uint8_t reportAckPeekMissing(uint8_t* out, uint8_t outMax);
+// The REPORT from the last reportAckPeekMissing() is queued: spends a retry
+// and counts a re-send.
+void reportAckResendQueued();
+
+uint32_t reportAckConfirmed();
+uint32_t reportAckResent();
+
+#endif  // REPORT_ACK_H
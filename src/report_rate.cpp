@@ -0,0 +1,131 @@
+#include "report_rate.h"
+
+#include "config.h"
+#include "mesh_params.h"
+
+namespace {
+
+constexpr uint32_t GW_EVAL_PERIOD_MS = 60000UL;
+
+FreqSet gReportedFreqs = {};
+uint8_t gReportedFlags = 0xFFU;
+bool gChangePending = true;  // Boot state is always worth one report.
+
+bool gStarted = false;
+uint32_t gPhaseMs = 0UL;
+uint32_t gLastReportMs = 0UL;
+uint32_t gNextHeartbeatMs = 0UL;
+uint32_t gHeartbeatMs = REPORT_STATUS_PERIOD_MS;
+uint8_t gSlowdown = 0U;
+uint8_t gCongestion = 0U;
+
+uint16_t gGwReportsInWindow = 0U;
+uint32_t gGwWindowStartMs = 0UL;
+
+uint32_t statusPeriodMs() {
+  return static_cast<uint32_t>(meshParams().reportStatusPeriodS) * 1000UL;
+}
+
+uint8_t effectiveShift() {
+  return (gCongestion > gSlowdown) ? gCongestion : gSlowdown;
+}
+
+bool timeReached(uint32_t nowMs, uint32_t deadlineMs) {
+  return static_cast<int32_t>(nowMs - deadlineMs) >= 0;
+}
+
+uint32_t jitterMs() {
+  return static_cast<uint32_t>(random(static_cast<long>(REPORT_JITTER_MS + 1UL)));
+}
+
+}  // namespace
+
+void reportRateInit(uint8_t nodeId) {
+  // Fibonacci hashing spreads consecutive node ids evenly over one period.
+  const uint32_t frac = (static_cast<uint32_t>(nodeId) * 40503UL) & 0xFFFFUL;
+  gPhaseMs = (statusPeriodMs() * frac) >> 16;
+  gStarted = false;
+  gChangePending = true;
+  freqSetClear(gReportedFreqs);
+  gReportedFlags = 0xFFU;
+  gHeartbeatMs = statusPeriodMs();
+  gSlowdown = 0U;
+  gCongestion = 0U;
+}
+
+void reportRateNoteFreqSet(const FreqSet& freqs) {
+  if (!freqSetEqual(freqs, gReportedFreqs)) {
+    gChangePending = true;
+  }
+}
+
+void reportRateNoteFlags(uint8_t statusFlags) {
+  if (statusFlags != gReportedFlags) {
+    gChangePending = true;
+  }
+}
+
+bool reportRateDue(uint32_t nowMs) {
+  if (!gStarted) {
+    gStarted = true;
+    // The boot report itself waits for the phase; later reports follow it.
+    gLastReportMs = nowMs + gPhaseMs - (REPORT_MIN_GAP_MS << effectiveShift());
+    gNextHeartbeatMs = nowMs + gPhaseMs;
+  }
+  if (gChangePending && timeReached(nowMs, gLastReportMs + (REPORT_MIN_GAP_MS << effectiveShift()))) {
+    return true;
+  }
+  return timeReached(nowMs, gNextHeartbeatMs);
+}
+
+void reportRateOnReported(const FreqSet& freqs, uint8_t statusFlags, uint32_t nowMs) {
+  if (gChangePending) {
+    gHeartbeatMs = statusPeriodMs();
+  } else if (gHeartbeatMs < REPORT_STATUS_PERIOD_MAX_MS) {
+    gHeartbeatMs = ((gHeartbeatMs * 2UL) < REPORT_STATUS_PERIOD_MAX_MS) ? (gHeartbeatMs * 2UL)
+                                                                         : REPORT_STATUS_PERIOD_MAX_MS;
+  }
+  gChangePending = false;
+  gLastReportMs = nowMs;
+  gNextHeartbeatMs = nowMs + (gHeartbeatMs << effectiveShift()) + jitterMs();
+
+  gReportedFreqs = freqs;
+  gReportedFlags = statusFlags;
+}
+
+void reportRateSetSlowdown(uint8_t shift) {
+  gSlowdown = (shift < REPORT_SLOWDOWN_MAX) ? shift : REPORT_SLOWDOWN_MAX;
+}
+
+uint8_t reportRateSlowdown() {
+  return gSlowdown;
+}
+
+void reportRateSetCongestion(uint8_t shift) {
+  gCongestion = (shift < REPORT_SLOWDOWN_MAX) ? shift : REPORT_SLOWDOWN_MAX;
+}
+
+uint32_t reportRateHeartbeatMs() {
+  return gHeartbeatMs << effectiveShift();
+}
+
+void reportRateObserveReport() {
+  if (gGwReportsInWindow < 0xFFFFU) {
+    ++gGwReportsInWindow;
+  }
+}
+
+uint8_t reportRateEvaluate(uint32_t nowMs) {
+  if ((nowMs - gGwWindowStartMs) < GW_EVAL_PERIOD_MS) {
+    return gSlowdown;
+  }
+  // One step per window either way; the half-budget dead band avoids flapping.
+  if ((gGwReportsInWindow > GW_REPORT_BUDGET_PER_MIN) && (gSlowdown < REPORT_SLOWDOWN_MAX)) {
+    ++gSlowdown;
+  } else if ((gGwReportsInWindow < (GW_REPORT_BUDGET_PER_MIN / 2U)) && (gSlowdown > 0U)) {
+    --gSlowdown;
+  }
+  gGwWindowStartMs = nowMs;
+  gGwReportsInWindow = 0U;
+  return gSlowdown;
+}
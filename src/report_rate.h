@@ -0,0 +1,37 @@
+#ifndef REPORT_RATE_H
+#define REPORT_RATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "freq_set.h"
+
+// Own REPORT rate controller (tuning: "Report rate" in config.h).
+// Emits on a real state change (frequency set difference or status flags),
+// never closer than the minimum gap, plus an exponentially backed-off
+// heartbeat. The boot report is phase-shifted by NODE_ID so nodes that
+// boot together do not report together.
+
+void reportRateInit(uint8_t nodeId);
+
+// Marks a change when `freqs` differs from the last reported set.
+void reportRateNoteFreqSet(const FreqSet& freqs);
+// Marks a change when status flags differ from the last reported ones.
+void reportRateNoteFlags(uint8_t statusFlags);
+
+bool reportRateDue(uint32_t nowMs);
+// The REPORT carrying this state is queued; rearms gap and heartbeat.
+void reportRateOnReported(const FreqSet& freqs, uint8_t statusFlags, uint32_t nowMs);
+
+void reportRateSetSlowdown(uint8_t shift);
+uint8_t reportRateSlowdown();
+// Slowdown asked for by congested neighbours; the larger of it and the
+// gateway's applies.
+void reportRateSetCongestion(uint8_t shift);
+uint32_t reportRateHeartbeatMs();
+
+// Gateway side: counts REPORTs heard and picks the slowdown to announce.
+void reportRateObserveReport();
+uint8_t reportRateEvaluate(uint32_t nowMs);
+
+#endif  // REPORT_RATE_H
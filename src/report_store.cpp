@@ -0,0 +1,289 @@
+#include "report_store.h"
+
+#include "board.h"
+#include "config.h"
+#include "frame_codec.h"
+
+namespace {
+
+constexpr uint16_t PAGE_MAGIC = 0x5346U;  // "SF"
+constexpr uint16_t PAGE_HEADER_LEN = 4U;  // magic, page seq
+constexpr uint16_t RECORD_OVERHEAD = 4U;  // len/~len, done half-word
+constexpr uint16_t RECORD_LIVE = 0xFFFFU;
+
+bool gEnabled = false;  // STORE_FORWARD_ENABLED and the pages are clear of the image.
+bool gHeadOpen = false;
+uint8_t gHeadPage = 0U;
+uint16_t gHeadOffset = 0U;
+uint16_t gPageSeq = 0U;
+bool gPeeked = false;
+uint8_t gPeekPage = 0U;
+uint16_t gPeekOffset = 0U;
+uint8_t gPeekLen = 0U;
+bool gGatewaySeen = false;
+uint32_t gLastBeaconMs = 0UL;
+uint16_t gPending = 0U;
+uint32_t gWritten = 0UL;
+uint32_t gDrained = 0UL;
+uint32_t gDropped = 0UL;
+uint32_t gSuperseded = 0UL;
+
+uint16_t flashU16(uint8_t page, uint16_t offset) {
+  uint8_t b[2];
+  boardFlashRead(page, offset, b, 2U);
+  return static_cast<uint16_t>(b[0] | (b[1] << 8));
+}
+
+uint16_t padded(uint8_t len) {
+  return static_cast<uint16_t>((len + 1U) & ~1U);
+}
+
+uint16_t recordSize(uint8_t len) {
+  return static_cast<uint16_t>(RECORD_OVERHEAD + padded(len));
+}
+
+bool pageSeq(uint8_t page, uint16_t& seq) {
+  if (flashU16(page, 0U) != PAGE_MAGIC) {
+    return false;
+  }
+  seq = flashU16(page, 2U);
+  return true;
+}
+
+// Frame length of the record at `offset`; 0 where the page's records end.
+uint8_t recordLen(uint8_t page, uint16_t offset) {
+  if ((offset + RECORD_OVERHEAD) > STORE_PAGE_SIZE) {
+    return 0U;
+  }
+  const uint16_t head = flashU16(page, offset);
+  const uint8_t len = static_cast<uint8_t>(head & 0xFFU);
+  if ((len == 0U) || (static_cast<uint8_t>(head >> 8) != static_cast<uint8_t>(~len)) ||
+      ((offset + recordSize(len)) > STORE_PAGE_SIZE)) {
+    return 0U;
+  }
+  return len;
+}
+
+bool recordLive(uint8_t page, uint16_t offset, uint8_t len) {
+  return flashU16(page, static_cast<uint16_t>(offset + 2U + padded(len))) == RECORD_LIVE;
+}
+
+void retire(uint8_t page, uint16_t offset, uint8_t len) {
+  const uint8_t zero[2] = {0U, 0U};
+  (void)boardFlashWrite(page, static_cast<uint16_t>(offset + 2U + padded(len)), zero, 2U);
+  if (gPending > 0U) {
+    --gPending;
+  }
+  if (gPeeked && (gPeekPage == page) && (gPeekOffset == offset)) {
+    gPeeked = false;
+  }
+}
+
+// Visits live records oldest first: the pages after the head, then the head.
+// `fn(page, offset, len)` returns false to stop.
+template <typename Fn>
+void forEachLive(Fn fn) {
+  if (!gHeadOpen) {
+    return;
+  }
+  for (uint8_t n = 1U; n <= STORE_PAGES; ++n) {
+    const uint8_t page = static_cast<uint8_t>((gHeadPage + n) % STORE_PAGES);
+    uint16_t seq = 0U;
+    if (!pageSeq(page, seq)) {
+      continue;
+    }
+    uint16_t offset = PAGE_HEADER_LEN;
+    uint8_t len = 0U;
+    while ((len = recordLen(page, offset)) > 0U) {
+      if (recordLive(page, offset, len) && !fn(page, offset, len)) {
+        return;
+      }
+      offset = static_cast<uint16_t>(offset + recordSize(len));
+    }
+  }
+}
+
+uint16_t countLive(uint8_t page) {
+  uint16_t live = 0U;
+  uint16_t seq = 0U;
+  if (!pageSeq(page, seq)) {
+    return 0U;
+  }
+  uint16_t offset = PAGE_HEADER_LEN;
+  uint8_t len = 0U;
+  while ((len = recordLen(page, offset)) > 0U) {
+    live = static_cast<uint16_t>(live + (recordLive(page, offset, len) ? 1U : 0U));
+    offset = static_cast<uint16_t>(offset + recordSize(len));
+  }
+  return live;
+}
+
+// Moves the head to the next page; whatever is still live there is lost.
+bool openNextPage() {
+  const uint8_t page = gHeadOpen ? static_cast<uint8_t>((gHeadPage + 1U) % STORE_PAGES) : 0U;
+  const uint16_t lost = countLive(page);
+  if (!boardFlashErase(page)) {
+    return false;
+  }
+  gDropped += lost;
+  gPending = static_cast<uint16_t>(gPending - lost);
+  if (gPeeked && (gPeekPage == page)) {
+    gPeeked = false;
+  }
+  ++gPageSeq;
+  uint8_t header[PAGE_HEADER_LEN];
+  codec::writeU16(&header[0], PAGE_MAGIC);
+  codec::writeU16(&header[2], gPageSeq);
+  gHeadOpen = true;
+  gHeadPage = page;
+  gHeadOffset = PAGE_HEADER_LEN;
+  return boardFlashWrite(page, 0U, header, PAGE_HEADER_LEN);
+}
+
+}  // namespace
+
+void reportStoreInit() {
+  gHeadOpen = false;
+  gPeeked = false;
+  gGatewaySeen = false;
+  gPending = 0U;
+  gWritten = 0UL;
+  gDrained = 0UL;
+  gDropped = 0UL;
+  gSuperseded = 0UL;
+  gEnabled = STORE_FORWARD_ENABLED && boardFlashStoreFree();
+  if (!gEnabled) {
+    return;
+  }
+  // The head is the page with the newest sequence number.
+  for (uint8_t page = 0U; page < STORE_PAGES; ++page) {
+    uint16_t seq = 0U;
+    if (pageSeq(page, seq) && (!gHeadOpen || (static_cast<int16_t>(seq - gPageSeq) > 0))) {
+      gHeadOpen = true;
+      gHeadPage = page;
+      gPageSeq = seq;
+    }
+  }
+  if (!gHeadOpen) {
+    return;
+  }
+  for (uint8_t page = 0U; page < STORE_PAGES; ++page) {
+    gPending = static_cast<uint16_t>(gPending + countLive(page));
+  }
+  uint16_t offset = PAGE_HEADER_LEN;
+  uint8_t len = 0U;
+  while ((len = recordLen(gHeadPage, offset)) > 0U) {
+    offset = static_cast<uint16_t>(offset + recordSize(len));
+  }
+  // Anything but erased flash after the last record: a torn header. Start
+  // the next write on a fresh page.
+  const bool erased = ((offset + 2U) > STORE_PAGE_SIZE) || (flashU16(gHeadPage, offset) == 0xFFFFU);
+  gHeadOffset = erased ? offset : STORE_PAGE_SIZE;
+}
+
+void reportStoreOnBeacon(uint32_t nowMs) {
+  gGatewaySeen = true;
+  gLastBeaconMs = nowMs;
+}
+
+bool reportStoreHolding(uint32_t nowMs) {
+  if (!gEnabled || IS_GATEWAY) {
+    return false;
+  }
+  return !gGatewaySeen || ((nowMs - gLastBeaconMs) >= STORE_GW_STALE_MS);
+}
+
+bool reportStorePut(const uint8_t* frame, uint8_t len) {
+  codec::FrameView view;
+  if (!gEnabled || !view.init(frame, len) ||
+      (recordSize(len) > (STORE_PAGE_SIZE - PAGE_HEADER_LEN))) {
+    return false;
+  }
+  if (STORE_POLICY == STORE_POLICY_LATEST_PER_SOURCE) {
+    const uint8_t src = view.src();
+    forEachLive([src](uint8_t page, uint16_t offset, uint8_t recLen) {
+      // Enough for readHeader() on either header format.
+      uint8_t head[codec::HEADER_LEN + codec::CRC_LEN];
+      const uint8_t n = (recLen < sizeof(head)) ? recLen : static_cast<uint8_t>(sizeof(head));
+      boardFlashRead(page, static_cast<uint16_t>(offset + 2U), head, n);
+      codec::Header h{};
+      if (codec::readHeader(head, n, h) && (h.src == src)) {
+        retire(page, offset, recLen);
+        ++gSuperseded;
+      }
+      return true;
+    });
+  }
+  if ((!gHeadOpen || ((gHeadOffset + recordSize(len)) > STORE_PAGE_SIZE)) && !openNextPage()) {
+    return false;
+  }
+  const uint8_t head[2] = {len, static_cast<uint8_t>(~len)};
+  const uint16_t offset = gHeadOffset;
+  gHeadOffset = static_cast<uint16_t>(gHeadOffset + recordSize(len));
+  // Header first: a reset before the frame is complete leaves a record
+  // whose CRC fails, which reportStorePeek() retires.
+  ++gPending;
+  if (!boardFlashWrite(gHeadPage, offset, head, 2U) ||
+      !boardFlashWrite(gHeadPage, static_cast<uint16_t>(offset + 2U), frame, len)) {
+    retire(gHeadPage, offset, len);
+    ++gDropped;
+    return false;
+  }
+  ++gWritten;
+  return true;
+}
+
+uint8_t reportStorePeek(uint8_t* out, uint8_t outMax) {
+  gPeeked = false;
+  if (!gEnabled) {
+    return 0U;
+  }
+  uint8_t found = 0U;
+  forEachLive([&](uint8_t page, uint16_t offset, uint8_t len) {
+    if (len > outMax) {
+      return true;
+    }
+    boardFlashRead(page, static_cast<uint16_t>(offset + 2U), out, len);
+    codec::FrameView view;
+    if (!view.init(out, len) || !view.crcOk()) {
+      retire(page, offset, len);
+      ++gDropped;
+      return true;
+    }
+    gPeeked = true;
+    gPeekPage = page;
+    gPeekOffset = offset;
+    gPeekLen = len;
+    found = len;
+    return false;
+  });
+  return found;
+}
+
+void reportStorePop() {
+  if (!gPeeked) {
+    return;
+  }
+  retire(gPeekPage, gPeekOffset, gPeekLen);
+  ++gDrained;
+}
+
+uint16_t reportStorePending() {
+  return gPending;
+}
+
+uint32_t reportStoreWritten() {
+  return gWritten;
+}
+
+uint32_t reportStoreDrained() {
+  return gDrained;
+}
+
+uint32_t reportStoreDropped() {
+  return gDropped;
+}
+
+uint32_t reportStoreSuperseded() {
+  return gSuperseded;
+}
@@ -0,0 +1,38 @@
+#ifndef REPORT_STORE_H
+#define REPORT_STORE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Store-and-forward log of whole REPORT frames in spare flash
+// (STORE_FORWARD_ENABLED, tuning: "Report store" in config.h). A page starts
+// with a magic and a sequence number; records follow back to back: len, ~len,
+// the frame padded to an even length, then a half-word cleared once the
+// REPORT has left the store. Pages are reused round-robin, so the log
+// survives a reset and wear is spread evenly. Records whose frame CRC fails
+// (a write cut short by a reset) are skipped.
+
+void reportStoreInit();
+
+// Gateway presence, from the beacons a node hears.
+void reportStoreOnBeacon(uint32_t nowMs);
+// No beacon within STORE_GW_STALE_MS (or none yet): REPORTs belong in the
+// store, not on the air. Always false on gateways or with the store off,
+// which includes an image too large to leave its pages free.
+bool reportStoreHolding(uint32_t nowMs);
+
+// False when the store is off or the flash write failed. Under
+// STORE_POLICY_LATEST_PER_SOURCE older REPORTs of the same source are retired.
+bool reportStorePut(const uint8_t* frame, uint8_t len);
+// Oldest stored REPORT copied to `out`; 0 when none. Stays stored until
+// reportStorePop().
+uint8_t reportStorePeek(uint8_t* out, uint8_t outMax);
+void reportStorePop();
+
+uint16_t reportStorePending();
+uint32_t reportStoreWritten();
+uint32_t reportStoreDrained();
+uint32_t reportStoreDropped();  // Evicted by a full store or unreadable.
+uint32_t reportStoreSuperseded();
+
+#endif  // REPORT_STORE_H
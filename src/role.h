@@ -0,0 +1,40 @@
+#ifndef ROLE_H
+#define ROLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "config.h"
+
+// Compile-time role policy (ROLE_GATEWAY, sizes: "Roles" in config.h). A
+// task runs only where its role has it, so with the linker's section GC an
+// image holds none of the other role's code or buffers.
+
+template <bool Gateway>
+struct RolePolicy;
+
+template <>
+struct RolePolicy<false> {
+  static constexpr bool SCANS = true;            // UART ingest, own REPORTs, battery status.
+  static constexpr bool FOLLOWS_GATEWAY = true;  // Beacon following, ACK re-sends, report store.
+  static constexpr bool BEACONS = false;         // Beacon origin, PHY and report-rate evaluation.
+  static constexpr bool EXPORTS = false;         // FRAG reassembly and the export bridge.
+  static constexpr uint8_t TX_QUEUE_CAPACITY = SCANNER_TX_QUEUE;
+  static constexpr uint8_t FWD_QUEUE_CAPACITY = SCANNER_FWD_QUEUE;
+  static constexpr uint16_t DEDUP_N = SCANNER_DEDUP_N;
+};
+
+template <>
+struct RolePolicy<true> {
+  static constexpr bool SCANS = false;
+  static constexpr bool FOLLOWS_GATEWAY = false;
+  static constexpr bool BEACONS = true;
+  static constexpr bool EXPORTS = true;
+  static constexpr uint8_t TX_QUEUE_CAPACITY = GATEWAY_TX_QUEUE;
+  static constexpr uint8_t FWD_QUEUE_CAPACITY = GATEWAY_FWD_QUEUE;
+  static constexpr uint16_t DEDUP_N = GATEWAY_DEDUP_N;
+};
+
+using Role = RolePolicy<IS_GATEWAY>;
+
+#endif  // ROLE_H
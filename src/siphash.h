@@ -0,0 +1,92 @@
+#ifndef SIPHASH_H
+#define SIPHASH_H
+
+// SipHash-2-4 (Aumasson & Bernstein), streaming, 64-bit output.
+// Header-only and Arduino-free like frame_codec.h. On 32-bit MCUs every
+// 64-bit add/rotate is a few instructions; RADIO_FRAME_SELFTEST logs the
+// per-frame cost on target.
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace codec {
+
+class SipHash24 {
+ public:
+  explicit SipHash24(const uint8_t key[16]) {
+    const uint64_t k0 = load64(key);
+    const uint64_t k1 = load64(&key[8]);
+    mV0 = k0 ^ 0x736f6d6570736575ULL;
+    mV1 = k1 ^ 0x646f72616e646f6dULL;
+    mV2 = k0 ^ 0x6c7967656e657261ULL;
+    mV3 = k1 ^ 0x7465646279746573ULL;
+  }
+
+  void update(const uint8_t* data, size_t len) {
+    for (size_t i = 0U; i < len; ++i) {
+      mTail |= static_cast<uint64_t>(data[i]) << (8U * (mTotal & 7U));
+      ++mTotal;
+      if ((mTotal & 7U) == 0U) {
+        compress(mTail);
+        mTail = 0U;
+      }
+    }
+  }
+
+  uint64_t final() {
+    compress(mTail | (static_cast<uint64_t>(mTotal & 0xFFU) << 56));
+    mV2 ^= 0xFFU;
+    for (uint8_t i = 0U; i < 4U; ++i) {
+      round();
+    }
+    return mV0 ^ mV1 ^ mV2 ^ mV3;
+  }
+
+ private:
+  static uint64_t load64(const uint8_t* p) {
+    uint64_t v = 0U;
+    for (uint8_t i = 0U; i < 8U; ++i) {
+      v |= static_cast<uint64_t>(p[i]) << (8U * i);
+    }
+    return v;
+  }
+
+  static uint64_t rotl(uint64_t v, uint8_t n) {
+    return (v << n) | (v >> (64U - n));
+  }
+
+  void round() {
+    mV0 += mV1;
+    mV1 = rotl(mV1, 13U);
+    mV1 ^= mV0;
+    mV0 = rotl(mV0, 32U);
+    mV2 += mV3;
+    mV3 = rotl(mV3, 16U);
+    mV3 ^= mV2;
+    mV0 += mV3;
+    mV3 = rotl(mV3, 21U);
+    mV3 ^= mV0;
+    mV2 += mV1;
+    mV1 = rotl(mV1, 17U);
+    mV1 ^= mV2;
+    mV2 = rotl(mV2, 32U);
+  }
+
+  void compress(uint64_t m) {
+    mV3 ^= m;
+    round();
+    round();
+    mV0 ^= m;
+  }
+
+  uint64_t mV0;
+  uint64_t mV1;
+  uint64_t mV2;
+  uint64_t mV3;
+  uint64_t mTail = 0U;
+  size_t mTotal = 0U;
+};
+
+}  // namespace codec
+
+#endif  // SIPHASH_H
@@ -0,0 +1,230 @@
+#include "sx126x.h"
+
+namespace {
+
+constexpr uint32_t BUSY_TIMEOUT_MS = 10UL;  // Calibration takes about 3.5 ms.
+
+constexpr uint8_t OP_CLEAR_DEVICE_ERRORS = 0x07U;
+constexpr uint8_t OP_CLEAR_IRQ_STATUS = 0x02U;
+constexpr uint8_t OP_SET_DIO_IRQ_PARAMS = 0x08U;
+constexpr uint8_t OP_WRITE_REGISTER = 0x0DU;
+constexpr uint8_t OP_WRITE_BUFFER = 0x0EU;
+constexpr uint8_t OP_GET_IRQ_STATUS = 0x12U;
+constexpr uint8_t OP_GET_RX_BUFFER_STATUS = 0x13U;
+constexpr uint8_t OP_GET_PACKET_STATUS = 0x14U;
+constexpr uint8_t OP_READ_REGISTER = 0x1DU;
+constexpr uint8_t OP_READ_BUFFER = 0x1EU;
+constexpr uint8_t OP_SET_STANDBY = 0x80U;
+constexpr uint8_t OP_SET_RX = 0x82U;
+constexpr uint8_t OP_SET_TX = 0x83U;
+constexpr uint8_t OP_SET_RF_FREQUENCY = 0x86U;
+constexpr uint8_t OP_CALIBRATE = 0x89U;
+constexpr uint8_t OP_SET_PACKET_TYPE = 0x8AU;
+constexpr uint8_t OP_SET_MODULATION_PARAMS = 0x8BU;
+constexpr uint8_t OP_SET_PACKET_PARAMS = 0x8CU;
+constexpr uint8_t OP_SET_TX_PARAMS = 0x8EU;
+constexpr uint8_t OP_SET_BUFFER_BASE = 0x8FU;
+constexpr uint8_t OP_SET_PA_CONFIG = 0x95U;
+constexpr uint8_t OP_SET_REGULATOR_MODE = 0x96U;
+constexpr uint8_t OP_SET_DIO3_AS_TCXO = 0x97U;
+constexpr uint8_t OP_CALIBRATE_IMAGE = 0x98U;
+constexpr uint8_t OP_GET_STATUS = 0xC0U;
+
+constexpr uint16_t REG_SYNC_WORD = 0x0740U;
+constexpr uint16_t REG_TX_MODULATION = 0x0889U;  // Errata 15.1: bit 2 set below 500 kHz.
+constexpr uint16_t REG_RX_GAIN = 0x08ACU;
+constexpr uint8_t RX_GAIN_BOOSTED = 0x96U;
+
+constexpr uint8_t PREAMBLE_SYMBOLS = 8U;
+constexpr uint8_t PAYLOAD_MAX = 0xFFU;
+constexpr uint32_t RX_CONTINUOUS = 0xFFFFFFUL;
+constexpr uint32_t TCXO_DELAY_STEPS = 320UL;  // 5 ms in 15.625 us steps.
+
+bool command(const uint8_t* cmd,
+             uint8_t cmdLen,
+             const uint8_t* tx = nullptr,
+             uint8_t* rx = nullptr,
+             uint8_t len = 0U) {
+  if (!sx126xBusWaitReady(BUSY_TIMEOUT_MS)) {
+    return false;
+  }
+  sx126xBusCommand(cmd, cmdLen, tx, rx, len);
+  return true;
+}
+
+bool writeRegister(uint16_t addr, uint8_t value) {
+  const uint8_t cmd[] = {OP_WRITE_REGISTER, static_cast<uint8_t>(addr >> 8), static_cast<uint8_t>(addr), value};
+  return command(cmd, sizeof(cmd));
+}
+
+bool readRegister(uint16_t addr, uint8_t& value) {
+  const uint8_t cmd[] = {OP_READ_REGISTER, static_cast<uint8_t>(addr >> 8), static_cast<uint8_t>(addr), 0x00U};
+  return command(cmd, sizeof(cmd), nullptr, &value, 1U);
+}
+
+bool setPacketLength(uint8_t len) {
+  const uint8_t cmd[] = {OP_SET_PACKET_PARAMS, 0x00U, PREAMBLE_SYMBOLS, 0x00U /* explicit header */, len,
+                         0x01U /* CRC on */, 0x00U /* standard IQ */};
+  return command(cmd, sizeof(cmd));
+}
+
+// SetTx/SetRx timeouts count 15.625 us steps.
+bool setTimed(uint8_t op, uint32_t steps) {
+  const uint8_t cmd[] = {op, static_cast<uint8_t>(steps >> 16), static_cast<uint8_t>(steps >> 8),
+                         static_cast<uint8_t>(steps)};
+  return command(cmd, sizeof(cmd));
+}
+
+// Datasheet table 9-2: the calibrated band that contains `freqHz`.
+void imageBand(uint32_t freqHz, uint8_t& f1, uint8_t& f2) {
+  if (freqHz > 900000000UL) {
+    f1 = 0xE1U;
+    f2 = 0xE9U;
+  } else if (freqHz > 850000000UL) {
+    f1 = 0xD7U;
+    f2 = 0xDBU;
+  } else if (freqHz > 770000000UL) {
+    f1 = 0xC1U;
+    f2 = 0xC5U;
+  } else if (freqHz > 460000000UL) {
+    f1 = 0x75U;
+    f2 = 0x81U;
+  } else {
+    f1 = 0x6BU;
+    f2 = 0x6FU;
+  }
+}
+
+bool bandwidthCode(uint32_t bwHz, uint8_t& code) {
+  switch (bwHz) {
+    case 125000UL:
+      code = 0x04U;
+      return true;
+    case 250000UL:
+      code = 0x05U;
+      return true;
+    case 500000UL:
+      code = 0x06U;
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+bool sx126xGetStatus(uint8_t& status) {
+  const uint8_t cmd[] = {OP_GET_STATUS};
+  return command(cmd, sizeof(cmd), nullptr, &status, 1U);
+}
+
+bool sx126xSetStandby() {
+  const uint8_t cmd[] = {OP_SET_STANDBY, 0x00U /* RC */};
+  return command(cmd, sizeof(cmd));
+}
+
+bool sx126xSetup(uint32_t freqHz, bool tcxo, uint16_t syncWord) {
+  if (!sx126xSetStandby()) {
+    return false;
+  }
+  if (tcxo) {
+    // 3.3 V; the XOSC start error logged while it was off is cleared.
+    const uint8_t tcxoCmd[] = {OP_SET_DIO3_AS_TCXO, 0x07U, static_cast<uint8_t>(TCXO_DELAY_STEPS >> 16),
+                               static_cast<uint8_t>(TCXO_DELAY_STEPS >> 8), static_cast<uint8_t>(TCXO_DELAY_STEPS)};
+    const uint8_t clearErrors[] = {OP_CLEAR_DEVICE_ERRORS, 0x00U, 0x00U};
+    if (!command(tcxoCmd, sizeof(tcxoCmd)) || !command(clearErrors, sizeof(clearErrors))) {
+      return false;
+    }
+  }
+  uint8_t f1 = 0U;
+  uint8_t f2 = 0U;
+  imageBand(freqHz, f1, f2);
+  const uint32_t rf = static_cast<uint32_t>((static_cast<uint64_t>(freqHz) << 25) / 32000000ULL);
+  const uint8_t calibrate[] = {OP_CALIBRATE, 0x7FU};
+  const uint8_t regulator[] = {OP_SET_REGULATOR_MODE, 0x01U /* DC-DC */};
+  const uint8_t pa[] = {OP_SET_PA_CONFIG, 0x04U, 0x07U, 0x00U, 0x01U};
+  const uint8_t image[] = {OP_CALIBRATE_IMAGE, f1, f2};
+  const uint8_t lora[] = {OP_SET_PACKET_TYPE, 0x01U};
+  const uint8_t freq[] = {OP_SET_RF_FREQUENCY, static_cast<uint8_t>(rf >> 24), static_cast<uint8_t>(rf >> 16),
+                          static_cast<uint8_t>(rf >> 8), static_cast<uint8_t>(rf)};
+  const uint8_t base[] = {OP_SET_BUFFER_BASE, 0x00U, 0x00U};
+  const uint8_t irq[] = {OP_SET_DIO_IRQ_PARAMS,
+                         static_cast<uint8_t>(SX126X_IRQ_DIO1 >> 8),
+                         static_cast<uint8_t>(SX126X_IRQ_DIO1),
+                         static_cast<uint8_t>(SX126X_IRQ_DIO1 >> 8),
+                         static_cast<uint8_t>(SX126X_IRQ_DIO1),
+                         0x00U,
+                         0x00U,
+                         0x00U,
+                         0x00U};
+  return command(calibrate, sizeof(calibrate)) && command(regulator, sizeof(regulator)) &&
+         command(pa, sizeof(pa)) && command(image, sizeof(image)) && command(lora, sizeof(lora)) &&
+         command(freq, sizeof(freq)) && command(base, sizeof(base)) &&
+         writeRegister(REG_SYNC_WORD, static_cast<uint8_t>(syncWord >> 8)) &&
+         writeRegister(REG_SYNC_WORD + 1U, static_cast<uint8_t>(syncWord)) &&
+         writeRegister(REG_RX_GAIN, RX_GAIN_BOOSTED) && command(irq, sizeof(irq));
+}
+
+bool sx126xSetModem(uint8_t sf, uint32_t bwHz, uint8_t cr, int8_t txPowerDbm) {
+  uint8_t bw = 0U;
+  if ((sf < 5U) || (sf > 12U) || (cr < 5U) || (cr > 8U) || !bandwidthCode(bwHz, bw)) {
+    return false;
+  }
+  // Low data rate optimisation from 16.38 ms symbols (SF11/125 kHz, SF12/250 kHz).
+  const bool ldro = ((1000000UL << sf) / bwHz) >= 16384UL;
+  const uint8_t modulation[] = {OP_SET_MODULATION_PARAMS, sf, bw, static_cast<uint8_t>(cr - 4U),
+                                static_cast<uint8_t>(ldro ? 0x01U : 0x00U)};
+  const uint8_t txParams[] = {OP_SET_TX_PARAMS, static_cast<uint8_t>(txPowerDbm), 0x02U /* 40 us ramp */};
+  uint8_t txMod = 0U;
+  if (!sx126xSetStandby() || !command(modulation, sizeof(modulation)) || !command(txParams, sizeof(txParams)) ||
+      !readRegister(REG_TX_MODULATION, txMod)) {
+    return false;
+  }
+  txMod = (bwHz == 500000UL) ? static_cast<uint8_t>(txMod & ~0x04U) : static_cast<uint8_t>(txMod | 0x04U);
+  return writeRegister(REG_TX_MODULATION, txMod) && setPacketLength(PAYLOAD_MAX);
+}
+
+bool sx126xStartTx(const uint8_t* data, uint8_t len, uint32_t timeoutMs) {
+  const uint8_t write[] = {OP_WRITE_BUFFER, 0x00U};
+  const uint32_t steps = timeoutMs * 64UL;
+  return sx126xSetStandby() && command(write, sizeof(write), data, nullptr, len) && setPacketLength(len) &&
+         sx126xClearIrq(SX126X_IRQ_ALL) && setTimed(OP_SET_TX, (steps < RX_CONTINUOUS) ? steps : RX_CONTINUOUS - 1UL);
+}
+
+bool sx126xStartRx() {
+  return sx126xClearIrq(SX126X_IRQ_ALL) && setPacketLength(PAYLOAD_MAX) && setTimed(OP_SET_RX, RX_CONTINUOUS);
+}
+
+bool sx126xIrqStatus(uint16_t& irq) {
+  const uint8_t cmd[] = {OP_GET_IRQ_STATUS, 0x00U};
+  uint8_t reply[2] = {0U, 0U};
+  if (!command(cmd, sizeof(cmd), nullptr, reply, sizeof(reply))) {
+    return false;
+  }
+  irq = static_cast<uint16_t>((reply[0] << 8) | reply[1]);
+  return true;
+}
+
+bool sx126xClearIrq(uint16_t mask) {
+  const uint8_t cmd[] = {OP_CLEAR_IRQ_STATUS, static_cast<uint8_t>(mask >> 8), static_cast<uint8_t>(mask)};
+  return command(cmd, sizeof(cmd));
+}
+
+uint8_t sx126xReadPacket(uint8_t* out, uint8_t maxLen, int16_t& rssiDbm, int8_t& snrDb) {
+  const uint8_t bufferCmd[] = {OP_GET_RX_BUFFER_STATUS, 0x00U};
+  uint8_t buffer[2] = {0U, 0U};  // Payload length, start offset.
+  if (!command(bufferCmd, sizeof(bufferCmd), nullptr, buffer, sizeof(buffer))) {
+    return 0U;
+  }
+  const uint8_t len = (buffer[0] < maxLen) ? buffer[0] : maxLen;
+  const uint8_t readCmd[] = {OP_READ_BUFFER, buffer[1], 0x00U};
+  const uint8_t statusCmd[] = {OP_GET_PACKET_STATUS, 0x00U};
+  uint8_t status[3] = {0U, 0U, 0U};  // RSSI, SNR, signal RSSI.
+  if (!command(readCmd, sizeof(readCmd), nullptr, out, len) ||
+      !command(statusCmd, sizeof(statusCmd), nullptr, status, sizeof(status))) {
+    return 0U;
+  }
+  rssiDbm = static_cast<int16_t>(-static_cast<int16_t>(status[0] / 2U));
+  snrDb = static_cast<int8_t>(static_cast<int8_t>(status[1]) / 4);
+  return len;
+}
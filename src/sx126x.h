@@ -0,0 +1,51 @@
+#ifndef SX126X_H
+#define SX126X_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// SX126x command layer for the one way this project drives the chip: LoRa,
+// explicit header, payload CRC on, 8-symbol preamble, buffers at 0. Each
+// call is the datasheet command sequence for one job; every command waits
+// for BUSY low and gets its own NSS frame. False means BUSY stayed high.
+
+// The bus, supplied at link time: radio.cpp on the target, the host mock in
+// tools/sx126x_mock.cpp.
+// Waits for BUSY low, yielding; false after `timeoutMs`.
+bool sx126xBusWaitReady(uint32_t timeoutMs);
+// One NSS frame: `cmd` out, then `len` bytes written from `tx` or, with
+// `tx` null, read into `rx` while NOPs go out.
+void sx126xBusCommand(const uint8_t* cmd, uint8_t cmdLen, const uint8_t* tx, uint8_t* rx, uint8_t len);
+
+constexpr uint16_t SX126X_IRQ_TX_DONE = 0x0001U;
+constexpr uint16_t SX126X_IRQ_RX_DONE = 0x0002U;
+constexpr uint16_t SX126X_IRQ_HEADER_ERR = 0x0020U;
+constexpr uint16_t SX126X_IRQ_CRC_ERR = 0x0040U;
+constexpr uint16_t SX126X_IRQ_TIMEOUT = 0x0200U;
+constexpr uint16_t SX126X_IRQ_ALL = 0x03FFU;
+// Routed to DIO1 by sx126xSetup().
+constexpr uint16_t SX126X_IRQ_DIO1 = SX126X_IRQ_TX_DONE | SX126X_IRQ_RX_DONE | SX126X_IRQ_HEADER_ERR |
+                                     SX126X_IRQ_CRC_ERR | SX126X_IRQ_TIMEOUT;
+
+bool sx126xGetStatus(uint8_t& status);
+bool sx126xSetStandby();
+// Once after reset: TCXO on DIO3 (when `tcxo`), calibration, DC-DC, PA for
+// +22 dBm parts, image calibration for the band of `freqHz`, LoRa, the
+// frequency, `syncWord` (0x1424 private, 0x3444 public), boosted RX gain
+// and SX126X_IRQ_DIO1 on DIO1.
+bool sx126xSetup(uint32_t freqHz, bool tcxo, uint16_t syncWord);
+// Modulation and TX power, from standby. `cr` 5..8 for 4/5..4/8; false for
+// a coding rate or bandwidth (125/250/500 kHz) the chip does not have.
+bool sx126xSetModem(uint8_t sf, uint32_t bwHz, uint8_t cr, int8_t txPowerDbm);
+// Standby, payload to the buffer, its length, IRQs cleared, TX. DIO1 rises
+// on TX_DONE or after `timeoutMs`.
+bool sx126xStartTx(const uint8_t* data, uint8_t len, uint32_t timeoutMs);
+// The TX->RX turnaround: IRQs cleared, maximum length, continuous RX.
+bool sx126xStartRx();
+bool sx126xIrqStatus(uint16_t& irq);
+bool sx126xClearIrq(uint16_t mask);
+// The received payload, cut to `maxLen`, with its RSSI and SNR; 0 when the
+// bus failed.
+uint8_t sx126xReadPacket(uint8_t* out, uint8_t maxLen, int16_t& rssiDbm, int8_t& snrDb);
+
+#endif  // SX126X_H
@@ -0,0 +1,99 @@
+#include "tdma.h"
+
+#include "config.h"
+#include "log.h"
+#include "phy.h"
+#include "radio.h"
+
+namespace {
+
+bool gSynced = false;
+int32_t gOffsetMs = 0;  // Network time minus local millis().
+uint32_t gLastSyncMs = 0UL;
+
+uint32_t airtimeMs(uint8_t len) {
+  return phyAirtimeMs(PHY_PROFILES[radioProfileId()], len);
+}
+
+uint32_t superframeMs() {
+  return tdmaSlotMs() * (TDMA_SLOTS + TDMA_CONTENTION_SLOTS);
+}
+
+// Earliest local time >= nowMs at which [start, end) of the superframe has
+// room for `needMs`; windows are offsets into the superframe.
+uint32_t nextWindowMs(uint32_t nowMs, uint32_t startMs, uint32_t endMs, uint32_t needMs) {
+  const uint32_t frameMs = superframeMs();
+  const uint32_t pos = tdmaNetTimeMs(nowMs) % frameMs;
+  if ((pos >= startMs) && ((pos + needMs) <= endMs)) {
+    return nowMs;
+  }
+  const uint32_t wait = (pos < startMs) ? (startMs - pos) : ((frameMs - pos) + startMs);
+  return nowMs + wait;
+}
+
+}  // namespace
+
+void tdmaInit() {
+  gSynced = IS_GATEWAY;
+  gOffsetMs = 0;
+  gLastSyncMs = 0UL;
+}
+
+void tdmaOnBeaconTime(uint32_t netTimeMs, uint8_t frameLen, uint32_t nowMs) {
+  if constexpr (IS_GATEWAY) {
+    return;
+  }
+  // The stamp is taken at TX start; the frame ended its airtime later.
+  const int32_t sample = static_cast<int32_t>(netTimeMs + airtimeMs(frameLen) - nowMs);
+  const int32_t err = sample - gOffsetMs;
+  if (!tdmaSynced(nowMs) || (err > static_cast<int32_t>(TIME_SYNC_STEP_MS)) ||
+      (err < -static_cast<int32_t>(TIME_SYNC_STEP_MS))) {
+    gOffsetMs = sample;
+    logEvent2("TSTEP", err);
+  } else {
+    // Slew: relay and read latency jitter averages out, drift is followed.
+    gOffsetMs += err / 4;
+  }
+  gSynced = true;
+  gLastSyncMs = nowMs;
+}
+
+bool tdmaSynced(uint32_t nowMs) {
+  if constexpr (IS_GATEWAY) {
+    return true;
+  }
+  if (gSynced && ((nowMs - gLastSyncMs) >= GW_TIMEOUT_MS)) {
+    gSynced = false;
+    logEvent("TLOST");
+  }
+  return gSynced;
+}
+
+uint32_t tdmaNetTimeMs(uint32_t nowMs) {
+  return nowMs + static_cast<uint32_t>(gOffsetMs);
+}
+
+int32_t tdmaOffsetMs() {
+  return gOffsetMs;
+}
+
+uint32_t tdmaSlotMs() {
+  return airtimeMs(TDMA_SLOT_BYTES) + TDMA_GUARD_MS;
+}
+
+uint8_t tdmaSlotAt(uint32_t nowMs) {
+  return static_cast<uint8_t>((tdmaNetTimeMs(nowMs) % superframeMs()) / tdmaSlotMs());
+}
+
+uint32_t tdmaNextOwnTxMs(uint32_t nowMs, uint8_t len) {
+  const uint32_t slotMs = tdmaSlotMs();
+  // Half a guard on each side absorbs sync error between neighbours.
+  const uint32_t startMs = ((NODE_ID % TDMA_SLOTS) * slotMs) + (TDMA_GUARD_MS / 2U);
+  return nextWindowMs(nowMs, startMs, startMs + slotMs - TDMA_GUARD_MS, airtimeMs(len));
+}
+
+uint32_t tdmaNextContentionTxMs(uint32_t nowMs, uint8_t len) {
+  const uint32_t slotMs = tdmaSlotMs();
+  const uint32_t startMs = (TDMA_SLOTS * slotMs) + (TDMA_GUARD_MS / 2U);
+  return nextWindowMs(nowMs, startMs, superframeMs() - (TDMA_GUARD_MS / 2U), airtimeMs(len));
+}
@@ -0,0 +1,28 @@
+#ifndef TDMA_H
+#define TDMA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Network time and TDMA superframe (tuning: "Time sync / TDMA" in config.h).
+// The gateway clock is the reference. Nodes take it from beacons, correct
+// for airtime, and stay synced for GW_TIMEOUT_MS after the last one.
+
+void tdmaInit();
+
+// Node: beacon time `netTimeMs` (stamped at TX start) read at `nowMs`.
+void tdmaOnBeaconTime(uint32_t netTimeMs, uint8_t frameLen, uint32_t nowMs);
+bool tdmaSynced(uint32_t nowMs);
+uint32_t tdmaNetTimeMs(uint32_t nowMs);
+int32_t tdmaOffsetMs();
+
+uint32_t tdmaSlotMs();
+// Slot index at local time `nowMs`; TDMA_SLOTS and above are contention.
+uint8_t tdmaSlotAt(uint32_t nowMs);
+
+// Earliest local time >= nowMs at which a `len`-byte frame fits in this
+// node's own slot / in the contention period. Only valid while synced.
+uint32_t tdmaNextOwnTxMs(uint32_t nowMs, uint8_t len);
+uint32_t tdmaNextContentionTxMs(uint32_t nowMs, uint8_t len);
+
+#endif  // TDMA_H
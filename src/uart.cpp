@@ -1,7 +1,6 @@
 #include "uart.h"
 
 #include <Arduino.h>
-#include <string.h>
 
 #include "config.h"
 #include "log.h"
@@ -9,16 +8,18 @@
 namespace {
 
 UartRxState gRxState = UartRxState::UART_IDLE;
-char gLineBuf[UART_LINE_MAX] = {0};
-uint8_t gLineLen = 0;
+FreqTokenizer gTokenizer = {};
+FreqSet gLineFreqs = {};
+uint16_t gLineLen = 0;
 
-char lastValidLine[UART_LINE_MAX] = {0};
+FreqSet lastValidFreqs = {};
 uint32_t last_uart_timestamp_ms = 0;
 bool uartValid = false;
 
 void resetCollector() {
   gLineLen = 0;
-  gLineBuf[0] = '\0';
+  freqTokenizerReset(gTokenizer);
+  freqSetClear(gLineFreqs);
 }
 
 void setOverrun() {
@@ -28,11 +29,11 @@ void setOverrun() {
 }
 
 void finalizeLine(uint32_t nowMs) {
-  gLineBuf[gLineLen] = '\0';
+  freqTokenizerFinish(gTokenizer, gLineFreqs);
   gRxState = UartRxState::UART_READY;
-  logEvent2("UOK", gLineLen);
+  logEvent3("UOK", gLineLen, gLineFreqs.count);
 
-  memcpy(lastValidLine, gLineBuf, UART_LINE_MAX);
+  lastValidFreqs = gLineFreqs;
   last_uart_timestamp_ms = nowMs;
   uartValid = true;
 
@@ -46,7 +47,7 @@ void uartInit() {
   Serial.begin(UART_BAUD);
   gRxState = UartRxState::UART_IDLE;
   resetCollector();
-  lastValidLine[0] = '\0';
+  freqSetClear(lastValidFreqs);
   last_uart_timestamp_ms = 0;
   uartValid = false;
 }
@@ -82,12 +83,12 @@ void uartPoll(uint32_t nowMs) {
       gRxState = UartRxState::UART_COLLECT;
     }
 
-    if (gLineLen >= static_cast<uint8_t>(UART_LINE_MAX - 1U)) {
+    if (gLineLen >= static_cast<uint16_t>(UART_LINE_MAX - 1U)) {
       setOverrun();
       continue;
     }
 
-    gLineBuf[gLineLen] = ch;
+    freqTokenizerFeed(gTokenizer, ch, gLineFreqs);
     ++gLineLen;
   }
 }
@@ -100,8 +101,8 @@ bool uartHasValidLine() {
   return uartValid;
 }
 
-const char* uartLastValidLine() {
-  return lastValidLine;
+const FreqSet& uartLastFreqs() {
+  return lastValidFreqs;
 }
 
 uint32_t uartLastTimestampMs() {
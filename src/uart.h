@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 
+#include "freq_set.h"
+
 enum class UartRxState : uint8_t {
   UART_IDLE = 0,
   UART_COLLECT,
@@ -15,7 +17,8 @@ void uartPoll(uint32_t nowMs);
 
 UartRxState uartState();
 bool uartHasValidLine();
-const char* uartLastValidLine();
+// Frequencies of the last complete line, tokenized as the bytes arrived.
+const FreqSet& uartLastFreqs();
 uint32_t uartLastTimestampMs();
 
 #endif  // UART_H
@@ -0,0 +1,52 @@
+import shutil
+import subprocess
+from pathlib import Path
+
+import pytest
+
+REPO_ROOT = Path(__file__).resolve().parent.parent
+
+
+@pytest.fixture(scope="session")
+def host_build(tmp_path_factory):
+    """Compiles a host-side C++ tool from the repo; skips when no compiler is available."""
+    cxx = shutil.which("g++") or shutil.which("clang++")
+    if cxx is None:
+        pytest.skip("no host C++ compiler")
+    out_dir = tmp_path_factory.mktemp("host_build")
+    built = {}
+
+    def build(name, sources, include_dirs=("src", "tools"), defines=()):
+        if name in built:
+            return built[name]
+        exe = out_dir / name
+        cmd = [cxx, "-O2", "-std=gnu++17", "-Wall", "-Wextra", "-Werror"]
+        cmd += [f"-I{REPO_ROOT / d}" for d in include_dirs]
+        cmd += [f"-D{d}" for d in defines]
+        cmd += [str(REPO_ROOT / s) for s in sources]
+        cmd += ["-o", str(exe)]
+        subprocess.run(cmd, check=True)
+        built[name] = exe
+        return exe
+
+    return build
+
+
+@pytest.fixture(scope="session")
+def sim_build(tmp_path_factory):
+    """Builds a tools/sim driver linked against the real firmware sources."""
+    if (shutil.which("g++") or shutil.which("clang++")) is None:
+        pytest.skip("no host C++ compiler")
+    from tools.sim.build import build
+
+    out_dir = tmp_path_factory.mktemp("sim_build")
+    built = {}
+
+    def _build(tool, extra_defines=()):
+        key = (tool, tuple(extra_defines))
+        if key not in built:
+            suffix = "_".join(d.replace("=", "-") for d in extra_defines)
+            built[key] = build(tool, out_dir / (tool + ("_" + suffix if suffix else "")), extra_defines=extra_defines)
+        return built[key]
+
+    return _build
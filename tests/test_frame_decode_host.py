@@ -0,0 +1,210 @@
+import subprocess
+
+from tools.protocol_model import (
+    FRAME_FLAG_TRACE,
+    build_export_rx_record,
+    build_ping_frame,
+    build_report_band_frame,
+    build_report_frame,
+    crc16_ccitt_false,
+    fragment_frame,
+    neighbours_append,
+    parse_report_frame,
+    trace_append,
+    trace_stamp,
+)
+
+
+def _report(src_id: int, seq: int, freqs):
+    return build_report_frame(
+        net_id=1,
+        src_id=src_id,
+        dst_id=0xFF,
+        boot_id=7,
+        seq=seq,
+        freq_mhz=freqs,
+        status_flags=0x05,
+        last_uart_age_s=12,
+    )
+
+
+def test_python_report_parser_roundtrip_and_truncated_tlv() -> None:
+    frame = _report(3, 44, [433, 868])
+    parsed = parse_report_frame(frame, expected_net_id=1)
+    assert parsed.ok is True
+    assert parsed.freq_mhz == [433, 868]
+    assert (parsed.status_flags, parsed.last_uart_age_s) == (0x05, 12)
+
+    broken = bytearray(frame)
+    broken[11] = 0x30  # FREQ_LIST length now runs past the payload
+    crc = crc16_ccitt_false(bytes(broken[:-2]))
+    broken[-2] = crc & 0xFF
+    broken[-1] = (crc >> 8) & 0xFF
+    assert parse_report_frame(bytes(broken), expected_net_id=1).err_code == 5
+
+
+def test_host_decoder_agrees_with_python_model(host_build, tmp_path) -> None:
+    exe = host_build("frame_decode", ["tools/frame_decode.cpp"])
+    truncated_tlv = bytearray(_report(5, 2, [433]))
+    truncated_tlv[11] = 0x20
+    crc = crc16_ccitt_false(bytes(truncated_tlv[:-2]))
+    truncated_tlv[-2:] = bytes([crc & 0xFF, crc >> 8])
+    frames = [
+        _report(3, 44, [433, 868]),
+        build_ping_frame(net_id=1, src_id=9, dst_id=0xFF, boot_id=1, seq=5),
+        _report(4, 1, []),
+        bytes(truncated_tlv),
+    ]
+    stream = b"UOK 3\r\n".join(
+        build_export_rx_record(ts_ms=1000 + i, rssi=-80 - i, snr=4 - i, frame=f) for i, f in enumerate(frames)
+    )
+    capture = tmp_path / "gw.bin"
+    capture.write_bytes(stream)
+
+    csv = subprocess.run([str(exe), "--csv", str(capture)], check=True, capture_output=True, text=True).stdout
+    lines = csv.strip().splitlines()
+    assert lines[0] == "1000,-80,4,3,44,REPORT,8,0,5,12,433 868"
+    assert lines[1] == "1001,-81,3,9,5,PING,8,0,,,"
+    assert lines[2] == "1002,-82,2,4,1,REPORT,8,0,5,12,"
+
+    summary = subprocess.run([str(exe), str(capture)], check=True, capture_output=True, text=True).stdout
+    assert "frames=4 reports=2 pings=1" in summary
+    assert "bad_frames=1" in summary
+
+
+def test_host_decoder_expands_band_tlvs_like_python_model(host_build, tmp_path) -> None:
+    exe = host_build("frame_decode", ["tools/frame_decode.cpp"])
+    sets = [list(range(410, 600)) + [868], list(range(400, 440, 2)), [433]]
+    frames = [
+        build_report_band_frame(
+            net_id=1, src_id=2, dst_id=0xFF, boot_id=1, seq=i, freq_mhz=f, status_flags=0x07, last_uart_age_s=0
+        )
+        for i, f in enumerate(sets)
+    ]
+    capture = tmp_path / "band.lp"
+    capture.write_bytes(b"".join(bytes([len(f)]) + f for f in frames))
+
+    csv = subprocess.run([str(exe), "--lp", "--csv", str(capture)], check=True, capture_output=True, text=True).stdout
+    for line, frame in zip(csv.strip().splitlines(), frames):
+        freqs = [int(v) for v in line.split(",")[-1].split()]
+        assert freqs == parse_report_frame(frame, expected_net_id=1).freq_mhz
+
+
+def test_host_decoder_reassembles_fragments_and_bounds_loss(host_build, tmp_path) -> None:
+    exe = host_build("frame_decode", ["tools/frame_decode.cpp"])
+    big = lambda src, seq: build_report_band_frame(
+        net_id=1,
+        src_id=src,
+        dst_id=0xFF,
+        boot_id=1,
+        seq=seq,
+        freq_mhz=list(range(400, 640, 3)) + list(range(1000, 1000 + src)),
+        status_flags=0x07,
+        last_uart_age_s=0,
+    )
+    a, b = fragment_frame(big(20, 1)), fragment_frame(big(21, 1))
+    # 40 messages that each lose their last piece, then two complete ones interleaved.
+    lossy = [fragment_frame(big(22, seq))[0] for seq in range(40)]
+    frames = lossy + [b[1], a[0], a[0], b[0], a[1]]
+    stream = b"".join(
+        build_export_rx_record(ts_ms=1000 * i, rssi=-90, snr=0, frame=f) for i, f in enumerate(frames)
+    )
+    capture = tmp_path / "frag.bin"
+    capture.write_bytes(stream)
+
+    csv = subprocess.run([str(exe), "--csv", str(capture)], check=True, capture_output=True, text=True).stdout
+    lines = csv.strip().splitlines()
+    assert [line.split(",")[3] for line in lines] == ["21", "20"]
+    for line, src in zip(lines, (21, 20)):
+        freqs = [int(v) for v in line.split(",")[-1].split()]
+        assert freqs == parse_report_frame(big(src, 1), expected_net_id=1).freq_mhz
+
+    summary = subprocess.run([str(exe), str(capture)], check=True, capture_output=True, text=True).stdout
+    assert "frames=45 reports=2" in summary
+    assert "fragments=45 reassembled=2" in summary
+    assert "bad_frames=0" in summary
+
+
+def test_host_decoder_reads_compact_and_legacy_headers_alike(host_build, tmp_path) -> None:
+    exe = host_build("frame_decode", ["tools/frame_decode.cpp"])
+    kwargs = dict(net_id=1, src_id=6, dst_id=0xFF, boot_id=3, seq=0x0105, freq_mhz=[433, 868], status_flags=0x05,
+                  last_uart_age_s=12)
+    big = dict(kwargs, freq_mhz=list(range(400, 640, 3)) + list(range(1000, 1020)))
+    frames = [
+        build_report_frame(**kwargs),
+        build_report_frame(**kwargs, compact=True),
+        build_ping_frame(net_id=1, src_id=9, dst_id=0xFF, boot_id=1, seq=0x200, compact=True),
+    ] + fragment_frame(build_report_band_frame(**big, compact=True))
+    capture = tmp_path / "compact.lp"
+    capture.write_bytes(b"".join(bytes([len(f)]) + f for f in frames))
+
+    csv = subprocess.run([str(exe), "--lp", "--csv", str(capture)], check=True, capture_output=True, text=True).stdout
+    lines = csv.strip().splitlines()
+    assert lines[0] == "0,0,0,6,261,REPORT,8,0,5,12,433 868"
+    assert lines[1] == "0,0,0,6,5,REPORT,8,0,5,12,433 868"
+    assert lines[2] == "0,0,0,9,0,PING,8,0,,,"
+    freqs = [int(v) for v in lines[3].split(",")[-1].split()]
+    assert freqs == parse_report_frame(build_report_band_frame(**big), expected_net_id=1).freq_mhz
+
+
+def test_host_decoder_groups_traced_reports_by_path(host_build, tmp_path) -> None:
+    exe = host_build("frame_decode", ["tools/frame_decode.cpp"])
+
+    def traced(seq, origin_ms, hops):
+        frame = trace_stamp(
+            trace_append(
+                build_report_frame(net_id=1, src_id=7, dst_id=0xFF, boot_id=1, seq=seq, freq_mhz=[433],
+                                   status_flags=0x05, last_uart_age_s=0, flags=FRAME_FLAG_TRACE)
+            ),
+            0xFF,
+            origin_ms,
+        )
+        for relay, delay in hops:
+            frame = trace_stamp(frame, relay, delay)
+        return frame
+
+    frames = [
+        traced(1, 100, [(3, 50), (4, 900)]),
+        traced(2, 300, [(3, 150), (4, 100)]),
+        traced(3, 20, []),
+        _report(7, 4, [433]),
+    ]
+    capture = tmp_path / "trace.lp"
+    capture.write_bytes(b"".join(bytes([len(f)]) + f for f in frames))
+
+    out = subprocess.run([str(exe), "--lp", "--trace", str(capture)], check=True, capture_output=True, text=True).stdout
+    lines = [line for line in out.splitlines() if line.startswith("trace ")]
+    assert lines == [
+        "trace src=7 relays=0x0000 reports=1 hops_avg=0.0 origin_queue_ms_avg=20 relay_queue_ms_avg=0 "
+        "max_hop_ms=0 max_hop_relay=255 last_relay=255",
+        "trace src=7 relays=0x0018 reports=2 hops_avg=0.0 origin_queue_ms_avg=200 relay_queue_ms_avg=600 "
+        "max_hop_ms=900 max_hop_relay=4 last_relay=4",
+    ]
+    assert "reports=4" in out
+
+
+def test_host_decoder_keeps_the_last_neighbour_links_per_source(host_build, tmp_path) -> None:
+    exe = host_build("frame_decode", ["tools/frame_decode.cpp"])
+    frames = [
+        neighbours_append(_report(3, 1, [433]), [(7, -70, 6, 75)]),
+        neighbours_append(_report(3, 2, [433]), [(7, -72, 5, 80), (9, -118, -12, 40)]),
+        _report(3, 3, [433]),  # No links: the last list stands.
+        neighbours_append(_report(4, 1, [433]), [(3, -60, 9, 100)]),
+    ]
+    assert parse_report_frame(frames[1], expected_net_id=1).neighbours == [(7, -72, 5, 80), (9, -118, -12, 40)]
+    capture = tmp_path / "links.lp"
+    capture.write_bytes(b"".join(bytes([len(f)]) + f for f in frames))
+
+    out = subprocess.run([str(exe), "--lp", "--links", str(capture)], check=True, capture_output=True, text=True).stdout
+    assert [line for line in out.splitlines() if line.startswith("links ")] == [
+        "links src=3 n=2 7:-72/5/80 9:-118/-12/40",
+        "links src=4 n=1 3:-60/9/100",
+    ]
+    assert "reports=4" in out and "bad_frames=0" in out
+
+
+def test_host_decoder_bench_runs(host_build) -> None:
+    exe = host_build("frame_decode", ["tools/frame_decode.cpp"])
+    out = subprocess.run([str(exe), "--bench", "20000"], check=True, capture_output=True, text=True).stdout
+    assert "bench frames=20000" in out
+    assert "bench_auth frames=20000" in out
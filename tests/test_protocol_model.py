@@ -1,23 +1,54 @@
 from tools.protocol_model import (
+    BRIDGE_KIND_LOG,
+    BRIDGE_KIND_RX,
+    BRIDGE_KIND_STATS,
+    BEACON_TYPE,
+    FRAME_FLAG_AUTH,
     FRAME_FLAG_NO_RELAY,
     ForwardQueue,
     ForwardWindowLimiter,
+    ReportRateController,
+    TxQueue,
     HEADER_LEN,
+    PHY_PROFILE_DEFAULT,
     PING_FRAME_LEN,
     PING_TYPE,
     REPORT_TYPE,
+    TLV_FREQ_BITMAP,
     TLV_FREQ_LIST,
+    TLV_FREQ_RLE,
     TLV_NODE_STATUS,
+    auth_append,
+    auth_ok,
+    build_beacon_frame,
+    build_export_log_record,
+    build_export_rx_record,
+    build_export_stats_record,
+    build_header,
     build_ping_frame,
+    build_report_band_frame,
+    simulate_cell_reports,
+    fragment_frame,
+    reassemble_fragments,
     build_report_frame,
     build_status_flags,
+    report_ack_missing,
+    report_phase_ms,
     calc_last_uart_age_s,
     crc16_ccitt_false,
+    decode_band_value,
+    encode_band_tlv,
     frame_crc_ok,
     frame_dec_ttl_inc_hops_recrc,
+    parse_beacon,
+    parse_export_stream,
     parse_freq_line_mhz,
+    parse_header,
     parse_ping_frame,
+    parse_report_frame,
     mesh_should_forward,
+    select_phy_profile,
+    siphash24,
 )
 
 
@@ -137,6 +168,22 @@ def test_forward_queue_drop_newest_policy() -> None:
     assert q.saturated_events == 1
 
 
+def test_tx_queue_coalesces_own_reports_in_place() -> None:
+    q = TxQueue(capacity=4)
+    assert q.push(BEACON_TYPE) == 0
+    assert q.push_report() == 1
+    assert q.push(BEACON_TYPE) == 2
+    for _ in range(10):
+        assert q.push_report() == 1  # same slot, same seq
+    assert q.items == [(BEACON_TYPE, 0), (REPORT_TYPE, 1), (BEACON_TYPE, 2)]
+    assert (q.superseded, q.dropped) == (10, 0)
+
+    q.pop()
+    q.pop()  # the report goes on air; the next one queues behind the beacon
+    assert q.push_report() == 3
+    assert q.items == [(BEACON_TYPE, 2), (REPORT_TYPE, 3)]
+
+
 def test_forward_window_limiter_resets_on_new_window() -> None:
     limiter = ForwardWindowLimiter(window_ms=10000, max_forwards_per_window=2)
 
@@ -165,3 +212,267 @@ def test_mesh_forward_rejects_when_dedup_already_seen() -> None:
     frame = build_ping_frame(net_id=1, src_id=10, dst_id=0xFF, boot_id=2, seq=78)
     assert frame_crc_ok(frame) is True
     assert mesh_should_forward(frame, dedup_seen=True, rate_allow=True) is False
+
+
+def test_export_stream_roundtrip_with_interleaved_logs() -> None:
+    frame = build_ping_frame(net_id=1, src_id=4, dst_id=0xFF, boot_id=9, seq=300)
+    stream = (
+        b"RXOK 1 12\r\n"
+        + build_export_rx_record(ts_ms=123456, rssi=-97, snr=-5, frame=frame)
+        + b"BXDROP 2\r\n"
+        + build_export_stats_record(ts_ms=130000, exported=41, dropped=2, high_water=512)
+    )
+    records = parse_export_stream(stream)
+    assert len(records) == 2
+
+    rx = records[0]
+    assert rx.kind == BRIDGE_KIND_RX
+    assert rx.ts_ms == 123456
+    assert rx.rssi == -97
+    assert rx.snr == -5
+    assert rx.frame == frame
+
+    stats = records[1]
+    assert stats.kind == BRIDGE_KIND_STATS
+    assert (stats.exported, stats.dropped, stats.high_water) == (41, 2, 512)
+
+
+def test_export_stream_carries_log_lines_as_records() -> None:
+    frame = build_ping_frame(net_id=1, src_id=4, dst_id=0xFF, boot_id=9, seq=301)
+    stream = (
+        build_export_log_record(ts_ms=5, text="BOOT 1 7")
+        + build_export_rx_record(ts_ms=6, rssi=-80, snr=2, frame=frame)
+        + build_export_log_record(ts_ms=7, text="BXDROP -3")
+    )
+    records = parse_export_stream(stream)
+    assert [(r.kind, r.ts_ms) for r in records] == [(BRIDGE_KIND_LOG, 5), (BRIDGE_KIND_RX, 6), (BRIDGE_KIND_LOG, 7)]
+    assert (records[0].text, records[1].frame, records[2].text) == ("BOOT 1 7", frame, "BXDROP -3")
+
+
+def test_export_stream_skips_corrupted_record_and_resyncs() -> None:
+    frame = build_ping_frame(net_id=1, src_id=5, dst_id=0xFF, boot_id=1, seq=1)
+    bad = bytearray(build_export_rx_record(ts_ms=1, rssi=-50, snr=7, frame=frame))
+    bad[-3] ^= 0xFF  # corrupt payload, CRC no longer matches
+    good = build_export_rx_record(ts_ms=2, rssi=-60, snr=3, frame=frame)
+
+    records = parse_export_stream(bytes(bad) + good)
+    assert [r.ts_ms for r in records] == [2]
+
+
+def test_beacon_phy_switch_roundtrip() -> None:
+    frame = build_beacon_frame(
+        net_id=1, src_id=0, boot_id=3, seq=12, active=2, target=0, switch_in_ms=30000, report_slowdown=2
+    )
+    assert frame[4] == BEACON_TYPE
+    assert len(frame) == HEADER_LEN + (2 + 4) + (2 + 1) + 2
+    beacon = parse_beacon(frame)
+    assert beacon.phy == (2, 0, 30000)
+    assert beacon.report_slowdown == 2
+
+    broken = bytearray(frame)
+    broken[12] ^= 0x01
+    assert parse_beacon(bytes(broken)) is None
+
+
+def test_phy_selection_uses_margin_hysteresis_and_power() -> None:
+    # SF7 floor -7.5 dB + 5 dB margin + 3 dB hysteresis when speeding up from SF9.
+    assert select_phy_profile(PHY_PROFILE_DEFAULT, 1) == 0
+    assert select_phy_profile(PHY_PROFILE_DEFAULT, 0) == 1
+    assert select_phy_profile(0, -2) == 0  # already there: no hysteresis to hold it
+    assert select_phy_profile(0, -3) == 1
+    # -11 dB at SF9/2 dBm fails SF9; SF10 at 10 dBm predicts -3 dB against a -10 dB need.
+    assert select_phy_profile(PHY_PROFILE_DEFAULT, -11) == 3
+    assert select_phy_profile(PHY_PROFILE_DEFAULT, -40) == 5
+
+
+def test_report_rate_set_change_gap_and_heartbeat_backoff() -> None:
+    ctl = ReportRateController(node_id=1)
+    sent = []
+    freqs, flags = [433, 868], 0x07
+    for now in range(0, 400_000, 100):
+        if now == 200_000:
+            freqs = [868, 433, 433]  # same set: not a change
+        if now == 250_000:
+            freqs = [433, 915]
+        if 250_000 < now < 256_000:
+            freqs = [433, 915 + (now // 1000) % 2]  # flapping: limited by the min gap
+        ctl.note(freqs, flags)
+        if ctl.due(now):
+            ctl.reported(freqs, flags, now)
+            sent.append(now)
+
+    gaps = [b - a for a, b in zip(sent, sent[1:])]
+    assert report_phase_ms(1) <= sent[0] < report_phase_ms(1) + 100  # boot report is phase shifted
+    assert gaps[0:4] == [5000, 10000, 20000, 40000]  # doubles while stable
+    assert max(gaps) == 80000
+    assert 250_000 in sent
+    assert min(gaps) >= 2000
+    assert len([t for t in sent if 250_000 <= t < 260_000]) <= 5
+
+
+def test_report_phase_spreads_consecutive_node_ids() -> None:
+    phases = sorted(report_phase_ms(n) for n in range(1, 9))
+    assert min(b - a for a, b in zip(phases, phases[1:])) >= 300
+
+
+def test_band_tlv_picks_smaller_encoding_and_roundtrips() -> None:
+    sparse = [403, 417, 590]
+    tlv = encode_band_tlv(sparse)
+    assert tlv[0] == TLV_FREQ_RLE
+    assert decode_band_value(tlv[0], tlv[2:]) == sparse
+
+    alternating = list(range(400, 440, 2))
+    tlv = encode_band_tlv(alternating)
+    assert tlv[0] == TLV_FREQ_BITMAP
+    assert len(tlv) == 2 + 3 + 5
+    assert decode_band_value(tlv[0], tlv[2:]) == alternating
+
+    dense = list(range(410, 600))
+    tlv = encode_band_tlv(dense)
+    assert tlv[0] == TLV_FREQ_RLE
+    assert len(tlv) < 2 + 3 + 10
+    assert decode_band_value(tlv[0], tlv[2:]) == dense
+
+    # Runs longer than 255 continue after a zero-length opposite run.
+    wide = list(range(0, 700))
+    tlv = encode_band_tlv(wide, start_mhz=0, channels=1024)
+    assert list(tlv[5:]) == [0, 255, 0, 255, 0, 190]
+    assert decode_band_value(tlv[0], tlv[2:]) == wide
+
+
+def test_report_band_frame_carries_200_channels_in_one_frame() -> None:
+    freqs = [f for f in range(400, 640) if f % 6 != 0][:200] + [868, 915]
+    frame = build_report_band_frame(
+        net_id=1, src_id=2, dst_id=0xFF, boot_id=1, seq=7, freq_mhz=freqs, status_flags=0x07, last_uart_age_s=0
+    )
+    assert len(frame) <= 64
+    parsed = parse_report_frame(frame, expected_net_id=1)
+    assert parsed.ok is True
+    assert sorted(parsed.freq_mhz) == sorted(freqs)
+
+
+def test_oversized_report_fragments_and_reassembles_out_of_order() -> None:
+    freqs = list(range(400, 640, 3)) + list(range(1000, 1020))
+    frame = build_report_band_frame(
+        net_id=1, src_id=2, dst_id=0xFF, boot_id=1, seq=9, freq_mhz=freqs, status_flags=0x07, last_uart_age_s=0
+    )
+    assert len(frame) > 64
+    pieces = fragment_frame(frame)
+    assert len(pieces) == 2 and all(len(p) <= 64 for p in pieces)
+    assert all(p[5:7] == frame[5:7] for p in pieces)  # SEQ is the message id
+
+    assert reassemble_fragments(pieces[1:]) == []
+    assert reassemble_fragments([pieces[1], pieces[1], pieces[0]]) == [frame]
+    assert sorted(parse_report_frame(frame, expected_net_id=1).freq_mhz) == sorted(freqs)
+
+
+def test_beacon_time_sync_tlv_is_optional_and_roundtrips() -> None:
+    plain = build_beacon_frame(net_id=1, src_id=0, boot_id=3, seq=1, active=2, target=2, switch_in_ms=0)
+    assert parse_beacon(plain).net_time_ms is None
+    timed = build_beacon_frame(
+        net_id=1, src_id=0, boot_id=3, seq=1, active=2, target=2, switch_in_ms=0, net_time_ms=0x12345678
+    )
+    assert len(timed) == len(plain) + 6
+    assert parse_beacon(timed).net_time_ms == 0x12345678
+
+
+def test_beacon_report_ack_list_roundtrips_and_marks_missing_seqs() -> None:
+    acks = [(7, 0x0102, 0b0000_0101), (9, 0xFFFF, 0xFF)]
+    frame = build_beacon_frame(
+        net_id=1, src_id=0, boot_id=3, seq=1, active=2, target=2, switch_in_ms=0, net_time_ms=5, report_acks=acks
+    )
+    plain = build_beacon_frame(net_id=1, src_id=0, boot_id=3, seq=1, active=2, target=2, switch_in_ms=0, net_time_ms=5)
+    assert len(frame) == len(plain) + 2 + 4 * len(acks)
+    info = parse_beacon(frame)
+    assert info.report_acks == acks and info.net_time_ms == 5
+    # 0x0102 arrived, 0x0101 and 0x00FF did (bits 0 and 2), 0x0100 did not.
+    assert [report_ack_missing(0x0102, 0b101, s) for s in (0x0102, 0x0101, 0x0100, 0x00FF)] == [
+        False, False, True, False,
+    ]
+    assert report_ack_missing(0x0102, 0b101, 0x0103) is None  # not heard of yet
+    assert report_ack_missing(0x0102, 0b101, 0x00F0) is None  # left the window
+    assert report_ack_missing(0x0001, 0, 0xFFFF) is True  # across the wrap
+    assert report_ack_missing(0x01, 0b11, 0xFF, seq_bits=8) is False  # compact seqs wrap at 256
+    assert report_ack_missing(0x01, 0b01, 0xFF, seq_bits=8) is True
+
+
+def test_tdma_slots_deliver_more_reports_than_random_backoff_in_dense_cell() -> None:
+    aloha = simulate_cell_reports(8, 5000, 600_000, tdma=False)
+    slotted = simulate_cell_reports(8, 5000, 600_000, tdma=True)
+    assert slotted >= 3 * aloha
+    # One full frame per node per superframe, none lost.
+    assert slotted > 1.3
+
+
+def test_compact_header_elides_defaults_and_coexists_with_legacy() -> None:
+    ping = build_ping_frame(net_id=1, src_id=9, dst_id=0xFF, boot_id=0xAB, seq=0x1234, compact=True)
+    assert len(ping) == PING_FRAME_LEN - 5
+    assert ping[0] & 0x80 and not build_ping_frame(1, 9, 0xFF, 0xAB, 0x1234)[0] & 0x80
+    parsed = parse_ping_frame(ping, expected_net_id=1)
+    assert parsed.ok and (parsed.seq, parsed.src_id, parsed.boot_id) == (0x34, 9, 0)
+
+    # BOOT rides on every SEQ wrap; DST and FLAGS only when not default.
+    epoch = parse_header(build_ping_frame(net_id=1, src_id=9, dst_id=0xFF, boot_id=0xAB, seq=0x100, compact=True))
+    assert (epoch.boot_id, epoch.length) == (0xAB, 6)
+    head = build_header(
+        net_id=3, src_id=4, dst_id=2, boot_id=1, frame_type=REPORT_TYPE, seq=7, ttl=20, hops=3,
+        flags=FRAME_FLAG_NO_RELAY, compact=True,
+    )
+    h = parse_header(head + b"\0\0")
+    assert (h.net_id, h.dst_id, h.ttl, h.hops, h.flags, h.length) == (3, 2, 15, 3, FRAME_FLAG_NO_RELAY, 7)
+
+    kwargs = dict(net_id=1, src_id=2, dst_id=0xFF, boot_id=7, seq=300, freq_mhz=[433, 868], status_flags=5,
+                  last_uart_age_s=1)
+    legacy, compact = build_report_frame(**kwargs), build_report_frame(**kwargs, compact=True)
+    assert len(legacy) - len(compact) == 5
+    assert parse_report_frame(compact, expected_net_id=1).freq_mhz == [433, 868]
+
+    relayed = frame_dec_ttl_inc_hops_recrc(compact)
+    assert frame_crc_ok(relayed)
+    assert (parse_header(relayed).ttl, parse_header(relayed).hops) == (7, 1)
+    saturated = build_header(net_id=1, src_id=2, dst_id=0xFF, boot_id=0, frame_type=PING_TYPE, seq=1, ttl=2,
+                             hops=15, compact=True)
+    assert parse_header(frame_dec_ttl_inc_hops_recrc(saturated + _crc(saturated))).hops == 15
+
+    big = build_report_band_frame(**{**kwargs, "freq_mhz": list(range(400, 640, 3)) + list(range(1000, 1020))},
+                                  compact=True)
+    pieces = fragment_frame(big)
+    assert len(pieces) == 2 and all(len(p) <= 64 and p[0] & 0x80 for p in pieces)
+    assert reassemble_fragments(pieces[::-1]) == [big]
+
+
+def _crc(body: bytes) -> bytes:
+    crc = crc16_ccitt_false(body)
+    return bytes([crc & 0xFF, crc >> 8])
+
+
+def test_auth_tag_survives_relays_and_catches_tampering() -> None:
+    key = bytes(range(16))
+    assert siphash24(key, bytes(range(15))) == 0xA129CA6149BE45E5  # reference vector
+    assert siphash24(key, b"") == 0x726FDB47DD0E0E31
+
+    for compact in (False, True):
+        plain = build_report_frame(net_id=1, src_id=2, dst_id=0xFF, boot_id=3, seq=9, freq_mhz=[433, 868],
+                                   status_flags=5, last_uart_age_s=1, flags=FRAME_FLAG_AUTH, compact=compact)
+        signed = auth_append(plain, key)
+        assert len(signed) == len(plain) + 6 and auth_ok(signed, key)
+        assert parse_report_frame(signed, expected_net_id=1).freq_mhz == [433, 868]
+        # TTL/HOPS are outside the tag: relays forward without re-signing.
+        assert auth_ok(frame_dec_ttl_inc_hops_recrc(signed), key)
+        assert not auth_ok(signed, bytes(16))
+        assert not auth_ok(plain, key)
+        forged = bytearray(signed)
+        forged[-8] ^= 0x01  # NODE_STATUS age byte, CRC fixed up
+        assert frame_crc_ok(bytes(forged[:-2]) + _crc(bytes(forged[:-2]))) is True
+        assert not auth_ok(bytes(forged[:-2]) + _crc(bytes(forged[:-2])), key)
+
+    # Each FRAG piece carries its own tag; the rebuilt frame keeps the original one.
+    big = auth_append(
+        build_report_band_frame(net_id=1, src_id=2, dst_id=0xFF, boot_id=3, seq=10, status_flags=5,
+                                last_uart_age_s=1, freq_mhz=list(range(400, 640, 3)) + list(range(1000, 1020)),
+                                flags=FRAME_FLAG_AUTH),
+        key,
+    )
+    pieces = fragment_frame(big, key=key)
+    assert all(len(p) <= 64 and auth_ok(p, key) for p in pieces)
+    assert reassemble_fragments(pieces) == [big]
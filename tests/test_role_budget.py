@@ -0,0 +1,29 @@
+import shutil
+
+import pytest
+
+from tools.sim.budget import measure
+
+pytestmark = pytest.mark.skipif(shutil.which("g++") is None, reason="no host C++ compiler")
+
+
+def _symbols(image, source):
+    return " ".join(image.sections.get(source, ()))
+
+
+def test_each_role_image_holds_only_its_own_tasks_and_buffers() -> None:
+    scanner, gateway = measure("scanner"), measure("gateway")
+
+    # Reassembly table, export ring and beacon state are gateway-only.
+    assert "gReasm" in _symbols(gateway, "app.cpp") and "gReasm" not in _symbols(scanner, "app.cpp")
+    assert "bridge.cpp" in gateway.modules and "bridge.cpp" not in scanner.modules
+    assert "gBeaconCount" in _symbols(gateway, "app.cpp") and "gBeaconCount" not in _symbols(scanner, "app.cpp")
+    # UART ingest, the frequency set and loss recovery are scanner-only.
+    assert "uart.cpp" in scanner.modules and "uart.cpp" not in gateway.modules
+    assert "gFreqs" in _symbols(scanner, "app.cpp") and "gFreqs" not in _symbols(gateway, "app.cpp")
+    assert "relay_ack.cpp" not in gateway.modules and "report_store.cpp" not in gateway.modules
+    assert "gRetx" in _symbols(scanner, "report_ack.cpp") and "gRetx" not in _symbols(gateway, "report_ack.cpp")
+
+    # Scanners spend the freed RAM on a larger dedup cache and deeper queues.
+    # Host images only compare the roles; they say nothing about target sizes.
+    assert scanner.modules["dedup.cpp"][1] > gateway.modules["dedup.cpp"][1]
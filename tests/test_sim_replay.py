@@ -0,0 +1,866 @@
+import subprocess
+from collections import Counter
+from pathlib import Path
+
+from tools.make_storm_trace import generate
+from tools.protocol_model import (
+    BEACON_TYPE,
+    CONFIG_TYPE,
+    FRAME_FLAG_AUTH,
+    FRAME_FLAG_NO_RELAY,
+    FRAME_FLAG_TRACE,
+    MeshParams,
+    PHY_PROFILE_DEFAULT,
+    REPORT_TYPE,
+    auth_append,
+    congestion_level,
+    auth_ok,
+    build_beacon_frame,
+    build_config_frame,
+    build_export_rx_record,
+    build_header,
+    build_coded_frame,
+    build_report_frame,
+    CODED_TYPE,
+    crc16_ccitt_false,
+    decode_coded,
+    frame_dec_ttl_inc_hops_recrc,
+    parse_beacon,
+    parse_config,
+    parse_header,
+    parse_report_frame,
+    parse_trace,
+    reassemble_fragments,
+    trace_append,
+    trace_stamp,
+)
+
+TRACES = Path(__file__).resolve().parent / "traces"
+
+
+def _with_hops(frame: bytes, hops: int) -> bytes:
+    body = bytearray(frame[:-2])
+    body[8] = hops  # legacy header
+    crc = crc16_ccitt_false(bytes(body))
+    return bytes(body) + bytes([crc & 0xFF, crc >> 8])
+
+
+def _metrics(stdout: str) -> dict:
+    return {k: float(v) for k, v in (line.split("=", 1) for line in stdout.splitlines() if "=" in line)}
+
+
+def _sent_frames(dump: Path) -> list:
+    data, frames = dump.read_bytes(), []
+    while data:
+        frames.append(data[1 : 1 + data[0]])
+        data = data[1 + data[0] :]
+    return frames
+
+
+def test_checked_in_storm_trace_matches_generator() -> None:
+    stream = b"".join(
+        build_export_rx_record(ts_ms=ts, rssi=rssi, snr=snr, frame=frame) for ts, rssi, snr, frame in generate()
+    )
+    assert (TRACES / "storm_relay.cap").read_bytes() == stream
+
+
+def test_storm_replay_meets_regression_limits(sim_build) -> None:
+    exe = sim_build("replay")
+    result = subprocess.run(
+        [str(exe), "--check", str(TRACES / "storm_relay.expect"), str(TRACES / "storm_relay.cap")],
+        capture_output=True,
+        text=True,
+    )
+    assert result.returncode == 0, result.stdout
+    m = _metrics(result.stdout)
+    assert m["frames_in"] == 1171
+    assert m["fwd_sent"] == m["fwd_queued"]  # everything queued drains within the drain period
+
+
+def test_replay_is_deterministic_and_check_detects_regression(sim_build, tmp_path) -> None:
+    exe = sim_build("replay")
+    cap = str(TRACES / "storm_relay.cap")
+    first = subprocess.run([str(exe), cap], check=True, capture_output=True, text=True).stdout
+    second = subprocess.run([str(exe), cap], check=True, capture_output=True, text=True).stdout
+    strip = lambda out: {k: v for k, v in _metrics(out).items() if k not in ("cpu_ns_per_frame", "tick_ns_max")}
+    assert strip(first) == strip(second)
+
+    impossible = tmp_path / "impossible.expect"
+    impossible.write_text("fwd_sent >= 1000000\n")
+    result = subprocess.run([str(exe), "--check", str(impossible), cap], capture_output=True, text=True)
+    assert result.returncode == 1
+    assert "CHECK FAIL fwd_sent" in result.stdout
+
+
+def test_node_follows_beacon_phy_switch_then_falls_back(sim_build, tmp_path) -> None:
+    exe = sim_build("replay")
+    beacon = build_beacon_frame(net_id=1, src_id=0, boot_id=1, seq=5, active=2, target=0, switch_in_ms=2000)
+    cap = tmp_path / "beacon.cap"
+    cap.write_bytes(build_export_rx_record(ts_ms=0, rssi=-80, snr=6, frame=beacon))
+
+    run = lambda drain: _metrics(
+        subprocess.run([str(exe), "--drain", str(drain), str(cap)], check=True, capture_output=True, text=True).stdout
+    )
+    switched = run(5000)
+    assert (switched["phy_profile"], switched["phy_switches"]) == (0, 1)
+
+    # No beacon for GW_TIMEOUT_MS: back to the profile lost nodes share.
+    lost = run(125000)
+    assert (lost["phy_profile"], lost["phy_fallbacks"]) == (PHY_PROFILE_DEFAULT, 1)
+
+
+def test_rescue_beacon_rejoins_active_profile_immediately(sim_build, tmp_path) -> None:
+    exe = sim_build("replay")
+    # Heard on the default profile while the network runs profile 1.
+    beacon = build_beacon_frame(net_id=1, src_id=0, boot_id=1, seq=9, active=1, target=1, switch_in_ms=0)
+    cap = tmp_path / "rescue.cap"
+    cap.write_bytes(build_export_rx_record(ts_ms=0, rssi=-110, snr=-9, frame=beacon))
+    m = _metrics(subprocess.run([str(exe), "--drain", "100", str(cap)], check=True, capture_output=True, text=True).stdout)
+    assert (m["phy_profile"], m["phy_switches"]) == (1, 1)
+
+
+def test_own_reports_back_off_and_follow_gateway_slowdown(sim_build, tmp_path) -> None:
+    exe = sim_build("replay")
+    run = lambda cap: _metrics(
+        subprocess.run([str(exe), "--drain", "300000", str(cap)], check=True, capture_output=True, text=True).stdout
+    )
+    frame = lambda slowdown: build_beacon_frame(
+        net_id=1, src_id=0, boot_id=1, seq=3, active=2, target=2, switch_in_ms=0, report_slowdown=slowdown
+    )
+
+    stable = tmp_path / "stable.cap"
+    stable.write_bytes(build_export_rx_record(ts_ms=0, rssi=-80, snr=6, frame=frame(0)))
+    m = run(stable)
+    # Boot report, then heartbeats at 5, 10, 20, 40 s and every 80 s: not 60 at a fixed 5 s.
+    assert 6 <= m["tx_sent"] <= 9
+    assert m["report_slowdown"] == 0
+
+    slowed = tmp_path / "slowed.cap"
+    slowed.write_bytes(build_export_rx_record(ts_ms=0, rssi=-80, snr=6, frame=frame(2)))
+    m = run(slowed)
+    assert m["report_slowdown"] == 2
+    assert m["tx_sent"] <= 4
+
+
+def test_uart_line_with_hundreds_of_channels_reports_in_one_frame(sim_build, tmp_path) -> None:
+    exe = sim_build("replay")
+    freqs = [f for f in range(400, 640) if f % 7 != 0][:200] + [868, 915, 0, 70000]
+    uart = tmp_path / "uart.txt"
+    uart.write_text("100 " + ",".join(str(f) for f in freqs) + "\n")
+    cap = tmp_path / "empty.cap"
+    cap.write_bytes(b"")
+    dump = tmp_path / "tx.lp"
+    subprocess.run(
+        [str(exe), "--drain", "8000", "--uart", str(uart), "--dump-tx", str(dump), str(cap)],
+        check=True,
+        capture_output=True,
+    )
+
+    reports = [parse_report_frame(f, expected_net_id=1) for f in _sent_frames(dump) if f[4] == REPORT_TYPE]
+    assert reports and all(r.ok for r in reports)
+    # 0 and 70000 are not frequencies; everything else survives in a single frame.
+    assert sorted(reports[-1].freq_mhz) == sorted(f for f in freqs if 0 < f <= 0xFFFF)
+
+
+def test_report_with_many_off_band_values_goes_out_fragmented(sim_build, tmp_path) -> None:
+    exe = sim_build("replay")
+    freqs = list(range(400, 640, 3)) + list(range(1000, 1020))
+    uart = tmp_path / "uart.txt"
+    uart.write_text("100 " + ",".join(str(f) for f in freqs) + "\n")
+    cap = tmp_path / "empty.cap"
+    cap.write_bytes(b"")
+    dump = tmp_path / "tx.lp"
+    out = subprocess.run(
+        [str(exe), "--drain", "8000", "--uart", str(uart), "--dump-tx", str(dump), str(cap)],
+        check=True,
+        capture_output=True,
+        text=True,
+    ).stdout
+
+    frames = _sent_frames(dump)
+    assert all(len(f) <= 64 for f in frames)
+    rebuilt = reassemble_fragments(frames)
+    assert _metrics(out)["tx_fragments"] == 2 * len(rebuilt) > 0
+    report = parse_report_frame(rebuilt[-1], expected_net_id=1)
+    assert report.ok and sorted(report.freq_mhz) == sorted(freqs)
+
+
+def test_beacon_time_sync_puts_own_reports_in_node_slot(sim_build, tmp_path) -> None:
+    exe = sim_build("replay")
+    run = lambda cap: _metrics(
+        subprocess.run([str(exe), "--drain", "60000", str(cap)], check=True, capture_output=True, text=True).stdout
+    )
+    beacon = lambda t: build_beacon_frame(
+        net_id=1, src_id=0, boot_id=1, seq=5, active=2, target=2, switch_in_ms=0, net_time_ms=t
+    )
+
+    unsynced = tmp_path / "plain.cap"
+    unsynced.write_bytes(build_export_rx_record(ts_ms=0, rssi=-80, snr=6, frame=beacon(None)))
+    m = run(unsynced)
+    assert m["tdma_synced"] == 0
+
+    synced = tmp_path / "timed.cap"
+    synced.write_bytes(build_export_rx_record(ts_ms=0, rssi=-80, snr=6, frame=beacon(7_777_777)))
+    m = run(synced)
+    assert m["tdma_synced"] == 1
+    assert m["tdma_own_tx"] >= 4
+    assert m["tdma_own_tx_in_slot"] == m["tdma_own_tx"]
+
+
+def test_compact_header_build_sends_shorter_frames_and_relays_both_formats(sim_build, tmp_path) -> None:
+    uart = tmp_path / "uart.txt"
+    uart.write_text("100 433,868,915\n")
+    neighbour = lambda compact: build_report_frame(
+        net_id=1, src_id=7, dst_id=0xFF, boot_id=2, seq=0x0142, freq_mhz=[433], status_flags=0x07,
+        last_uart_age_s=0, compact=compact,
+    )
+    cap = tmp_path / "rx.cap"
+    cap.write_bytes(
+        build_export_rx_record(ts_ms=500, rssi=-80, snr=6, frame=neighbour(True))
+        + build_export_rx_record(ts_ms=6000, rssi=-80, snr=6, frame=neighbour(False))
+    )
+
+    def sent(defines):
+        dump = tmp_path / ("tx_" + "_".join(defines) + ".lp")
+        subprocess.run(
+            [str(sim_build("replay", defines)), "--drain", "20000", "--uart", str(uart), "--dump-tx", str(dump),
+             str(cap)],
+            check=True,
+            capture_output=True,
+        )
+        return _sent_frames(dump)
+
+    legacy, compact = sent(()), sent(("COMPACT_HEADER_TX=1",))
+    own = lambda frames: [
+        f for f in frames if parse_header(f).src_id == 1 and parse_header(f).frame_type == REPORT_TYPE
+    ]
+    assert own(legacy) and own(compact)
+    assert all(parse_header(f).compact for f in own(compact))
+    assert parse_report_frame(own(compact)[0], expected_net_id=1).freq_mhz == [433, 868, 915]
+    assert len(own(legacy)[-1]) - len(own(compact)[-1]) >= 4
+
+    # Relays keep the sender's format whatever this node sends itself.
+    relayed = [parse_header(f) for f in compact if parse_header(f).src_id == 7]
+    assert [(h.compact, h.ttl, h.hops) for h in relayed] == [(True, 7, 1), (False, 7, 1)]
+
+
+def test_auth_build_drops_untagged_frames_before_they_cost_a_forward(sim_build, tmp_path) -> None:
+    key = b"papuga-net-key-1"  # AUTH_KEY in src/config.h
+    exe = sim_build("replay", ("AUTH_ENABLED=1",))
+    report = lambda src, flags: build_report_frame(
+        net_id=1, src_id=src, dst_id=0xFF, boot_id=2, seq=src, freq_mhz=[433], status_flags=0x07,
+        last_uart_age_s=0, flags=flags,
+    )
+    beacon = build_beacon_frame(
+        net_id=1, src_id=0, boot_id=1, seq=77, active=2, target=2, switch_in_ms=0, net_time_ms=5000,
+        flags=FRAME_FLAG_AUTH,
+    )
+    frames = [auth_append(report(41, FRAME_FLAG_AUTH), key), auth_append(beacon, key)]
+    frames += [auth_append(report(40, FRAME_FLAG_AUTH), bytes(16))]  # wrong key
+    frames += [report(src, 0) for src in range(20, 40)]  # valid CRC, no tag
+    cap = tmp_path / "auth.cap"
+    cap.write_bytes(
+        b"".join(build_export_rx_record(ts_ms=1000 * i, rssi=-80, snr=6, frame=f) for i, f in enumerate(frames))
+    )
+    uart = tmp_path / "uart.txt"
+    uart.write_text("100 433\n")
+    dump = tmp_path / "tx.lp"
+    out = subprocess.run(
+        [str(exe), "--drain", "15000", "--uart", str(uart), "--dump-tx", str(dump), str(cap)],
+        check=True,
+        capture_output=True,
+        text=True,
+    ).stdout
+    m = _metrics(out)
+    assert m["rx_accepted"] == 2
+    assert m["fwd_queued"] == 2
+    # Everything else the radio delivered (some arrive while it transmits) fails the tag.
+    assert m["rx_drop_auth"] == m["rx_frames"] - 2 >= 15
+
+    sent = _sent_frames(dump)
+    # Own frames are tagged; the relayed beacon was restamped and re-signed.
+    assert sent and all(auth_ok(f, key) for f in sent)
+    relayed = [f for f in sent if parse_header(f).frame_type == BEACON_TYPE]
+    assert relayed and relayed[0] != auth_append(beacon, key)
+
+
+def test_rx_classifier_counts_each_rejection_at_its_own_stage(sim_build, tmp_path) -> None:
+    def frame(src, seq, *, net_id=1, frame_type=REPORT_TYPE, ttl=7, flags=0, compact=False):
+        body = build_header(net_id=net_id, src_id=src, dst_id=0xFF, boot_id=2, frame_type=frame_type, seq=seq,
+                            ttl=ttl, flags=flags, compact=compact) + bytes([0x01, 0x02, 0xB1, 0x01])
+        crc = crc16_ccitt_false(body)
+        return body + bytes([crc & 0xFF, crc >> 8])
+
+    good = frame(20, 1)
+    frames = [
+        good,
+        good,  # dedup
+        frame(21, 1, net_id=2),  # foreign network
+        frame(22, 1, frame_type=0x7E),  # unknown type
+        frame(1, 1),  # own echo (NODE_ID 1)
+        frame(23, 1, ttl=0),
+        frame(24, 1, flags=FRAME_FLAG_NO_RELAY),
+        frame(25, 1)[:-1] + b"\x00",  # bad CRC
+        b"\x01\x02\x03",  # length
+        # Kept despite TTL 0: nodes still act on beacons.
+        build_beacon_frame(net_id=1, src_id=0, boot_id=1, seq=9, active=2, target=2, switch_in_ms=0, ttl=0),
+        frame(26, 1, compact=True),  # compact header carries NET_ID's low nibble
+    ]
+    cap = tmp_path / "classify.cap"
+    cap.write_bytes(
+        b"".join(build_export_rx_record(ts_ms=1000 * i, rssi=-80, snr=6, frame=f) for i, f in enumerate(frames))
+    )
+    out = subprocess.run(
+        [str(sim_build("replay")), "--drain", "5000", str(cap)], check=True, capture_output=True, text=True
+    ).stdout
+    m = _metrics(out)
+    assert m["rx_frames"] == len(frames)
+    assert m["rx_accepted"] == 3
+    for reason in ("dedup", "net", "type", "self", "crc", "length"):
+        assert m["rx_drop_" + reason] == 1, reason
+    assert m["rx_drop_no_relay"] == 2
+    assert m["rx_drop_auth"] == 0
+    assert m["fwd_queued"] == 2
+
+
+def test_relay_ack_resends_reports_no_neighbour_was_heard_relaying(sim_build, tmp_path) -> None:
+    report = lambda src, hops: _with_hops(
+        build_report_frame(net_id=1, src_id=src, dst_id=0xFF, boot_id=2, seq=5, freq_mhz=[433], status_flags=0x07,
+                           last_uart_age_s=0),
+        hops,
+    )
+    events = [
+        (1000, report(20, 0)),
+        (1600, report(20, 2)),  # next hop relays our copy: ACK
+        (5000, report(21, 0)),  # nobody relays: two re-sends, then give up
+        (6000, report(22, 0)[:9] + bytes([FRAME_FLAG_NO_RELAY]) + report(22, 0)[10:]),
+    ]
+    cap = tmp_path / "ack.cap"
+    cap.write_bytes(b"".join(build_export_rx_record(ts_ms=t, rssi=-80, snr=6, frame=f) for t, f in events))
+    dump = tmp_path / "tx.lp"
+    out = subprocess.run(
+        [str(sim_build("replay", ("RELAY_ACK_ENABLED=1",))), "--drain", "20000", "--dump-tx", str(dump), str(cap)],
+        check=True,
+        capture_output=True,
+        text=True,
+    ).stdout
+    sent = [parse_header(f).src_id for f in _sent_frames(dump)]
+    assert sent.count(20) == 1
+    assert sent.count(21) == 3
+    assert sent.count(22) == 0
+    m = _metrics(out)
+    assert m["relay_ack_heard"] >= 1
+    assert m["relay_ack_gave_up"] >= 1
+
+    # Signed network: a relayed copy whose tag does not verify is no ACK.
+    key = b"papuga-net-key-1"  # AUTH_KEY in src/config.h
+    signed = auth_append(
+        build_report_frame(net_id=1, src_id=20, dst_id=0xFF, boot_id=2, seq=5, freq_mhz=[433], status_flags=0x07,
+                           last_uart_age_s=0, flags=FRAME_FLAG_AUTH),
+        key,
+    )
+    forged = bytearray(_with_hops(signed, 2))
+    forged[-3] ^= 0xFF  # last tag byte
+    forged = _with_hops(bytes(forged), 2)  # re-seal the CRC only
+    for relayed, copies in ((_with_hops(signed, 2), 1), (forged, 3)):
+        cap.write_bytes(
+            build_export_rx_record(ts_ms=1000, rssi=-80, snr=6, frame=signed)
+            + build_export_rx_record(ts_ms=1600, rssi=-80, snr=6, frame=relayed)
+        )
+        subprocess.run(
+            [str(sim_build("replay", ("RELAY_ACK_ENABLED=1", "AUTH_ENABLED=1"))), "--drain", "20000", "--dump-tx",
+             str(dump), str(cap)],
+            check=True,
+            capture_output=True,
+        )
+        assert [parse_header(f).src_id for f in _sent_frames(dump)].count(20) == copies
+
+    # A burst past the forward budget: refused re-sends wait for another
+    # timeout instead of counting as retries that never went on air.
+    burst = [
+        build_report_frame(net_id=1, src_id=10 + i, dst_id=0xFF, boot_id=1, seq=1, freq_mhz=[433], status_flags=0,
+                           last_uart_age_s=0)
+        for i in range(12)
+    ]
+    cap.write_bytes(
+        b"".join(build_export_rx_record(ts_ms=10 * i, rssi=-80, snr=6, frame=f) for i, f in enumerate(burst))
+    )
+    out = subprocess.run(
+        [str(sim_build("replay", ("RELAY_ACK_ENABLED=1",))), "--drain", "60000", "--dump-tx", str(dump), str(cap)],
+        check=True,
+        capture_output=True,
+        text=True,
+    ).stdout
+    copies = Counter((h.src_id, h.seq) for h in map(parse_header, _sent_frames(dump)) if h.frame_type == REPORT_TYPE)
+    m = _metrics(out)
+    assert m["fwd_drop_rate"] > 0
+    assert m["relay_ack_retries"] == sum(n - 1 for n in copies.values()) > 0
+
+
+
+def test_node_resends_only_the_reports_a_gateway_beacon_lists_missing(sim_build, tmp_path) -> None:
+    # Own REPORTs go out with seq 0, 1, 2 in the first 20 s; the gateway says
+    # it has 2 and 1 (bitmap bit 0) but not 0 (bit 1).
+    beacon = build_beacon_frame(
+        net_id=1, src_id=0, boot_id=1, seq=40, active=2, target=2, switch_in_ms=0, report_acks=[(9, 0, 0), (1, 2, 0b01)]
+    )
+    cap = tmp_path / "rack.cap"
+    foreign = build_report_frame(
+        net_id=2, src_id=5, dst_id=0xFF, boot_id=1, seq=1, freq_mhz=[], status_flags=0, last_uart_age_s=0
+    )  # Replay time starts at the first record.
+    cap.write_bytes(
+        build_export_rx_record(ts_ms=0, rssi=-80, snr=6, frame=foreign)
+        + build_export_rx_record(ts_ms=24000, rssi=-80, snr=6, frame=beacon)
+    )
+    dump = tmp_path / "tx.lp"
+    out = subprocess.run(
+        [str(sim_build("replay", ("REPORT_ACK_ENABLED=1",))), "--drain", "5000", "--dump-tx", str(dump), str(cap)],
+        check=True,
+        capture_output=True,
+        text=True,
+    ).stdout
+    own = [h.seq for h in map(parse_header, _sent_frames(dump)) if (h.src_id, h.frame_type) == (1, REPORT_TYPE)]
+    assert own[:3] == [0, 1, 2]
+    assert own.count(0) == 2 and own.count(1) == 1 and own.count(2) == 1
+    m = _metrics(out)
+    assert m["report_ack_confirmed"] == 2
+    assert m["report_resent"] == 1
+
+
+def test_missing_reports_listed_while_the_tx_queue_is_full_go_out_once_it_drains(sim_build, tmp_path) -> None:
+    # Heartbeats send seq 0..3 first. A long UART line then queues a two-piece
+    # fragmented REPORT, and a beacon heard before either piece is on air lists
+    # all four as missing: only two re-sends fit a 4-deep TX queue at first.
+    freqs = list(range(400, 640, 2)) + list(range(1000, 1024))
+    uart = tmp_path / "uart.txt"
+    uart.write_text("42000 " + ",".join(str(f) for f in freqs) + "\n")
+    foreign = build_report_frame(
+        net_id=2, src_id=5, dst_id=0xFF, boot_id=1, seq=1, freq_mhz=[], status_flags=0, last_uart_age_s=0
+    )  # Replay time starts at the first record.
+    beacon = build_beacon_frame(
+        net_id=1, src_id=0, boot_id=1, seq=40, active=2, target=2, switch_in_ms=0, report_acks=[(1, 4, 0)]
+    )
+    cap = tmp_path / "full.cap"
+    cap.write_bytes(
+        build_export_rx_record(ts_ms=0, rssi=-80, snr=6, frame=foreign)
+        + build_export_rx_record(ts_ms=42100, rssi=-80, snr=6, frame=beacon)
+    )
+    dump = tmp_path / "tx.lp"
+    out = subprocess.run(
+        [str(sim_build("replay", ("REPORT_ACK_ENABLED=1", "SCANNER_TX_QUEUE_DEPTH=4"))), "--drain", "10000",
+         "--uart", str(uart), "--dump-tx", str(dump), str(cap)],
+        check=True,
+        capture_output=True,
+        text=True,
+    ).stdout
+    own = [h.seq for h in map(parse_header, _sent_frames(dump)) if (h.src_id, h.frame_type) == (1, REPORT_TYPE)]
+    assert [own.count(seq) for seq in range(4)] == [2, 2, 2, 2]
+    m = _metrics(out)
+    assert (m["report_resent"], m["tx_queue_high_water"], m["tx_drop_queue"]) == (4, 4, 0)
+
+
+def test_report_ack_compares_compact_seqs_across_the_8_bit_wrap(sim_build, tmp_path) -> None:
+    # Gateway: a compact source going 253..255, 0, 1 has moved on, not restarted.
+    reports = [
+        build_report_frame(
+            net_id=1, src_id=9, dst_id=0xFF, boot_id=1, seq=seq, freq_mhz=[433], status_flags=0,
+            last_uart_age_s=0, compact=True,
+        )
+        for seq in (253, 254, 255, 0, 1)
+    ]
+    cap = tmp_path / "wrap_gw.cap"
+    cap.write_bytes(
+        b"".join(build_export_rx_record(ts_ms=50 * i, rssi=-80, snr=6, frame=f) for i, f in enumerate(reports))
+    )
+    dump = tmp_path / "tx.lp"
+    subprocess.run(
+        [str(sim_build("replay", ("ROLE_GATEWAY=1", "REPORT_ACK_ENABLED=1"))), "--drain", "20000", "--dump-tx",
+         str(dump), str(cap)],
+        check=True,
+        capture_output=True,
+    )
+    acks = [a for b in map(parse_beacon, _sent_frames(dump)) if b for a in b.report_acks]
+    assert acks and acks[0] == (9, 1, 0b1111)
+
+    # Node: one changed UART line every 2.6 s takes its own seq past 255, the
+    # last one on air being 258 & 0xFF. The gateway then has all of them,
+    # including the four kept for re-send across the wrap.
+    lines = 259
+    uart = tmp_path / "uart.txt"
+    uart.write_text("".join(f"{1000 + 2600 * i} {433 + i % 2}\n" for i in range(lines)))
+    last_ms = 1000 + 2600 * (lines - 1)
+    foreign = build_report_frame(
+        net_id=2, src_id=5, dst_id=0xFF, boot_id=1, seq=1, freq_mhz=[], status_flags=0, last_uart_age_s=0
+    )  # Replay time starts at the first record.
+    beacon = build_beacon_frame(
+        net_id=1, src_id=0, boot_id=1, seq=40, active=2, target=2, switch_in_ms=0, report_acks=[(1, 2, 0xFF)]
+    )
+    cap = tmp_path / "wrap_node.cap"
+    cap.write_bytes(
+        build_export_rx_record(ts_ms=0, rssi=-80, snr=6, frame=foreign)
+        + build_export_rx_record(ts_ms=last_ms + 2500, rssi=-80, snr=6, frame=beacon)
+    )
+    out = subprocess.run(
+        [str(sim_build("replay", ("COMPACT_HEADER_TX=1", "REPORT_ACK_ENABLED=1"))), "--drain", "1000", "--uart",
+         str(uart), "--dump-tx", str(dump), str(cap)],
+        check=True,
+        capture_output=True,
+        text=True,
+    ).stdout
+    own = [h.seq for h in map(parse_header, _sent_frames(dump)) if (h.src_id, h.frame_type) == (1, REPORT_TYPE)]
+    assert len(own) == lines and own[-4:] == [255, 0, 1, 2]
+    m = _metrics(out)
+    assert (m["report_ack_confirmed"], m["report_resent"]) == (4, 0)
+
+
+def test_traced_reports_carry_origin_queue_time_and_relay_stamps(sim_build, tmp_path) -> None:
+    traced = trace_stamp(
+        trace_append(
+            build_report_frame(net_id=1, src_id=30, dst_id=0xFF, boot_id=2, seq=9, freq_mhz=[433], status_flags=0x07,
+                               last_uart_age_s=0, flags=FRAME_FLAG_TRACE)
+        ),
+        relay_id=0xFF,
+        delay_ms=40,
+    )
+    plain = build_report_frame(
+        net_id=1, src_id=31, dst_id=0xFF, boot_id=2, seq=9, freq_mhz=[433], status_flags=0x07, last_uart_age_s=0
+    )
+    cap = tmp_path / "trace.cap"
+    cap.write_bytes(
+        build_export_rx_record(ts_ms=1000, rssi=-80, snr=6, frame=traced)
+        + build_export_rx_record(ts_ms=4000, rssi=-80, snr=6, frame=plain)
+    )
+    dump = tmp_path / "tx.lp"
+    subprocess.run(
+        [str(sim_build("replay", ("TRACE_REPORT_EVERY=1",))), "--drain", "15000", "--dump-tx", str(dump), str(cap)],
+        check=True,
+        capture_output=True,
+        text=True,
+    )
+    sent = {}
+    for frame in _sent_frames(dump):
+        h = parse_header(frame)
+        if h.frame_type == REPORT_TYPE:
+            sent.setdefault(h.src_id, frame)
+
+    own = parse_trace(sent[1])
+    assert own is not None and (own.last_relay, own.relay_bits) == (0xFF, 0)
+    assert parse_report_frame(sent[1], expected_net_id=1).ok
+
+    relayed = parse_trace(sent[30])
+    assert (relayed.origin_queue_ms, relayed.last_relay, relayed.max_hop_relay) == (40, 1, 1)
+    assert relayed.relay_bits == 1 << 1
+    assert relayed.relay_queue_ms == relayed.max_hop_ms
+    assert parse_report_frame(sent[30], expected_net_id=1).ok
+
+    assert parse_trace(sent[31]) is None
+    assert len(sent[31]) == len(plain)
+
+
+def _store_run(sim_build, tmp_path, defines, outage_end_ms: int):
+    beacon = lambda seq: build_beacon_frame(net_id=1, src_id=0, boot_id=1, seq=seq, active=2, target=2, switch_in_ms=0)
+    foreign = build_report_frame(
+        net_id=2, src_id=5, dst_id=0xFF, boot_id=1, seq=1, freq_mhz=[], status_flags=0, last_uart_age_s=0
+    )  # Replay time starts at the first record.
+    # Beacons stop after 1 s and come back, every 10 s, at outage_end_ms.
+    events = [(0, foreign), (1000, beacon(40))]
+    events += [(outage_end_ms + 10000 * i, beacon(41 + i)) for i in range(20)]
+    cap = tmp_path / "store.cap"
+    cap.write_bytes(b"".join(build_export_rx_record(ts_ms=t, rssi=-80, snr=6, frame=f) for t, f in events))
+    # A new frequency set every 3 s keeps own REPORTs coming through the outage.
+    uart = tmp_path / "uart.txt"
+    uart.write_text("".join(f"{t} {400 + i % 200}\n" for i, t in enumerate(range(2000, outage_end_ms + 20000, 3000))))
+    dump = tmp_path / "tx.lp"
+    out = subprocess.run(
+        [str(sim_build("replay", ("STORE_FORWARD_ENABLED=1",) + defines)), "--drain", "20000", "--uart", str(uart),
+         "--dump-tx", str(dump), str(cap)],
+        check=True,
+        capture_output=True,
+        text=True,
+    ).stdout
+    seqs = [h.seq for h in map(parse_header, _sent_frames(dump)) if (h.src_id, h.frame_type) == (1, REPORT_TYPE)]
+    return seqs, _metrics(out)
+
+
+def test_reports_made_during_a_gateway_outage_drain_from_flash_afterwards(sim_build, tmp_path) -> None:
+    # Holding starts 35 s after the last beacon and ends at 70 s.
+    seqs, m = _store_run(sim_build, tmp_path, (), 70000)
+    assert sorted(seqs) == list(range(len(seqs)))  # no gap
+    assert m["store_written"] >= 10
+    assert m["store_drained"] == m["store_written"]
+    assert (m["store_pending"], m["store_dropped"]) == (0, 0)
+
+    seqs, m = _store_run(sim_build, tmp_path, ("STORE_POLICY=1",), 70000)
+    assert m["store_superseded"] == m["store_written"] - 1
+    assert m["store_drained"] == 1
+    # Only the newest REPORT of the outage is left to send.
+    stored = [s for s in range(max(seqs)) if s not in seqs]
+    assert len(stored) == m["store_superseded"]
+
+
+def test_full_report_store_drops_its_oldest_page_and_wears_pages_evenly(sim_build, tmp_path) -> None:
+    seqs, m = _store_run(sim_build, tmp_path, (), 700000)
+    assert m["store_dropped"] > 0
+    assert m["store_drained"] == m["store_written"] - m["store_dropped"]
+    assert m["store_erases_min"] >= 1 and m["store_erases_max"] - m["store_erases_min"] <= 1
+    # What survives is the newest, contiguous part of the outage.
+    missing = [s for s in range(max(seqs)) if s not in seqs]
+    assert len(missing) == m["store_dropped"]
+    assert missing == list(range(missing[0], missing[-1] + 1))
+
+
+def _config_run(sim_build, tmp_path, neighbour_ms):
+    params = MeshParams(200, 900, 10000, 6, 5, 60)
+    foreign = build_report_frame(
+        net_id=2, src_id=5, dst_id=0xFF, boot_id=1, seq=1, freq_mhz=[], status_flags=0, last_uart_age_s=0
+    )  # Replay time starts at the first record.
+    bad = MeshParams(200, 900, 10000, 6, 0, 60)  # TTL 0: refused
+    events = [(0, foreign), (5000, build_config_frame(net_id=1, src_id=7, seq=1, version=4, params=bad))]
+    events += [(t, build_config_frame(net_id=1, src_id=7, seq=2 + i, version=3, params=params))
+               for i, t in enumerate(neighbour_ms)]
+    cap = tmp_path / "config.cap"
+    cap.write_bytes(b"".join(build_export_rx_record(ts_ms=t, rssi=-80, snr=6, frame=f) for t, f in events))
+    uart = tmp_path / "uart.txt"
+    uart.write_text("20000 433\n")
+    dump = tmp_path / "tx.lp"
+    out = subprocess.run(
+        [str(sim_build("replay", ("CONFIG_SYNC_ENABLED=1",))), "--drain", "600000", "--uart", str(uart),
+         "--dump-tx", str(dump), str(cap)],
+        check=True,
+        capture_output=True,
+        text=True,
+    ).stdout
+    configs, reports = [], []
+    for frame in _sent_frames(dump):
+        h = parse_header(frame)
+        if h.src_id == 1 and h.frame_type == CONFIG_TYPE:
+            configs.append(parse_config(frame))
+        elif h.src_id == 1 and h.frame_type == REPORT_TYPE:
+            reports.append(h)
+    return configs, reports, params, _metrics(out)
+
+
+def test_node_adopts_newer_mesh_params_and_trickle_spaces_out_its_announcements(sim_build, tmp_path) -> None:
+    configs, reports, params, m = _config_run(sim_build, tmp_path, [10000])
+    # One announce at boot without parameters, then the adopted version.
+    assert configs[0] == (0, None)
+    assert configs[1:] and all(c == (3, params) for c in configs[1:])
+    # Intervals double from 4 s: a handful of sends in ten minutes.
+    assert len(configs) <= 10
+    assert (m["config_version"], m["config_adopted"]) == (3, 1)
+    # REPORTs before the adoption went out with config.h's TTL, all later ones with the new one.
+    ttls = [h.ttl for h in reports]
+    assert ttls[0] != params.data_ttl and ttls[-1] == params.data_ttl
+    assert ttls == sorted(ttls, reverse=True)
+
+
+def test_consistent_neighbour_suppresses_config_announcements(sim_build, tmp_path) -> None:
+    configs, _, _, m = _config_run(sim_build, tmp_path, range(10000, 600000, 1000))
+    assert configs == [(0, None)]
+    assert m["config_suppressed"] >= 5
+
+
+def test_relay_stamps_its_congestion_level_on_forwarded_frames(sim_build, tmp_path) -> None:
+    key = b"papuga-net-key-1"  # AUTH_KEY in src/config.h
+    # Twelve neighbours' REPORTs in one burst: eight fill a scanner's forward queue.
+    burst = lambda compact, auth: [
+        (f if not auth else auth_append(f, key))
+        for f in (
+            build_report_frame(
+                net_id=1, src_id=10 + i, dst_id=0xFF, boot_id=1, seq=1, freq_mhz=[433], status_flags=0,
+                last_uart_age_s=0, compact=compact, flags=FRAME_FLAG_AUTH if auth else 0,
+            )
+            for i in range(12)
+        )
+    ]
+    for defines, compact, auth in (((), True, False), (("AUTH_ENABLED=1",), False, True)):
+        cap = tmp_path / "burst.cap"
+        cap.write_bytes(
+            b"".join(build_export_rx_record(ts_ms=10 * i, rssi=-80, snr=6, frame=f)
+                     for i, f in enumerate(burst(compact, auth)))
+        )
+        dump = tmp_path / "tx.lp"
+        out = subprocess.run(
+            [str(sim_build("replay", ("CONGESTION_ENABLED=1",) + defines)), "--drain", "20000", "--dump-tx",
+             str(dump), str(cap)],
+            check=True,
+            capture_output=True,
+            text=True,
+        ).stdout
+        sent = _sent_frames(dump)
+        relayed = [f for f in sent if parse_header(f).src_id >= 10]
+        levels = [congestion_level(f) for f in relayed]
+        # Full queue first, then lower levels as it drains. The last one goes out
+        # alone, but 8 of 10 forwards in this window are spent.
+        assert len(relayed) == 8 and levels[0] == 3 and levels[-1] == 2
+        assert levels == sorted(levels, reverse=True)
+        # Own frames sent meanwhile carry the level too.
+        assert _metrics(out)["congestion_signalled"] == sum(1 for f in sent if congestion_level(f) > 0)
+        # Compact frames gain a FLAGS byte only while the level is non-zero; signed ones stay valid.
+        for f in relayed:
+            assert parse_report_frame(f, expected_net_id=1).freq_mhz == [433]
+            assert not auth or auth_ok(f, key)
+        if compact:
+            assert [parse_header(f).length for f in relayed] == [6 if lv else 5 for lv in levels]
+
+
+def test_heard_congestion_slows_own_reports_until_it_decays(sim_build, tmp_path) -> None:
+    congested = build_report_frame(
+        net_id=1, src_id=7, dst_id=0xFF, boot_id=1, seq=1, freq_mhz=[433], status_flags=0, last_uart_age_s=0,
+        flags=3 << 3,
+    )
+    # A new frequency set every 2.5 s for 4 minutes asks for a REPORT each time.
+    uart = tmp_path / "uart.txt"
+    uart.write_text("".join(f"{t} {400 + i % 200}\n" for i, t in enumerate(range(1000, 240000, 2500))))
+
+    def own_reports(signal_until_ms):
+        foreign = build_report_frame(
+            net_id=2, src_id=5, dst_id=0xFF, boot_id=1, seq=1, freq_mhz=[], status_flags=0, last_uart_age_s=0
+        )  # Replay time starts at the first record.
+        events = [(0, foreign)] + [(t, congested) for t in range(1000, signal_until_ms, 10000)] + [(240000, foreign)]
+        cap = tmp_path / "congested.cap"
+        cap.write_bytes(b"".join(build_export_rx_record(ts_ms=t, rssi=-80, snr=6, frame=f) for t, f in events))
+        dump = tmp_path / "tx.lp"
+        out = subprocess.run(
+            [str(sim_build("replay", ("CONGESTION_ENABLED=1",))), "--drain", "10000", "--uart", str(uart),
+             "--dump-tx", str(dump), str(cap)],
+            check=True,
+            capture_output=True,
+            text=True,
+        ).stdout
+        sent = [f for f in _sent_frames(dump) if parse_header(f).src_id == 1]
+        return len(sent), _metrics(out)
+
+    free, m = own_reports(0)
+    assert m["congestion_heard"] == 0
+    throttled, m = own_reports(240000)
+    assert m["congestion_heard"] == 24
+    decayed, _ = own_reports(60000)
+    # Level 3 stretches the 2 s minimum gap to 16 s; 30 s after the last signal it is 2 s again.
+    assert free >= 80 and throttled <= free // 5
+    assert throttled < decayed < free
+
+
+def test_neighbour_table_tracks_direct_links_and_reports_them(sim_build, tmp_path) -> None:
+    report = lambda src, seq: build_report_frame(
+        net_id=1, src_id=src, dst_id=0xFF, boot_id=1, seq=seq, freq_mhz=[433], status_flags=0, last_uart_age_s=0
+    )
+    # Twenty one-off neighbours, then node 7 every 2 s with every 4th seq lost
+    # and node 8 only ever heard through relays.
+    events = [(100 + 10 * i, report(30 + i, 1)) for i in range(20)]
+    events += [(2000 * s, report(7, s)) for s in range(1, 196) if s % 4 != 0]
+    events += [(1000 + 2000 * s, _with_hops(report(8, s), 2)) for s in range(1, 41)]
+    cap = tmp_path / "neighbours.cap"
+    cap.write_bytes(b"".join(build_export_rx_record(ts_ms=t, rssi=-70, snr=6, frame=f) for t, f in sorted(events)))
+    dump = tmp_path / "tx.lp"
+    out = subprocess.run(
+        [str(sim_build("replay", ("NEIGHBOUR_REPORT_EVERY=1",))), "--drain", "2400000", "--dump-tx", str(dump),
+         str(cap)],
+        check=True,
+        capture_output=True,
+        text=True,
+    ).stdout
+    m = _metrics(out)
+    # 21 direct sources in 16 slots; the one-offs age out after NEIGHBOUR_STALE_MS
+    # (45 minutes), node 7 is still fresh at the end.
+    assert (m["neighbours_evicted"], m["neighbours"]) == (5, 1)
+    # 147 sent; one arrives while this node is transmitting.
+    assert (m["nbr_7_rssi"], m["nbr_7_snr"], m["nbr_7_heard"]) == (-70, 6, 146)
+    assert 60 <= m["nbr_7_prr"] <= 90
+    assert "nbr_8_heard" not in m
+
+    links = [
+        parse_report_frame(f, expected_net_id=1).neighbours
+        for f in _sent_frames(dump)
+        if parse_header(f).src_id == 1 and parse_header(f).frame_type == REPORT_TYPE
+    ]
+    assert links and all(len(lk) <= 4 for lk in links)
+    assert any(lk and lk[0][:3] == (7, -70, 6) for lk in links)
+
+
+def _netcode_run(sim_build, tmp_path, events, defines=("NETCODE_ENABLED=1",)):
+    foreign = build_report_frame(
+        net_id=2, src_id=5, dst_id=0xFF, boot_id=1, seq=1, freq_mhz=[], status_flags=0, last_uart_age_s=0
+    )  # Replay time starts at the first record and ends at the last.
+    events = [(0, foreign)] + events + [(20000, foreign)]
+    cap = tmp_path / "netcode.cap"
+    cap.write_bytes(b"".join(build_export_rx_record(ts_ms=t, rssi=-80, snr=6, frame=f) for t, f in events))
+    dump = tmp_path / "tx.lp"
+    out = subprocess.run(
+        [str(sim_build("replay", defines)), "--drain", "10000", "--dump-tx", str(dump), str(cap)],
+        check=True,
+        capture_output=True,
+        text=True,
+    ).stdout
+    heads = [(f, parse_header(f)) for f in _sent_frames(dump)]
+    return [f for f, h in heads if (h.src_id, h.frame_type) != (1, REPORT_TYPE)], _metrics(out)
+
+
+_NC_REPORT = build_report_frame(
+    net_id=1, src_id=5, dst_id=0xFF, boot_id=1, seq=40, freq_mhz=[433, 434], status_flags=0, last_uart_age_s=0
+)
+_NC_BEACON = build_beacon_frame(
+    net_id=1, src_id=0, boot_id=1, seq=7, active=PHY_PROFILE_DEFAULT, target=PHY_PROFILE_DEFAULT, switch_in_ms=0
+)
+
+
+def test_relay_codes_an_upward_and_a_downward_forward_into_one_frame(sim_build, tmp_path) -> None:
+    events = [(1000, _NC_REPORT), (1010, _NC_BEACON)]
+    plain, m = _netcode_run(sim_build, tmp_path, events, defines=())
+    assert [parse_header(f).frame_type for f in plain].count(CODED_TYPE) == 0 and m["fwd_sent"] == 2
+
+    sent, m = _netcode_run(sim_build, tmp_path, events)
+    coded = [f for f in sent if parse_header(f).frame_type == CODED_TYPE]
+    assert len(coded) == 1 and (m["netcode_sent"], m["fwd_sent"]) == (1, 2)
+    assert parse_header(coded[0]).ttl == 0
+    # Each side holds its own copy as relayed and recovers the other one.
+    report, beacon = frame_dec_ttl_inc_hops_recrc(_NC_REPORT), frame_dec_ttl_inc_hops_recrc(_NC_BEACON)
+    assert decode_coded(coded[0], report) == beacon
+    assert decode_coded(coded[0], beacon) == report
+    assert len(coded[0]) < len(report) + len(beacon)
+
+
+def test_node_decodes_a_coded_frame_with_the_native_it_already_heard(sim_build, tmp_path) -> None:
+    report = frame_dec_ttl_inc_hops_recrc(_NC_REPORT)
+    beacon = frame_dec_ttl_inc_hops_recrc(_NC_BEACON)
+    other = build_report_frame(
+        net_id=1, src_id=6, dst_id=0xFF, boot_id=1, seq=3, freq_mhz=[433], status_flags=0, last_uart_age_s=0
+    )
+    next_beacon = build_beacon_frame(
+        net_id=1, src_id=0, boot_id=1, seq=8, active=PHY_PROFILE_DEFAULT, target=PHY_PROFILE_DEFAULT, switch_in_ms=0
+    )
+    events = [
+        (1000, _NC_REPORT),
+        (1020, build_coded_frame(net_id=1, src_id=3, seq=9, a=report, b=beacon)),
+        # Neither native known here.
+        (1040, build_coded_frame(net_id=1, src_id=3, seq=10, a=frame_dec_ttl_inc_hops_recrc(other),
+                                 b=frame_dec_ttl_inc_hops_recrc(next_beacon))),
+    ]
+    sent, m = _netcode_run(sim_build, tmp_path, events)
+    assert (m["netcode_decoded"], m["netcode_undecodable"]) == (1, 1)
+    # The recovered beacon is relayed on, here coded with node 5's REPORT.
+    relayed = frame_dec_ttl_inc_hops_recrc(beacon)
+    assert any(
+        f == relayed or (parse_header(f).frame_type == CODED_TYPE and decode_coded(f, report) == relayed)
+        for f in sent
+    )
+
+    # Without the switch a CODED frame is dropped at the type stage.
+    _, m = _netcode_run(sim_build, tmp_path, events, defines=())
+    assert (m["netcode_decoded"], m["rx_drop_type"]) == (0, 2)
+
+
+def test_relayed_phy_switch_counts_down_from_the_switch_time_not_from_enqueue(sim_build, tmp_path) -> None:
+    switching = build_beacon_frame(
+        net_id=1, src_id=0, boot_id=1, seq=11, active=PHY_PROFILE_DEFAULT, target=0, switch_in_ms=2000
+    )
+    events = [(1000, _NC_REPORT), (1010, switching)]
+    sent, m = _netcode_run(sim_build, tmp_path, events)
+    # Restamped at TX, so it stays native instead of pairing with the REPORT.
+    assert m["netcode_sent"] == 0 and m["fwd_sent"] == 2
+    relayed = [parse_beacon(f) for f in sent if parse_header(f).frame_type == BEACON_TYPE]
+    assert len(relayed) == 1
+    active, target, switch_in = relayed[0].phy
+    # Whatever the relay spent in queue and backoff is taken off the countdown.
+    assert (active, target) == (PHY_PROFILE_DEFAULT, 0) and 0 < switch_in < 2000
+    assert (m["phy_profile"], m["phy_switches"]) == (0, 1)
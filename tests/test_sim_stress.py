@@ -0,0 +1,13 @@
+import subprocess
+
+
+def test_stress_sweep_reports_sustainable_rates(sim_build) -> None:
+    exe = sim_build("stress")
+    out = subprocess.run([str(exe), "--step-ms", "10000"], check=True, capture_output=True, text=True).stdout
+    summary = dict(line.split("=", 1) for line in out.splitlines() if "=" in line and " " not in line)
+
+    assert float(summary["max_rx_fps"]) >= 1.0
+    assert float(summary["max_uart_lines_per_s"]) >= 1.0
+    assert int(summary["tick_ns_p99"]) <= int(summary["tick_ns_max"])
+    # The sweep ends on a saturated step, so the bottleneck is visible in the log.
+    assert " SAT" in out
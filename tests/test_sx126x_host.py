@@ -0,0 +1,89 @@
+import subprocess
+
+
+def _run(host_build, script: str) -> list:
+    exe = host_build("sx126x_mock", ["src/sx126x.cpp", "tools/sx126x_mock.cpp"], include_dirs=("src",))
+    out = subprocess.run([str(exe)], input=script, capture_output=True, text=True, check=True).stdout
+    return out.splitlines()
+
+
+def test_setup_and_modem_follow_datasheet_sequence(host_build) -> None:
+    lines = _run(
+        host_build,
+        "setup 433000000 1 1424\n"
+        "reply 00\nmodem 9 125000 6 2\n"
+        "reply 1F\nmodem 12 500000 8 22\n"
+        "reply 00\nmodem 11 125000 5 10\n"
+        "modem 9 125000 9 2\n",
+    )
+    assert lines == [
+        "> 8000",  # standby RC
+        "> 9707000140",  # TCXO 3.3 V, 5 ms
+        "> 070000",  # clear the XOSC start error
+        "> 897F",
+        "> 9601",  # DC-DC
+        "> 9504070001",  # PA for +22 dBm
+        "> 986B6F",  # image 430-440 MHz
+        "> 8A01",  # LoRa
+        "> 861B100000",  # 433 MHz * 2^25 / 32 MHz
+        "> 8F0000",
+        "> 0D074014",
+        "> 0D074124",
+        "> 0D08AC96",  # boosted RX gain
+        "> 080263026300000000",  # TX/RX done, header/CRC error, timeout on DIO1
+        "= ok",
+        "> 8000",
+        "> 8B09040200",  # SF9, 125 kHz, 4/6, no LDRO
+        "> 8E0202",
+        "> 1D088900 r 1",
+        "> 0D088904",  # errata: bit 2 set below 500 kHz
+        "> 8C000800FF0100",
+        "= ok",
+        "> 8000",
+        "> 8B0C060400",  # SF12, 500 kHz, 4/8: 8.2 ms symbols, no LDRO
+        "> 8E1602",
+        "> 1D088900 r 1",
+        "> 0D08891B",  # errata: bit 2 cleared at 500 kHz
+        "> 8C000800FF0100",
+        "= ok",
+        "> 8000",
+        "> 8B0B040101",  # SF11 at 125 kHz: 16.4 ms symbols need LDRO
+        "> 8E0A02",
+        "> 1D088900 r 1",
+        "> 0D088904",
+        "> 8C000800FF0100",
+        "= ok",
+        "= fail",  # CR 4/9 does not exist; nothing reaches the bus
+    ]
+
+
+def test_tx_rx_turnaround_and_packet_read(host_build) -> None:
+    lines = _run(
+        host_build,
+        "tx 0102A5 3000\n"
+        "rx\n"
+        "reply 0002\nirq\n"
+        "reply 0410A0B0C1F6EE\nread 3\n"
+        "stuck 1\nrx\n",
+    )
+    assert lines == [
+        "> 8000",
+        "> 0E00 w 0102A5",  # payload in one burst
+        "> 8C000800030100",
+        "> 0203FF",
+        "> 8302EE00",  # 3000 ms in 15.625 us steps
+        "= ok",
+        "> 0203FF",
+        "> 8C000800FF0100",
+        "> 82FFFFFF",  # continuous RX
+        "= ok",
+        "> 1200 r 2",
+        "irq=0002",
+        "= ok",
+        "> 1300 r 2",  # 4 bytes at 0x10, cut to 3
+        "> 1E1000 r 3",
+        "> 1400 r 3",
+        "packet len=3 rssi=-123 snr=-4 data=A0B0C1",
+        "= ok",
+        "= fail",  # BUSY stuck high: nothing is clocked out
+    ]
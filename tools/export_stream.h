@@ -0,0 +1,82 @@
+#ifndef EXPORT_STREAM_H
+#define EXPORT_STREAM_H
+
+// Host-side reader for the gateway export stream (see src/bridge.h).
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bridge.h"
+#include "frame_codec.h"
+
+struct ExportRecord {
+  uint8_t kind;
+  uint32_t tsMs;
+  int16_t rssi;
+  int8_t snr;
+  const uint8_t* frame;
+  uint8_t frameLen;
+  const uint8_t* body;
+  uint8_t bodyLen;
+};
+
+// Resyncs on the sync pair and trusts only records whose CRC matches,
+// so interleaved log lines and truncated records are skipped.
+class ExportStreamReader {
+ public:
+  ExportStreamReader(const uint8_t* data, size_t len) : mData(data), mLen(len) {}
+
+  bool next(ExportRecord& out) {
+    while ((mPos + 4U) <= mLen) {
+      if ((mData[mPos] != BRIDGE_SYNC0) || (mData[mPos + 1U] != BRIDGE_SYNC1)) {
+        ++mPos;
+        continue;
+      }
+      const uint8_t bodyLen = mData[mPos + 3U];
+      const size_t end = mPos + 4U + bodyLen + codec::CRC_LEN;
+      if (end > mLen) {
+        return false;
+      }
+      const uint16_t crc = codec::crc16(&mData[mPos + 2U], 2U + bodyLen);
+      if (crc != codec::readU16(&mData[end - codec::CRC_LEN])) {
+        ++mBadRecords;
+        ++mPos;
+        continue;
+      }
+
+      out.kind = mData[mPos + 2U];
+      out.body = &mData[mPos + 4U];
+      out.bodyLen = bodyLen;
+      out.tsMs = 0U;
+      out.rssi = 0;
+      out.snr = 0;
+      out.frame = nullptr;
+      out.frameLen = 0U;
+      if (bodyLen >= 4U) {
+        out.tsMs = static_cast<uint32_t>(codec::readU16(out.body)) |
+                   (static_cast<uint32_t>(codec::readU16(out.body + 2U)) << 16);
+      }
+      if ((out.kind == BRIDGE_KIND_RX) && (bodyLen >= BRIDGE_RX_META_LEN)) {
+        out.rssi = static_cast<int16_t>(codec::readU16(out.body + 4U));
+        out.snr = static_cast<int8_t>(out.body[6]);
+        out.frame = out.body + BRIDGE_RX_META_LEN;
+        out.frameLen = static_cast<uint8_t>(bodyLen - BRIDGE_RX_META_LEN);
+      }
+      mPos = end;
+      return true;
+    }
+    return false;
+  }
+
+  uint32_t badRecords() const {
+    return mBadRecords;
+  }
+
+ private:
+  const uint8_t* mData;
+  size_t mLen;
+  size_t mPos = 0U;
+  uint32_t mBadRecords = 0U;
+};
+
+#endif  // EXPORT_STREAM_H
@@ -0,0 +1,432 @@
+// Batch decoder for gateway export streams and raw frame captures.
+//
+// Build: g++ -O2 -std=c++17 -Isrc -Itools tools/frame_decode.cpp -o frame_decode
+//
+// Usage:
+//   frame_decode [--net ID] [--lp] [--csv] [--trace] [--links] [FILE|-]
+//     Decodes an export stream (default) or length-prefixed raw frames (--lp:
+//     one length byte followed by the frame). Prints a summary, or one CSV
+//     line per frame with --csv. FRAG pieces are reassembled and the rebuilt
+//     frame is printed in their place. --trace adds one latency breakdown
+//     line per (source, relay set) for REPORTs that carry a trace TLV.
+//     --links prints the last neighbour links each source reported.
+//   frame_decode --bench N
+//     Synthesizes N export records in memory and reports decode throughput,
+//     then the cost of checking the auth tag of a full-size REPORT.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include "export_stream.h"
+#include "frame_codec.h"
+
+namespace {
+
+constexpr uint32_t FRAG_TIMEOUT_MS = 20000UL;  // Matches the firmware FRAG_REASM_TIMEOUT_MS.
+
+// Host side has room for every in-flight message a gateway could see.
+using Reassembler = codec::Reassembler<32U, 243U>;
+
+struct Options {
+  uint8_t netId = 1U;
+  bool lengthPrefixed = false;
+  bool csv = false;
+  bool trace = false;
+  bool links = false;
+  long benchFrames = 0;
+  const char* path = "-";
+};
+
+// Traced REPORTs of one source that took the same set of relays.
+struct TracePath {
+  uint64_t count = 0U;
+  uint64_t hops = 0U;
+  uint64_t originQueueMs = 0U;
+  uint64_t relayQueueMs = 0U;
+  uint16_t maxHopMs = 0U;
+  uint8_t maxHopRelay = 0xFFU;
+  uint8_t lastRelay = 0xFFU;
+};
+
+struct Stats {
+  uint64_t records = 0U;
+  uint64_t frames = 0U;
+  uint64_t pings = 0U;
+  uint64_t reports = 0U;
+  uint64_t other = 0U;
+  uint64_t fragments = 0U;
+  uint64_t badFrames = 0U;
+  uint64_t freqValues = 0U;
+  uint64_t statsRecords = 0U;
+  uint64_t logRecords = 0U;
+  uint64_t badRecords = 0U;
+  uint64_t bytes = 0U;
+  bool srcSeen[256] = {};
+  Reassembler reasm;
+  std::map<uint32_t, TracePath> tracePaths;  // Key: src << 16 | relayBits.
+  std::map<uint8_t, std::vector<codec::Link>> links;  // Last list per source.
+};
+
+void usage() {
+  std::fprintf(stderr,
+               "usage: frame_decode [--net ID] [--lp] [--csv] [--trace] [--links] [FILE|-]\n"
+               "       frame_decode --bench N\n");
+}
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--net") == 0 && (i + 1) < argc) {
+      opt.netId = static_cast<uint8_t>(std::strtoul(argv[++i], nullptr, 0));
+    } else if (std::strcmp(argv[i], "--lp") == 0) {
+      opt.lengthPrefixed = true;
+    } else if (std::strcmp(argv[i], "--csv") == 0) {
+      opt.csv = true;
+    } else if (std::strcmp(argv[i], "--trace") == 0) {
+      opt.trace = true;
+    } else if (std::strcmp(argv[i], "--links") == 0) {
+      opt.links = true;
+    } else if (std::strcmp(argv[i], "--bench") == 0 && (i + 1) < argc) {
+      opt.benchFrames = std::strtol(argv[++i], nullptr, 0);
+    } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+      return false;
+    } else {
+      opt.path = argv[i];
+    }
+  }
+  return true;
+}
+
+bool readAll(const char* path, std::vector<uint8_t>& out) {
+  FILE* f = (std::strcmp(path, "-") == 0) ? stdin : std::fopen(path, "rb");
+  if (f == nullptr) {
+    return false;
+  }
+  uint8_t chunk[65536];
+  size_t n = 0U;
+  while ((n = std::fread(chunk, 1U, sizeof(chunk), f)) > 0U) {
+    out.insert(out.end(), chunk, chunk + n);
+  }
+  if (f != stdin) {
+    std::fclose(f);
+  }
+  return true;
+}
+
+void collectTrace(Stats& st, const codec::FrameView& view, uint8_t src, uint8_t hops) {
+  codec::Trace t{};
+  if (!codec::readTrace(view, t)) {
+    return;
+  }
+  TracePath& path = st.tracePaths[(static_cast<uint32_t>(src) << 16) | t.relayBits];
+  ++path.count;
+  path.hops += hops;
+  path.originQueueMs += t.originQueueMs;
+  path.relayQueueMs += t.relayQueueMs;
+  if ((t.maxHopRelay != 0xFFU) && ((path.maxHopRelay == 0xFFU) || (t.maxHopMs > path.maxHopMs))) {
+    path.maxHopMs = t.maxHopMs;
+    path.maxHopRelay = t.maxHopRelay;
+  }
+  path.lastRelay = t.lastRelay;
+}
+
+// Decodes one frame as received, or as rebuilt from fragments.
+void decodeBody(const Options& opt,
+                Stats& st,
+                uint32_t tsMs,
+                int16_t rssi,
+                int8_t snr,
+                const uint8_t* frame,
+                uint8_t len) {
+  codec::FrameView view;
+  if (!view.init(frame, len) || (view.netId() != opt.netId) || !view.crcOk()) {
+    ++st.badFrames;
+    return;
+  }
+  codec::Header h{};
+  (void)codec::readHeader(frame, len, h);
+  st.srcSeen[h.src] = true;
+
+  if (h.type == codec::FRAG_TYPE) {
+    ++st.fragments;
+    (void)st.reasm.expire(tsMs, FRAG_TIMEOUT_MS);
+    uint8_t whole[Reassembler::FRAME_MAX];
+    const uint8_t wholeLen = st.reasm.accept(view, tsMs, whole, sizeof(whole));
+    if (wholeLen > 0U) {
+      decodeBody(opt, st, tsMs, rssi, snr, whole, wholeLen);
+    }
+  } else if (h.type == codec::REPORT_TYPE) {
+    codec::Report r{};
+    uint8_t err = 0U;
+    if (!codec::parseReportView(view, r, err)) {
+      ++st.badFrames;
+      return;
+    }
+    ++st.reports;
+    st.freqValues += r.freqCount;
+    if (opt.trace) {
+      collectTrace(st, view, h.src, h.hops);
+    }
+    codec::Link links[codec::NEIGHBOURS_MAX];
+    const uint8_t linkCount = opt.links ? codec::readNeighbours(view, links, codec::NEIGHBOURS_MAX) : 0U;
+    if (linkCount > 0U) {
+      st.links[h.src].assign(links, links + linkCount);
+    }
+    if (opt.csv) {
+      std::printf("%u,%d,%d,%u,%u,REPORT,%u,%u,%u,%u,", tsMs, rssi, snr, h.src, h.seq, h.ttl, h.hops,
+                  r.statusFlags, r.lastUartAgeS);
+      for (uint8_t i = 0U; i < r.freqCount; ++i) {
+        std::printf(i == 0U ? "%u" : " %u", r.freqAt(i));
+      }
+    }
+    // Band detections follow the list values, ascending.
+    codec::BandIter band = r.bandFreqs();
+    uint16_t mhz = 0U;
+    bool first = (r.freqCount == 0U);
+    while (band.next(mhz)) {
+      ++st.freqValues;
+      if (opt.csv) {
+        std::printf(first ? "%u" : " %u", mhz);
+        first = false;
+      }
+    }
+    if (opt.csv) {
+      std::printf("\n");
+    }
+  } else if (h.type == codec::PING_TYPE) {
+    ++st.pings;
+    if (opt.csv) {
+      std::printf("%u,%d,%d,%u,%u,PING,%u,%u,,,\n", tsMs, rssi, snr, h.src, h.seq, h.ttl, h.hops);
+    }
+  } else {
+    ++st.other;
+    if (opt.csv) {
+      std::printf("%u,%d,%d,%u,%u,0x%02X,%u,%u,,,\n", tsMs, rssi, snr, h.src, h.seq, h.type, h.ttl, h.hops);
+    }
+  }
+}
+
+void decodeFrame(const Options& opt,
+                 Stats& st,
+                 uint32_t tsMs,
+                 int16_t rssi,
+                 int8_t snr,
+                 const uint8_t* frame,
+                 uint8_t len) {
+  ++st.frames;
+  st.bytes += len;
+  decodeBody(opt, st, tsMs, rssi, snr, frame, len);
+}
+
+void decodeExportStream(const Options& opt, const uint8_t* data, size_t len, Stats& st) {
+  ExportStreamReader reader(data, len);
+  ExportRecord rec{};
+  while (reader.next(rec)) {
+    ++st.records;
+    if (rec.kind == BRIDGE_KIND_RX) {
+      decodeFrame(opt, st, rec.tsMs, rec.rssi, rec.snr, rec.frame, rec.frameLen);
+    } else if (rec.kind == BRIDGE_KIND_STATS) {
+      ++st.statsRecords;
+    } else if (rec.kind == BRIDGE_KIND_LOG) {
+      ++st.logRecords;
+    }
+  }
+  st.badRecords += reader.badRecords();
+}
+
+void decodeLengthPrefixed(const Options& opt, const uint8_t* data, size_t len, Stats& st) {
+  size_t pos = 0U;
+  while (pos < len) {
+    const uint8_t frameLen = data[pos];
+    if ((pos + 1U + frameLen) > len) {
+      ++st.badRecords;
+      break;
+    }
+    ++st.records;
+    decodeFrame(opt, st, 0U, 0, 0, &data[pos + 1U], frameLen);
+    pos += 1U + frameLen;
+  }
+}
+
+void printSummary(const Stats& st) {
+  uint32_t sources = 0U;
+  for (bool seen : st.srcSeen) {
+    sources += seen ? 1U : 0U;
+  }
+  std::printf("records=%llu frames=%llu reports=%llu pings=%llu other=%llu bad_frames=%llu "
+              "bad_records=%llu stats=%llu logs=%llu freq_values=%llu sources=%u fragments=%llu reassembled=%u "
+              "frag_dropped=%u\n",
+              static_cast<unsigned long long>(st.records),
+              static_cast<unsigned long long>(st.frames),
+              static_cast<unsigned long long>(st.reports),
+              static_cast<unsigned long long>(st.pings),
+              static_cast<unsigned long long>(st.other),
+              static_cast<unsigned long long>(st.badFrames),
+              static_cast<unsigned long long>(st.badRecords),
+              static_cast<unsigned long long>(st.statsRecords),
+              static_cast<unsigned long long>(st.logRecords),
+              static_cast<unsigned long long>(st.freqValues),
+              sources,
+              static_cast<unsigned long long>(st.fragments),
+              static_cast<unsigned>(st.reasm.completed()),
+              static_cast<unsigned>(st.reasm.timedOut() + st.reasm.evicted()));
+}
+
+// Averages are per traced REPORT; relay ids are 255 while none relayed.
+void printTrace(const Stats& st) {
+  for (const auto& entry : st.tracePaths) {
+    const TracePath& path = entry.second;
+    const double n = static_cast<double>(path.count);
+    std::printf("trace src=%u relays=0x%04X reports=%llu hops_avg=%.1f origin_queue_ms_avg=%.0f "
+                "relay_queue_ms_avg=%.0f max_hop_ms=%u max_hop_relay=%u last_relay=%u\n",
+                static_cast<unsigned>(entry.first >> 16),
+                static_cast<unsigned>(entry.first & 0xFFFFU),
+                static_cast<unsigned long long>(path.count),
+                static_cast<double>(path.hops) / n,
+                static_cast<double>(path.originQueueMs) / n,
+                static_cast<double>(path.relayQueueMs) / n,
+                static_cast<unsigned>(path.maxHopMs),
+                static_cast<unsigned>(path.maxHopRelay),
+                static_cast<unsigned>(path.lastRelay));
+  }
+}
+
+// One line per source: id:rssi/snr/prr for each link, freshest first.
+void printLinks(const Stats& st) {
+  for (const auto& entry : st.links) {
+    std::printf("links src=%u n=%u", static_cast<unsigned>(entry.first), static_cast<unsigned>(entry.second.size()));
+    for (const codec::Link& link : entry.second) {
+      std::printf(" %u:%d/%d/%u", static_cast<unsigned>(link.id), link.rssiDbm, link.snrDb,
+                  static_cast<unsigned>(link.prrPct));
+    }
+    std::printf("\n");
+  }
+}
+
+void appendExportRecord(std::vector<uint8_t>& out, uint32_t tsMs, const uint8_t* frame, uint8_t len) {
+  uint8_t rec[255 + BRIDGE_RECORD_OVERHEAD];
+  uint8_t idx = 0U;
+  rec[idx++] = BRIDGE_SYNC0;
+  rec[idx++] = BRIDGE_SYNC1;
+  rec[idx++] = BRIDGE_KIND_RX;
+  rec[idx++] = static_cast<uint8_t>(BRIDGE_RX_META_LEN + len);
+  codec::writeU16(&rec[idx], static_cast<uint16_t>(tsMs & 0xFFFFU));
+  codec::writeU16(&rec[idx + 2U], static_cast<uint16_t>(tsMs >> 16));
+  codec::writeU16(&rec[idx + 4U], static_cast<uint16_t>(-90 - static_cast<int16_t>(tsMs % 30U)));
+  rec[idx + 6U] = static_cast<uint8_t>(static_cast<int8_t>(5 - static_cast<int8_t>(tsMs % 15U)));
+  idx = static_cast<uint8_t>(idx + BRIDGE_RX_META_LEN);
+  std::memcpy(&rec[idx], frame, len);
+  idx = static_cast<uint8_t>(idx + len);
+  codec::writeU16(&rec[idx], codec::crc16(&rec[2], static_cast<size_t>(idx - 2U)));
+  idx = static_cast<uint8_t>(idx + codec::CRC_LEN);
+  out.insert(out.end(), rec, rec + idx);
+}
+
+bool benchAuth(const Options& opt) {
+  const uint8_t key[codec::AUTH_KEY_LEN] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+  const uint16_t freqs[5] = {433U, 434U, 435U, 868U, 915U};
+  codec::Header h{};
+  h.netId = opt.netId;
+  h.src = 1U;
+  h.dst = 0xFFU;
+  h.ttl = 8U;
+  h.flags = codec::FLAG_AUTH;
+  uint8_t frame[64];
+  uint8_t len = codec::buildReport(h, freqs, 5U, 0x07U, 3U, frame, sizeof(frame) - codec::AUTH_TLV_LEN);
+  len = codec::authAppend(key, frame, len, sizeof(frame));
+  codec::FrameView view;
+  if ((len == 0U) || !view.parse(frame, len)) {
+    return false;
+  }
+
+  uint64_t ok = 0U;
+  const auto t0 = std::chrono::steady_clock::now();
+  for (long i = 0; i < opt.benchFrames; ++i) {
+    ok += codec::authOk(key, view) ? 1U : 0U;
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+  std::printf("bench_auth frames=%ld frame_len=%u ns_per_frame=%.1f\n",
+              opt.benchFrames,
+              static_cast<unsigned>(len),
+              ns / static_cast<double>(opt.benchFrames));
+  return ok == static_cast<uint64_t>(opt.benchFrames);
+}
+
+int runBench(const Options& opt) {
+  std::vector<uint8_t> stream;
+  stream.reserve(static_cast<size_t>(opt.benchFrames) * 48U);
+
+  const uint16_t freqs[5] = {433U, 434U, 435U, 868U, 915U};
+  for (long i = 0; i < opt.benchFrames; ++i) {
+    codec::Header h{};
+    h.netId = opt.netId;
+    h.src = static_cast<uint8_t>(1U + (i % 200));
+    h.dst = 0xFFU;
+    h.bootId = 0x42U;
+    h.seq = static_cast<uint16_t>(i);
+    h.ttl = 8U;
+    uint8_t frame[64];
+    uint8_t len = 0U;
+    if ((i % 8) == 0) {
+      len = codec::buildPing(h, frame);
+    } else {
+      len = codec::buildReport(h, freqs, static_cast<uint8_t>(i % 6), 0x07U, 3U, frame, sizeof(frame));
+    }
+    appendExportRecord(stream, static_cast<uint32_t>(i), frame, len);
+  }
+
+  Stats st{};
+  const auto t0 = std::chrono::steady_clock::now();
+  decodeExportStream(opt, stream.data(), stream.size(), st);
+  const auto t1 = std::chrono::steady_clock::now();
+
+  const double sec = std::chrono::duration<double>(t1 - t0).count();
+  printSummary(st);
+  std::printf("bench frames=%llu bytes=%zu seconds=%.6f frames_per_s=%.0f mb_per_s=%.1f\n",
+              static_cast<unsigned long long>(st.frames),
+              stream.size(),
+              sec,
+              (sec > 0.0) ? static_cast<double>(st.frames) / sec : 0.0,
+              (sec > 0.0) ? static_cast<double>(stream.size()) / sec / 1.0e6 : 0.0);
+  return (st.badFrames == 0U && st.frames == static_cast<uint64_t>(opt.benchFrames) && benchAuth(opt)) ? 0 : 1;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opt{};
+  if (!parseArgs(argc, argv, opt)) {
+    usage();
+    return 2;
+  }
+  if (opt.benchFrames > 0) {
+    return runBench(opt);
+  }
+
+  std::vector<uint8_t> data;
+  if (!readAll(opt.path, data)) {
+    std::fprintf(stderr, "cannot open %s\n", opt.path);
+    return 2;
+  }
+
+  Stats st{};
+  if (opt.lengthPrefixed) {
+    decodeLengthPrefixed(opt, data.data(), data.size(), st);
+  } else {
+    decodeExportStream(opt, data.data(), data.size(), st);
+  }
+  if (!opt.csv) {
+    printSummary(st);
+  }
+  if (opt.trace) {
+    printTrace(st);
+  }
+  if (opt.links) {
+    printLinks(st);
+  }
+  return 0;
+}
@@ -0,0 +1,108 @@
+"""Generates a deterministic synthetic RX storm capture for replay tests.
+
+The output is an export stream (see src/bridge.h), the same format a gateway
+or an RX_CAPTURE_ENABLED node produces, so real captures can replace it.
+
+Usage: python -m tools.make_storm_trace tests/traces/storm_relay.cap
+"""
+
+from __future__ import annotations
+
+import random
+import sys
+from pathlib import Path
+from typing import List, Tuple
+
+from tools.protocol_model import (
+    build_export_rx_record,
+    build_ping_frame,
+    build_report_frame,
+    crc16_ccitt_false,
+)
+
+NET_ID = 1
+LOCAL_NODE_ID = 1
+
+
+def _relay_copy(frame: bytes) -> bytes:
+    out = bytearray(frame)
+    out[7] = max(0, out[7] - 1)
+    out[8] = out[8] + 1
+    crc = crc16_ccitt_false(bytes(out[:-2]))
+    out[-2] = crc & 0xFF
+    out[-1] = (crc >> 8) & 0xFF
+    return bytes(out)
+
+
+def generate(seed: int = 26, duration_ms: int = 60000) -> List[Tuple[int, int, int, bytes]]:
+    rng = random.Random(seed)
+    events: List[Tuple[int, int, int, bytes]] = []
+    sources = list(range(2, 40))
+    seqs = {src: rng.randrange(0, 1000) for src in sources}
+
+    def report(src: int, ts: int) -> None:
+        freqs = rng.sample(range(430, 440), rng.randrange(0, 6))
+        frame = build_report_frame(
+            net_id=NET_ID,
+            src_id=src,
+            dst_id=0xFF,
+            boot_id=src * 7,
+            seq=seqs[src],
+            freq_mhz=freqs,
+            status_flags=0x07,
+            last_uart_age_s=rng.randrange(0, 5),
+        )
+        seqs[src] += 1
+        rssi = -60 - rng.randrange(0, 50)
+        snr = 10 - rng.randrange(0, 20)
+        events.append((ts, rssi, snr, frame))
+        if rng.random() < 0.6:
+            # Same frame relayed by a neighbour shortly after.
+            events.append((ts + rng.randrange(80, 400), rssi - 5, snr - 2, _relay_copy(frame)))
+
+    # Background: every source reports about every 5 s.
+    for src in sources:
+        ts = rng.randrange(0, 5000)
+        while ts < duration_ms:
+            report(src, ts)
+            ts += 4500 + rng.randrange(0, 1000)
+
+    # Storm: a cluster of sources bursting between 20 s and 30 s.
+    for src in sources[:12]:
+        ts = 20000 + rng.randrange(0, 500)
+        while ts < 30000:
+            report(src, ts)
+            ts += 300 + rng.randrange(0, 400)
+
+    # Noise the classifier must reject: bad CRC, foreign network, own echoes.
+    for _ in range(60):
+        ts = rng.randrange(0, duration_ms)
+        kind = rng.randrange(0, 3)
+        frame = bytearray(build_ping_frame(net_id=NET_ID, src_id=rng.choice(sources), dst_id=0xFF, boot_id=1, seq=ts))
+        if kind == 0:
+            frame[3] ^= 0x5A
+        elif kind == 1:
+            frame = bytearray(build_ping_frame(net_id=7, src_id=99, dst_id=0xFF, boot_id=1, seq=ts))
+        else:
+            frame = bytearray(
+                _relay_copy(build_ping_frame(net_id=NET_ID, src_id=LOCAL_NODE_ID, dst_id=0xFF, boot_id=0x42, seq=ts))
+            )
+        events.append((ts, -100, -8, bytes(frame)))
+
+    events.sort(key=lambda e: e[0])
+    return events
+
+
+def main(argv: List[str]) -> int:
+    if len(argv) != 1:
+        print(__doc__)
+        return 2
+    stream = b"".join(
+        build_export_rx_record(ts_ms=ts, rssi=rssi, snr=snr, frame=frame) for ts, rssi, snr, frame in generate()
+    )
+    Path(argv[0]).write_bytes(stream)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
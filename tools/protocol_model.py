@@ -1,48 +1,170 @@
 from __future__ import annotations
 
-from dataclasses import dataclass
+import random
+from dataclasses import dataclass, field
 from typing import List, Optional
 
 
 PING_TYPE = 0x01
 REPORT_TYPE = 0x10
+BEACON_TYPE = 0x20
+FRAG_TYPE = 0x30
+CONFIG_TYPE = 0x40
+CODED_TYPE = 0x50
 TLV_FREQ_LIST = 0x01
 TLV_NODE_STATUS = 0x02
+TLV_FREQ_BITMAP = 0x03
+TLV_FREQ_RLE = 0x04
+TLV_PHY_SWITCH = 0x10
+TLV_REPORT_RATE = 0x11
+TLV_TIME_SYNC = 0x12
+TLV_REPORT_ACK = 0x13
+TLV_CONFIG_VERSION = 0x14
+TLV_MESH_PARAMS = 0x15
+TLV_CODED = 0x16
+REPORT_ACK_MAX = 6
+TLV_AUTH = 0x05
+TLV_TRACE = 0x06
+TLV_NEIGHBOURS = 0x07
+TRACE_LEN = 10
 FRAME_FLAG_NO_RELAY = 0x01
+FRAME_FLAG_AUTH = 0x02
+FRAME_FLAG_TRACE = 0x04
+FRAME_FLAG_CONGESTION_MASK = 0x18
+FRAME_FLAG_CONGESTION_SHIFT = 3
+AUTH_TAG_LEN = 4
+AUTH_TLV_LEN = 2 + AUTH_TAG_LEN
 PING_FRAME_LEN = 12
 HEADER_LEN = 10
 MAX_FREQS = 5
+FREQ_EXTRA_MAX = 24
+FRAG_HEADER_LEN = 3
+TX_FRAME_MAX = 64
+# Compact header (codec::compact): first byte 1|HAS_DST|HAS_BOOT|HAS_FLAGS|NET4,
+# then SRC, TYPE, SEQ8, TTL<<4|HOPS and the optional bytes in that order.
+COMPACT_VERSION_BIT = 0x80
+COMPACT_HAS_DST = 0x40
+COMPACT_HAS_BOOT = 0x20
+COMPACT_HAS_FLAGS = 0x10
+COMPACT_BASE_LEN = 5
+MIN_FRAME_LEN = COMPACT_BASE_LEN + 2
 
 
-def crc16_ccitt_false(data: bytes) -> int:
-    crc = 0xFFFF
-    for b in data:
-        crc ^= (b << 8) & 0xFFFF
+def _crc16_table() -> List[int]:
+    table = []
+    for i in range(256):
+        crc = i << 8
         for _ in range(8):
             if crc & 0x8000:
                 crc = ((crc << 1) ^ 0x1021) & 0xFFFF
             else:
                 crc = (crc << 1) & 0xFFFF
+        table.append(crc)
+    return table
+
+
+_CRC16_TABLE = _crc16_table()
+
+
+def crc16_ccitt_false(data: bytes) -> int:
+    # Same byte-table algorithm as codec::crc16Update() in src/frame_codec.h.
+    crc = 0xFFFF
+    for b in data:
+        crc = ((crc << 8) & 0xFFFF) ^ _CRC16_TABLE[((crc >> 8) ^ b) & 0xFF]
     return crc
 
 
-def build_ping_frame(net_id: int, src_id: int, dst_id: int, boot_id: int, seq: int) -> bytes:
-    head = bytes(
-        [
-            net_id & 0xFF,
-            src_id & 0xFF,
-            dst_id & 0xFF,
-            boot_id & 0xFF,
-            PING_TYPE,
-            seq & 0xFF,
-            (seq >> 8) & 0xFF,
-            8,   # TTL
-            0,   # HOPS
-            0,   # FLAGS
-        ]
+@dataclass
+class FrameHeader:
+    net_id: int
+    src_id: int
+    dst_id: int
+    boot_id: int
+    frame_type: int
+    seq: int
+    ttl: int
+    hops: int
+    flags: int
+    compact: bool
+    length: int
+
+
+def build_header(
+    *,
+    net_id: int,
+    src_id: int,
+    dst_id: int,
+    boot_id: int,
+    frame_type: int,
+    seq: int,
+    ttl: int = 8,
+    hops: int = 0,
+    flags: int = 0,
+    compact: bool = False,
+) -> bytes:
+    """Header bytes as codec::writeHeader() emits them, in either format."""
+    if not compact:
+        return bytes(
+            [net_id & 0xFF, src_id & 0xFF, dst_id & 0xFF, boot_id & 0xFF, frame_type & 0xFF,
+             seq & 0xFF, (seq >> 8) & 0xFF, ttl & 0xFF, hops & 0xFF, flags & 0xFF]
+        )
+    has_dst, has_boot, has_flags = (dst_id & 0xFF) != 0xFF, (seq & 0xFF) == 0, (flags & 0xFF) != 0
+    first = COMPACT_VERSION_BIT | (net_id & 0x0F)
+    first |= (COMPACT_HAS_DST if has_dst else 0) | (COMPACT_HAS_BOOT if has_boot else 0)
+    first |= COMPACT_HAS_FLAGS if has_flags else 0
+    head = bytearray([first, src_id & 0xFF, frame_type & 0xFF, seq & 0xFF, (min(ttl, 15) << 4) | min(hops, 15)])
+    if has_dst:
+        head.append(dst_id & 0xFF)
+    if has_boot:
+        head.append(boot_id & 0xFF)
+    if has_flags:
+        head.append(flags & 0xFF)
+    return bytes(head)
+
+
+def parse_header(buf: bytes) -> Optional[FrameHeader]:
+    """Decodes either format like codec::readHeader(); None when `buf` cannot
+    hold the header plus CRC."""
+    if len(buf) < MIN_FRAME_LEN:
+        return None
+    first = buf[0]
+    if not first & COMPACT_VERSION_BIT:
+        if len(buf) < HEADER_LEN + 2:
+            return None
+        return FrameHeader(buf[0], buf[1], buf[2], buf[3], buf[4], buf[5] | (buf[6] << 8), buf[7], buf[8], buf[9],
+                           False, HEADER_LEN)
+    i = COMPACT_BASE_LEN
+    opt = {}
+    for bit, name in ((COMPACT_HAS_DST, "dst"), (COMPACT_HAS_BOOT, "boot"), (COMPACT_HAS_FLAGS, "flags")):
+        if first & bit:
+            opt[name] = i
+            i += 1
+    if len(buf) < i + 2:
+        return None
+    return FrameHeader(
+        first & 0x0F, buf[1], buf[opt["dst"]] if "dst" in opt else 0xFF, buf[opt["boot"]] if "boot" in opt else 0,
+        buf[2], buf[3], buf[4] >> 4, buf[4] & 0x0F, buf[opt["flags"]] if "flags" in opt else 0, True, i,
+    )
+
+
+def _type_index(frame: bytes) -> int:
+    return 2 if frame[0] & COMPACT_VERSION_BIT else 4
+
+
+def _set_ttl_hops(head: bytearray, ttl: int, hops: int) -> None:
+    if head[0] & COMPACT_VERSION_BIT:
+        head[4] = (min(ttl, 15) << 4) | min(hops, 15)
+    else:
+        head[7], head[8] = ttl & 0xFF, hops & 0xFF
+
+
+def build_ping_frame(
+    net_id: int, src_id: int, dst_id: int, boot_id: int, seq: int, *, compact: bool = False
+) -> bytes:
+    return _seal(
+        build_header(net_id=net_id, src_id=src_id, dst_id=dst_id, boot_id=boot_id, frame_type=PING_TYPE, seq=seq,
+                     compact=compact)
     )
-    crc = crc16_ccitt_false(head)
-    return head + bytes([crc & 0xFF, (crc >> 8) & 0xFF])
 
 
 @dataclass
@@ -55,20 +177,16 @@ class PingParseResult:
 
 
 def parse_ping_frame(buf: bytes, expected_net_id: int) -> PingParseResult:
-    if len(buf) != PING_FRAME_LEN:
+    h = parse_header(buf)
+    if h is None or len(buf) != h.length + 2:
         return PingParseResult(ok=False, err_code=1)
-    if buf[0] != (expected_net_id & 0xFF):
+    if h.net_id != (expected_net_id & 0xFF):
         return PingParseResult(ok=False, err_code=2)
-    if buf[4] != PING_TYPE:
+    if h.frame_type != PING_TYPE:
         return PingParseResult(ok=False, err_code=4)
-
-    crc_calc = crc16_ccitt_false(buf[:HEADER_LEN])
-    crc_in = buf[-2] | (buf[-1] << 8)
-    if crc_calc != crc_in:
+    if not frame_crc_ok(buf):
         return PingParseResult(ok=False, err_code=3)
-
-    seq = buf[5] | (buf[6] << 8)
-    return PingParseResult(ok=True, err_code=0, seq=seq, src_id=buf[1], boot_id=buf[3])
+    return PingParseResult(ok=True, err_code=0, seq=h.seq, src_id=h.src_id, boot_id=h.boot_id)
 
 
 def parse_freq_line_mhz(line: str, max_freqs: int = MAX_FREQS) -> List[int]:
@@ -144,6 +262,8 @@ def build_report_frame(
     status_flags: int,
     last_uart_age_s: int,
     out_max: int = 64,
+    compact: bool = False,
+    flags: int = 0,
 ) -> Optional[bytes]:
     safe_freqs = [f & 0xFFFF for f in freq_mhz[:MAX_FREQS]]
     freq_bytes = len(safe_freqs) * 2
@@ -155,19 +275,9 @@ def build_report_frame(
 
     payload += bytes([TLV_NODE_STATUS, 3, status_flags & 0xFF, last_uart_age_s & 0xFF, (last_uart_age_s >> 8) & 0xFF])
 
-    head = bytes(
-        [
-            net_id & 0xFF,
-            src_id & 0xFF,
-            dst_id & 0xFF,
-            boot_id & 0xFF,
-            REPORT_TYPE,
-            seq & 0xFF,
-            (seq >> 8) & 0xFF,
-            8,   # TTL
-            0,   # HOPS
-            0,   # FLAGS
-        ]
+    head = build_header(
+        net_id=net_id, src_id=src_id, dst_id=dst_id, boot_id=boot_id, frame_type=REPORT_TYPE, seq=seq, flags=flags,
+        compact=compact,
     )
     full_no_crc = head + payload
     if len(full_no_crc) + 2 > out_max:
@@ -177,42 +287,590 @@ def build_report_frame(
     return full_no_crc + bytes([crc & 0xFF, (crc >> 8) & 0xFF])
 
 
+FREQ_BAND_START_MHZ = 400
+FREQ_BAND_STEP_MHZ = 1
+FREQ_BAND_CHANNELS = 240
+
+
+def encode_band_tlv(freqs, start_mhz: int = FREQ_BAND_START_MHZ, step_mhz: int = FREQ_BAND_STEP_MHZ,
+                    channels: int = FREQ_BAND_CHANNELS) -> bytes:
+    """Band TLV as codec::writeBandTlv() emits it: trimmed bitmap, or RLE when shorter."""
+    bits = bytearray(channels // 8)
+    for f in freqs:
+        off = f - start_mhz
+        if 0 <= off < channels * step_mhz and off % step_mhz == 0:
+            i = off // step_mhz
+            bits[i >> 3] |= 1 << (i & 7)
+    first = next((i for i, b in enumerate(bits) if b), len(bits))
+    end = len(bits)
+    while end > first and bits[end - 1] == 0:
+        end -= 1
+    body, tlv_type = bytes(bits[first:end]), TLV_FREQ_BITMAP
+    if body:
+        last = max(i for i in range(first * 8, end * 8) if bits[i >> 3] & (1 << (i & 7)))
+        runs, present, i = [], False, first * 8
+        while i <= last:
+            run = 0
+            while i <= last and bool(bits[i >> 3] & (1 << (i & 7))) == present and run < 255:
+                run += 1
+                i += 1
+            runs.append(run)
+            present = not present
+        if len(runs) < len(body):
+            body, tlv_type = bytes(runs), TLV_FREQ_RLE
+    start = start_mhz + first * 8 * step_mhz
+    return bytes([tlv_type, 3 + len(body), start & 0xFF, start >> 8, step_mhz]) + body
+
+
+def decode_band_value(tlv_type: int, value: bytes) -> List[int]:
+    start, step, body = value[0] | (value[1] << 8), value[2], value[3:]
+    if tlv_type == TLV_FREQ_BITMAP:
+        idx = [i for i in range(len(body) * 8) if body[i >> 3] & (1 << (i & 7))]
+    else:
+        idx, pos = [], 0
+        for n, run in enumerate(body):
+            if n & 1:
+                idx.extend(range(pos, pos + run))
+            pos += run
+    return [start + i * step for i in idx if start + i * step <= 0xFFFF]
+
+
+def build_report_band_frame(
+    *,
+    net_id: int,
+    src_id: int,
+    dst_id: int,
+    boot_id: int,
+    seq: int,
+    freq_mhz: List[int],
+    status_flags: int,
+    last_uart_age_s: int,
+    compact: bool = False,
+    flags: int = 0,
+) -> bytes:
+    """REPORT with in-band values as a band TLV and the rest as FREQ_LIST."""
+    band_end = FREQ_BAND_START_MHZ + FREQ_BAND_CHANNELS * FREQ_BAND_STEP_MHZ
+    in_band = lambda f: FREQ_BAND_START_MHZ <= f < band_end and (f - FREQ_BAND_START_MHZ) % FREQ_BAND_STEP_MHZ == 0
+    extra = list(dict.fromkeys(f for f in freq_mhz if not in_band(f)))[:FREQ_EXTRA_MAX]
+    payload = bytearray()
+    if extra:
+        payload += bytes([TLV_FREQ_LIST, len(extra) * 2])
+        for f in extra:
+            payload += bytes([f & 0xFF, (f >> 8) & 0xFF])
+    payload += encode_band_tlv([f for f in freq_mhz if in_band(f)])
+    payload += bytes([TLV_NODE_STATUS, 3, status_flags & 0xFF, last_uart_age_s & 0xFF, (last_uart_age_s >> 8) & 0xFF])
+    head = build_header(
+        net_id=net_id, src_id=src_id, dst_id=dst_id, boot_id=boot_id, frame_type=REPORT_TYPE, seq=seq, flags=flags,
+        compact=compact,
+    )
+    return _seal(head + bytes(payload))
+
+
+@dataclass
+class ReportParseResult:
+    ok: bool
+    err_code: int
+    src_id: int = 0
+    seq: int = 0
+    ttl: int = 0
+    hops: int = 0
+    freq_mhz: Optional[List[int]] = None
+    status_flags: int = 0
+    last_uart_age_s: int = 0xFFFF
+    neighbours: List[tuple] = field(default_factory=list)  # (id, rssi_dbm, snr_db, prr_pct)
+
+
+def iter_tlvs(payload: bytes):
+    """Yields (type, value); raises ValueError on a truncated TLV."""
+    i = 0
+    while i < len(payload):
+        if i + 2 > len(payload) or i + 2 + payload[i + 1] > len(payload):
+            raise ValueError("truncated TLV")
+        yield payload[i], bytes(payload[i + 2 : i + 2 + payload[i + 1]])
+        i += 2 + payload[i + 1]
+
+
+def parse_report_frame(buf: bytes, expected_net_id: int) -> ReportParseResult:
+    # Error codes match codec::ParseError (5 = malformed TLV area).
+    h = parse_header(buf)
+    if h is None:
+        return ReportParseResult(ok=False, err_code=1)
+    if h.net_id != (expected_net_id & 0xFF):
+        return ReportParseResult(ok=False, err_code=2)
+    if h.frame_type != REPORT_TYPE:
+        return ReportParseResult(ok=False, err_code=4)
+    if not frame_crc_ok(buf):
+        return ReportParseResult(ok=False, err_code=3)
+
+    out = ReportParseResult(ok=True, err_code=0, src_id=h.src_id, seq=h.seq, ttl=h.ttl, hops=h.hops, freq_mhz=[])
+    band: List[int] = []
+    try:
+        for tlv_type, value in iter_tlvs(buf[h.length : _body_end(buf, h)]):
+            if tlv_type == TLV_FREQ_LIST and len(value) % 2 == 0:
+                out.freq_mhz = [value[i] | (value[i + 1] << 8) for i in range(0, len(value), 2)]
+            elif tlv_type == TLV_NODE_STATUS and len(value) >= 3:
+                out.status_flags = value[0]
+                out.last_uart_age_s = value[1] | (value[2] << 8)
+            elif tlv_type in (TLV_FREQ_BITMAP, TLV_FREQ_RLE) and len(value) >= 3:
+                band = decode_band_value(tlv_type, value)
+            elif tlv_type == TLV_NEIGHBOURS:
+                i8 = lambda b: b - 256 if b >= 128 else b
+                out.neighbours = [(value[i], i8(value[i + 1]), i8(value[i + 2]), value[i + 3])
+                                  for i in range(0, len(value) - 3, 4)]
+    except ValueError:
+        return ReportParseResult(ok=False, err_code=5)
+    out.freq_mhz = out.freq_mhz + band  # band values follow the list, ascending
+    return out
+
+
+# (sf, bw_hz, cr, tx_power_dbm), fastest first; mirrors PHY_PROFILES in config.h.
+PHY_PROFILES = [
+    (7, 125000, 5, 2),
+    (8, 125000, 5, 2),
+    (9, 125000, 6, 2),
+    (10, 125000, 6, 10),
+    (11, 125000, 6, 17),
+    (12, 125000, 8, 22),
+]
+PHY_PROFILE_DEFAULT = 2
+PHY_SNR_MARGIN_DB = 5
+PHY_UPGRADE_HYST_DB = 3
+
+
+def select_phy_profile(current: int, worst_snr_db: int) -> int:
+    """Same rule as phySelectProfile(): fastest profile whose predicted
+    worst-link SNR clears the SF demod floor plus margin (and hysteresis
+    when moving to a faster profile)."""
+    if current >= len(PHY_PROFILES):
+        return PHY_PROFILE_DEFAULT
+    current_power = PHY_PROFILES[current][3]
+    for pid, (sf, _bw, _cr, power) in enumerate(PHY_PROFILES):
+        predicted_db10 = (worst_snr_db + power - current_power) * 10
+        needed_db10 = -25 * (sf - 4) + PHY_SNR_MARGIN_DB * 10
+        if pid < current:
+            needed_db10 += PHY_UPGRADE_HYST_DB * 10
+        if predicted_db10 >= needed_db10:
+            return pid
+    return len(PHY_PROFILES) - 1
+
+
+def build_beacon_frame(
+    *,
+    net_id: int,
+    src_id: int,
+    boot_id: int,
+    seq: int,
+    active: int,
+    target: int,
+    switch_in_ms: int,
+    report_slowdown: int = 0,
+    net_time_ms: Optional[int] = None,
+    ttl: int = 3,
+    compact: bool = False,
+    flags: int = 0,
+    report_acks: Optional[List[tuple]] = None,  # (src, highest_seq, bitmap)
+) -> bytes:
+    head = build_header(
+        net_id=net_id, src_id=src_id, dst_id=0xFF, boot_id=boot_id, frame_type=BEACON_TYPE, seq=seq, ttl=ttl,
+        flags=flags, compact=compact,
+    )
+    payload = bytes([TLV_PHY_SWITCH, 4, active, target, switch_in_ms & 0xFF, (switch_in_ms >> 8) & 0xFF])
+    payload += bytes([TLV_REPORT_RATE, 1, report_slowdown])
+    if net_time_ms is not None:
+        payload += bytes([TLV_TIME_SYNC, 4]) + (net_time_ms & 0xFFFFFFFF).to_bytes(4, "little")
+    if report_acks:
+        payload += bytes([TLV_REPORT_ACK, 4 * len(report_acks)])
+        for src, highest, bitmap in report_acks:
+            payload += bytes([src & 0xFF, highest & 0xFF, (highest >> 8) & 0xFF, bitmap & 0xFF])
+    return _seal(head + payload)
+
+
+@dataclass
+class BeaconInfo:
+    phy: Optional[tuple] = None  # (active, target, switch_in_ms)
+    report_slowdown: Optional[int] = None
+    net_time_ms: Optional[int] = None
+    report_acks: List[tuple] = field(default_factory=list)  # (src, highest_seq, bitmap)
+
+
+def parse_beacon(buf: bytes) -> Optional[BeaconInfo]:
+    """Decodes a valid BEACON; unknown TLVs are skipped like codec::parseBeaconView()."""
+    h = parse_header(buf)
+    if h is None or h.frame_type != BEACON_TYPE or not frame_crc_ok(buf):
+        return None
+    out = BeaconInfo()
+    try:
+        for tlv_type, value in iter_tlvs(buf[h.length : _body_end(buf, h)]):
+            if tlv_type == TLV_PHY_SWITCH and len(value) >= 4:
+                out.phy = (value[0], value[1], value[2] | (value[3] << 8))
+            elif tlv_type == TLV_REPORT_RATE and len(value) >= 1:
+                out.report_slowdown = value[0]
+            elif tlv_type == TLV_TIME_SYNC and len(value) >= 4:
+                out.net_time_ms = int.from_bytes(value[:4], "little")
+            elif tlv_type == TLV_REPORT_ACK:
+                for i in range(0, min(len(value) // 4, REPORT_ACK_MAX) * 4, 4):
+                    out.report_acks.append((value[i], value[i + 1] | (value[i + 2] << 8), value[i + 3]))
+    except ValueError:
+        return None
+    return out
+
+
+@dataclass
+class MeshParams:
+    backoff_min_ms: int
+    backoff_max_ms: int
+    window_ms: int
+    max_forwards_per_window: int
+    data_ttl: int
+    report_status_period_s: int
+
+
+def _mesh_params_bytes(p: MeshParams) -> bytes:
+    return (
+        p.backoff_min_ms.to_bytes(2, "little")
+        + p.backoff_max_ms.to_bytes(2, "little")
+        + p.window_ms.to_bytes(2, "little")
+        + bytes([p.max_forwards_per_window, p.data_ttl])
+        + p.report_status_period_s.to_bytes(2, "little")
+    )
+
+
+def build_config_frame(
+    *, net_id: int, src_id: int, boot_id: int = 1, seq: int, version: int, params: Optional[MeshParams] = None
+) -> bytes:
+    """CONFIG as buildConfigFrame(): TTL 0, parameters omitted for version 0."""
+    head = build_header(
+        net_id=net_id, src_id=src_id, dst_id=0xFF, boot_id=boot_id, frame_type=CONFIG_TYPE, seq=seq, ttl=0
+    )
+    payload = bytes([TLV_CONFIG_VERSION, 2]) + (version & 0xFFFF).to_bytes(2, "little")
+    if params is not None:
+        payload += bytes([TLV_MESH_PARAMS, 10]) + _mesh_params_bytes(params)
+    return _seal(head + payload)
+
+
+def parse_config(buf: bytes) -> Optional[tuple]:
+    """(version, MeshParams or None) of a valid CONFIG, as codec::parseConfigView()."""
+    h = parse_header(buf)
+    if h is None or h.frame_type != CONFIG_TYPE or not frame_crc_ok(buf):
+        return None
+    version, params = None, None
+    try:
+        for tlv_type, v in iter_tlvs(buf[h.length : _body_end(buf, h)]):
+            if tlv_type == TLV_CONFIG_VERSION and len(v) >= 2:
+                version = v[0] | (v[1] << 8)
+            elif tlv_type == TLV_MESH_PARAMS and len(v) >= 10:
+                u16 = lambda i: v[i] | (v[i + 1] << 8)
+                params = MeshParams(u16(0), u16(2), u16(4), v[6], v[7], u16(8))
+    except ValueError:
+        return None
+    return None if version is None else (version, params)
+
+
+TDMA_SLOTS = 8
+TDMA_CONTENTION_SLOTS = 4
+TDMA_SLOT_BYTES = 64
+TDMA_GUARD_MS = 20
+
+
+def lora_airtime_ms(profile_id: int, length: int) -> int:
+    """Same formula as phyAirtimeMs() (8-symbol preamble, explicit header, CRC on)."""
+    sf, bw, cr, _power = PHY_PROFILES[profile_id]
+    low_dr = sf >= 11 and bw <= 125000
+    t_sym_us = (1_000_000 << sf) // bw
+    num = 8 * length - 4 * sf + 28 + 16
+    den = 4 * (sf - (2 if low_dr else 0))
+    payload_sym = 8 + (-(-num // den) * cr if num > 0 else 0)
+    total_us = 8 * t_sym_us + (t_sym_us * 17) // 4 + payload_sym * t_sym_us
+    return (total_us + 999) // 1000
+
+
+def tdma_slot_ms(profile_id: int = PHY_PROFILE_DEFAULT) -> int:
+    return lora_airtime_ms(profile_id, TDMA_SLOT_BYTES) + TDMA_GUARD_MS
+
+
+def simulate_cell_reports(nodes: int, report_period_ms: int, duration_ms: int, *, tdma: bool, seed: int = 1) -> float:
+    """REPORTs per second one gateway decodes from `nodes` one-hop neighbours.
+
+    Every node produces a full-size REPORT each period (random phase and
+    jitter) and keeps at most one pending, like the coalescing TX queue.
+    Random access sends after a BACKOFF window; TDMA waits for slot
+    node % TDMA_SLOTS. Overlapping frames are all lost (no capture effect).
+    """
+    rng = random.Random(seed)
+    air = lora_airtime_ms(PHY_PROFILE_DEFAULT, TDMA_SLOT_BYTES)
+    slot = tdma_slot_ms()
+    frame = slot * (TDMA_SLOTS + TDMA_CONTENTION_SLOTS)
+    sends = []
+    for node in range(nodes):
+        t, busy_until = rng.uniform(0, report_period_ms), 0.0
+        while t < duration_ms:
+            start = max(t, busy_until)  # a newer report replaces the pending one
+            if tdma:
+                own = (node % TDMA_SLOTS) * slot + TDMA_GUARD_MS / 2
+                start = start - start % frame + own + (frame if start % frame > own else 0)
+            else:
+                start += rng.uniform(50, 300)
+            sends.append((start, start + air))
+            busy_until = start + air
+            t += report_period_ms + rng.uniform(0, 500)
+            t = max(t, busy_until)
+    sends.sort()
+    ok = sum(
+        1
+        for i, (s, e) in enumerate(sends)
+        if (i == 0 or sends[i - 1][1] <= s) and (i + 1 == len(sends) or sends[i + 1][0] >= e)
+    )
+    return ok * 1000.0 / duration_ms
+
+
 def frame_crc_ok(frame: bytes) -> bool:
-    if len(frame) < HEADER_LEN + 2:
+    if parse_header(frame) is None:
         return False
     crc_calc = crc16_ccitt_false(frame[:-2])
     crc_in = frame[-2] | (frame[-1] << 8)
     return crc_calc == crc_in
 
 
+def _seal(body: bytes) -> bytes:
+    crc = crc16_ccitt_false(body)
+    return bytes(body) + bytes([crc & 0xFF, (crc >> 8) & 0xFF])
+
+
+def fragment_frame(frame: bytes, frame_max: int = TX_FRAME_MAX, key: Optional[bytes] = None) -> List[bytes]:
+    """FRAG pieces of `frame` as codec::buildFragment() emits them; with `key`
+    each piece gets its own tag like buildFragmentFrame() under AUTH_ENABLED."""
+    hdr_len = parse_header(frame).length
+    chunk = frame_max - hdr_len - FRAG_HEADER_LEN - 2 - (AUTH_TLV_LEN if key else 0)
+    payload = frame[hdr_len:-2]
+    count = max(1, -(-len(payload) // chunk))
+    type_idx = _type_index(frame)
+    out = []
+    for idx in range(count):
+        head = bytearray(frame[:hdr_len])
+        head[type_idx] = FRAG_TYPE
+        piece = bytes([frame[type_idx], (idx << 4) | (count - 1), idx * chunk])
+        piece += payload[idx * chunk : (idx + 1) * chunk]
+        out.append(auth_append(_seal(bytes(head) + piece), key) if key else _seal(bytes(head) + piece))
+    return out
+
+
+def reassemble_fragments(frames: List[bytes]) -> List[bytes]:
+    """Rebuilt frames, in completion order; incomplete messages are dropped."""
+    pending, done = {}, []
+    for f in frames:
+        h = parse_header(f)
+        if h is None or len(f) < h.length + FRAG_HEADER_LEN + 2 or h.frame_type != FRAG_TYPE or not frame_crc_ok(f):
+            continue
+        key = (h.src_id, h.boot_id, h.seq)
+        inner, packed, offset = f[h.length : h.length + FRAG_HEADER_LEN]
+        idx, count = packed >> 4, (packed & 0x0F) + 1
+        head, parts = pending.setdefault(key, (bytearray(f[: h.length]), {}))
+        head[_type_index(f)] = inner
+        _set_ttl_hops(head, h.ttl, h.hops)
+        parts[idx] = (offset, f[h.length + FRAG_HEADER_LEN : _body_end(f, h)])
+        if len(parts) == count:
+            payload = bytearray()
+            for off, data in sorted(parts.values()):
+                payload[off : off + len(data)] = data
+            done.append(_seal(bytes(head) + bytes(payload)))
+            del pending[key]
+    return done
+
+
+def _body_end(frame: bytes, h: FrameHeader) -> int:
+    """End of the TLV area: before the auth TLV when FLAG_AUTH marks one."""
+    end = len(frame) - 2
+    tail = frame[end - AUTH_TLV_LEN : end - AUTH_TAG_LEN]
+    if h.flags & FRAME_FLAG_AUTH and end - h.length >= AUTH_TLV_LEN and tail == bytes([TLV_AUTH, AUTH_TAG_LEN]):
+        return end - AUTH_TLV_LEN
+    return end
+
+
+def siphash24(key: bytes, data: bytes) -> int:
+    """Reference SipHash-2-4, same as codec::SipHash24 in src/siphash.h."""
+    mask = 0xFFFFFFFFFFFFFFFF
+    rotl = lambda v, n: ((v << n) | (v >> (64 - n))) & mask
+    k0, k1 = int.from_bytes(key[:8], "little"), int.from_bytes(key[8:16], "little")
+    v = [k0 ^ 0x736F6D6570736575, k1 ^ 0x646F72616E646F6D, k0 ^ 0x6C7967656E657261, k1 ^ 0x7465646279746573]
+
+    def sip_round() -> None:
+        v[0] = (v[0] + v[1]) & mask
+        v[1] = rotl(v[1], 13) ^ v[0]
+        v[0] = rotl(v[0], 32)
+        v[2] = (v[2] + v[3]) & mask
+        v[3] = rotl(v[3], 16) ^ v[2]
+        v[0] = (v[0] + v[3]) & mask
+        v[3] = rotl(v[3], 21) ^ v[0]
+        v[2] = (v[2] + v[1]) & mask
+        v[1] = rotl(v[1], 17) ^ v[2]
+        v[2] = rotl(v[2], 32)
+
+    tail = len(data) & 7
+    blocks = [int.from_bytes(data[i : i + 8], "little") for i in range(0, len(data) - tail, 8)]
+    blocks.append(int.from_bytes(data[len(data) - tail :], "little") | ((len(data) & 0xFF) << 56))
+    for m in blocks:
+        v[3] ^= m
+        sip_round()
+        sip_round()
+        v[0] ^= m
+    v[2] ^= 0xFF
+    for _ in range(4):
+        sip_round()
+    return v[0] ^ v[1] ^ v[2] ^ v[3]
+
+
+def _auth_mac(h: FrameHeader, payload: bytes, key: bytes) -> bytes:
+    fields = bytes([h.net_id, h.src_id, h.dst_id, h.boot_id, h.frame_type, h.seq & 0xFF, h.seq >> 8, h.flags])
+    return (siphash24(key, fields + payload) & 0xFFFFFFFF).to_bytes(AUTH_TAG_LEN, "little")
+
+
+def auth_tag(frame: bytes, key: bytes) -> bytes:
+    """Tag over the immutable header fields and the TLV area, as codec::authTagOf()."""
+    h = parse_header(frame)
+    return _auth_mac(h, frame[h.length : _body_end(frame, h)], key)
+
+
+def auth_append(frame: bytes, key: bytes) -> bytes:
+    """Adds the auth TLV to a sealed frame built with FRAME_FLAG_AUTH."""
+    h = parse_header(frame)
+    assert h.flags & FRAME_FLAG_AUTH
+    tag = _auth_mac(h, frame[h.length : -2], key)
+    return _seal(frame[:-2] + bytes([TLV_AUTH, AUTH_TAG_LEN]) + tag)
+
+
+def auth_ok(frame: bytes, key: bytes) -> bool:
+    h = parse_header(frame)
+    if h is None or _body_end(frame, h) == len(frame) - 2:
+        return False
+    return frame[-2 - AUTH_TAG_LEN : -2] == auth_tag(frame, key)
+
+
+@dataclass
+class TraceInfo:
+    origin_queue_ms: int
+    relay_queue_ms: int
+    max_hop_ms: int
+    max_hop_relay: int
+    last_relay: int
+    relay_bits: int
+
+
+def trace_append(frame: bytes) -> bytes:
+    """Adds an empty trace TLV to a sealed frame built with FRAME_FLAG_TRACE,
+    as codec::traceAppend()."""
+    h = parse_header(frame)
+    assert h.flags & FRAME_FLAG_TRACE
+    empty = TraceInfo(0, 0, 0, 0xFF, 0xFF, 0)
+    return _seal(frame[:-2] + bytes([TLV_TRACE, TRACE_LEN]) + _trace_bytes(empty))
+
+
+def neighbours_append(frame: bytes, links: List[tuple]) -> bytes:
+    """Adds a NEIGHBOURS TLV of (id, rssi_dbm, snr_db, prr_pct) links to a sealed
+    frame, as codec::neighboursAppend()."""
+    value = b"".join(bytes([i, rssi & 0xFF, snr & 0xFF, prr]) for i, rssi, snr, prr in links[:4])
+    return _seal(frame[:-2] + bytes([TLV_NEIGHBOURS, len(value)]) + value)
+
+
+def _trace_bytes(t: TraceInfo) -> bytes:
+    return (
+        t.origin_queue_ms.to_bytes(2, "little")
+        + t.relay_queue_ms.to_bytes(2, "little")
+        + t.max_hop_ms.to_bytes(2, "little")
+        + bytes([t.max_hop_relay, t.last_relay])
+        + t.relay_bits.to_bytes(2, "little")
+    )
+
+
+def _trace_offset(frame: bytes) -> Optional[int]:
+    h = parse_header(frame)
+    if h is None or not h.flags & FRAME_FLAG_TRACE or h.frame_type == FRAG_TYPE:
+        return None
+    i, end = h.length, _body_end(frame, h)
+    while i + 2 <= end:
+        if frame[i] == TLV_TRACE and frame[i + 1] >= TRACE_LEN:
+            return i + 2
+        i += 2 + frame[i + 1]
+    return None
+
+
+def parse_trace(frame: bytes) -> Optional[TraceInfo]:
+    off = _trace_offset(frame)
+    if off is None:
+        return None
+    v = frame[off : off + TRACE_LEN]
+    u16 = lambda i: v[i] | (v[i + 1] << 8)
+    return TraceInfo(u16(0), u16(2), u16(4), v[6], v[7], u16(8))
+
+
+def trace_stamp(frame: bytes, relay_id: int, delay_ms: int) -> bytes:
+    """codec::traceStamp(): the origin's queue time for relay_id 0xFF, else one relay hop."""
+    t, off = parse_trace(frame), _trace_offset(frame)
+    assert t is not None
+    delay = min(delay_ms, 0xFFFF)
+    if relay_id == 0xFF:
+        t.origin_queue_ms = delay
+    else:
+        t.relay_queue_ms = min(t.relay_queue_ms + delay, 0xFFFF)
+        if t.max_hop_relay == 0xFF or delay > t.max_hop_ms:
+            t.max_hop_ms, t.max_hop_relay = delay, relay_id
+        t.last_relay = relay_id
+        t.relay_bits |= 1 << (relay_id % 16)
+    return _seal(frame[:off] + _trace_bytes(t) + frame[off + TRACE_LEN : -2])
+
+
+def congestion_level(frame: bytes) -> int:
+    """Sender congestion level (0-3) from FLAGS bits 3-4; 0 without a FLAGS byte."""
+    h = parse_header(frame)
+    return 0 if h is None else (h.flags & FRAME_FLAG_CONGESTION_MASK) >> FRAME_FLAG_CONGESTION_SHIFT
+
+
 def frame_get_ttl(frame: bytes) -> int:
-    if len(frame) < HEADER_LEN + 2:
-        return 0
-    return frame[7]
+    h = parse_header(frame)
+    return 0 if h is None else h.ttl
 
 
 def frame_is_no_relay(frame: bytes) -> bool:
-    if len(frame) < HEADER_LEN + 2:
-        return True
-    return (frame[9] & FRAME_FLAG_NO_RELAY) != 0
+    h = parse_header(frame)
+    return True if h is None else (h.flags & FRAME_FLAG_NO_RELAY) != 0
 
 
 def frame_dec_ttl_inc_hops_recrc(frame: bytes) -> Optional[bytes]:
-    if len(frame) < HEADER_LEN + 2:
-        return None
-    if not frame_crc_ok(frame):
-        return None
-    ttl = frame[7]
-    if ttl == 0:
+    h = parse_header(frame)
+    if h is None or not frame_crc_ok(frame) or h.ttl == 0:
         return None
+    out = bytearray(frame[:-2])
+    _set_ttl_hops(out, h.ttl - 1, (h.hops + 1) & 0xFF)
+    return _seal(bytes(out))
 
-    out = bytearray(frame)
-    out[7] = (out[7] - 1) & 0xFF
-    out[8] = (out[8] + 1) & 0xFF
-    crc = crc16_ccitt_false(bytes(out[:-2]))
-    out[-2] = crc & 0xFF
-    out[-1] = (crc >> 8) & 0xFF
-    return bytes(out)
+
+def build_coded_frame(*, net_id: int, src_id: int, boot_id: int = 1, seq: int, a: bytes, b: bytes) -> bytes:
+    """CODED as buildCodedFrame(): TTL 0, (src, seq low byte, length) per native, then both XORed."""
+    ha, hb = parse_header(a), parse_header(b)
+    head = build_header(
+        net_id=net_id, src_id=src_id, dst_id=0xFF, boot_id=boot_id, frame_type=CODED_TYPE, seq=seq, ttl=0
+    )
+    n = max(len(a), len(b))
+    mixed = bytes(x ^ y for x, y in zip(a.ljust(n, b"\0"), b.ljust(n, b"\0")))
+    entries = bytes([ha.src_id, ha.seq & 0xFF, len(a), hb.src_id, hb.seq & 0xFF, len(b)])
+    return _seal(head + bytes([TLV_CODED, len(entries) + n]) + entries + mixed)
+
+
+def decode_coded(coded: bytes, known: bytes) -> Optional[bytes]:
+    """The native of a CODED frame that is not `known`, as codec::decodeCoded(); None when it does not pair."""
+    h, k = parse_header(coded), parse_header(known)
+    if h is None or k is None or h.frame_type != CODED_TYPE or not frame_crc_ok(coded):
+        return None
+    for tlv_type, v in iter_tlvs(coded[h.length : _body_end(coded, h)]):
+        if tlv_type != TLV_CODED or len(v) < 6:
+            continue
+        entries = [(v[0], v[1], v[2]), (v[3], v[4], v[5])]
+        mine = (k.src_id, k.seq & 0xFF, len(known))
+        if mine not in entries:
+            return None
+        other_len = entries[1 - entries.index(mine)][2]
+        out = bytes(x ^ y for x, y in zip(v[6 : 6 + other_len], known.ljust(other_len, b"\0")))
+        return out if frame_crc_ok(out) else None
+    return None
 
 
 def mesh_should_forward(frame: bytes, *, dedup_seen: bool, rate_allow: bool) -> bool:
@@ -244,6 +902,87 @@ class ForwardQueue:
         return True
 
 
+@dataclass
+class TxQueue:
+    """Own-frame TX queue; items are (frame_type, seq). REPORTs coalesce:
+    a new one replaces the pending one in place and keeps its seq."""
+
+    capacity: int
+    items: List[tuple] = field(default_factory=list)
+    next_report_seq: int = 0
+    superseded: int = 0
+    dropped: int = 0
+
+    def push_report(self) -> int:
+        for i, (frame_type, seq) in enumerate(self.items):
+            if frame_type == REPORT_TYPE:
+                self.items[i] = (REPORT_TYPE, seq)
+                self.superseded += 1
+                return seq
+        return self.push(REPORT_TYPE)
+
+    def push(self, frame_type: int) -> int:
+        if len(self.items) >= self.capacity:
+            self.dropped += 1
+            return -1
+        seq = self.next_report_seq
+        self.next_report_seq = (self.next_report_seq + 1) & 0xFFFF
+        self.items.append((frame_type, seq))
+        return seq
+
+    def pop(self) -> tuple:
+        return self.items.pop(0)
+
+
+REPORT_STATUS_PERIOD_MS = 5000
+REPORT_STATUS_PERIOD_MAX_MS = 80000
+REPORT_MIN_GAP_MS = 2000
+REPORT_SLOWDOWN_MAX = 4
+
+
+def report_phase_ms(node_id: int) -> int:
+    return (REPORT_STATUS_PERIOD_MS * ((node_id * 40503) & 0xFFFF)) >> 16
+
+
+@dataclass
+class ReportRateController:
+    """Mirrors src/report_rate.cpp without the random jitter (jitter_ms is fixed)."""
+
+    node_id: int
+    jitter_ms: int = 0
+    slowdown: int = 0
+    heartbeat_ms: int = REPORT_STATUS_PERIOD_MS
+    change_pending: bool = True
+    reported_freqs: frozenset = frozenset()
+    reported_flags: int = -1
+    last_report_ms: Optional[int] = None
+    next_heartbeat_ms: int = 0
+
+    def note(self, freqs: List[int], flags: int) -> None:
+        if frozenset(freqs) != self.reported_freqs or flags != self.reported_flags:
+            self.change_pending = True
+
+    def due(self, now_ms: int) -> bool:
+        gap = REPORT_MIN_GAP_MS << self.slowdown
+        if self.last_report_ms is None:
+            self.last_report_ms = now_ms + report_phase_ms(self.node_id) - gap
+            self.next_heartbeat_ms = now_ms + report_phase_ms(self.node_id)
+        if self.change_pending and now_ms - self.last_report_ms >= gap:
+            return True
+        return now_ms >= self.next_heartbeat_ms
+
+    def reported(self, freqs: List[int], flags: int, now_ms: int) -> None:
+        if self.change_pending:
+            self.heartbeat_ms = REPORT_STATUS_PERIOD_MS
+        else:
+            self.heartbeat_ms = min(self.heartbeat_ms * 2, REPORT_STATUS_PERIOD_MAX_MS)
+        self.change_pending = False
+        self.last_report_ms = now_ms
+        self.next_heartbeat_ms = now_ms + (self.heartbeat_ms << self.slowdown) + self.jitter_ms
+        self.reported_freqs = frozenset(freqs)
+        self.reported_flags = flags
+
+
 @dataclass
 class ForwardWindowLimiter:
     window_ms: int
@@ -261,3 +1000,105 @@ class ForwardWindowLimiter:
 
     def consume(self) -> None:
         self.count_in_window += 1
+
+
+BRIDGE_SYNC = b"\xA5\x5A"
+BRIDGE_KIND_RX = 0x01
+BRIDGE_KIND_STATS = 0x02
+BRIDGE_KIND_LOG = 0x03
+BRIDGE_RX_META_LEN = 7
+
+
+@dataclass
+class ExportRecord:
+    kind: int
+    ts_ms: int
+    rssi: int = 0
+    snr: int = 0
+    frame: bytes = b""
+    exported: int = 0
+    dropped: int = 0
+    high_water: int = 0
+    text: str = ""
+
+
+def build_export_record(kind: int, body: bytes) -> bytes:
+    head = bytes([kind & 0xFF, len(body) & 0xFF])
+    crc = crc16_ccitt_false(head + body)
+    return BRIDGE_SYNC + head + body + bytes([crc & 0xFF, (crc >> 8) & 0xFF])
+
+
+def build_export_rx_record(*, ts_ms: int, rssi: int, snr: int, frame: bytes) -> bytes:
+    body = (
+        (ts_ms & 0xFFFFFFFF).to_bytes(4, "little")
+        + (rssi & 0xFFFF).to_bytes(2, "little")
+        + bytes([snr & 0xFF])
+        + frame
+    )
+    return build_export_record(BRIDGE_KIND_RX, body)
+
+
+def build_export_stats_record(*, ts_ms: int, exported: int, dropped: int, high_water: int) -> bytes:
+    body = (
+        (ts_ms & 0xFFFFFFFF).to_bytes(4, "little")
+        + (exported & 0xFFFFFFFF).to_bytes(4, "little")
+        + (dropped & 0xFFFFFFFF).to_bytes(4, "little")
+        + (high_water & 0xFFFF).to_bytes(2, "little")
+    )
+    return build_export_record(BRIDGE_KIND_STATS, body)
+
+
+def build_export_log_record(*, ts_ms: int, text: str) -> bytes:
+    return build_export_record(BRIDGE_KIND_LOG, (ts_ms & 0xFFFFFFFF).to_bytes(4, "little") + text.encode("ascii"))
+
+
+def parse_export_stream(stream: bytes) -> List[ExportRecord]:
+    # Log lines share the serial link, so resync on the sync pair and trust only the CRC.
+    out: List[ExportRecord] = []
+    i = 0
+    while True:
+        i = stream.find(BRIDGE_SYNC, i)
+        if i < 0 or i + 4 > len(stream):
+            break
+        kind = stream[i + 2]
+        body_len = stream[i + 3]
+        end = i + 4 + body_len + 2
+        if end > len(stream):
+            break
+        body = stream[i + 4 : i + 4 + body_len]
+        crc_in = stream[end - 2] | (stream[end - 1] << 8)
+        if crc16_ccitt_false(stream[i + 2 : i + 4] + body) != crc_in:
+            i += 1
+            continue
+
+        ts_ms = int.from_bytes(body[0:4], "little") if len(body) >= 4 else 0
+        if kind == BRIDGE_KIND_RX and body_len >= BRIDGE_RX_META_LEN:
+            rssi = int.from_bytes(body[4:6], "little", signed=True)
+            snr = int.from_bytes(body[6:7], "little", signed=True)
+            out.append(ExportRecord(kind=kind, ts_ms=ts_ms, rssi=rssi, snr=snr, frame=bytes(body[7:])))
+        elif kind == BRIDGE_KIND_STATS and body_len >= 14:
+            out.append(
+                ExportRecord(
+                    kind=kind,
+                    ts_ms=ts_ms,
+                    exported=int.from_bytes(body[4:8], "little"),
+                    dropped=int.from_bytes(body[8:12], "little"),
+                    high_water=int.from_bytes(body[12:14], "little"),
+                )
+            )
+        elif kind == BRIDGE_KIND_LOG and body_len >= 4:
+            out.append(ExportRecord(kind=kind, ts_ms=ts_ms, text=bytes(body[4:]).decode("ascii", "replace")))
+        i = end
+    return out
+
+
+def report_ack_missing(highest_seq: int, bitmap: int, seq: int, seq_bits: int = 16) -> Optional[bool]:
+    """Node-side reading of a REPORT_ACK entry like reportAckOnBeacon():
+    None when `seq` is newer than anything the gateway heard or out of the
+    8-seq window, else whether the gateway still lacks it. Compact frames
+    carry 8 SEQ bits (seq_bits=8), so their seqs wrap at 256."""
+    mask = (1 << seq_bits) - 1
+    d = (highest_seq - seq) & mask
+    if d > (mask >> 1) or d > 8:
+        return None
+    return d != 0 and not (bitmap >> (d - 1)) & 1
@@ -0,0 +1,58 @@
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+// Minimal Arduino surface for compiling the firmware sources on the host.
+// Time is virtual (see sim.h); nothing here touches real hardware.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+enum : uint8_t { PA0 = 0, PA1, PA2, PA3, PA4, PA5, PA6, PA7, PB0, PB1, PB10, PB11, PB12, PC13 };
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_ANALOG 2
+#define HEX 16
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+long random(long maxExclusive);
+long random(long minInclusive, long maxExclusive);
+void randomSeed(uint32_t seed);
+
+inline void pinMode(uint32_t, uint32_t) {}
+inline void digitalWrite(uint32_t, uint32_t) {}
+inline int digitalRead(uint32_t) {
+  return LOW;
+}
+inline int analogRead(uint32_t) {
+  return 2300;
+}
+inline void analogReadResolution(int) {}
+
+// Host serial: RX is fed by the sim driver, TX bytes are counted and dropped.
+class SimSerial {
+ public:
+  void begin(uint32_t) {}
+  int available();
+  int read();
+  int availableForWrite();
+  size_t write(uint8_t b);
+  size_t write(const uint8_t* data, size_t len);
+  template <typename T>
+  void print(T) {}
+  template <typename T>
+  void print(T, int) {}
+  template <typename T>
+  void println(T) {}
+  void println() {}
+};
+
+extern SimSerial Serial;
+
+#endif  // SIM_ARDUINO_H
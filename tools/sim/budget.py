@@ -0,0 +1,143 @@
+"""Per-module size comparison of the scanner and gateway images.
+
+Links the sketch and firmware sources the way the Arduino core does (-Os,
+one section per function and object, --gc-sections) and charges what the
+linker keeps to each firmware source through the map file. The images are
+built with the host compiler, with host shims for board, radio and log and
+without the Arduino core, HAL and stack. The numbers therefore only say
+which module each role keeps and how the roles compare; they are not target
+sizes. For those, check the flash and RAM usage arduino-cli prints for the
+real sketch.
+
+Usage: python tools/sim/budget.py [-D DEFINE]... [--role scanner|gateway]
+"""
+
+from __future__ import annotations
+
+import argparse
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Dict, Optional, Sequence, Tuple
+
+if __package__ in (None, ""):
+    sys.path.insert(0, str(Path(__file__).resolve().parents[2]))
+
+from tools.sim.build import DEFINES, FIRMWARE_SOURCES, INCLUDE_DIRS, REPO_ROOT, SIM_SOURCES
+
+SKETCH = "papuga.ino"
+ROLES = {"scanner": "ROLE_GATEWAY=0", "gateway": "ROLE_GATEWAY=1"}
+
+# Close to what the STM32 core passes; no unwind tables on the target.
+FIRMWARE_FLAGS = ["-Os", "-ffunction-sections", "-fdata-sections", "-fno-exceptions", "-fno-rtti",
+                  "-fno-asynchronous-unwind-tables", "-fno-threadsafe-statics"]
+
+_MAP_LINE = re.compile(r"^\s(\.\S+)?\s+0x[0-9a-f]+\s+0x([0-9a-f]+)\s+(\S+\.o)$")
+_FLASH_SECTIONS = (".text", ".rodata", ".data.rel.ro", ".init_array")
+_RAM_SECTIONS = (".data", ".bss")
+
+
+@dataclass
+class Image:
+    role: str
+    modules: Dict[str, Tuple[int, int]] = field(default_factory=dict)  # source -> (flash, ram)
+    sections: Dict[str, set] = field(default_factory=dict)  # source -> input sections kept
+
+    @property
+    def flash(self) -> int:
+        return sum(f for f, _ in self.modules.values())
+
+    @property
+    def ram(self) -> int:
+        return sum(r for _, r in self.modules.values())
+
+
+def _charge(section: str) -> Tuple[bool, bool]:
+    """(counts as flash, counts as RAM); initialised data is both."""
+    if section.startswith(_FLASH_SECTIONS):
+        return True, False
+    if section.startswith(".data"):
+        return True, True
+    return False, section.startswith(_RAM_SECTIONS)
+
+
+def parse_map(text: str, objects: Dict[str, str], role: str) -> Image:
+    """Input sections the link kept, charged to the source each object came from."""
+    image = Image(role)
+    lines = text.split("Linker script and memory map", 1)[-1].splitlines()
+    pending: Optional[str] = None
+    for line in lines:
+        # Long section names put address, size and object on the next line.
+        if pending is None and re.match(r"^\s\.\S+$", line):
+            pending = line.strip()
+            continue
+        m = _MAP_LINE.match(line if pending is None else f" {pending}{line}")
+        pending = None
+        if m is None or m.group(1) is None:
+            continue
+        source = objects.get(Path(m.group(3)).name)
+        size = int(m.group(2), 16)
+        if source is None or size == 0:
+            continue
+        flash, ram = _charge(m.group(1))
+        f, r = image.modules.get(source, (0, 0))
+        image.modules[source] = (f + (size if flash else 0), r + (size if ram else 0))
+        image.sections.setdefault(source, set()).add(m.group(1))
+    return image
+
+
+def measure(role: str, extra_defines: Sequence[str] = (), cxx: Optional[str] = None) -> Image:
+    cxx = cxx or shutil.which("g++") or shutil.which("clang++")
+    if cxx is None:
+        raise RuntimeError("no host C++ compiler found")
+    defines = [f"-D{d}" for d in list(DEFINES) + [ROLES[role]] + list(extra_defines)]
+    includes = [f"-I{REPO_ROOT / d}" for d in INCLUDE_DIRS]
+    with tempfile.TemporaryDirectory() as tmp:
+        out = Path(tmp)
+        objects: Dict[str, str] = {}
+        units = [(s, FIRMWARE_FLAGS) for s in FIRMWARE_SOURCES + [SKETCH]]
+        units += [(s, ["-O2"]) for s in SIM_SOURCES + ["tools/sim/budget_main.cpp"]]
+        for source, flags in units:
+            obj = out / (Path(source).stem + ".o")
+            cmd = [cxx, "-std=gnu++17", "-Wall", "-Wextra", "-Werror", *flags, *includes, *defines]
+            cmd += ["-x", "c++", str(REPO_ROOT / source), "-x", "none", "-c", "-o", str(obj)]
+            subprocess.run(cmd, check=True)
+            if source in FIRMWARE_SOURCES or source == SKETCH:
+                objects[obj.name] = Path(source).name
+        link_map = out / "image.map"
+        cmd = [cxx, *[str(out / (Path(s).stem + ".o")) for s, _ in units]]
+        cmd += ["-Wl,--gc-sections", f"-Wl,-Map={link_map}", "-o", str(out / "image")]
+        subprocess.run(cmd, check=True)
+        return parse_map(link_map.read_text(), objects, role)
+
+
+def report(images: Sequence[Image]) -> None:
+    """One flash/ram column pair per role, '-' where a role links nothing of a module."""
+    print("host-relative sizes, not target sizes")
+    print(f"{'module':<20}" + "".join(f" {i.role + ' flash':>14} {i.role + ' ram':>12}" for i in images))
+    for source in sorted({s for i in images for s in i.modules}):
+        cells = ""
+        for image in images:
+            flash, ram = image.modules.get(source, ("-", "-"))
+            cells += f" {flash:>14} {ram:>12}"
+        print(f"{source:<20}{cells}")
+    for image in images:
+        print(f"{image.role}_flash={image.flash}")
+        print(f"{image.role}_ram={image.ram}")
+
+
+def main(argv: Sequence[str]) -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-D", dest="defines", action="append", default=[], help="extra firmware define")
+    parser.add_argument("--role", choices=sorted(ROLES), action="append", help="default: both")
+    args = parser.parse_args(argv)
+    report([measure(role, args.defines) for role in args.role or ROLES])
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,11 @@
+// Entry point for budget.py: the sketch's setup()/loop() as the core runs them.
+
+void setup();
+void loop();
+
+int main() {
+  setup();
+  for (;;) {
+    loop();
+  }
+}
@@ -0,0 +1,75 @@
+"""Builds host simulation tools that link the real firmware sources.
+
+Usage: python tools/sim/build.py replay -o replay
+"""
+
+from __future__ import annotations
+
+import argparse
+import shutil
+import subprocess
+import sys
+from pathlib import Path
+from typing import Optional, Sequence
+
+REPO_ROOT = Path(__file__).resolve().parents[2]
+
+# Firmware translation units compiled unchanged on the host.
+FIRMWARE_SOURCES = [
+    "src/app.cpp",
+    "src/bridge.cpp",
+    "src/congestion.cpp",
+    "src/crc16.cpp",
+    "src/dedup.cpp",
+    "src/frame.cpp",
+    "src/freq_set.cpp",
+    "src/led.cpp",
+    "src/mesh_params.cpp",
+    "src/neighbours.cpp",
+    "src/netcode.cpp",
+    "src/phy.cpp",
+    "src/relay_ack.cpp",
+    "src/report_ack.cpp",
+    "src/report_rate.cpp",
+    "src/report_store.cpp",
+    "src/tdma.cpp",
+    "src/uart.cpp",
+]
+
+# Host replacements for hardware-facing modules (board, radio, log, Arduino core).
+SIM_SOURCES = [
+    "tools/sim/sim_arduino.cpp",
+    "tools/sim/sim_board.cpp",
+    "tools/sim/sim_log.cpp",
+    "tools/sim/sim_radio.cpp",
+]
+
+INCLUDE_DIRS = ["tools/sim", "src", "tools"]
+DEFINES = ["MESH_ENABLED=1"]
+
+
+def build(tool: str, out: Path, cxx: Optional[str] = None, extra_defines: Sequence[str] = ()) -> Path:
+    cxx = cxx or shutil.which("g++") or shutil.which("clang++")
+    if cxx is None:
+        raise RuntimeError("no host C++ compiler found")
+    cmd = [cxx, "-O2", "-std=gnu++17", "-Wall", "-Wextra", "-Werror"]
+    cmd += [f"-I{REPO_ROOT / d}" for d in INCLUDE_DIRS]
+    cmd += [f"-D{d}" for d in list(DEFINES) + list(extra_defines)]
+    cmd += [str(REPO_ROOT / s) for s in FIRMWARE_SOURCES + SIM_SOURCES]
+    cmd += [str(REPO_ROOT / "tools" / "sim" / f"{tool}.cpp"), "-o", str(out)]
+    subprocess.run(cmd, check=True)
+    return out
+
+
+def main(argv: Sequence[str]) -> int:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("tool", help="driver name in tools/sim (e.g. replay)")
+    parser.add_argument("-o", "--out", type=Path, required=True)
+    parser.add_argument("-D", dest="defines", action="append", default=[], help="extra firmware define")
+    args = parser.parse_args(argv)
+    build(args.tool, args.out, extra_defines=args.defines)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,371 @@
+// Replays a captured RX stream through the real firmware mesh code on a
+// virtual clock and reports queue, drop, forward and timing metrics.
+//
+// Build: python tools/sim/build.py replay -o replay
+//
+// Usage: replay [--check FILE] [--drain MS] [--echo] [--uart FILE] [--dump-tx FILE] CAPTURE
+//   CAPTURE is an export stream (gateway bridge / RX_CAPTURE_ENABLED output).
+//   --check FILE compares metrics against "name >= value" / "name <= value"
+//   lines and exits 1 on any regression.
+//   --uart FILE feeds "AT_MS text" lines to the node's UART at wire speed
+//   (AT_MS relative to the first captured frame).
+//   --dump-tx FILE writes every transmitted frame, length-prefixed
+//   (frame_decode --lp format).
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "app.h"
+#include "config.h"
+#include "export_stream.h"
+#include "frame_codec.h"
+#include "neighbours.h"
+#include "radio.h"
+#include "report_rate.h"
+#include "sim.h"
+#include "tdma.h"
+
+namespace {
+
+constexpr uint32_t START_MS = 1000U;
+constexpr double SERIAL_BYTE_MS = 10.0 * 1000.0 / static_cast<double>(UART_BAUD);
+
+struct UartByte {
+  double atMs;
+  char ch;
+};
+
+struct RxEvent {
+  uint32_t atMs;
+  int16_t rssi;
+  int8_t snr;
+  std::vector<uint8_t> frame;
+};
+
+struct Options {
+  const char* capture = nullptr;
+  const char* checkFile = nullptr;
+  uint32_t drainMs = 10000U;
+  bool echo = false;
+  const char* uartFile = nullptr;
+  const char* dumpTxFile = nullptr;
+};
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--check") == 0 && (i + 1) < argc) {
+      opt.checkFile = argv[++i];
+    } else if (std::strcmp(argv[i], "--drain") == 0 && (i + 1) < argc) {
+      opt.drainMs = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 0));
+    } else if (std::strcmp(argv[i], "--echo") == 0) {
+      opt.echo = true;
+    } else if (std::strcmp(argv[i], "--uart") == 0 && (i + 1) < argc) {
+      opt.uartFile = argv[++i];
+    } else if (std::strcmp(argv[i], "--dump-tx") == 0 && (i + 1) < argc) {
+      opt.dumpTxFile = argv[++i];
+    } else if (argv[i][0] == '-') {
+      return false;
+    } else {
+      opt.capture = argv[i];
+    }
+  }
+  return opt.capture != nullptr;
+}
+
+bool loadCapture(const char* path, std::vector<RxEvent>& out) {
+  FILE* f = std::fopen(path, "rb");
+  if (f == nullptr) {
+    return false;
+  }
+  std::vector<uint8_t> data;
+  uint8_t chunk[65536];
+  size_t n = 0U;
+  while ((n = std::fread(chunk, 1U, sizeof(chunk), f)) > 0U) {
+    data.insert(data.end(), chunk, chunk + n);
+  }
+  std::fclose(f);
+
+  ExportStreamReader reader(data.data(), data.size());
+  ExportRecord rec{};
+  uint32_t firstTs = 0U;
+  while (reader.next(rec)) {
+    if ((rec.kind != BRIDGE_KIND_RX) || (rec.frameLen == 0U)) {
+      continue;
+    }
+    if (out.empty()) {
+      firstTs = rec.tsMs;
+    }
+    RxEvent ev;
+    ev.atMs = START_MS + (rec.tsMs - firstTs);
+    ev.rssi = rec.rssi;
+    ev.snr = rec.snr;
+    ev.frame.assign(rec.frame, rec.frame + rec.frameLen);
+    out.push_back(ev);
+  }
+  return true;
+}
+
+bool loadUart(const char* path, std::vector<UartByte>& out) {
+  FILE* f = std::fopen(path, "r");
+  if (f == nullptr) {
+    return false;
+  }
+  static char line[8192];
+  double wireFreeAt = 0.0;
+  while (std::fgets(line, sizeof(line), f) != nullptr) {
+    char* text = nullptr;
+    const double atMs = START_MS + std::strtod(line, &text);
+    if ((text == line) || (*text != ' ')) {
+      continue;
+    }
+    ++text;
+    // Back to back on the wire: a line never starts before the previous one ends.
+    double t = std::max(atMs, wireFreeAt);
+    for (; *text != '\0'; ++text) {
+      out.push_back(UartByte{t, *text});
+      t += SERIAL_BYTE_MS;
+    }
+    wireFreeAt = t;
+  }
+  std::fclose(f);
+  return true;
+}
+
+bool dumpTx(const char* path) {
+  FILE* f = std::fopen(path, "wb");
+  if (f == nullptr) {
+    return false;
+  }
+  for (size_t i = 0U; i < sim::radioTxCount(); ++i) {
+    const sim::TxRecord& tx = sim::radioTx(i);
+    std::fputc(tx.len, f);
+    std::fwrite(tx.data, 1U, tx.len, f);
+  }
+  std::fclose(f);
+  return true;
+}
+
+uint32_t flowKey(uint8_t src, uint16_t seq) {
+  return (static_cast<uint32_t>(src) << 16) | seq;
+}
+
+uint32_t percentile(std::vector<uint32_t> v, uint32_t pct) {
+  if (v.empty()) {
+    return 0U;
+  }
+  std::sort(v.begin(), v.end());
+  const size_t idx = ((v.size() - 1U) * pct) / 100U;
+  return v[idx];
+}
+
+bool runChecks(const char* path, const std::map<std::string, double>& metrics) {
+  FILE* f = std::fopen(path, "r");
+  if (f == nullptr) {
+    std::fprintf(stderr, "cannot open %s\n", path);
+    return false;
+  }
+  bool ok = true;
+  char line[256];
+  while (std::fgets(line, sizeof(line), f) != nullptr) {
+    char name[128];
+    char op[4];
+    double limit = 0.0;
+    if ((line[0] == '#') || (std::sscanf(line, "%127s %3s %lf", name, op, &limit) != 3)) {
+      continue;
+    }
+    const auto it = metrics.find(name);
+    if (it == metrics.end()) {
+      std::printf("CHECK FAIL %s unknown metric\n", name);
+      ok = false;
+      continue;
+    }
+    const bool pass = (std::strcmp(op, ">=") == 0) ? (it->second >= limit)
+                      : (std::strcmp(op, "<=") == 0) ? (it->second <= limit)
+                                                       : (it->second == limit);
+    if (!pass) {
+      std::printf("CHECK FAIL %s=%.0f expected %s %.0f\n", name, it->second, op, limit);
+      ok = false;
+    }
+  }
+  std::fclose(f);
+  return ok;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opt{};
+  if (!parseArgs(argc, argv, opt)) {
+    std::fprintf(stderr, "usage: replay [--check FILE] [--drain MS] [--echo] [--uart FILE] [--dump-tx FILE] CAPTURE\n");
+    return 2;
+  }
+  std::vector<RxEvent> events;
+  if (!loadCapture(opt.capture, events)) {
+    std::fprintf(stderr, "cannot open %s\n", opt.capture);
+    return 2;
+  }
+  std::vector<UartByte> uartBytes;
+  if ((opt.uartFile != nullptr) && !loadUart(opt.uartFile, uartBytes)) {
+    std::fprintf(stderr, "cannot open %s\n", opt.uartFile);
+    return 2;
+  }
+
+  sim::logSetEcho(opt.echo);
+  sim::setNow(0U);
+  appInit();
+
+  const uint32_t endMs = (events.empty() ? START_MS : events.back().atMs) + opt.drainMs;
+  std::map<uint32_t, uint32_t> firstRxAt;
+  uint64_t tickNs = 0U;
+  uint64_t tickNsMax = 0U;
+  size_t next = 0U;
+  size_t nextUart = 0U;
+
+  sim::setNow(START_MS);
+  while (static_cast<int32_t>(sim::now() - endMs) < 0) {
+    const uint32_t nowMs = sim::now();
+    while ((next < events.size()) && (static_cast<int32_t>(events[next].atMs - nowMs) <= 0)) {
+      const RxEvent& ev = events[next++];
+      const uint8_t len = static_cast<uint8_t>(ev.frame.size());
+      codec::FrameView view;
+      if (view.init(ev.frame.data(), len)) {
+        firstRxAt.emplace(flowKey(view.src(), view.seq()), ev.atMs);
+      }
+      sim::radioDeliver(ev.atMs, ev.frame.data(), len, ev.rssi, ev.snr);
+    }
+    while ((nextUart < uartBytes.size()) && (uartBytes[nextUart].atMs <= nowMs)) {
+      sim::serialInject(&uartBytes[nextUart++].ch, 1U);
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+    appTick(nowMs);
+    const auto t1 = std::chrono::steady_clock::now();
+    const uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+    tickNs += ns;
+    tickNsMax = std::max(tickNsMax, ns);
+
+    if (sim::now() == nowMs) {
+      sim::setNow(nowMs + 1U);  // No blocking TX this tick: 1 ms loop period.
+    }
+  }
+
+  std::vector<uint32_t> latencies;
+  for (size_t i = 0U; i < sim::radioTxCount(); ++i) {
+    const sim::TxRecord& tx = sim::radioTx(i);
+    codec::FrameView view;
+    if (!view.init(tx.data, tx.len) || (view.src() == NODE_ID)) {
+      continue;
+    }
+    const auto it = firstRxAt.find(flowKey(view.src(), view.seq()));
+    if (it != firstRxAt.end()) {
+      latencies.push_back(tx.startMs - it->second);
+    }
+  }
+
+  // Own frames, and how many started inside this node's TDMA slot.
+  uint32_t ownTx = 0U;
+  uint32_t ownTxInSlot = 0U;
+  for (size_t i = 0U; i < sim::radioTxCount(); ++i) {
+    const sim::TxRecord& tx = sim::radioTx(i);
+    codec::FrameView view;
+    if (view.init(tx.data, tx.len) && (view.src() == NODE_ID) && (view.hops() == 0U)) {
+      ++ownTx;
+      ownTxInSlot += (tdmaSlotAt(tx.startMs) == (NODE_ID % TDMA_SLOTS)) ? 1U : 0U;
+    }
+  }
+
+  const AppStats& st = appStats();
+  uint64_t latencySum = 0U;
+  for (uint32_t l : latencies) {
+    latencySum += l;
+  }
+
+  if ((opt.dumpTxFile != nullptr) && !dumpTx(opt.dumpTxFile)) {
+    std::fprintf(stderr, "cannot write %s\n", opt.dumpTxFile);
+    return 2;
+  }
+
+  std::map<std::string, double> m;
+  m["frames_in"] = static_cast<double>(events.size());
+  m["rx_lost_busy"] = sim::radioRxLostBusy();
+  m["rx_overwritten"] = sim::radioRxOverwritten();
+  m["rx_frames"] = st.rxFrames;
+  m["rx_accepted"] = st.rxAccepted;
+  for (uint8_t i = 0U; i < static_cast<uint8_t>(RxDrop::Count); ++i) {
+    m[std::string("rx_drop_") + rxDropName(static_cast<RxDrop>(i))] = st.rxDrop[i];
+  }
+  m["fwd_queued"] = st.fwdQueued;
+  m["fwd_sent"] = st.fwdSent;
+  m["fwd_drop_queue"] = st.fwdDropQueue;
+  m["fwd_drop_rate"] = st.fwdDropRate;
+  m["fwd_queue_high_water"] = st.fwdQueueHighWater;
+  m["relay_ack_heard"] = st.relayAckHeard;
+  m["relay_ack_retries"] = st.relayAckRetries;
+  m["relay_ack_gave_up"] = st.relayAckGaveUp;
+  m["report_ack_confirmed"] = st.reportAckConfirmed;
+  m["report_resent"] = st.reportResent;
+  m["store_written"] = st.storeWritten;
+  m["store_drained"] = st.storeDrained;
+  m["store_dropped"] = st.storeDropped;
+  m["store_superseded"] = st.storeSuperseded;
+  m["store_pending"] = st.storePending;
+  m["config_version"] = st.configVersion;
+  m["config_adopted"] = st.configAdopted;
+  m["config_suppressed"] = st.configSuppressed;
+  m["congestion_signalled"] = st.congestionSignalled;
+  m["congestion_heard"] = st.congestionHeard;
+  m["neighbours"] = st.neighbours;
+  m["neighbours_evicted"] = st.neighboursEvicted;
+  m["netcode_sent"] = st.netcodeSent;
+  m["netcode_decoded"] = st.netcodeDecoded;
+  m["netcode_undecodable"] = st.netcodeUndecodable;
+  Neighbour nb{};
+  for (uint8_t rank = 0U; neighbourAt(rank, nb); ++rank) {
+    const std::string key = "nbr_" + std::to_string(nb.id) + "_";
+    m[key + "rssi"] = nb.rssiDbm;
+    m[key + "snr"] = nb.snrDb;
+    m[key + "prr"] = nb.prrPct;
+    m[key + "heard"] = nb.heard;
+  }
+  uint32_t erasesMin = sim::flashErases(0U);
+  uint32_t erasesMax = erasesMin;
+  for (uint8_t page = 1U; page < STORE_PAGES; ++page) {
+    erasesMin = std::min(erasesMin, sim::flashErases(page));
+    erasesMax = std::max(erasesMax, sim::flashErases(page));
+  }
+  m["store_erases_min"] = erasesMin;
+  m["store_erases_max"] = erasesMax;
+  m["tx_sent"] = st.txSent;
+  m["tx_drop_queue"] = st.txDropQueue;
+  m["tx_superseded"] = st.txSuperseded;
+  m["tx_fragments"] = st.txFragments;
+  m["tx_queue_high_water"] = st.txQueueHighWater;
+  m["latency_avg_ms"] = latencies.empty() ? 0.0 : static_cast<double>(latencySum / latencies.size());
+  m["latency_p95_ms"] = percentile(latencies, 95U);
+  m["latency_max_ms"] = percentile(latencies, 100U);
+  m["cpu_ns_per_frame"] = events.empty() ? 0.0 : static_cast<double>(tickNs / events.size());
+  m["tick_ns_max"] = static_cast<double>(tickNsMax);
+  m["report_slowdown"] = reportRateSlowdown();
+  m["phy_profile"] = radioProfileId();
+  m["phy_switches"] = sim::logCount("PHYSW") + sim::logCount("PHYJOIN");
+  m["phy_fallbacks"] = sim::logCount("PHYFB");
+  m["tdma_synced"] = tdmaSynced(sim::now()) ? 1.0 : 0.0;
+  m["tdma_offset_ms"] = tdmaOffsetMs();
+  m["tdma_own_tx"] = ownTx;
+  m["tdma_own_tx_in_slot"] = ownTxInSlot;
+
+  for (const auto& kv : m) {
+    std::printf("%s=%.0f\n", kv.first.c_str(), kv.second);
+  }
+
+  if ((opt.checkFile != nullptr) && !runChecks(opt.checkFile, m)) {
+    return 1;
+  }
+  return 0;
+}
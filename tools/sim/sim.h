@@ -0,0 +1,49 @@
+#ifndef SIM_H
+#define SIM_H
+
+// Driver-side controls for the host simulation of one node.
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace sim {
+
+struct TxRecord {
+  uint32_t startMs;
+  uint32_t endMs;
+  uint8_t len;
+  uint8_t profileId;  // PHY profile the frame went out on.
+  uint8_t data[255];
+};
+
+// Virtual clock. radioSend() advances it by the frame airtime (WAIT_TX).
+uint32_t now();
+void setNow(uint32_t ms);
+
+// Bytes the node will read from its UART. The RX ring holds 64 bytes like
+// the STM32 core; bytes that do not fit are dropped and counted.
+void serialInject(const char* data, size_t len);
+size_t serialPending();
+uint32_t serialRxDropped();
+uint64_t serialTxBytes();
+
+// A frame whose reception finished at `atMs` (<= now()). Lost if the radio
+// was transmitting then; overwrites an unread frame (the SX126x keeps one).
+void radioDeliver(uint32_t atMs, const uint8_t* frame, uint8_t len, int16_t rssi, int8_t snr);
+size_t radioTxCount();
+const TxRecord& radioTx(size_t i);
+uint32_t radioRxLostBusy();
+uint32_t radioRxOverwritten();
+uint32_t airtimeMs(uint8_t len);
+
+// Page erases of the emulated spare flash (boardFlash*()), for wear checks.
+uint32_t flashErases(uint8_t page);
+
+// Counts of log tags emitted by the firmware (e.g. "FQSAT").
+uint32_t logCount(const char* tag);
+void logSetEcho(bool on);
+void resetCounters();
+
+}  // namespace sim
+
+#endif  // SIM_H
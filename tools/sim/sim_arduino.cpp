@@ -0,0 +1,115 @@
+#include <Arduino.h>
+
+#include <deque>
+
+#include "sim.h"
+
+SimSerial Serial;
+
+namespace {
+
+// STM32duino HardwareSerial default RX ring (SERIAL_RX_BUFFER_SIZE).
+constexpr size_t SERIAL_RX_CAPACITY = 64U;
+
+uint32_t gNowMs = 0U;
+uint32_t gRandState = 1U;
+std::deque<uint8_t> gSerialRx;
+uint64_t gSerialTx = 0U;
+uint32_t gSerialRxDropped = 0U;
+
+}  // namespace
+
+namespace sim {
+
+uint32_t now() {
+  return gNowMs;
+}
+
+void setNow(uint32_t ms) {
+  gNowMs = ms;
+}
+
+void serialInject(const char* data, size_t len) {
+  for (size_t i = 0U; i < len; ++i) {
+    if (gSerialRx.size() >= SERIAL_RX_CAPACITY) {
+      ++gSerialRxDropped;
+      continue;
+    }
+    gSerialRx.push_back(static_cast<uint8_t>(data[i]));
+  }
+}
+
+uint32_t serialRxDropped() {
+  return gSerialRxDropped;
+}
+
+size_t serialPending() {
+  return gSerialRx.size();
+}
+
+uint64_t serialTxBytes() {
+  return gSerialTx;
+}
+
+}  // namespace sim
+
+uint32_t millis() {
+  return gNowMs;
+}
+
+uint32_t micros() {
+  return gNowMs * 1000U;
+}
+
+void delay(uint32_t ms) {
+  gNowMs += ms;
+}
+
+void delayMicroseconds(uint32_t) {}
+
+// Deterministic LCG so replays are reproducible run to run.
+long random(long maxExclusive) {
+  gRandState = (gRandState * 1103515245U) + 12345U;
+  if (maxExclusive <= 0) {
+    return 0;
+  }
+  return static_cast<long>((gRandState >> 8) % static_cast<uint32_t>(maxExclusive));
+}
+
+long random(long minInclusive, long maxExclusive) {
+  if (maxExclusive <= minInclusive) {
+    return minInclusive;
+  }
+  return minInclusive + random(maxExclusive - minInclusive);
+}
+
+void randomSeed(uint32_t seed) {
+  gRandState = (seed == 0U) ? 1U : seed;
+}
+
+int SimSerial::available() {
+  return static_cast<int>(gSerialRx.size());
+}
+
+int SimSerial::read() {
+  if (gSerialRx.empty()) {
+    return -1;
+  }
+  const uint8_t b = gSerialRx.front();
+  gSerialRx.pop_front();
+  return b;
+}
+
+int SimSerial::availableForWrite() {
+  return 256;
+}
+
+size_t SimSerial::write(uint8_t) {
+  ++gSerialTx;
+  return 1U;
+}
+
+size_t SimSerial::write(const uint8_t*, size_t len) {
+  gSerialTx += len;
+  return len;
+}
@@ -0,0 +1,85 @@
+#include "board.h"
+
+#include "config.h"
+#include "sim.h"
+
+namespace {
+
+// Behaves like the F103 array: erase sets a page to 0xFF, programming can
+// only clear bits.
+uint8_t gFlash[STORE_PAGES][STORE_PAGE_SIZE];
+uint32_t gFlashErases[STORE_PAGES] = {};
+bool gFlashReady = false;
+
+void flashReady() {
+  if (gFlashReady) {
+    return;
+  }
+  for (uint8_t p = 0U; p < STORE_PAGES; ++p) {
+    for (uint16_t i = 0U; i < STORE_PAGE_SIZE; ++i) {
+      gFlash[p][i] = 0xFFU;
+    }
+  }
+  gFlashReady = true;
+}
+
+}  // namespace
+
+namespace sim {
+
+uint32_t flashErases(uint8_t page) {
+  return (page < STORE_PAGES) ? gFlashErases[page] : 0U;
+}
+
+}  // namespace sim
+
+void boardInit() {}
+
+void boardLedSet(bool) {}
+
+uint8_t boardBootId() {
+  return 0x42U;
+}
+
+uint16_t battReadMv() {
+  return 3700U;
+}
+
+// The host image lives elsewhere.
+bool boardFlashStoreFree() {
+  return true;
+}
+
+bool boardFlashErase(uint8_t page) {
+  flashReady();
+  if (page >= STORE_PAGES) {
+    return false;
+  }
+  for (uint16_t i = 0U; i < STORE_PAGE_SIZE; ++i) {
+    gFlash[page][i] = 0xFFU;
+  }
+  ++gFlashErases[page];
+  return true;
+}
+
+bool boardFlashWrite(uint8_t page, uint16_t offset, const uint8_t* data, uint16_t len) {
+  flashReady();
+  if ((page >= STORE_PAGES) || ((offset & 1U) != 0U) ||
+      ((static_cast<uint32_t>(offset) + len) > STORE_PAGE_SIZE)) {
+    return false;
+  }
+  bool ok = true;
+  for (uint16_t i = 0U; i < len; ++i) {
+    uint8_t& cell = gFlash[page][offset + i];
+    ok = ok && ((cell & data[i]) == data[i]);
+    cell = static_cast<uint8_t>(cell & data[i]);
+  }
+  return ok;
+}
+
+void boardFlashRead(uint8_t page, uint16_t offset, uint8_t* out, uint16_t len) {
+  flashReady();
+  for (uint16_t i = 0U; i < len; ++i) {
+    out[i] = gFlash[page][offset + i];
+  }
+}
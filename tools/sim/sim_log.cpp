@@ -0,0 +1,62 @@
+#include "log.h"
+
+#include <cstdio>
+#include <map>
+#include <string>
+
+#include "sim.h"
+
+namespace {
+
+std::map<std::string, uint32_t> gTagCounts;
+bool gEcho = false;
+
+void count(const char* tag) {
+  ++gTagCounts[tag];
+}
+
+}  // namespace
+
+namespace sim {
+
+uint32_t logCount(const char* tag) {
+  const auto it = gTagCounts.find(tag);
+  return (it == gTagCounts.end()) ? 0U : it->second;
+}
+
+void logSetEcho(bool on) {
+  gEcho = on;
+}
+
+void resetCounters() {
+  gTagCounts.clear();
+}
+
+}  // namespace sim
+
+void logInit() {}
+
+void logEvent(const char* tag) {
+  count(tag);
+  if (gEcho) {
+    std::printf("%u %s\n", sim::now(), tag);
+  }
+}
+
+void logEvent2(const char* tag, int32_t v) {
+  count(tag);
+  if (gEcho) {
+    std::printf("%u %s %d\n", sim::now(), tag, v);
+  }
+}
+
+void logEvent3(const char* tag, int32_t v1, int32_t v2) {
+  count(tag);
+  if (gEcho) {
+    std::printf("%u %s %d %d\n", sim::now(), tag, v1, v2);
+  }
+}
+
+void logHex8(const char* tag, const uint8_t[8]) {
+  count(tag);
+}
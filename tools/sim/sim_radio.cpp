@@ -0,0 +1,139 @@
+#include "radio.h"
+
+#include <cstring>
+#include <vector>
+
+#include "config.h"
+#include "phy.h"
+#include "sim.h"
+
+namespace {
+
+struct PendingRx {
+  bool valid;
+  uint8_t len;
+  uint8_t data[255];
+  int16_t rssi;
+  int8_t snr;
+};
+
+PendingRx gPending = {};
+std::vector<sim::TxRecord> gTx;
+uint32_t gBusyUntilMs = 0U;  // End of the last transmission.
+uint32_t gLostBusy = 0U;
+uint32_t gOverwritten = 0U;
+int16_t gLastRssi = 0;
+int8_t gLastSnr = 0;
+uint8_t gProfileId = PHY_PROFILE_DEFAULT;
+
+}  // namespace
+
+namespace sim {
+
+// Time on air for the active profile; same formula the firmware schedules with.
+uint32_t airtimeMs(uint8_t len) {
+  return phyAirtimeMs(PHY_PROFILES[gProfileId], len);
+}
+
+void radioDeliver(uint32_t atMs, const uint8_t* frame, uint8_t len, int16_t rssi, int8_t snr) {
+  for (size_t i = gTx.size(); i > 0U; --i) {
+    const TxRecord& tx = gTx[i - 1U];
+    if (static_cast<int32_t>(tx.endMs - atMs) <= 0) {
+      break;
+    }
+    if (static_cast<int32_t>(atMs - tx.startMs) >= 0) {
+      ++gLostBusy;
+      return;
+    }
+  }
+  if (gPending.valid) {
+    ++gOverwritten;
+  }
+  gPending.valid = true;
+  gPending.len = len;
+  std::memcpy(gPending.data, frame, len);
+  gPending.rssi = rssi;
+  gPending.snr = snr;
+}
+
+size_t radioTxCount() {
+  return gTx.size();
+}
+
+const TxRecord& radioTx(size_t i) {
+  return gTx[i];
+}
+
+uint32_t radioRxLostBusy() {
+  return gLostBusy;
+}
+
+uint32_t radioRxOverwritten() {
+  return gOverwritten;
+}
+
+}  // namespace sim
+
+bool radioInit() {
+  return true;
+}
+
+// Mirrors the blocking WAIT_TX send: the node is stuck for the airtime.
+bool radioSend(const uint8_t* data, uint8_t len) {
+  sim::TxRecord rec = {};
+  rec.startMs = sim::now();
+  rec.endMs = rec.startMs + sim::airtimeMs(len);
+  rec.len = len;
+  rec.profileId = gProfileId;
+  std::memcpy(rec.data, data, len);
+  gTx.push_back(rec);
+
+  gPending.valid = false;  // Half duplex: anything half-received is gone.
+  gBusyUntilMs = rec.endMs;
+  sim::setNow(rec.endMs);
+  return true;
+}
+
+bool radioStartRx() {
+  return true;
+}
+
+bool radioIsIdle() {
+  return static_cast<int32_t>(sim::now() - gBusyUntilMs) >= 0;
+}
+
+uint8_t radioRead(uint8_t* out, uint8_t maxLen) {
+  if (!gPending.valid) {
+    return 0U;
+  }
+  gPending.valid = false;
+  const uint8_t n = (gPending.len < maxLen) ? gPending.len : maxLen;
+  std::memcpy(out, gPending.data, n);
+  gLastRssi = gPending.rssi;
+  gLastSnr = gPending.snr;
+  return n;
+}
+
+int16_t radioLastRssi() {
+  return gLastRssi;
+}
+
+int8_t radioLastSnr() {
+  return gLastSnr;
+}
+
+bool radioApplyProfile(uint8_t profileId) {
+  if (profileId >= PHY_PROFILE_COUNT) {
+    return false;
+  }
+  gProfileId = profileId;
+  return true;
+}
+
+uint8_t radioProfileId() {
+  return gProfileId;
+}
+
+uint8_t radioLastCode() {
+  return 0U;
+}
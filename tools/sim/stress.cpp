@@ -0,0 +1,297 @@
+// End-to-end throughput stress benchmark for one node's appTick().
+//
+// Build: python tools/sim/build.py stress -o stress
+//
+// Usage: stress [--step-ms MS] [--seed N] [--uart-rate LPS]
+//   Sweeps synthetic RX load (Poisson arrivals, random sources, frame sizes
+//   and TTLs) upward and reports the highest rate the node sustains before
+//   FQSAT, QSAT or UOVR appear, or before it fails to service its inputs
+//   (more than 1% of frames overwritten in the radio RX buffer, or any byte
+//   lost to a full serial RX ring while blocked in TX). Then sweeps UART
+//   frequency lines the same way. Each step runs in a forked child so every
+//   step starts from a freshly booted node.
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "app.h"
+#include "config.h"
+#include "frame_codec.h"
+#include "sim.h"
+
+namespace {
+
+constexpr uint32_t START_MS = 1000U;
+constexpr double SERIAL_BYTE_MS = 10.0 * 1000.0 / static_cast<double>(UART_BAUD);
+
+struct Options {
+  uint32_t stepMs = 30000U;
+  uint32_t seed = 30U;
+  double baseUartRate = 1.0;
+};
+
+struct StepResult {
+  double rxRate;
+  double uartRate;
+  uint32_t offered;
+  uint32_t rxFrames;
+  uint32_t lostBusy;
+  uint32_t overwritten;
+  uint32_t fqsat;
+  uint32_t qsat;
+  uint32_t uovr;
+  uint32_t serialDropped;
+  uint32_t fwdSent;
+  uint32_t fwdDropRate;
+  uint64_t tickP50Ns;
+  uint64_t tickP90Ns;
+  uint64_t tickP99Ns;
+  uint64_t tickMaxNs;
+  bool saturated;
+};
+
+struct UartByte {
+  double atMs;
+  char ch;
+};
+
+uint64_t pct(std::vector<uint64_t>& v, uint32_t p) {
+  if (v.empty()) {
+    return 0U;
+  }
+  const size_t idx = ((v.size() - 1U) * p) / 100U;
+  std::nth_element(v.begin(), v.begin() + static_cast<long>(idx), v.end());
+  return v[idx];
+}
+
+uint8_t buildRandomFrame(std::mt19937& rng, uint16_t seq, uint8_t* out) {
+  codec::Header h{};
+  h.netId = NET_ID;
+  h.src = static_cast<uint8_t>(2U + (rng() % 200U));
+  h.dst = 0xFFU;
+  h.bootId = static_cast<uint8_t>(rng());
+  h.seq = seq;
+  h.ttl = static_cast<uint8_t>(rng() % (DATA_TTL + 1U));
+  h.hops = static_cast<uint8_t>(rng() % 4U);
+  if ((rng() % 5U) == 0U) {
+    return codec::buildPing(h, out);
+  }
+  uint16_t freqs[MAX_FREQS];
+  const uint8_t count = static_cast<uint8_t>(rng() % (MAX_FREQS + 1U));
+  for (uint8_t i = 0U; i < count; ++i) {
+    freqs[i] = static_cast<uint16_t>(430U + (rng() % 10U));
+  }
+  return codec::buildReport(h, freqs, count, 0x07U, 1U, out, 64U);
+}
+
+void queueUartLine(std::mt19937& rng, double atMs, std::deque<UartByte>& out) {
+  char line[64];
+  int n = 0;
+  const uint32_t count = 1U + (rng() % MAX_FREQS);
+  for (uint32_t i = 0U; i < count; ++i) {
+    n += std::snprintf(&line[n], sizeof(line) - static_cast<size_t>(n), i == 0U ? "%u" : ",%u",
+                       static_cast<unsigned>(430U + (rng() % 10U)));
+  }
+  line[n++] = '\n';
+  // Lines arrive back to back on the wire; never before the previous one ends.
+  double t = out.empty() ? atMs : std::max(atMs, out.back().atMs + SERIAL_BYTE_MS);
+  for (int i = 0; i < n; ++i) {
+    out.push_back(UartByte{t, line[i]});
+    t += SERIAL_BYTE_MS;
+  }
+}
+
+StepResult runStep(double rxRate, double uartRate, const Options& opt) {
+  std::mt19937 rng(opt.seed);
+  std::exponential_distribution<double> rxGap(rxRate > 0.0 ? rxRate / 1000.0 : 1.0);
+  std::exponential_distribution<double> uartGap(uartRate > 0.0 ? uartRate / 1000.0 : 1.0);
+
+  sim::setNow(0U);
+  appInit();
+  sim::setNow(START_MS);
+
+  const double endMs = static_cast<double>(START_MS + opt.stepMs);
+  double nextRx = (rxRate > 0.0) ? START_MS + rxGap(rng) : endMs + 1.0;
+  double nextLine = (uartRate > 0.0) ? START_MS + uartGap(rng) : endMs + 1.0;
+  std::deque<UartByte> uartBytes;
+  std::vector<uint64_t> tickNs;
+  tickNs.reserve(opt.stepMs);
+
+  StepResult r{};
+  r.rxRate = rxRate;
+  r.uartRate = uartRate;
+  uint16_t seq = 0U;
+
+  while (static_cast<double>(sim::now()) < endMs) {
+    const uint32_t nowMs = sim::now();
+    while (nextRx <= nowMs) {
+      uint8_t frame[64];
+      const uint8_t len = buildRandomFrame(rng, seq++, frame);
+      sim::radioDeliver(static_cast<uint32_t>(nextRx), frame, len, -90, 3);
+      ++r.offered;
+      nextRx += rxGap(rng);
+    }
+    while (nextLine <= nowMs) {
+      queueUartLine(rng, nextLine, uartBytes);
+      nextLine += uartGap(rng);
+    }
+    while (!uartBytes.empty() && (uartBytes.front().atMs <= nowMs)) {
+      sim::serialInject(&uartBytes.front().ch, 1U);
+      uartBytes.pop_front();
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+    appTick(nowMs);
+    const auto t1 = std::chrono::steady_clock::now();
+    tickNs.push_back(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()));
+
+    if (sim::now() == nowMs) {
+      sim::setNow(nowMs + 1U);
+    }
+  }
+
+  const AppStats& st = appStats();
+  r.rxFrames = st.rxFrames;
+  r.lostBusy = sim::radioRxLostBusy();
+  r.overwritten = sim::radioRxOverwritten();
+  r.fqsat = sim::logCount("FQSAT");
+  r.qsat = sim::logCount("QSAT");
+  r.uovr = sim::logCount("UOVR");
+  r.serialDropped = sim::serialRxDropped();
+  r.fwdSent = st.fwdSent;
+  r.fwdDropRate = st.fwdDropRate;
+  r.tickP50Ns = pct(tickNs, 50U);
+  r.tickP90Ns = pct(tickNs, 90U);
+  r.tickP99Ns = pct(tickNs, 99U);
+  r.tickMaxNs = pct(tickNs, 100U);
+  const bool radioServiceLoss = (r.offered > 0U) && ((r.overwritten * 100U) > r.offered);
+  r.saturated = (r.fqsat > 0U) || (r.qsat > 0U) || (r.uovr > 0U) || radioServiceLoss || (r.serialDropped > 0U);
+  return r;
+}
+
+// Firmware state is global, so each step gets a fresh process.
+bool runStepIsolated(double rxRate, double uartRate, const Options& opt, StepResult& out) {
+  int fds[2];
+  if (pipe(fds) != 0) {
+    return false;
+  }
+  const pid_t pid = fork();
+  if (pid < 0) {
+    return false;
+  }
+  if (pid == 0) {
+    close(fds[0]);
+    const StepResult r = runStep(rxRate, uartRate, opt);
+    const ssize_t w = write(fds[1], &r, sizeof(r));
+    _exit(w == static_cast<ssize_t>(sizeof(r)) ? 0 : 1);
+  }
+  close(fds[1]);
+  const ssize_t n = read(fds[0], &out, sizeof(out));
+  close(fds[0]);
+  int status = 0;
+  waitpid(pid, &status, 0);
+  return (n == static_cast<ssize_t>(sizeof(out))) && WIFEXITED(status) && (WEXITSTATUS(status) == 0);
+}
+
+void printStep(const char* sweep, const StepResult& r) {
+  std::printf("%s rx_fps=%.2f uart_lps=%.2f offered=%u rx=%u lost_busy=%u overwritten=%u fqsat=%u qsat=%u "
+              "uovr=%u serial_drop=%u fwd_sent=%u fwd_drop_rate=%u tick_ns_p50=%llu p90=%llu p99=%llu max=%llu%s\n",
+              sweep,
+              r.rxRate,
+              r.uartRate,
+              r.offered,
+              r.rxFrames,
+              r.lostBusy,
+              r.overwritten,
+              r.fqsat,
+              r.qsat,
+              r.uovr,
+              r.serialDropped,
+              r.fwdSent,
+              r.fwdDropRate,
+              static_cast<unsigned long long>(r.tickP50Ns),
+              static_cast<unsigned long long>(r.tickP90Ns),
+              static_cast<unsigned long long>(r.tickP99Ns),
+              static_cast<unsigned long long>(r.tickMaxNs),
+              r.saturated ? " SAT" : "");
+}
+
+// Geometric ramp to the first saturated step, then bisection between the
+// last good and first bad rate. Returns the highest sustained rate.
+double sweep(const char* name, bool rxSweep, const Options& opt, StepResult& best) {
+  double good = 0.0;
+  double bad = 0.0;
+  double rate = 0.25;
+  StepResult r{};
+  while (rate <= 512.0) {
+    if (!runStepIsolated(rxSweep ? rate : 0.0, rxSweep ? opt.baseUartRate : rate, opt, r)) {
+      return good;
+    }
+    printStep(name, r);
+    if (r.saturated) {
+      bad = rate;
+      break;
+    }
+    good = rate;
+    best = r;
+    rate *= 2.0;
+  }
+  if (bad == 0.0) {
+    return good;
+  }
+  for (int i = 0; i < 5; ++i) {
+    const double mid = (good + bad) / 2.0;
+    if (!runStepIsolated(rxSweep ? mid : 0.0, rxSweep ? opt.baseUartRate : mid, opt, r)) {
+      break;
+    }
+    printStep(name, r);
+    if (r.saturated) {
+      bad = mid;
+    } else {
+      good = mid;
+      best = r;
+    }
+  }
+  return good;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opt{};
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--step-ms") == 0 && (i + 1) < argc) {
+      opt.stepMs = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 0));
+    } else if (std::strcmp(argv[i], "--seed") == 0 && (i + 1) < argc) {
+      opt.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 0));
+    } else if (std::strcmp(argv[i], "--uart-rate") == 0 && (i + 1) < argc) {
+      opt.baseUartRate = std::strtod(argv[++i], nullptr);
+    } else {
+      std::fprintf(stderr, "usage: stress [--step-ms MS] [--seed N] [--uart-rate LPS]\n");
+      return 2;
+    }
+  }
+
+  StepResult bestRx{};
+  StepResult bestUart{};
+  const double maxRx = sweep("rx", true, opt, bestRx);
+  const double maxUart = sweep("uart", false, opt, bestUart);
+
+  std::printf("max_rx_fps=%.2f\n", maxRx);
+  std::printf("max_uart_lines_per_s=%.2f\n", maxUart);
+  std::printf("tick_ns_p50=%llu\ntick_ns_p90=%llu\ntick_ns_p99=%llu\ntick_ns_max=%llu\n",
+              static_cast<unsigned long long>(bestRx.tickP50Ns),
+              static_cast<unsigned long long>(bestRx.tickP90Ns),
+              static_cast<unsigned long long>(bestRx.tickP99Ns),
+              static_cast<unsigned long long>(bestRx.tickMaxNs));
+  return 0;
+}
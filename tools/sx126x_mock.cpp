@@ -0,0 +1,138 @@
+// Host mock of the SX126x bus: drives src/sx126x.cpp from a script and
+// prints every NSS frame, so command sequences can be checked against the
+// datasheet without hardware.
+//
+// Build: g++ -O2 -std=c++17 -Isrc src/sx126x.cpp tools/sx126x_mock.cpp -o sx126x_mock
+//
+// Script (stdin), one step per line:
+//   reply HEX            bytes returned by the next read frames, in order
+//   stuck N              BUSY stays high for the next N waits
+//   status | standby | rx | irq
+//   setup FREQ_HZ TCXO SYNC_HEX
+//   modem SF BW_HZ CR POWER_DBM
+//   tx HEX TIMEOUT_MS
+//   clear MASK_HEX
+//   read MAX_LEN
+// Output: "> CMD_HEX [w PAYLOAD_HEX | r N]" per frame, then "= ok" or
+// "= fail" per step, plus any values read.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "sx126x.h"
+
+namespace {
+
+std::deque<uint8_t> gReplies;
+unsigned gStuck = 0U;
+
+void printHex(const uint8_t* data, size_t len) {
+  for (size_t i = 0U; i < len; ++i) {
+    std::printf("%02X", data[i]);
+  }
+}
+
+std::vector<uint8_t> parseHex(const char* text) {
+  std::vector<uint8_t> out;
+  for (size_t i = 0U; (text[i] != '\0') && (text[i + 1U] != '\0'); i += 2U) {
+    const char pair[3] = {text[i], text[i + 1U], '\0'};
+    out.push_back(static_cast<uint8_t>(std::strtoul(pair, nullptr, 16)));
+  }
+  return out;
+}
+
+void result(bool ok) {
+  std::printf("= %s\n", ok ? "ok" : "fail");
+}
+
+}  // namespace
+
+bool sx126xBusWaitReady(uint32_t) {
+  if (gStuck > 0U) {
+    --gStuck;
+    return false;
+  }
+  return true;
+}
+
+void sx126xBusCommand(const uint8_t* cmd, uint8_t cmdLen, const uint8_t* tx, uint8_t* rx, uint8_t len) {
+  std::printf("> ");
+  printHex(cmd, cmdLen);
+  if ((len > 0U) && (tx != nullptr)) {
+    std::printf(" w ");
+    printHex(tx, len);
+  } else if (len > 0U) {
+    std::printf(" r %u", len);
+    for (uint8_t i = 0U; i < len; ++i) {
+      rx[i] = gReplies.empty() ? 0x00U : gReplies.front();
+      if (!gReplies.empty()) {
+        gReplies.pop_front();
+      }
+    }
+  }
+  std::printf("\n");
+}
+
+int main() {
+  char line[1024];
+  while (std::fgets(line, sizeof(line), stdin) != nullptr) {
+    char op[16] = {0};
+    char arg[600] = {0};
+    unsigned long a = 0UL;
+    unsigned long b = 0UL;
+    unsigned long c = 0UL;
+    long d = 0L;
+    if (std::sscanf(line, "%15s", op) != 1) {
+      continue;
+    }
+    const std::string cmd(op);
+    if ((cmd == "reply") && (std::sscanf(line, "%*s %599s", arg) == 1)) {
+      for (uint8_t byte : parseHex(arg)) {
+        gReplies.push_back(byte);
+      }
+    } else if ((cmd == "stuck") && (std::sscanf(line, "%*s %lu", &a) == 1)) {
+      gStuck = static_cast<unsigned>(a);
+    } else if (cmd == "status") {
+      uint8_t status = 0U;
+      const bool ok = sx126xGetStatus(status);
+      std::printf("status=%02X\n", status);
+      result(ok);
+    } else if (cmd == "standby") {
+      result(sx126xSetStandby());
+    } else if (cmd == "rx") {
+      result(sx126xStartRx());
+    } else if (cmd == "irq") {
+      uint16_t irq = 0U;
+      const bool ok = sx126xIrqStatus(irq);
+      std::printf("irq=%04X\n", irq);
+      result(ok);
+    } else if ((cmd == "setup") && (std::sscanf(line, "%*s %lu %lu %lx", &a, &b, &c) == 3)) {
+      result(sx126xSetup(static_cast<uint32_t>(a), b != 0UL, static_cast<uint16_t>(c)));
+    } else if ((cmd == "modem") && (std::sscanf(line, "%*s %lu %lu %lu %ld", &a, &b, &c, &d) == 4)) {
+      result(sx126xSetModem(static_cast<uint8_t>(a), static_cast<uint32_t>(b), static_cast<uint8_t>(c),
+                            static_cast<int8_t>(d)));
+    } else if ((cmd == "tx") && (std::sscanf(line, "%*s %599s %lu", arg, &a) == 2)) {
+      const std::vector<uint8_t> payload = parseHex(arg);
+      result(sx126xStartTx(payload.data(), static_cast<uint8_t>(payload.size()), static_cast<uint32_t>(a)));
+    } else if ((cmd == "clear") && (std::sscanf(line, "%*s %lx", &a) == 1)) {
+      result(sx126xClearIrq(static_cast<uint16_t>(a)));
+    } else if ((cmd == "read") && (std::sscanf(line, "%*s %lu", &a) == 1)) {
+      uint8_t out[255];
+      int16_t rssi = 0;
+      int8_t snr = 0;
+      const uint8_t len = sx126xReadPacket(out, static_cast<uint8_t>(a), rssi, snr);
+      std::printf("packet len=%u rssi=%d snr=%d data=", len, rssi, snr);
+      printHex(out, len);
+      std::printf("\n");
+      result(len > 0U);
+    } else {
+      std::fprintf(stderr, "bad step: %s", line);
+      return 2;
+    }
+  }
+  return 0;
+}